@@ -90,6 +90,7 @@ connection_recv(UA_Connection *connection, UA_ByteString *response,
         return UA_STATUSCODE_BADCONNECTIONCLOSED;
 
     /* Listen on the socket for the given timeout until a message arrives */
+#ifndef UA_ENABLE_EPOLL
     fd_set fdset;
     FD_ZERO(&fdset);
     UA_fd_set(connection->sockfd, &fdset);
@@ -97,6 +98,14 @@ connection_recv(UA_Connection *connection, UA_ByteString *response,
     struct timeval tmptv = {(long int)(timeout_usec / 1000000),
                             (int)(timeout_usec % 1000000)};
     int resultsize = UA_select(connection->sockfd+1, &fdset, NULL, NULL, &tmptv);
+#else
+    /* The socket can be beyond FD_SETSIZE. Use poll instead of select. */
+    struct pollfd pfd;
+    pfd.fd = connection->sockfd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    int resultsize = poll(&pfd, 1, (int)timeout);
+#endif
 
     /* No result */
     if(resultsize == 0)
@@ -161,9 +170,20 @@ connection_recv(UA_Connection *connection, UA_ByteString *response,
 #define NOHELLOTIMEOUT 120000 /* timeout in ms before close the connection
                                * if server does not receive Hello Message */
 
+#ifdef UA_ENABLE_EPOLL
+#define MAXEPOLLEVENTS 256 /* Maximum number of events processed per listen */
+#endif
+
 typedef struct ConnectionEntry {
     UA_Connection connection;
     LIST_ENTRY(ConnectionEntry) pointers;
+#ifdef UA_ENABLE_EPOLL
+    /* Connections are added to the tail of the "opening" queue. Since the
+     * openingDate is monotonic, the Hello timeout only needs to look at the
+     * head of the queue. */
+    TAILQ_ENTRY(ConnectionEntry) openingPointers;
+    UA_Boolean opening; /* Contained in the opening queue */
+#endif
 } ConnectionEntry;
 
 typedef struct {
@@ -174,6 +194,10 @@ typedef struct {
     UA_UInt16 serverSocketsSize;
     LIST_HEAD(, ConnectionEntry) connections;
     UA_UInt16 connectionsSize;
+#ifdef UA_ENABLE_EPOLL
+    int epollfd;
+    TAILQ_HEAD(, ConnectionEntry) openingConnections;
+#endif
 } ServerNetworkLayerTCP;
 
 static void
@@ -181,6 +205,24 @@ ServerNetworkLayerTCP_freeConnection(UA_Connection *connection) {
     UA_free(connection);
 }
 
+/* Remove the connection from the layer and close the socket. The connection
+ * itself is freed by the caller. */
+static void
+ServerNetworkLayerTCP_unlinkConnection(ServerNetworkLayerTCP *layer,
+                                       ConnectionEntry *e) {
+    LIST_REMOVE(e, pointers);
+    layer->connectionsSize--;
+#ifdef UA_ENABLE_EPOLL
+    if(e->opening) {
+        TAILQ_REMOVE(&layer->openingConnections, e, openingPointers);
+        e->opening = false;
+    }
+    if(layer->epollfd >= 0)
+        epoll_ctl(layer->epollfd, EPOLL_CTL_DEL, e->connection.sockfd, NULL);
+#endif
+    UA_close(e->connection.sockfd);
+}
+
 /* This performs only 'shutdown'. 'close' is called when the shutdown
  * socket is returned from select. */
 static void
@@ -196,9 +238,7 @@ purgeFirstConnectionWithoutChannel(ServerNetworkLayerTCP *layer) {
     ConnectionEntry *e;
     LIST_FOREACH(e, &layer->connections, pointers) {
         if(e->connection.channel == NULL) {
-            LIST_REMOVE(e, pointers);
-            layer->connectionsSize--;
-            UA_close(e->connection.sockfd);
+            ServerNetworkLayerTCP_unlinkConnection(layer, e);
             e->connection.free(&e->connection);
             return true;
         }
@@ -269,6 +309,25 @@ ServerNetworkLayerTCP_add(UA_ServerNetworkLayer *nl, ServerNetworkLayerTCP *laye
     c->state = UA_CONNECTIONSTATE_OPENING;
     c->openingDate = UA_DateTime_nowMonotonic();
 
+#ifdef UA_ENABLE_EPOLL
+    /* Register the socket for read events. Level-triggered, as only one buffer
+     * is received per event. Remaining data is reported in the next listen. */
+    struct epoll_event event;
+    memset(&event, 0, sizeof(struct epoll_event));
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.ptr = e;
+    if(epoll_ctl(layer->epollfd, EPOLL_CTL_ADD, newsockfd, &event) != 0) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+            UA_LOG_WARNING(layer->logger, UA_LOGCATEGORY_NETWORK,
+                           "Connection %i | Could not register the socket "
+                           "with epoll: %s", (int)newsockfd, errno_str));
+        UA_free(e);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    TAILQ_INSERT_TAIL(&layer->openingConnections, e, openingPointers);
+    e->opening = true;
+#endif
+
     /* Add to the linked list */
     LIST_INSERT_HEAD(&layer->connections, e, pointers);
     if(nl->statistics) {
@@ -348,6 +407,23 @@ addServerSocket(ServerNetworkLayerTCP *layer, struct addrinfo *ai) {
         layer->port = ntohs(returned_addr.sin_port);
     }
 
+#ifdef UA_ENABLE_EPOLL
+    /* Server sockets are identified by a pointer into the serverSockets
+     * array */
+    struct epoll_event event;
+    memset(&event, 0, sizeof(struct epoll_event));
+    event.events = EPOLLIN;
+    event.data.ptr = &layer->serverSockets[layer->serverSocketsSize];
+    if(epoll_ctl(layer->epollfd, EPOLL_CTL_ADD, newsock, &event) != 0) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+            UA_LOG_WARNING(layer->logger, UA_LOGCATEGORY_NETWORK,
+                           "Could not register the server socket "
+                           "with epoll: %s", errno_str));
+        UA_close(newsock);
+        return UA_STATUSCODE_BADCOMMUNICATIONERROR;
+    }
+#endif
+
     layer->serverSockets[layer->serverSocketsSize] = newsock;
     layer->serverSocketsSize++;
     return UA_STATUSCODE_GOOD;
@@ -359,6 +435,16 @@ ServerNetworkLayerTCP_start(UA_ServerNetworkLayer *nl, const UA_String *customHo
 
     ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP *)nl->handle;
 
+#ifdef UA_ENABLE_EPOLL
+    layer->epollfd = epoll_create1(EPOLL_CLOEXEC);
+    if(layer->epollfd < 0) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+            UA_LOG_ERROR(layer->logger, UA_LOGCATEGORY_NETWORK,
+                         "Could not create the epoll instance: %s", errno_str));
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+#endif
+
     /* Get addrinfo of the server and create server sockets */
     char portno[6];
     UA_snprintf(portno, 6, "%d", layer->port);
@@ -411,6 +497,70 @@ ServerNetworkLayerTCP_start(UA_ServerNetworkLayer *nl, const UA_String *customHo
     return UA_STATUSCODE_GOOD;
 }
 
+/* Accept a new connection on a server socket */
+static void
+ServerNetworkLayerTCP_accept(UA_ServerNetworkLayer *nl, ServerNetworkLayerTCP *layer,
+                             UA_SOCKET serverSocket) {
+    struct sockaddr_storage remote;
+    socklen_t remote_size = sizeof(remote);
+    UA_SOCKET newsockfd = UA_accept(serverSocket, (struct sockaddr*)&remote,
+                                    &remote_size);
+    if(newsockfd == UA_INVALID_SOCKET)
+        return;
+
+    UA_LOG_TRACE(layer->logger, UA_LOGCATEGORY_NETWORK,
+                 "Connection %i | New TCP connection on server socket %i",
+                 (int)newsockfd, (int)serverSocket);
+
+    if(ServerNetworkLayerTCP_add(nl, layer, (UA_Int32)newsockfd, &remote) != UA_STATUSCODE_GOOD) {
+        UA_close(newsockfd);
+    }
+}
+
+static void
+ServerNetworkLayerTCP_closeOnTimeout(UA_ServerNetworkLayer *nl, ServerNetworkLayerTCP *layer,
+                                     UA_Server *server, ConnectionEntry *e) {
+    UA_LOG_INFO(layer->logger, UA_LOGCATEGORY_NETWORK,
+                "Connection %i | Closed by the server (no Hello Message)",
+                (int)(e->connection.sockfd));
+    ServerNetworkLayerTCP_unlinkConnection(layer, e);
+    UA_Server_removeConnection(server, &e->connection);
+    if(nl->statistics) {
+        nl->statistics->connectionTimeoutCount--;
+        nl->statistics->currentConnectionCount--;
+    }
+}
+
+/* Receive from a socket with activity and process the messages */
+static void
+ServerNetworkLayerTCP_process(UA_ServerNetworkLayer *nl, ServerNetworkLayerTCP *layer,
+                              UA_Server *server, ConnectionEntry *e) {
+    UA_LOG_TRACE(layer->logger, UA_LOGCATEGORY_NETWORK,
+                 "Connection %i | Activity on the socket",
+                 (int)(e->connection.sockfd));
+
+    UA_ByteString buf = UA_BYTESTRING_NULL;
+    UA_StatusCode retval = connection_recv(&e->connection, &buf, 0);
+
+    if(retval == UA_STATUSCODE_GOOD) {
+        /* Process packets */
+        UA_Server_processBinaryMessage(server, &e->connection, &buf);
+        connection_releaserecvbuffer(&e->connection, &buf);
+    } else if(retval == UA_STATUSCODE_BADCONNECTIONCLOSED) {
+        /* The socket is shutdown but not closed */
+        UA_LOG_INFO(layer->logger, UA_LOGCATEGORY_NETWORK,
+                    "Connection %i | Closed",
+                    (int)(e->connection.sockfd));
+        ServerNetworkLayerTCP_unlinkConnection(layer, e);
+        UA_Server_removeConnection(server, &e->connection);
+        if(nl->statistics) {
+            nl->statistics->currentConnectionCount--;
+        }
+    }
+}
+
+#ifndef UA_ENABLE_EPOLL
+
 /* After every select, reset the sockets to listen on */
 static UA_Int32
 setFDSet(ServerNetworkLayerTCP *layer, fd_set *fdset) {
@@ -458,21 +608,7 @@ ServerNetworkLayerTCP_listen(UA_ServerNetworkLayer *nl, UA_Server *server,
     for(UA_UInt16 i = 0; i < layer->serverSocketsSize; i++) {
         if(!UA_fd_isset(layer->serverSockets[i], &fdset))
             continue;
-
-        struct sockaddr_storage remote;
-        socklen_t remote_size = sizeof(remote);
-        UA_SOCKET newsockfd = UA_accept((UA_SOCKET)layer->serverSockets[i],
-                                  (struct sockaddr*)&remote, &remote_size);
-        if(newsockfd == UA_INVALID_SOCKET)
-            continue;
-
-        UA_LOG_TRACE(layer->logger, UA_LOGCATEGORY_NETWORK,
-                    "Connection %i | New TCP connection on server socket %i",
-                    (int)newsockfd, (int)(layer->serverSockets[i]));
-
-        if(ServerNetworkLayerTCP_add(nl, layer, (UA_Int32)newsockfd, &remote) != UA_STATUSCODE_GOOD) {
-            UA_close(newsockfd);
-        }
+        ServerNetworkLayerTCP_accept(nl, layer, layer->serverSockets[i]);
     }
 
     /* Read from established sockets */
@@ -481,17 +617,7 @@ ServerNetworkLayerTCP_listen(UA_ServerNetworkLayer *nl, UA_Server *server,
     LIST_FOREACH_SAFE(e, &layer->connections, pointers, e_tmp) {
         if((e->connection.state == UA_CONNECTIONSTATE_OPENING) &&
             (now > (e->connection.openingDate + (NOHELLOTIMEOUT * UA_DATETIME_MSEC)))) {
-            UA_LOG_INFO(layer->logger, UA_LOGCATEGORY_NETWORK,
-                        "Connection %i | Closed by the server (no Hello Message)",
-                         (int)(e->connection.sockfd));
-            LIST_REMOVE(e, pointers);
-            layer->connectionsSize--;
-            UA_close(e->connection.sockfd);
-            UA_Server_removeConnection(server, &e->connection);
-            if(nl->statistics) {
-                nl->statistics->connectionTimeoutCount--;
-                nl->statistics->currentConnectionCount--;
-            }
+            ServerNetworkLayerTCP_closeOnTimeout(nl, layer, server, e);
             continue;
         }
 
@@ -499,34 +625,86 @@ ServerNetworkLayerTCP_listen(UA_ServerNetworkLayer *nl, UA_Server *server,
            !UA_fd_isset(e->connection.sockfd, &fdset))
           continue;
 
-        UA_LOG_TRACE(layer->logger, UA_LOGCATEGORY_NETWORK,
-                    "Connection %i | Activity on the socket",
-                    (int)(e->connection.sockfd));
+        ServerNetworkLayerTCP_process(nl, layer, server, e);
+    }
+    return UA_STATUSCODE_GOOD;
+}
 
-        UA_ByteString buf = UA_BYTESTRING_NULL;
-        UA_StatusCode retval = connection_recv(&e->connection, &buf, 0);
-
-        if(retval == UA_STATUSCODE_GOOD) {
-            /* Process packets */
-            UA_Server_processBinaryMessage(server, &e->connection, &buf);
-            connection_releaserecvbuffer(&e->connection, &buf);
-        } else if(retval == UA_STATUSCODE_BADCONNECTIONCLOSED) {
-            /* The socket is shutdown but not closed */
-            UA_LOG_INFO(layer->logger, UA_LOGCATEGORY_NETWORK,
-                        "Connection %i | Closed",
-                        (int)(e->connection.sockfd));
-            LIST_REMOVE(e, pointers);
-            layer->connectionsSize--;
-            UA_close(e->connection.sockfd);
-            UA_Server_removeConnection(server, &e->connection);
-            if(nl->statistics) {
-                nl->statistics->currentConnectionCount--;
-            }
+#else /* UA_ENABLE_EPOLL */
+
+/* Close connections that did not receive a Hello message in time. Connections
+ * that left the opening state are dropped from the queue on the way. So every
+ * connection is looked at only once. */
+static void
+ServerNetworkLayerTCP_checkHelloTimeouts(UA_ServerNetworkLayer *nl,
+                                         ServerNetworkLayerTCP *layer,
+                                         UA_Server *server) {
+    UA_DateTime timeout = UA_DateTime_nowMonotonic() -
+        (NOHELLOTIMEOUT * UA_DATETIME_MSEC);
+    ConnectionEntry *e;
+    while((e = TAILQ_FIRST(&layer->openingConnections))) {
+        if(e->connection.state != UA_CONNECTIONSTATE_OPENING) {
+            TAILQ_REMOVE(&layer->openingConnections, e, openingPointers);
+            e->opening = false;
+            continue;
+        }
+        if(e->connection.openingDate >= timeout)
+            break;
+        ServerNetworkLayerTCP_closeOnTimeout(nl, layer, server, e);
+    }
+}
+
+/* Only the sockets with activity are visited. The cost does not depend on the
+ * number of idle connections. */
+static UA_StatusCode
+ServerNetworkLayerTCP_listen(UA_ServerNetworkLayer *nl, UA_Server *server,
+                             UA_UInt16 timeout) {
+    ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP *)nl->handle;
+
+    if(layer->serverSocketsSize == 0)
+        return UA_STATUSCODE_GOOD;
+
+    ServerNetworkLayerTCP_checkHelloTimeouts(nl, layer, server);
+
+    struct epoll_event events[MAXEPOLLEVENTS];
+    int nfds = epoll_wait(layer->epollfd, events, MAXEPOLLEVENTS, (int)timeout);
+    if(nfds < 0) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+            UA_LOG_DEBUG(layer->logger, UA_LOGCATEGORY_NETWORK,
+                           "Socket epoll_wait failed with %s", errno_str));
+        // we will retry, so do not return bad
+        return UA_STATUSCODE_GOOD;
+    }
+
+    /* Read from established sockets. New connections are accepted afterwards.
+     * Accepting can purge a connection (maxConnections) that might still be
+     * referenced further down in the events array. */
+    UA_Boolean accept = false;
+    for(int i = 0; i < nfds; i++) {
+        void *ptr = events[i].data.ptr;
+        if(ptr >= (void*)layer->serverSockets &&
+           ptr < (void*)&layer->serverSockets[layer->serverSocketsSize]) {
+            accept = true;
+            continue;
         }
+        ServerNetworkLayerTCP_process(nl, layer, server, (ConnectionEntry*)ptr);
+    }
+
+    if(!accept)
+        return UA_STATUSCODE_GOOD;
+
+    /* Accept new connections via the server sockets */
+    for(int i = 0; i < nfds; i++) {
+        UA_SOCKET *serverSocket = (UA_SOCKET*)events[i].data.ptr;
+        if(serverSocket >= layer->serverSockets &&
+           serverSocket < &layer->serverSockets[layer->serverSocketsSize])
+            ServerNetworkLayerTCP_accept(nl, layer, *serverSocket);
     }
     return UA_STATUSCODE_GOOD;
 }
 
+#endif /* UA_ENABLE_EPOLL */
+
 static void
 ServerNetworkLayerTCP_stop(UA_ServerNetworkLayer *nl, UA_Server *server) {
     ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP *)nl->handle;
@@ -547,7 +725,19 @@ ServerNetworkLayerTCP_stop(UA_ServerNetworkLayer *nl, UA_Server *server) {
 
     /* Run recv on client sockets. This picks up the closed sockets and frees
      * the connection. */
+#ifndef UA_ENABLE_EPOLL
     ServerNetworkLayerTCP_listen(nl, server, 0);
+#else
+    /* The listen processes a bounded number of events. Repeat as long as
+     * connections are picked up. The socket is closed in the end. */
+    UA_UInt16 remaining;
+    do {
+        remaining = layer->connectionsSize;
+        ServerNetworkLayerTCP_listen(nl, server, 0);
+    } while(layer->connectionsSize > 0 && layer->connectionsSize < remaining);
+    UA_close(layer->epollfd);
+    layer->epollfd = -1;
+#endif
 
     UA_deinitialize_architecture_network();
 }
@@ -562,15 +752,18 @@ ServerNetworkLayerTCP_deleteMembers(UA_ServerNetworkLayer *nl) {
      * running. So this is safe. */
     ConnectionEntry *e, *e_tmp;
     LIST_FOREACH_SAFE(e, &layer->connections, pointers, e_tmp) {
-        LIST_REMOVE(e, pointers);
-        layer->connectionsSize--;
-        UA_close(e->connection.sockfd);
+        ServerNetworkLayerTCP_unlinkConnection(layer, e);
         UA_free(e);
         if(nl->statistics) {
             nl->statistics->currentConnectionCount--;
         }
     }
 
+#ifdef UA_ENABLE_EPOLL
+    if(layer->epollfd >= 0)
+        UA_close(layer->epollfd);
+#endif
+
     /* Free the layer */
     UA_free(layer);
 }
@@ -596,6 +789,10 @@ UA_ServerNetworkLayerTCP(UA_ConnectionConfig config, UA_UInt16 port,
     layer->logger = logger;
     layer->port = port;
     layer->maxConnections = maxConnections;
+#ifdef UA_ENABLE_EPOLL
+    layer->epollfd = -1;
+    TAILQ_INIT(&layer->openingConnections);
+#endif
 
     return nl;
 }
@@ -31,6 +31,10 @@
 #include <netdb.h>
 #include <sys/ioctl.h>
 #include <sys/select.h>
+#ifdef UA_ENABLE_EPOLL
+# include <poll.h>
+# include <sys/epoll.h>
+#endif
 #include <sys/types.h>
 #include <net/if.h>
 #ifndef UA_sleep_ms
@@ -311,9 +311,11 @@ UA_STATIC_ASSERT(sizeof(bool) == 1, cannot_overlay_integers_with_large_bool);
 /* Atomic Operations
  * -----------------
  * Atomic operations that synchronize across processor cores (for
- * multithreading). Only the inline-functions defined next are used. Replace
- * with architecture-specific operations if necessary. */
-#if UA_MULTITHREADING >= 200
+ * multithreading). They are enabled with the thread-safe API, as the
+ * application can call into the server from several threads. Only the
+ * inline-functions defined next are used. Replace with architecture-specific
+ * operations if necessary. */
+#if UA_MULTITHREADING >= 100
     #ifdef _MSC_VER /* Visual Studio */
     #define UA_atomic_sync() _ReadWriteBarrier()
     #else /* GCC/Clang */
@@ -325,7 +327,7 @@ UA_STATIC_ASSERT(sizeof(bool) == 1, cannot_overlay_integers_with_large_bool);
 
 static UA_INLINE void *
 UA_atomic_xchg(void * volatile * addr, void *newptr) {
-#if UA_MULTITHREADING >= 200
+#if UA_MULTITHREADING >= 100
 #ifdef _MSC_VER /* Visual Studio */
     return _InterlockedExchangePointer(addr, newptr);
 #else /* GCC/Clang */
@@ -340,7 +342,7 @@ UA_atomic_xchg(void * volatile * addr, void *newptr) {
 
 static UA_INLINE void *
 UA_atomic_cmpxchg(void * volatile * addr, void *expected, void *newptr) {
-#if UA_MULTITHREADING >= 200
+#if UA_MULTITHREADING >= 100
 #ifdef _MSC_VER /* Visual Studio */
     return _InterlockedCompareExchangePointer(addr, expected, newptr);
 #else /* GCC/Clang */
@@ -355,9 +357,32 @@ UA_atomic_cmpxchg(void * volatile * addr, void *expected, void *newptr) {
 #endif
 }
 
+static UA_INLINE size_t
+UA_atomic_cmpxchgSize(volatile size_t *addr, size_t expected, size_t newval) {
+#if UA_MULTITHREADING >= 100
+#ifdef _MSC_VER /* Visual Studio */
+# ifdef _WIN64
+    return (size_t)_InterlockedCompareExchange64((volatile __int64*)addr,
+                                                 (__int64)newval, (__int64)expected);
+# else
+    return (size_t)_InterlockedCompareExchange((volatile long*)addr,
+                                               (long)newval, (long)expected);
+# endif
+#else /* GCC/Clang */
+    return __sync_val_compare_and_swap(addr, expected, newval);
+#endif
+#else
+    size_t old = *addr;
+    if(old == expected) {
+        *addr = newval;
+    }
+    return old;
+#endif
+}
+
 static UA_INLINE uint32_t
 UA_atomic_addUInt32(volatile uint32_t *addr, uint32_t increase) {
-#if UA_MULTITHREADING >= 200
+#if UA_MULTITHREADING >= 100
 #ifdef _MSC_VER /* Visual Studio */
     return _InterlockedExchangeAdd(addr, increase) + increase;
 #else /* GCC/Clang */
@@ -371,7 +396,7 @@ UA_atomic_addUInt32(volatile uint32_t *addr, uint32_t increase) {
 
 static UA_INLINE size_t
 UA_atomic_addSize(volatile size_t *addr, size_t increase) {
-#if UA_MULTITHREADING >= 200
+#if UA_MULTITHREADING >= 100
 #ifdef _MSC_VER /* Visual Studio */
     return _InterlockedExchangeAdd(addr, increase) + increase;
 #else /* GCC/Clang */
@@ -385,7 +410,7 @@ UA_atomic_addSize(volatile size_t *addr, size_t increase) {
 
 static UA_INLINE uint32_t
 UA_atomic_subUInt32(volatile uint32_t *addr, uint32_t decrease) {
-#if UA_MULTITHREADING >= 200
+#if UA_MULTITHREADING >= 100
 #ifdef _MSC_VER /* Visual Studio */
     return _InterlockedExchangeSub(addr, decrease) - decrease;
 #else /* GCC/Clang */
@@ -399,7 +424,7 @@ UA_atomic_subUInt32(volatile uint32_t *addr, uint32_t decrease) {
 
 static UA_INLINE size_t
 UA_atomic_subSize(volatile size_t *addr, size_t decrease) {
-#if UA_MULTITHREADING >= 200
+#if UA_MULTITHREADING >= 100
 #ifdef _MSC_VER /* Visual Studio */
     return _InterlockedExchangeSub(addr, decrease) - decrease;
 #else /* GCC/Clang */
@@ -102,6 +102,22 @@ UA_Client_Subscriptions_delete_async(UA_Client *client,
 UA_StatusCode UA_EXPORT
 UA_Client_Subscriptions_deleteSingle(UA_Client *client, UA_UInt32 subscriptionId);
 
+/* Callback for all DataChange notifications of a NotificationMessage at once.
+ * The monContexts array is parallel to notification->monitoredItems and holds
+ * the context of the matching MonitoredItem (NULL if the clientHandle is
+ * unknown). The array is only valid during the callback. */
+typedef void (*UA_Client_DataChangeBatchNotificationCallback)
+    (UA_Client *client, UA_UInt32 subId, void *subContext,
+     UA_DataChangeNotification *notification, void **monContexts);
+
+/* Hand the DataChange notifications of the subscription to a single batch
+ * callback. The callbacks of the individual MonitoredItems are then no longer
+ * called for DataChanges. Set to NULL to return to the individual
+ * callbacks. */
+UA_StatusCode UA_EXPORT
+UA_Client_Subscriptions_setDataChangeBatchCallback(UA_Client *client,
+    UA_UInt32 subscriptionId, UA_Client_DataChangeBatchNotificationCallback callback);
+
 static UA_INLINE UA_SetPublishingModeResponse
 UA_Client_Subscriptions_setPublishingMode(UA_Client *client,
     const UA_SetPublishingModeRequest request) {
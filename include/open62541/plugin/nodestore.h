@@ -257,6 +257,7 @@ typedef struct {
     UA_MethodCallback method;
 #if UA_MULTITHREADING >= 100
     UA_Boolean async; /* Indicates an async method call */
+    UA_Byte asyncPriority; /* Priority lane of the async operations */
 #endif
 } UA_MethodNode;
 
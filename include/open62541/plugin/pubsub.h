@@ -67,6 +67,17 @@ struct UA_PubSubChannel {
     UA_StatusCode (*receive)(UA_PubSubChannel * channel, UA_ByteString *,
                              UA_ExtensionObject *transportSettings, UA_UInt32 timeout);
 
+    /* Receive several messages at once into the buffers provided by the
+     * caller. Waits up to the timeout (in usec) for the first message. Then
+     * takes the messages that are already pending without blocking. The length
+     * of the buffers is set to the size of the received messages. The number
+     * of received messages is returned in received. This is optional. If not
+     * set, the receive method is used. */
+    UA_StatusCode (*receiveMultiple)(UA_PubSubChannel *channel, UA_ByteString *messages,
+                                     size_t messagesSize, size_t *received,
+                                     UA_ExtensionObject *transportSettings,
+                                     UA_UInt32 timeout);
+
     /* Closing the connection and implicit free of the channel structures. */
     UA_StatusCode (*close)(UA_PubSubChannel *channel);
 
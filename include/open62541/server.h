@@ -852,6 +852,17 @@ UA_StatusCode UA_EXPORT UA_THREADSAFE
 UA_Server_setVariableNode_dataSource(UA_Server *server, const UA_NodeId nodeId,
                                      const UA_DataSource dataSource);
 
+/* Cache the value read from the DataSource of the variable for up to maxAge
+ * milliseconds. A cached value is returned for Read requests if it is younger
+ * than the maxAge of the request and for the sampling of MonitoredItems if it
+ * is younger than their sampling interval. The ServerTimestamp of a cached
+ * value is the time when it was read from the DataSource. Reads with an
+ * IndexRange always call the DataSource. Writing to the variable drops the
+ * cached value. A maxAge of zero disables the cache for the variable. */
+UA_StatusCode UA_EXPORT UA_THREADSAFE
+UA_Server_setVariableNode_dataSourceCache(UA_Server *server, const UA_NodeId nodeId,
+                                          UA_Double maxAge);
+
 /**
  * .. _value-callback:
  *
@@ -1325,7 +1336,16 @@ UA_Server_deleteReference(UA_Server *server, const UA_NodeId sourceNodeId,
  * generated automatically and is returned through ``outEventId``. ``NULL`` can be passed if the `EventId` is not
  * needed. ``deleteEventNode`` specifies whether the node representation of the event should be deleted after invoking
  * the method. This can be useful if events with the similar attributes are triggered frequently. ``UA_TRUE`` would
- * cause the node to be deleted. */
+ * cause the node to be deleted.
+ *
+ * The method ``UA_Server_emitEvent`` emits an event without creating a node for
+ * it. The event fields are taken from an array of ``UA_EventField`` (that can
+ * reside on the stack) and the EventFilters of the MonitoredItems are evaluated
+ * directly against them. The fields `EventId`, `EventType`, `SourceNode` and
+ * `ReceiveTime` are set by the server. `Time` defaults to the `ReceiveTime` if
+ * it is not given. The nodes that emit the events of an origin are cached until
+ * the references in the information model change. Events emitted this way are
+ * not handed to the history database. */
 #ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
 
 /* The EventQueueOverflowEventType is defined as abstract, therefore we can not
@@ -1357,6 +1377,31 @@ UA_StatusCode UA_EXPORT UA_THREADSAFE
 UA_Server_triggerEvent(UA_Server *server, const UA_NodeId eventNodeId, const UA_NodeId originId,
                        UA_ByteString *outEventId, const UA_Boolean deleteEventNode);
 
+/* A field of an event emitted with UA_Server_emitEvent. The field is
+ * identified by the BrowsePath relative to the event, as used in the
+ * SimpleAttributeOperand of an EventFilter select clause. Most fields of the
+ * BaseEventType have a BrowsePath with a single element. The value is not
+ * copied by the server. */
+typedef struct {
+    size_t browsePathSize;
+    const UA_QualifiedName *browsePath;
+    UA_Variant value;
+} UA_EventField;
+
+/* Emits an event without a node representation by applying the EventFilters
+ * and adding it to the appropriate queues.
+ * @param server The server object
+ * @param eventType The type of the event (a subtype of BaseEventType)
+ * @param originId The NodeId of the node that emits the event
+ * @param fieldsSize The number of event fields
+ * @param fields The event fields
+ * @param outEventId The EventId of the new event. Can be NULL.
+ * @return The StatusCode of the UA_Server_emitEvent method */
+UA_StatusCode UA_EXPORT UA_THREADSAFE
+UA_Server_emitEvent(UA_Server *server, const UA_NodeId eventType, const UA_NodeId originId,
+                    size_t fieldsSize, const UA_EventField *fields,
+                    UA_ByteString *outEventId);
+
 #endif /* UA_ENABLE_SUBSCRIPTIONS_EVENTS */
 
 #ifdef UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS
@@ -1532,15 +1577,36 @@ UA_Server_AccessControl_allowHistoryUpdateDeleteRawModified(UA_Server *server,
 * the usage.
 *
 * Note that the operation can time out (see the asyncOperationTimeout setting in
-* the server config) also when it has been retrieved by the worker. */
+* the server config) also when it has been retrieved by the worker.
+*
+* Every async method node has a priority. The pending operations are kept in
+* one FIFO lane per priority. Workers always take the operations from the
+* lane with the highest priority first. So slow low-priority operations do not
+* block urgent ones. Workers can take out several operations at once with
+* ``UA_Server_getAsyncOperations``.
+*
+* With internal worker threads (``UA_MULTITHREADING >= 200``), the server can
+* execute the callbacks of async methods itself on the worker threads (see the
+* asyncOperationExecutor setting in the server config). Then no application
+* thread needs to poll for operations. */
 
 #if UA_MULTITHREADING >= 100
 
+/* Number of priority lanes for async operations. The priority 0 is the lowest
+ * and the default. */
+#define UA_ASYNCOPERATION_PRIORITIES 4
+
 /* Set the async flag in a method node */
 UA_StatusCode UA_EXPORT
 UA_Server_setMethodNodeAsync(UA_Server *server, const UA_NodeId id,
                              UA_Boolean isAsync);
 
+/* Set the priority of the async operations for a method node. Must be lower
+ * than UA_ASYNCOPERATION_PRIORITIES. */
+UA_StatusCode UA_EXPORT
+UA_Server_setMethodNodeAsyncPriority(UA_Server *server, const UA_NodeId id,
+                                     UA_Byte priority);
+
 typedef enum {
     UA_ASYNCOPERATIONTYPE_INVALID, /* 0, the default */
     UA_ASYNCOPERATIONTYPE_CALL
@@ -1575,12 +1641,36 @@ UA_Server_getAsyncOperationNonBlocking(UA_Server *server, UA_AsyncOperationType
                                        const UA_AsyncOperationRequest **request,
                                        void **context, UA_DateTime *timeout);
 
+typedef struct {
+    UA_AsyncOperationType type;
+    const UA_AsyncOperationRequest *request;
+    void *context;
+    UA_DateTime timeout;
+} UA_AsyncOperationEntry;
+
+/* Get up to opsSize async operations without blocking. The operations are
+ * taken out in the order of their priority under a single lock. The result of
+ * every operation has to be set with UA_Server_setAsyncOperationResult.
+ *
+ * @param server The server object
+ * @param ops Array that receives the operations
+ * @param opsSize The length of the ops array
+ * @return The number of operations written to ops */
+size_t UA_EXPORT
+UA_Server_getAsyncOperations(UA_Server *server, UA_AsyncOperationEntry *ops,
+                             size_t opsSize);
+
 /* UA_Boolean UA_EXPORT */
 /* UA_Server_getAsyncOperationBlocking(UA_Server *server, UA_AsyncOperationType *type, */
 /*                                     const UA_AsyncOperationRequest **request, */
 /*                                     void **context, UA_DateTime *timeout); */
 
-/* Submit an async operation result
+/* Submit an async operation result. This does not block and can be called
+ * from any thread. It has to be called exactly once for every operation that
+ * was taken out. The context is invalid afterwards. A second result for an
+ * operation that is still pending is rejected with a warning. But once the
+ * server has processed the result, the operation is freed and the context
+ * must no longer be used.
  *
  * @param server The server object
  * @param response Pointer to the operation result
@@ -1606,10 +1696,17 @@ UA_Server_getAsyncOperation(UA_Server *server, UA_AsyncOperationType *type,
 * Statistic counters keeping track of the current state of the stack. Counters
 * are structured per OPC UA communication layer. */
 
+typedef struct {
+    size_t cacheHitCount;  /* Reads answered from the DataSource cache */
+    size_t cacheMissCount; /* Reads of cached variables that called the
+                            * DataSource */
+} UA_DataSourceStatistics;
+
 typedef struct {
    UA_NetworkStatistics ns;
    UA_SecureChannelStatistics scs;
    UA_SessionStatistics ss;
+   UA_DataSourceStatistics dss;
 } UA_ServerStatistics;
 
 UA_ServerStatistics UA_Server_getStatistics(UA_Server *server);
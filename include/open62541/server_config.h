@@ -170,6 +170,10 @@ struct UA_ServerConfig {
     UA_DEPRECATED UA_Double asyncCallRequestTimeout; /* in ms, 0 => unlimited */
     /* Notify workers when an async operation was enqueued */
     UA_Server_AsyncOperationNotifyCallback asyncOperationNotifyCallback;
+# if UA_MULTITHREADING >= 200
+    /* Execute the callbacks of async methods on the internal worker threads */
+    UA_Boolean asyncOperationExecutor;
+# endif
 #endif
 
     /**
@@ -179,6 +183,13 @@ struct UA_ServerConfig {
     /* Nodestore */
     UA_Nodestore nodestore;
 
+    /* Read responses point into the nodes for values that are costly to copy
+     * (arrays, strings, structures). The nodes are held until the response is
+     * encoded and sent. The server must then not edit held nodes in place.
+     * So the option takes effect only with UA_ENABLE_IMMUTABLE_NODES (where
+     * edits replace the node with a copy) and is ignored otherwise. */
+    UA_Boolean readNoCopy;
+
     /* Certificate Verification */
     UA_CertificateVerification certificateVerification;
 
@@ -0,0 +1,1216 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/plugin/historydata/history_data_backend_file.h>
+#include <open62541/plugin/log_stdout.h>
+
+#include "ua_types_encoding_binary.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Every node has its own series of segment files, named
+ * <NodeId hash>-<slot>-<sequence>.seg. The slot distinguishes nodes with the
+ * same hash. A segment file starts with a header:
+ *
+ *   UInt32 magic, UInt32 version, UInt32 dataStart, UInt32 nodeIdSize,
+ *   binary encoded NodeId, padding to 8 bytes
+ *
+ * It is followed by records that are aligned to 8 bytes:
+ *
+ *   UInt32 size, UInt32 checksum, DateTime time,
+ *   binary encoded DataValue of size bytes, padding to 8 bytes
+ *
+ * The size is written last and commits the record. Zero marks the end of the
+ * segment. The checksum covers the time and the encoded DataValue. The numbers
+ * are stored in host byte order. A segment file that is no longer appended to
+ * is truncated behind its last record.
+ *
+ * In memory, every segment keeps the time and position of every
+ * HISTORY_FILE_INDEXINTERVAL-th record. A lookup jumps to the closest index
+ * entry and steps over at most HISTORY_FILE_INDEXINTERVAL record headers.
+ *
+ * A new segment file starts with HISTORY_FILE_INITIALSIZE bytes. Its size is
+ * doubled when a record does not fit, up to the segment size of the store.
+ * Then the segment is sealed and a new one is started.
+ *
+ * The tail segment of every node, which is appended to, stays mapped. Sealed
+ * segments are mapped on demand. At most HISTORY_FILE_MAXMAPPED of them stay
+ * mapped; the least recently used one is unmapped first. */
+
+#define HISTORY_FILE_MAGIC 0x46484155 /* "UAHF" in little endian */
+#define HISTORY_FILE_VERSION 1
+#define HISTORY_FILE_HEADERSIZE 16
+#define HISTORY_FILE_RECORDHEADERSIZE 16
+#define HISTORY_FILE_INDEXINTERVAL 32
+#define HISTORY_FILE_NODEINDEX_MIN 16
+#define HISTORY_FILE_MAXMAPPED 64
+#define HISTORY_FILE_INITIALSIZE 4096
+#define HISTORY_FILE_NAMELENGTH 26 /* 8 + 1 + 4 + 1 + 8 + strlen(".seg") */
+
+#define HISTORY_FILE_MASK_SOURCETIMESTAMP 0x04
+#define HISTORY_FILE_MASK_SERVERTIMESTAMP 0x08
+
+typedef struct {
+    UA_DateTime time;
+    size_t offset;
+} FileIndexEntry;
+
+typedef struct FileSegment {
+    UA_UInt32 sequence;
+    UA_Boolean sealed; /* No longer appended to */
+    UA_Byte *data;  /* The mapped file or NULL */
+    size_t size;    /* Size of the file and the mapping */
+    /* List of the mapped sealed segments, most recently used first */
+    struct FileSegment *lruPrev;
+    struct FileSegment *lruNext;
+    size_t start;   /* Position of the first record */
+    size_t end;     /* Position behind the last record */
+    size_t first;   /* Index of the first record in the node */
+    size_t count;
+    UA_DateTime lastTime;
+    size_t indexSize;
+    FileIndexEntry *index; /* Entry i for record i * HISTORY_FILE_INDEXINTERVAL */
+} FileSegment;
+
+typedef struct {
+    UA_NodeId nodeId;
+    UA_UInt32 hash;
+    UA_UInt16 slot;
+    size_t size; /* Number of records */
+    size_t segmentsSize;
+    FileSegment **segments; /* Ordered by sequence */
+} FileNode;
+
+typedef struct {
+    char *directory;
+    size_t segmentSize;
+    size_t maxSegmentsPerNode;
+
+    size_t nodesSize;
+    FileNode **nodes;
+    size_t nodesIndexSize;
+    FileNode **nodesIndex; /* Open addressing with linear probing */
+
+    size_t mappedSize; /* Number of mapped sealed segments */
+    FileSegment *lruFirst;
+    FileSegment *lruLast;
+
+    UA_DataValue scratch; /* Returned from getDataValue */
+} UA_FileStoreContext;
+
+static size_t
+fileAlign(size_t size) {
+    return (size + 7) & ~(size_t)7;
+}
+
+static UA_UInt32
+fileReadUInt32(const UA_Byte *pos) {
+    UA_UInt32 v;
+    memcpy(&v, pos, sizeof(UA_UInt32));
+    return v;
+}
+
+static UA_DateTime
+fileRecordTime(const FileSegment *seg, size_t pos) {
+    UA_DateTime t;
+    memcpy(&t, &seg->data[pos + 8], sizeof(UA_DateTime));
+    return t;
+}
+
+/* Bytes from the start of the record to the next record */
+static size_t
+fileRecordLength(const FileSegment *seg, size_t pos) {
+    return HISTORY_FILE_RECORDHEADERSIZE + fileAlign(fileReadUInt32(&seg->data[pos]));
+}
+
+static UA_UInt32
+fileChecksum(UA_UInt32 size, UA_DateTime time, const UA_Byte *payload) {
+    UA_UInt32 h = UA_ByteString_hash(size, (const UA_Byte*)&time, sizeof(UA_DateTime));
+    return UA_ByteString_hash(h, payload, size);
+}
+
+static char *
+fileSegmentPath(const UA_FileStoreContext *ctx, const FileNode *node,
+                UA_UInt32 sequence) {
+    size_t len = strlen(ctx->directory) + 1 + HISTORY_FILE_NAMELENGTH + 1;
+    char *path = (char*)UA_malloc(len);
+    if(path)
+        snprintf(path, len, "%s/%08x-%04x-%08x.seg", ctx->directory,
+                 (unsigned)node->hash, (unsigned)node->slot, (unsigned)sequence);
+    return path;
+}
+
+static void
+fileUnlinkSegment(const UA_FileStoreContext *ctx, const FileNode *node,
+                  UA_UInt32 sequence) {
+    char *path = fileSegmentPath(ctx, node, sequence);
+    if(!path)
+        return;
+    unlink(path);
+    UA_free(path);
+}
+
+static void
+lruRemove(UA_FileStoreContext *ctx, FileSegment *seg) {
+    if(seg->lruPrev)
+        seg->lruPrev->lruNext = seg->lruNext;
+    else
+        ctx->lruFirst = seg->lruNext;
+    if(seg->lruNext)
+        seg->lruNext->lruPrev = seg->lruPrev;
+    else
+        ctx->lruLast = seg->lruPrev;
+    seg->lruPrev = NULL;
+    seg->lruNext = NULL;
+}
+
+static void
+lruPushFront(UA_FileStoreContext *ctx, FileSegment *seg) {
+    seg->lruPrev = NULL;
+    seg->lruNext = ctx->lruFirst;
+    if(ctx->lruFirst)
+        ctx->lruFirst->lruPrev = seg;
+    else
+        ctx->lruLast = seg;
+    ctx->lruFirst = seg;
+}
+
+static void
+unmapFileSegment(UA_FileStoreContext *ctx, FileSegment *seg) {
+    if(!seg->data)
+        return;
+    munmap(seg->data, seg->size);
+    seg->data = NULL;
+    if(seg->sealed) {
+        lruRemove(ctx, seg);
+        ctx->mappedSize--;
+    }
+}
+
+static void
+FileSegment_delete(UA_FileStoreContext *ctx, FileSegment *seg) {
+    unmapFileSegment(ctx, seg);
+    UA_free(seg->index);
+    UA_free(seg);
+}
+
+/* Map the segment file if it is not mapped already. The pointers into other
+ * sealed segments may become invalid. */
+static UA_StatusCode
+mapFileSegment(UA_FileStoreContext *ctx, const FileNode *node, FileSegment *seg) {
+    if(seg->data) {
+        if(seg->sealed && ctx->lruFirst != seg) {
+            lruRemove(ctx, seg);
+            lruPushFront(ctx, seg);
+        }
+        return UA_STATUSCODE_GOOD;
+    }
+    if(seg->sealed && ctx->mappedSize >= HISTORY_FILE_MAXMAPPED && ctx->lruLast)
+        unmapFileSegment(ctx, ctx->lruLast);
+
+    char *path = fileSegmentPath(ctx, node, seg->sequence);
+    if(!path)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    int fd = open(path, O_RDWR);
+    if(fd < 0) {
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
+                       "History segment file %s cannot be opened", path);
+        UA_free(path);
+        return UA_STATUSCODE_BADRESOURCEUNAVAILABLE;
+    }
+    struct stat st;
+    void *data = MAP_FAILED;
+    if(fstat(fd, &st) == 0 && (size_t)st.st_size >= seg->end && st.st_size > 0)
+        data = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED) {
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
+                       "History segment file %s cannot be mapped", path);
+        UA_free(path);
+        return UA_STATUSCODE_BADRESOURCEUNAVAILABLE;
+    }
+    UA_free(path);
+    seg->data = (UA_Byte*)data;
+    seg->size = (size_t)st.st_size;
+    if(seg->sealed) {
+        lruPushFront(ctx, seg);
+        ctx->mappedSize++;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Grow the mapped tail segment to hold at least size bytes. The file size is
+ * doubled up to the segment size of the store. The disk space is allocated
+ * before the file is mapped again. */
+static UA_StatusCode
+growFileSegment(UA_FileStoreContext *ctx, const FileNode *node, FileSegment *seg,
+                size_t size) {
+    size_t newSize = seg->size;
+    while(newSize < size)
+        newSize *= 2;
+    if(newSize > ctx->segmentSize)
+        newSize = (size > ctx->segmentSize) ? size : ctx->segmentSize;
+
+    char *path = fileSegmentPath(ctx, node, seg->sequence);
+    if(!path)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    int fd = open(path, O_RDWR);
+    if(fd < 0) {
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
+                       "History segment file %s cannot be opened", path);
+        UA_free(path);
+        return UA_STATUSCODE_BADRESOURCEUNAVAILABLE;
+    }
+    void *data = MAP_FAILED;
+    int err = posix_fallocate(fd, 0, (off_t)newSize);
+    if(err == 0)
+        data = mmap(NULL, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED) {
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
+                       "History segment file %s cannot be grown (%s)", path,
+                       strerror(err != 0 ? err : errno));
+        UA_free(path);
+        return UA_STATUSCODE_BADRESOURCEUNAVAILABLE;
+    }
+    UA_free(path);
+    munmap(seg->data, seg->size);
+    seg->data = (UA_Byte*)data;
+    seg->size = newSize;
+    return UA_STATUSCODE_GOOD;
+}
+
+/*********/
+/* Nodes */
+/*********/
+
+static void
+FileNode_delete(UA_FileStoreContext *ctx, FileNode *node) {
+    for(size_t i = 0; i < node->segmentsSize; i++)
+        FileSegment_delete(ctx, node->segments[i]);
+    UA_free(node->segments);
+    UA_NodeId_clear(&node->nodeId);
+    UA_free(node);
+}
+
+static size_t
+findFileNodeSlot(const UA_FileStoreContext *ctx, const UA_NodeId *nodeId,
+                 UA_UInt32 hash) {
+    size_t mask = ctx->nodesIndexSize - 1;
+    size_t slot = hash & mask;
+    while(ctx->nodesIndex[slot] &&
+          !UA_NodeId_equal(&ctx->nodesIndex[slot]->nodeId, nodeId))
+        slot = (slot + 1) & mask;
+    return slot;
+}
+
+static FileNode *
+findFileNode(const UA_FileStoreContext *ctx, const UA_NodeId *nodeId) {
+    if(ctx->nodesIndexSize == 0)
+        return NULL;
+    return ctx->nodesIndex[findFileNodeSlot(ctx, nodeId, UA_NodeId_hash(nodeId))];
+}
+
+static UA_StatusCode
+resizeFileNodesIndex(UA_FileStoreContext *ctx, size_t newSize) {
+    FileNode **index = (FileNode**)UA_calloc(newSize, sizeof(FileNode*));
+    if(!index)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_free(ctx->nodesIndex);
+    ctx->nodesIndex = index;
+    ctx->nodesIndexSize = newSize;
+    for(size_t i = 0; i < ctx->nodesSize; i++) {
+        FileNode *node = ctx->nodes[i];
+        index[findFileNodeSlot(ctx, &node->nodeId, node->hash)] = node;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Add a node with the given slot. If slot is negative, the first slot that is
+ * not used by another node with the same hash is taken. */
+static FileNode *
+addFileNode(UA_FileStoreContext *ctx, const UA_NodeId *nodeId, long slot) {
+    UA_UInt32 hash = UA_NodeId_hash(nodeId);
+    if(slot < 0) {
+        slot = 0;
+        for(size_t i = 0; i < ctx->nodesSize; i++) {
+            if(ctx->nodes[i]->hash == hash && ctx->nodes[i]->slot >= slot)
+                slot = ctx->nodes[i]->slot + 1;
+        }
+        if(slot > UA_UINT16_MAX)
+            return NULL;
+    }
+
+    /* Keep the index at most half full */
+    if((ctx->nodesSize + 1) * 2 > ctx->nodesIndexSize) {
+        size_t newSize = ctx->nodesIndexSize * 2;
+        if(newSize < HISTORY_FILE_NODEINDEX_MIN)
+            newSize = HISTORY_FILE_NODEINDEX_MIN;
+        if(resizeFileNodesIndex(ctx, newSize) != UA_STATUSCODE_GOOD)
+            return NULL;
+    }
+    FileNode **nodes = (FileNode**)
+        UA_realloc(ctx->nodes, (ctx->nodesSize + 1) * sizeof(FileNode*));
+    if(!nodes)
+        return NULL;
+    ctx->nodes = nodes;
+    FileNode *node = (FileNode*)UA_calloc(1, sizeof(FileNode));
+    if(!node)
+        return NULL;
+    if(UA_NodeId_copy(nodeId, &node->nodeId) != UA_STATUSCODE_GOOD) {
+        UA_free(node);
+        return NULL;
+    }
+    node->hash = hash;
+    node->slot = (UA_UInt16)slot;
+    ctx->nodes[ctx->nodesSize] = node;
+    ctx->nodesSize++;
+    ctx->nodesIndex[findFileNodeSlot(ctx, nodeId, hash)] = node;
+    return node;
+}
+
+/************/
+/* Segments */
+/************/
+
+/* Stop appending to the segment. Unmap it and release the unused part of the
+ * file. */
+static void
+sealFileSegment(UA_FileStoreContext *ctx, const FileNode *node,
+                FileSegment *seg) {
+    unmapFileSegment(ctx, seg);
+    seg->sealed = true;
+    char *path = fileSegmentPath(ctx, node, seg->sequence);
+    if(!path)
+        return;
+    /* Keep the full file if this fails. The remainder is zero. */
+    if(truncate(path, (off_t)seg->end) == 0)
+        seg->size = seg->end;
+    UA_free(path);
+}
+
+static void
+dropOldestFileSegment(UA_FileStoreContext *ctx, FileNode *node) {
+    FileSegment *seg = node->segments[0];
+    size_t count = seg->count;
+    fileUnlinkSegment(ctx, node, seg->sequence);
+    FileSegment_delete(ctx, seg);
+    node->segmentsSize--;
+    memmove(node->segments, &node->segments[1],
+            node->segmentsSize * sizeof(FileSegment*));
+    for(size_t i = 0; i < node->segmentsSize; i++)
+        node->segments[i]->first -= count;
+    node->size -= count;
+}
+
+/* Start a new segment file that can hold at least a record of recordLength */
+static UA_StatusCode
+addFileSegment(UA_FileStoreContext *ctx, FileNode *node, size_t recordLength) {
+    size_t nodeIdSize = UA_calcSizeBinary(&node->nodeId, &UA_TYPES[UA_TYPES_NODEID]);
+    size_t start = fileAlign(HISTORY_FILE_HEADERSIZE + nodeIdSize);
+    size_t size = HISTORY_FILE_INITIALSIZE;
+    if(size > ctx->segmentSize)
+        size = ctx->segmentSize;
+    if(size < start + recordLength)
+        size = start + recordLength;
+
+    FileSegment **segments = (FileSegment**)
+        UA_realloc(node->segments, (node->segmentsSize + 1) * sizeof(FileSegment*));
+    if(!segments)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    node->segments = segments;
+
+    FileSegment *seg = (FileSegment*)UA_calloc(1, sizeof(FileSegment));
+    if(!seg)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    if(node->segmentsSize > 0)
+        seg->sequence = node->segments[node->segmentsSize - 1]->sequence + 1;
+
+    /* Create the file. Allocate the disk space before the file is mapped.
+     * Otherwise writing to the mapping of a sparse file on a full disk raises
+     * SIGBUS. */
+    char *path = fileSegmentPath(ctx, node, seg->sequence);
+    if(!path) {
+        UA_free(seg);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0) {
+        UA_free(path);
+        UA_free(seg);
+        return UA_STATUSCODE_BADRESOURCEUNAVAILABLE;
+    }
+    int err = posix_fallocate(fd, 0, (off_t)size);
+    close(fd);
+    if(err != 0) {
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
+                       "History segment file %s cannot be allocated (%s)",
+                       path, strerror(err));
+        unlink(path);
+        UA_free(path);
+        UA_free(seg);
+        return UA_STATUSCODE_BADRESOURCEUNAVAILABLE;
+    }
+    UA_free(path);
+    UA_StatusCode ret = mapFileSegment(ctx, node, seg);
+    if(ret != UA_STATUSCODE_GOOD) {
+        fileUnlinkSegment(ctx, node, seg->sequence);
+        UA_free(seg);
+        return ret;
+    }
+
+    /* Write the header */
+    UA_Byte *header = seg->data;
+    UA_UInt32 fields[4] = {HISTORY_FILE_MAGIC, HISTORY_FILE_VERSION,
+                           (UA_UInt32)start, (UA_UInt32)nodeIdSize};
+    memcpy(header, fields, sizeof(fields));
+    UA_Byte *pos = &header[HISTORY_FILE_HEADERSIZE];
+    const UA_Byte *posEnd = &header[start];
+    ret = UA_encodeBinary(&node->nodeId, &UA_TYPES[UA_TYPES_NODEID],
+                          &pos, &posEnd, NULL, NULL);
+    if(ret != UA_STATUSCODE_GOOD) {
+        fileUnlinkSegment(ctx, node, seg->sequence);
+        FileSegment_delete(ctx, seg);
+        return ret;
+    }
+
+    if(node->segmentsSize > 0) {
+        FileSegment *prev = node->segments[node->segmentsSize - 1];
+        if(!prev->sealed)
+            sealFileSegment(ctx, node, prev);
+    }
+    seg->start = start;
+    seg->end = start;
+    seg->first = node->size;
+    node->segments[node->segmentsSize] = seg;
+    node->segmentsSize++;
+
+    if(ctx->maxSegmentsPerNode > 0 && node->segmentsSize > ctx->maxSegmentsPerNode)
+        dropOldestFileSegment(ctx, node);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+appendFileRecord(UA_FileStoreContext *ctx, FileNode *node, UA_DateTime time,
+                 const UA_DataValue *value) {
+    size_t encodedSize = UA_calcSizeBinary(value, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    if(encodedSize == 0 || encodedSize > UA_UINT32_MAX)
+        return UA_STATUSCODE_BADENCODINGERROR;
+    size_t length = HISTORY_FILE_RECORDHEADERSIZE + fileAlign(encodedSize);
+
+    FileSegment *seg = (node->segmentsSize > 0) ?
+        node->segments[node->segmentsSize - 1] : NULL;
+    if(!seg || seg->sealed ||
+       (seg->count > 0 && seg->end + length > ctx->segmentSize)) {
+        UA_StatusCode ret = addFileSegment(ctx, node, length);
+        if(ret != UA_STATUSCODE_GOOD)
+            return ret;
+        seg = node->segments[node->segmentsSize - 1];
+    } else {
+        UA_StatusCode ret = mapFileSegment(ctx, node, seg);
+        if(ret == UA_STATUSCODE_GOOD && seg->end + length > seg->size)
+            ret = growFileSegment(ctx, node, seg, seg->end + length);
+        if(ret != UA_STATUSCODE_GOOD)
+            return ret;
+    }
+
+    /* Reserve the index entry before anything is written */
+    if(seg->count % HISTORY_FILE_INDEXINTERVAL == 0) {
+        FileIndexEntry *index = (FileIndexEntry*)
+            UA_realloc(seg->index, (seg->indexSize + 1) * sizeof(FileIndexEntry));
+        if(!index)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        seg->index = index;
+    }
+
+    UA_Byte *record = &seg->data[seg->end];
+    UA_Byte *pos = &record[HISTORY_FILE_RECORDHEADERSIZE];
+    const UA_Byte *posEnd = &pos[encodedSize];
+    UA_StatusCode ret = UA_encodeBinary(value, &UA_TYPES[UA_TYPES_DATAVALUE],
+                                        &pos, &posEnd, NULL, NULL);
+    if(ret != UA_STATUSCODE_GOOD) {
+        memset(&record[HISTORY_FILE_RECORDHEADERSIZE], 0, encodedSize);
+        return ret;
+    }
+    UA_UInt32 size = (UA_UInt32)encodedSize;
+    UA_UInt32 checksum = fileChecksum(size, time, &record[HISTORY_FILE_RECORDHEADERSIZE]);
+    memcpy(&record[8], &time, sizeof(UA_DateTime));
+    memcpy(&record[4], &checksum, sizeof(UA_UInt32));
+    memcpy(record, &size, sizeof(UA_UInt32)); /* Commit */
+
+    if(seg->count % HISTORY_FILE_INDEXINTERVAL == 0) {
+        seg->index[seg->indexSize].time = time;
+        seg->index[seg->indexSize].offset = seg->end;
+        seg->indexSize++;
+    }
+    seg->end += length;
+    seg->count++;
+    seg->lastTime = time;
+    node->size++;
+    return UA_STATUSCODE_GOOD;
+}
+
+/************/
+/* Recovery */
+/************/
+
+/* Read the header of an existing segment file and attach the (unmapped)
+ * segment to its node. Files with an invalid header are removed. Files that
+ * cannot be read are skipped. */
+static void
+openFileSegment(UA_FileStoreContext *ctx, const char *name, UA_UInt32 hash,
+                UA_UInt16 slot, UA_UInt32 sequence) {
+    size_t len = strlen(ctx->directory) + 1 + strlen(name) + 1;
+    char *path = (char*)UA_malloc(len);
+    if(!path) {
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
+                       "Skipping the history segment file %s (out of memory)", name);
+        return;
+    }
+    snprintf(path, len, "%s/%s", ctx->directory, name);
+
+    /* Read the fixed part of the header */
+    UA_Byte header[HISTORY_FILE_HEADERSIZE];
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+    if(fd < 0 || fstat(fd, &st) != 0 ||
+       (st.st_size >= HISTORY_FILE_HEADERSIZE &&
+        pread(fd, header, HISTORY_FILE_HEADERSIZE, 0) != HISTORY_FILE_HEADERSIZE)) {
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
+                       "Skipping the history segment file %s (%s)", path, strerror(errno));
+        if(fd >= 0)
+            close(fd);
+        UA_free(path);
+        return;
+    }
+
+    /* Validate the header */
+    size_t size = (size_t)st.st_size;
+    UA_UInt32 start = 0;
+    UA_UInt32 nodeIdSize = 0;
+    UA_Boolean valid = (size >= HISTORY_FILE_HEADERSIZE);
+    if(valid) {
+        start = fileReadUInt32(&header[8]);
+        nodeIdSize = fileReadUInt32(&header[12]);
+        valid = (fileReadUInt32(header) == HISTORY_FILE_MAGIC &&
+                 fileReadUInt32(&header[4]) == HISTORY_FILE_VERSION &&
+                 start <= size && start % 8 == 0 &&
+                 (size_t)nodeIdSize + HISTORY_FILE_HEADERSIZE <= start);
+    }
+
+    /* Decode the NodeId */
+    UA_NodeId nodeId;
+    UA_NodeId_init(&nodeId);
+    UA_StatusCode ret = UA_STATUSCODE_BADDECODINGERROR;
+    if(valid) {
+        UA_ByteString buf;
+        ret = UA_ByteString_allocBuffer(&buf, nodeIdSize);
+        if(ret == UA_STATUSCODE_GOOD) {
+            if(pread(fd, buf.data, nodeIdSize, HISTORY_FILE_HEADERSIZE) ==
+               (ssize_t)nodeIdSize) {
+                size_t offset = 0;
+                ret = UA_decodeBinary(&buf, &offset, &nodeId,
+                                      &UA_TYPES[UA_TYPES_NODEID], NULL);
+            } else {
+                ret = UA_STATUSCODE_BADRESOURCEUNAVAILABLE;
+            }
+            UA_ByteString_clear(&buf);
+        }
+    }
+    close(fd);
+    if(ret == UA_STATUSCODE_BADOUTOFMEMORY ||
+       ret == UA_STATUSCODE_BADRESOURCEUNAVAILABLE) {
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
+                       "Skipping the history segment file %s (%s)",
+                       path, UA_StatusCode_name(ret));
+        UA_free(path);
+        return;
+    }
+    if(ret != UA_STATUSCODE_GOOD) {
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
+                       "Removing the history segment file %s with an invalid header",
+                       path);
+        unlink(path);
+        UA_free(path);
+        return;
+    }
+    UA_free(path);
+
+    /* Files of a node must agree on the name */
+    FileNode *node = findFileNode(ctx, &nodeId);
+    if(!node && UA_NodeId_hash(&nodeId) == hash)
+        node = addFileNode(ctx, &nodeId, slot);
+    UA_NodeId_clear(&nodeId);
+    if(!node || node->hash != hash || node->slot != slot)
+        return;
+
+    FileSegment **segments = (FileSegment**)
+        UA_realloc(node->segments, (node->segmentsSize + 1) * sizeof(FileSegment*));
+    if(!segments)
+        return;
+    node->segments = segments;
+    FileSegment *seg = (FileSegment*)UA_calloc(1, sizeof(FileSegment));
+    if(!seg)
+        return;
+    seg->sequence = sequence;
+    seg->size = size;
+    seg->start = start;
+    seg->end = start;
+    node->segments[node->segmentsSize] = seg;
+    node->segmentsSize++;
+}
+
+static int
+compareFileSegments(const void *a, const void *b) {
+    UA_UInt32 sa = (*(FileSegment * const *)a)->sequence;
+    UA_UInt32 sb = (*(FileSegment * const *)b)->sequence;
+    return (sa > sb) - (sa < sb);
+}
+
+/* Index the records of the segment. Stop at the first record that is not
+ * committed, fails the checksum or is older than its predecessor. */
+static UA_StatusCode
+scanFileSegment(UA_FileStoreContext *ctx, const FileNode *node, FileSegment *seg,
+                UA_DateTime *lastTime) {
+    UA_StatusCode ret = mapFileSegment(ctx, node, seg);
+    if(ret != UA_STATUSCODE_GOOD)
+        return ret;
+    size_t pos = seg->start;
+    while(pos + HISTORY_FILE_RECORDHEADERSIZE <= seg->size) {
+        UA_UInt32 size = fileReadUInt32(&seg->data[pos]);
+        if(size == 0 || HISTORY_FILE_RECORDHEADERSIZE + fileAlign(size) > seg->size - pos)
+            break;
+        UA_DateTime time = fileRecordTime(seg, pos);
+        if(time < *lastTime ||
+           fileReadUInt32(&seg->data[pos + 4]) !=
+           fileChecksum(size, time, &seg->data[pos + HISTORY_FILE_RECORDHEADERSIZE]))
+            break;
+        if(seg->count % HISTORY_FILE_INDEXINTERVAL == 0) {
+            FileIndexEntry *index = (FileIndexEntry*)
+                UA_realloc(seg->index, (seg->indexSize + 1) * sizeof(FileIndexEntry));
+            if(!index)
+                return UA_STATUSCODE_BADOUTOFMEMORY;
+            seg->index = index;
+            seg->index[seg->indexSize].time = time;
+            seg->index[seg->indexSize].offset = pos;
+            seg->indexSize++;
+        }
+        seg->count++;
+        seg->lastTime = time;
+        *lastTime = time;
+        pos += fileRecordLength(seg, pos);
+    }
+    seg->end = pos;
+
+    /* Remove the remainder of a torn write. Otherwise an older record behind
+     * it might become visible after the next append. */
+    if(pos + HISTORY_FILE_RECORDHEADERSIZE <= seg->size &&
+       fileReadUInt32(&seg->data[pos]) != 0)
+        memset(&seg->data[pos], 0, seg->size - pos);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+recoverFileNode(UA_FileStoreContext *ctx, FileNode *node) {
+    qsort(node->segments, node->segmentsSize, sizeof(FileSegment*), compareFileSegments);
+    /* Only the last segment is appended to */
+    for(size_t i = 0; i + 1 < node->segmentsSize; i++)
+        node->segments[i]->sealed = true;
+    UA_DateTime lastTime = UA_INT64_MIN;
+    size_t i = 0;
+    while(i < node->segmentsSize) {
+        FileSegment *seg = node->segments[i];
+        UA_StatusCode ret = scanFileSegment(ctx, node, seg, &lastTime);
+        if(ret == UA_STATUSCODE_BADOUTOFMEMORY)
+            return ret;
+        /* Skip segments that cannot be mapped. Remove empty segments except
+         * for the last one. */
+        if(ret != UA_STATUSCODE_GOOD ||
+           (seg->count == 0 && i + 1 < node->segmentsSize)) {
+            if(ret == UA_STATUSCODE_GOOD)
+                fileUnlinkSegment(ctx, node, seg->sequence);
+            FileSegment_delete(ctx, seg);
+            node->segmentsSize--;
+            memmove(&node->segments[i], &node->segments[i + 1],
+                    (node->segmentsSize - i) * sizeof(FileSegment*));
+            continue;
+        }
+        seg->first = node->size;
+        node->size += seg->count;
+        i++;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+recoverFileStore(UA_FileStoreContext *ctx) {
+    DIR *dir = opendir(ctx->directory);
+    if(!dir)
+        return UA_STATUSCODE_BADRESOURCEUNAVAILABLE;
+    struct dirent *entry;
+    while((entry = readdir(dir))) {
+        unsigned hash, slot, sequence;
+        char suffix[5];
+        if(strlen(entry->d_name) != HISTORY_FILE_NAMELENGTH ||
+           sscanf(entry->d_name, "%8x-%4x-%8x%4s", &hash, &slot, &sequence, suffix) != 4 ||
+           strcmp(suffix, ".seg") != 0)
+            continue;
+        openFileSegment(ctx, entry->d_name, (UA_UInt32)hash,
+                        (UA_UInt16)slot, (UA_UInt32)sequence);
+    }
+    closedir(dir);
+
+    for(size_t i = 0; i < ctx->nodesSize; i++) {
+        UA_StatusCode ret = recoverFileNode(ctx, ctx->nodes[i]);
+        if(ret != UA_STATUSCODE_GOOD)
+            return ret;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/***********/
+/* Lookups */
+/***********/
+
+/* The segment containing the record at index */
+static size_t
+findFileSegment(const FileNode *node, size_t index) {
+    size_t min = 0;
+    size_t max = node->segmentsSize - 1;
+    while(min < max) {
+        size_t mid = min + (max - min + 1) / 2;
+        if(node->segments[mid]->first <= index)
+            min = mid;
+        else
+            max = mid - 1;
+    }
+    return min;
+}
+
+/* Position of the record at index within the segment */
+static size_t
+seekFileRecord(const FileSegment *seg, size_t index) {
+    size_t rel = index - seg->first;
+    size_t pos = seg->index[rel / HISTORY_FILE_INDEXINTERVAL].offset;
+    for(size_t i = rel % HISTORY_FILE_INDEXINTERVAL; i > 0; i--)
+        pos += fileRecordLength(seg, pos);
+    return pos;
+}
+
+/* Index of the first record with a timestamp not before time */
+static size_t
+fileLowerBound(UA_FileStoreContext *ctx, const FileNode *node, UA_DateTime time,
+               UA_Boolean *found) {
+    *found = false;
+    if(!node || node->size == 0)
+        return 0;
+
+    /* First segment that ends at or after the time */
+    size_t min = 0;
+    size_t max = node->segmentsSize;
+    while(min < max) {
+        size_t mid = min + (max - min) / 2;
+        if(node->segments[mid]->count == 0 || node->segments[mid]->lastTime < time)
+            min = mid + 1;
+        else
+            max = mid;
+    }
+    if(min == node->segmentsSize)
+        return node->size;
+    FileSegment *seg = node->segments[min];
+    if(mapFileSegment(ctx, node, seg) != UA_STATUSCODE_GOOD)
+        return node->size;
+
+    /* First index entry not before the time. Start walking from the entry
+     * before that. */
+    size_t lo = 0;
+    size_t hi = seg->indexSize;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(seg->index[mid].time < time)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if(lo > 0)
+        lo--;
+
+    size_t index = seg->first + lo * HISTORY_FILE_INDEXINTERVAL;
+    size_t pos = seg->index[lo].offset;
+    for(; index < seg->first + seg->count; index++) {
+        UA_DateTime t = fileRecordTime(seg, pos);
+        if(t >= time) {
+            *found = (t == time);
+            return index;
+        }
+        pos += fileRecordLength(seg, pos);
+    }
+    return index;
+}
+
+static UA_StatusCode
+decodeFileRecord(const FileSegment *seg, size_t pos, UA_DataValue *value) {
+    UA_ByteString buf = {fileReadUInt32(&seg->data[pos]),
+                         &seg->data[pos + HISTORY_FILE_RECORDHEADERSIZE]};
+    size_t offset = 0;
+    return UA_decodeBinary(&buf, &offset, value, &UA_TYPES[UA_TYPES_DATAVALUE], NULL);
+}
+
+static UA_StatusCode
+copyFileRecord(const FileSegment *seg, size_t pos, UA_DataValue *value,
+               const UA_NumericRange range) {
+    if(range.dimensionsSize == 0)
+        return decodeFileRecord(seg, pos, value);
+    UA_DataValue tmp;
+    UA_StatusCode ret = decodeFileRecord(seg, pos, &tmp);
+    if(ret != UA_STATUSCODE_GOOD)
+        return ret;
+    *value = tmp;
+    UA_Variant_init(&value->value);
+    if(tmp.hasValue)
+        ret = UA_Variant_copyRange(&tmp.value, &value->value, range);
+    else
+        ret = UA_STATUSCODE_BADDATAUNAVAILABLE;
+    UA_Variant_clear(&tmp.value);
+    return ret;
+}
+
+/*************/
+/* Interface */
+/*************/
+
+static UA_DateTime
+fileKeyTime(const UA_DataValue *value) {
+    if(value->hasSourceTimestamp)
+        return value->sourceTimestamp;
+    if(value->hasServerTimestamp)
+        return value->serverTimestamp;
+    return UA_DateTime_now();
+}
+
+static UA_StatusCode
+serverSetHistoryData_backend_file(UA_Server *server,
+                                  void *context,
+                                  const UA_NodeId *sessionId,
+                                  void *sessionContext,
+                                  const UA_NodeId *nodeId,
+                                  UA_Boolean historizing,
+                                  const UA_DataValue *value) {
+    UA_FileStoreContext *ctx = (UA_FileStoreContext*)context;
+    FileNode *node = findFileNode(ctx, nodeId);
+    if(!node) {
+        node = addFileNode(ctx, nodeId, -1);
+        if(!node)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    UA_DateTime time = fileKeyTime(value);
+    if(node->size > 0 && time < node->segments[node->segmentsSize - 1]->lastTime)
+        return UA_STATUSCODE_BADINVALIDTIMESTAMP;
+    return appendFileRecord(ctx, node, time, value);
+}
+
+static size_t
+getEnd_backend_file(UA_Server *server,
+                    void *context,
+                    const UA_NodeId *sessionId,
+                    void *sessionContext,
+                    const UA_NodeId *nodeId) {
+    const FileNode *node = findFileNode((UA_FileStoreContext*)context, nodeId);
+    return node ? node->size : 0;
+}
+
+static size_t
+lastIndex_backend_file(UA_Server *server,
+                       void *context,
+                       const UA_NodeId *sessionId,
+                       void *sessionContext,
+                       const UA_NodeId *nodeId) {
+    const FileNode *node = findFileNode((UA_FileStoreContext*)context, nodeId);
+    if(!node || node->size == 0)
+        return 0;
+    return node->size - 1;
+}
+
+static size_t
+firstIndex_backend_file(UA_Server *server,
+                        void *context,
+                        const UA_NodeId *sessionId,
+                        void *sessionContext,
+                        const UA_NodeId *nodeId) {
+    return 0;
+}
+
+static size_t
+resultSize_backend_file(UA_Server *server,
+                        void *context,
+                        const UA_NodeId *sessionId,
+                        void *sessionContext,
+                        const UA_NodeId *nodeId,
+                        size_t startIndex,
+                        size_t endIndex) {
+    size_t end = getEnd_backend_file(server, context, sessionId, sessionContext, nodeId);
+    if(end == 0 || startIndex == end || endIndex == end)
+        return 0;
+    return endIndex - startIndex + 1;
+}
+
+static size_t
+getDateTimeMatch_backend_file(UA_Server *server,
+                              void *context,
+                              const UA_NodeId *sessionId,
+                              void *sessionContext,
+                              const UA_NodeId *nodeId,
+                              const UA_DateTime timestamp,
+                              const MatchStrategy strategy) {
+    UA_FileStoreContext *ctx = (UA_FileStoreContext*)context;
+    const FileNode *node = findFileNode(ctx, nodeId);
+    size_t end = node ? node->size : 0;
+    UA_Boolean found;
+    size_t current = fileLowerBound(ctx, node, timestamp, &found);
+
+    if((strategy == MATCH_EQUAL ||
+        strategy == MATCH_EQUAL_OR_AFTER ||
+        strategy == MATCH_EQUAL_OR_BEFORE) && found)
+        return current;
+    switch(strategy) {
+    case MATCH_AFTER:
+        if(found)
+            return current + 1;
+        return current;
+    case MATCH_EQUAL_OR_AFTER:
+        return current;
+    case MATCH_EQUAL_OR_BEFORE:
+        /* found aka "equal" is handled before */
+    case MATCH_BEFORE:
+        if(current > 0)
+            return current - 1;
+        return end;
+    default:
+        break;
+    }
+    return end;
+}
+
+static UA_Boolean
+boundSupported_backend_file(UA_Server *server,
+                            void *context,
+                            const UA_NodeId *sessionId,
+                            void *sessionContext,
+                            const UA_NodeId *nodeId) {
+    return true;
+}
+
+static UA_Boolean
+timestampsToReturnSupported_backend_file(UA_Server *server,
+                                         void *context,
+                                         const UA_NodeId *sessionId,
+                                         void *sessionContext,
+                                         const UA_NodeId *nodeId,
+                                         const UA_TimestampsToReturn timestampsToReturn) {
+    UA_FileStoreContext *ctx = (UA_FileStoreContext*)context;
+    const FileNode *node = findFileNode(ctx, nodeId);
+    if(!node || node->size == 0)
+        return true;
+
+    /* The first byte of the encoded DataValue is the encoding mask */
+    FileSegment *seg = node->segments[0];
+    if(mapFileSegment(ctx, node, seg) != UA_STATUSCODE_GOOD)
+        return true;
+    UA_Byte mask = seg->data[seg->start + HISTORY_FILE_RECORDHEADERSIZE];
+    UA_Boolean hasSource = (mask & HISTORY_FILE_MASK_SOURCETIMESTAMP) != 0;
+    UA_Boolean hasServer = (mask & HISTORY_FILE_MASK_SERVERTIMESTAMP) != 0;
+    if(timestampsToReturn == UA_TIMESTAMPSTORETURN_NEITHER ||
+       timestampsToReturn == UA_TIMESTAMPSTORETURN_INVALID ||
+       (timestampsToReturn == UA_TIMESTAMPSTORETURN_SERVER && !hasServer) ||
+       (timestampsToReturn == UA_TIMESTAMPSTORETURN_SOURCE && !hasSource) ||
+       (timestampsToReturn == UA_TIMESTAMPSTORETURN_BOTH && !(hasSource && hasServer)))
+        return false;
+    return true;
+}
+
+/* The returned value is valid until the next call */
+static const UA_DataValue*
+getDataValue_backend_file(UA_Server *server,
+                          void *context,
+                          const UA_NodeId *sessionId,
+                          void *sessionContext,
+                          const UA_NodeId *nodeId,
+                          size_t index) {
+    UA_FileStoreContext *ctx = (UA_FileStoreContext*)context;
+    const FileNode *node = findFileNode(ctx, nodeId);
+    if(!node || index >= node->size)
+        return NULL;
+    FileSegment *seg = node->segments[findFileSegment(node, index)];
+    UA_DataValue_clear(&ctx->scratch);
+    if(mapFileSegment(ctx, node, seg) != UA_STATUSCODE_GOOD ||
+       decodeFileRecord(seg, seekFileRecord(seg, index), &ctx->scratch) != UA_STATUSCODE_GOOD)
+        return NULL;
+    return &ctx->scratch;
+}
+
+static UA_StatusCode
+copyDataValues_backend_file(UA_Server *server,
+                            void *context,
+                            const UA_NodeId *sessionId,
+                            void *sessionContext,
+                            const UA_NodeId *nodeId,
+                            size_t startIndex,
+                            size_t endIndex,
+                            UA_Boolean reverse,
+                            size_t maxValues,
+                            UA_NumericRange range,
+                            UA_Boolean releaseContinuationPoints,
+                            const UA_ByteString *continuationPoint,
+                            UA_ByteString *outContinuationPoint,
+                            size_t *providedValues,
+                            UA_DataValue *values) {
+    size_t skip = 0;
+    if(continuationPoint->length > 0) {
+        if(continuationPoint->length == sizeof(size_t))
+            skip = *((size_t*)(continuationPoint->data));
+        else
+            return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+    }
+    UA_FileStoreContext *ctx = (UA_FileStoreContext*)context;
+    const FileNode *node = findFileNode(ctx, nodeId);
+    size_t end = node ? node->size : 0;
+    size_t counter = 0;
+    if(reverse) {
+        /* Every record is looked up from the closest index entry */
+        size_t index = startIndex - skip;
+        while(skip <= startIndex && index >= endIndex && index < end &&
+              counter < maxValues) {
+            FileSegment *seg = node->segments[findFileSegment(node, index)];
+            UA_StatusCode ret = mapFileSegment(ctx, node, seg);
+            if(ret != UA_STATUSCODE_GOOD)
+                return ret;
+            copyFileRecord(seg, seekFileRecord(seg, index), &values[counter], range);
+            ++counter;
+            if(index == 0)
+                break;
+            --index;
+        }
+    } else {
+        /* Walk over the consecutive records */
+        size_t index = startIndex + skip;
+        if(index <= endIndex && index < end && counter < maxValues) {
+            size_t si = findFileSegment(node, index);
+            FileSegment *seg = node->segments[si];
+            UA_StatusCode ret = mapFileSegment(ctx, node, seg);
+            if(ret != UA_STATUSCODE_GOOD)
+                return ret;
+            size_t pos = seekFileRecord(seg, index);
+            while(index <= endIndex && index < end && counter < maxValues) {
+                copyFileRecord(seg, pos, &values[counter], range);
+                ++counter;
+                ++index;
+                pos += fileRecordLength(seg, pos);
+                if(pos >= seg->end && si + 1 < node->segmentsSize) {
+                    si++;
+                    seg = node->segments[si];
+                    pos = seg->start;
+                    ret = mapFileSegment(ctx, node, seg);
+                    if(ret != UA_STATUSCODE_GOOD)
+                        return ret;
+                }
+            }
+        }
+    }
+
+    if(providedValues)
+        *providedValues = counter;
+
+    if((!reverse && (endIndex - startIndex - skip + 1) > counter) ||
+       (reverse && (startIndex - endIndex - skip + 1) > counter)) {
+        outContinuationPoint->data = (UA_Byte*)UA_malloc(sizeof(size_t));
+        if(!outContinuationPoint->data)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        outContinuationPoint->length = sizeof(size_t);
+        *((size_t*)(outContinuationPoint->data)) = skip + counter;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+UA_FileStoreContext_deleteMembers(UA_FileStoreContext *ctx) {
+    for(size_t i = 0; i < ctx->nodesSize; i++)
+        FileNode_delete(ctx, ctx->nodes[i]);
+    UA_free(ctx->nodes);
+    UA_free(ctx->nodesIndex);
+    UA_free(ctx->directory);
+    UA_DataValue_clear(&ctx->scratch);
+    ctx->nodes = NULL;
+    ctx->nodesSize = 0;
+    ctx->nodesIndex = NULL;
+    ctx->nodesIndexSize = 0;
+    ctx->directory = NULL;
+}
+
+static void
+deleteMembers_backend_file(UA_HistoryDataBackend *backend) {
+    if(backend == NULL || backend->context == NULL)
+        return;
+    UA_FileStoreContext_deleteMembers((UA_FileStoreContext*)backend->context);
+}
+
+UA_HistoryDataBackend
+UA_HistoryDataBackend_File(const char *directory, size_t segmentSize,
+                           size_t maxSegmentsPerNode) {
+    if(segmentSize == 0)
+        segmentSize = UA_HISTORY_FILE_SEGMENTSIZE;
+    UA_HistoryDataBackend result;
+    memset(&result, 0, sizeof(UA_HistoryDataBackend));
+    UA_FileStoreContext *ctx = (UA_FileStoreContext*)
+        UA_calloc(1, sizeof(UA_FileStoreContext));
+    if(!ctx)
+        return result;
+    size_t len = strlen(directory);
+    ctx->directory = (char*)UA_malloc(len + 1);
+    if(!ctx->directory) {
+        UA_free(ctx);
+        return result;
+    }
+    memcpy(ctx->directory, directory, len + 1);
+    ctx->segmentSize = segmentSize;
+    ctx->maxSegmentsPerNode = maxSegmentsPerNode;
+    if(recoverFileStore(ctx) != UA_STATUSCODE_GOOD) {
+        UA_FileStoreContext_deleteMembers(ctx);
+        UA_free(ctx);
+        return result;
+    }
+    result.serverSetHistoryData = &serverSetHistoryData_backend_file;
+    result.resultSize = &resultSize_backend_file;
+    result.getEnd = &getEnd_backend_file;
+    result.lastIndex = &lastIndex_backend_file;
+    result.firstIndex = &firstIndex_backend_file;
+    result.getDateTimeMatch = &getDateTimeMatch_backend_file;
+    result.copyDataValues = &copyDataValues_backend_file;
+    result.getDataValue = &getDataValue_backend_file;
+    result.boundSupported = &boundSupported_backend_file;
+    result.timestampsToReturnSupported = &timestampsToReturnSupported_backend_file;
+    result.deleteMembers = &deleteMembers_backend_file;
+    result.getHistoryData = NULL;
+    result.context = ctx;
+    return result;
+}
+
+void
+UA_HistoryDataBackend_File_deleteMembers(UA_HistoryDataBackend *backend) {
+    UA_FileStoreContext *ctx = (UA_FileStoreContext*)backend->context;
+    if(ctx) {
+        UA_FileStoreContext_deleteMembers(ctx);
+        UA_free(ctx);
+    }
+    memset(backend, 0, sizeof(UA_HistoryDataBackend));
+}
@@ -0,0 +1,1477 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/plugin/historydata/history_data_backend_memory_compressed.h>
+
+#include <string.h>
+
+/* The samples of a node are ordered by their timestamp and stored in chunks.
+ * Each chunk holds three bit streams (columns):
+ *
+ * - times: The timestamps as delta-of-delta to the previous sample.
+ * - values: Numeric scalars as a 64-bit word, XOR'ed with the previous word.
+ *   Only the meaningful bits of the XOR are written.
+ * - meta: The remaining DataValue fields. A single bit if they did not change
+ *   from the previous sample.
+ *
+ * Values that do not fit into a word (strings, arrays, structures, ...) are
+ * copied into the overflow array of the chunk. New samples are appended to the
+ * last chunk. Out-of-order inserts, replacements and removals decode the
+ * affected chunk and encode it again. */
+
+#define HISTORY_NODEINDEX_MIN 16
+
+/* Bits per sample in the worst case */
+#define HISTORY_MAXBITS_TIME 68
+#define HISTORY_MAXBITS_VALUE 78
+#define HISTORY_MAXBITS_META 144
+
+#define HISTORY_META_VALUE 0x01
+#define HISTORY_META_STATUS 0x02
+#define HISTORY_META_SOURCETS 0x04
+#define HISTORY_META_SERVERTS 0x08
+#define HISTORY_META_SOURCEPICO 0x10
+#define HISTORY_META_SERVERPICO 0x20
+#define HISTORY_META_OVERFLOW 0x40
+
+/**************/
+/* Bit Stream */
+/**************/
+
+typedef struct {
+    UA_Byte *data;
+    size_t bits;     /* Number of bits written */
+    size_t capacity; /* Allocated bytes */
+} HistoryBitStream;
+
+typedef struct {
+    const UA_Byte *data;
+    size_t pos;
+} HistoryBitReader;
+
+static UA_StatusCode
+reserveBits(HistoryBitStream *s, size_t bits) {
+    size_t needed = (s->bits + bits + 7) / 8;
+    if(needed <= s->capacity)
+        return UA_STATUSCODE_GOOD;
+    size_t newCapacity = s->capacity * 2;
+    if(newCapacity < needed)
+        newCapacity = needed + 16;
+    UA_Byte *data = (UA_Byte*)UA_realloc(s->data, newCapacity);
+    if(!data)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    memset(&data[s->capacity], 0, newCapacity - s->capacity);
+    s->data = data;
+    s->capacity = newCapacity;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Release the spare capacity of a stream that no longer grows */
+static void
+shrinkBits(HistoryBitStream *s) {
+    size_t used = (s->bits + 7) / 8;
+    if(used == s->capacity)
+        return;
+    if(used == 0) {
+        UA_free(s->data);
+        s->data = NULL;
+        s->capacity = 0;
+        return;
+    }
+    UA_Byte *data = (UA_Byte*)UA_realloc(s->data, used);
+    if(!data)
+        return; /* Keep the larger buffer */
+    s->data = data;
+    s->capacity = used;
+}
+
+/* Write the lowest count bits of value, most significant first. The capacity
+ * must have been reserved. */
+static void
+writeBits(HistoryBitStream *s, UA_UInt64 value, UA_Byte count) {
+    while(count > 0) {
+        UA_Byte free = (UA_Byte)(8 - (s->bits % 8));
+        UA_Byte n = (count < free) ? count : free;
+        UA_Byte part = (UA_Byte)((value >> (count - n)) & ((1u << n) - 1));
+        s->data[s->bits / 8] |= (UA_Byte)(part << (free - n));
+        s->bits += n;
+        count = (UA_Byte)(count - n);
+    }
+}
+
+static UA_UInt64
+readBits(HistoryBitReader *r, UA_Byte count) {
+    UA_UInt64 value = 0;
+    while(count > 0) {
+        UA_Byte free = (UA_Byte)(8 - (r->pos % 8));
+        UA_Byte n = (count < free) ? count : free;
+        UA_Byte part = (UA_Byte)(((UA_UInt32)r->data[r->pos / 8] >> (free - n)) & ((1u << n) - 1));
+        value = (value << n) | part;
+        r->pos += n;
+        count = (UA_Byte)(count - n);
+    }
+    return value;
+}
+
+static UA_Boolean
+fitsSigned(UA_Int64 v, UA_Byte bits) {
+    UA_Int64 limit = (UA_Int64)1 << (bits - 1);
+    return v >= -limit && v < limit;
+}
+
+static UA_Int64
+readSigned(HistoryBitReader *r, UA_Byte bits) {
+    UA_UInt64 v = readBits(r, bits);
+    if(bits < 64 && (v & ((UA_UInt64)1 << (bits - 1))))
+        v |= ~(((UA_UInt64)1 << bits) - 1);
+    return (UA_Int64)v;
+}
+
+static UA_Byte
+leadingZeros(UA_UInt64 x) {
+    UA_Byte n = 0;
+    while(!(x & 0x8000000000000000ULL)) {
+        x <<= 1;
+        n++;
+    }
+    return n;
+}
+
+static UA_Byte
+trailingZeros(UA_UInt64 x) {
+    UA_Byte n = 0;
+    while(!(x & 1)) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+}
+
+/***********/
+/* Samples */
+/***********/
+
+typedef struct {
+    UA_Byte mask;
+    UA_Byte typeIndex; /* Of the numeric value in UA_TYPES */
+    UA_UInt16 sourcePicoseconds;
+    UA_UInt16 serverPicoseconds;
+    UA_StatusCode status;
+} HistorySampleMeta;
+
+typedef struct {
+    UA_DateTime time;       /* The key timestamp */
+    UA_Int64 serverOffset;  /* serverTimestamp - time if both timestamps are set */
+    UA_UInt64 word;         /* Numeric value */
+    HistorySampleMeta meta;
+    UA_DataValue *overflow; /* Values that are not stored in the columns */
+} HistorySample;
+
+static UA_Boolean
+HistorySampleMeta_equal(const HistorySampleMeta *a, const HistorySampleMeta *b) {
+    return a->mask == b->mask && a->typeIndex == b->typeIndex &&
+        a->status == b->status && a->sourcePicoseconds == b->sourcePicoseconds &&
+        a->serverPicoseconds == b->serverPicoseconds;
+}
+
+static UA_Boolean
+isNumericType(const UA_DataType *type) {
+    if(type != &UA_TYPES[type->typeIndex])
+        return false;
+    return type->typeIndex <= UA_TYPES_DOUBLE ||
+        type->typeIndex == UA_TYPES_DATETIME ||
+        type->typeIndex == UA_TYPES_STATUSCODE;
+}
+
+static UA_UInt64
+valueToWord(const void *data, UA_UInt16 typeIndex) {
+    UA_Double d;
+    UA_UInt64 word;
+    switch(typeIndex) {
+    case UA_TYPES_BOOLEAN: return *(const UA_Boolean*)data ? 1 : 0;
+    case UA_TYPES_SBYTE: return (UA_UInt64)(UA_Int64)*(const UA_SByte*)data;
+    case UA_TYPES_BYTE: return *(const UA_Byte*)data;
+    case UA_TYPES_INT16: return (UA_UInt64)(UA_Int64)*(const UA_Int16*)data;
+    case UA_TYPES_UINT16: return *(const UA_UInt16*)data;
+    case UA_TYPES_INT32: return (UA_UInt64)(UA_Int64)*(const UA_Int32*)data;
+    case UA_TYPES_UINT32: return *(const UA_UInt32*)data;
+    case UA_TYPES_INT64: return (UA_UInt64)*(const UA_Int64*)data;
+    case UA_TYPES_UINT64: return *(const UA_UInt64*)data;
+    case UA_TYPES_DATETIME: return (UA_UInt64)*(const UA_DateTime*)data;
+    case UA_TYPES_STATUSCODE: return *(const UA_StatusCode*)data;
+    case UA_TYPES_FLOAT:
+        /* float -> double -> float is lossless */
+        d = (UA_Double)*(const UA_Float*)data;
+        memcpy(&word, &d, sizeof(UA_UInt64));
+        return word;
+    case UA_TYPES_DOUBLE:
+        memcpy(&word, data, sizeof(UA_UInt64));
+        return word;
+    default:
+        return 0;
+    }
+}
+
+static void
+wordToValue(UA_UInt64 word, UA_UInt16 typeIndex, void *data) {
+    UA_Double d;
+    switch(typeIndex) {
+    case UA_TYPES_BOOLEAN: *(UA_Boolean*)data = (word != 0); break;
+    case UA_TYPES_SBYTE: *(UA_SByte*)data = (UA_SByte)(UA_Int64)word; break;
+    case UA_TYPES_BYTE: *(UA_Byte*)data = (UA_Byte)word; break;
+    case UA_TYPES_INT16: *(UA_Int16*)data = (UA_Int16)(UA_Int64)word; break;
+    case UA_TYPES_UINT16: *(UA_UInt16*)data = (UA_UInt16)word; break;
+    case UA_TYPES_INT32: *(UA_Int32*)data = (UA_Int32)(UA_Int64)word; break;
+    case UA_TYPES_UINT32: *(UA_UInt32*)data = (UA_UInt32)word; break;
+    case UA_TYPES_INT64: *(UA_Int64*)data = (UA_Int64)word; break;
+    case UA_TYPES_UINT64: *(UA_UInt64*)data = word; break;
+    case UA_TYPES_DATETIME: *(UA_DateTime*)data = (UA_DateTime)word; break;
+    case UA_TYPES_STATUSCODE: *(UA_StatusCode*)data = (UA_StatusCode)word; break;
+    case UA_TYPES_FLOAT:
+        memcpy(&d, &word, sizeof(UA_Double));
+        *(UA_Float*)data = (UA_Float)d;
+        break;
+    case UA_TYPES_DOUBLE:
+        memcpy(data, &word, sizeof(UA_Double));
+        break;
+    default:
+        break;
+    }
+}
+
+/* The key timestamp of a value, as in the memory backend */
+static UA_DateTime
+getKeyTime(const UA_DataValue *value) {
+    if(value->hasSourceTimestamp)
+        return value->sourceTimestamp;
+    if(value->hasServerTimestamp)
+        return value->serverTimestamp;
+    return UA_DateTime_now();
+}
+
+/* Set up a sample from a DataValue. If the value does not fit into the
+ * columns, the sample points to a deep copy in *overflow. */
+static UA_StatusCode
+HistorySample_init(HistorySample *s, UA_DateTime time, const UA_DataValue *value,
+                   UA_DataValue *overflow) {
+    memset(s, 0, sizeof(HistorySample));
+    s->time = time;
+    const UA_Variant *v = &value->value;
+    if(value->hasValue &&
+       (!v->type || !UA_Variant_isScalar(v) || !isNumericType(v->type) ||
+        v->arrayDimensionsSize > 0)) {
+        s->meta.mask = HISTORY_META_OVERFLOW;
+        s->overflow = overflow;
+        return UA_DataValue_copy(value, overflow);
+    }
+
+    if(value->hasValue) {
+        s->meta.mask |= HISTORY_META_VALUE;
+        s->meta.typeIndex = (UA_Byte)v->type->typeIndex;
+        s->word = valueToWord(v->data, v->type->typeIndex);
+    }
+    if(value->hasStatus) {
+        s->meta.mask |= HISTORY_META_STATUS;
+        s->meta.status = value->status;
+    }
+    if(value->hasSourceTimestamp)
+        s->meta.mask |= HISTORY_META_SOURCETS;
+    if(value->hasServerTimestamp) {
+        s->meta.mask |= HISTORY_META_SERVERTS;
+        if(value->hasSourceTimestamp)
+            s->serverOffset = (UA_Int64)((UA_UInt64)value->serverTimestamp -
+                                         (UA_UInt64)time);
+    }
+    if(value->hasSourcePicoseconds) {
+        s->meta.mask |= HISTORY_META_SOURCEPICO;
+        s->meta.sourcePicoseconds = value->sourcePicoseconds;
+    }
+    if(value->hasServerPicoseconds) {
+        s->meta.mask |= HISTORY_META_SERVERPICO;
+        s->meta.serverPicoseconds = value->serverPicoseconds;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+HistorySample_toDataValue(const HistorySample *s, UA_DataValue *value) {
+    if(s->overflow)
+        return UA_DataValue_copy(s->overflow, value);
+
+    UA_DataValue_init(value);
+    UA_Byte mask = s->meta.mask;
+    if(mask & HISTORY_META_VALUE) {
+        const UA_DataType *type = &UA_TYPES[s->meta.typeIndex];
+        void *data = UA_new(type);
+        if(!data)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        wordToValue(s->word, s->meta.typeIndex, data);
+        UA_Variant_setScalar(&value->value, data, type);
+        value->hasValue = true;
+    }
+    if(mask & HISTORY_META_STATUS) {
+        value->hasStatus = true;
+        value->status = s->meta.status;
+    }
+    if(mask & HISTORY_META_SOURCETS) {
+        value->hasSourceTimestamp = true;
+        value->sourceTimestamp = s->time;
+    }
+    if(mask & HISTORY_META_SERVERTS) {
+        value->hasServerTimestamp = true;
+        value->serverTimestamp = (UA_DateTime)((UA_UInt64)s->time +
+                                               (UA_UInt64)s->serverOffset);
+    }
+    if(mask & HISTORY_META_SOURCEPICO) {
+        value->hasSourcePicoseconds = true;
+        value->sourcePicoseconds = s->meta.sourcePicoseconds;
+    }
+    if(mask & HISTORY_META_SERVERPICO) {
+        value->hasServerPicoseconds = true;
+        value->serverPicoseconds = s->meta.serverPicoseconds;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/**********/
+/* Chunks */
+/**********/
+
+typedef struct {
+    size_t offset; /* Index of the first sample in the node */
+    size_t count;
+    UA_DateTime firstTime;
+    UA_DateTime lastTime;
+    HistoryBitStream times;
+    HistoryBitStream values;
+    HistoryBitStream meta;
+    size_t overflowSize;
+    UA_DataValue *overflow;
+} HistoryChunk;
+
+/* Codec state after a sample. Encoder and decoder keep the same state. */
+typedef struct {
+    UA_DateTime lastTime;
+    UA_Int64 lastDelta;
+    UA_UInt64 lastWord;
+    UA_Byte lastLeading;
+    UA_Byte lastLength; /* Zero before the first window */
+    UA_Int64 lastServerOffset;
+    HistorySampleMeta lastMeta;
+} HistoryCodecState;
+
+/* Free the streams. Overflow values are cleared only with clearOverflow. They
+ * might have been moved to another chunk. */
+static void
+HistoryChunk_clear(HistoryChunk *c, UA_Boolean clearOverflow) {
+    UA_free(c->times.data);
+    UA_free(c->values.data);
+    UA_free(c->meta.data);
+    if(clearOverflow) {
+        for(size_t i = 0; i < c->overflowSize; i++)
+            UA_DataValue_clear(&c->overflow[i]);
+    }
+    UA_free(c->overflow);
+    memset(c, 0, sizeof(HistoryChunk));
+}
+
+static void
+HistoryChunk_seal(HistoryChunk *c) {
+    shrinkBits(&c->times);
+    shrinkBits(&c->values);
+    shrinkBits(&c->meta);
+}
+
+static void
+encodeTime(HistoryChunk *c, HistoryCodecState *st, UA_DateTime time) {
+    if(c->count == 0) {
+        c->firstTime = time;
+        st->lastDelta = 0;
+    } else {
+        UA_Int64 delta = (UA_Int64)((UA_UInt64)time - (UA_UInt64)st->lastTime);
+        UA_Int64 dod = (UA_Int64)((UA_UInt64)delta - (UA_UInt64)st->lastDelta);
+        if(dod == 0) {
+            writeBits(&c->times, 0, 1);
+        } else if(fitsSigned(dod, 14)) {
+            writeBits(&c->times, 2, 2);
+            writeBits(&c->times, (UA_UInt64)dod, 14);
+        } else if(fitsSigned(dod, 20)) {
+            writeBits(&c->times, 6, 3);
+            writeBits(&c->times, (UA_UInt64)dod, 20);
+        } else if(fitsSigned(dod, 32)) {
+            writeBits(&c->times, 14, 4);
+            writeBits(&c->times, (UA_UInt64)dod, 32);
+        } else {
+            writeBits(&c->times, 15, 4);
+            writeBits(&c->times, (UA_UInt64)dod, 64);
+        }
+        st->lastDelta = delta;
+    }
+    st->lastTime = time;
+    c->lastTime = time;
+}
+
+static UA_DateTime
+decodeTime(const HistoryChunk *c, HistoryBitReader *r,
+           HistoryCodecState *st, size_t pos) {
+    if(pos == 0) {
+        st->lastDelta = 0;
+        st->lastTime = c->firstTime;
+        return c->firstTime;
+    }
+    UA_Int64 dod;
+    if(readBits(r, 1) == 0)
+        dod = 0;
+    else if(readBits(r, 1) == 0)
+        dod = readSigned(r, 14);
+    else if(readBits(r, 1) == 0)
+        dod = readSigned(r, 20);
+    else if(readBits(r, 1) == 0)
+        dod = readSigned(r, 32);
+    else
+        dod = readSigned(r, 64);
+    st->lastDelta = (UA_Int64)((UA_UInt64)st->lastDelta + (UA_UInt64)dod);
+    st->lastTime = (UA_DateTime)((UA_UInt64)st->lastTime + (UA_UInt64)st->lastDelta);
+    return st->lastTime;
+}
+
+static void
+encodeWord(HistoryBitStream *s, HistoryCodecState *st, UA_UInt64 word) {
+    UA_UInt64 x = word ^ st->lastWord;
+    st->lastWord = word;
+    if(x == 0) {
+        writeBits(s, 0, 1);
+        return;
+    }
+    writeBits(s, 1, 1);
+    UA_Byte leading = leadingZeros(x);
+    UA_Byte trailing = trailingZeros(x);
+    if(st->lastLength > 0 && leading >= st->lastLeading &&
+       trailing >= 64 - st->lastLeading - st->lastLength) {
+        /* Reuse the window of the previous value */
+        writeBits(s, 0, 1);
+        writeBits(s, x >> (64 - st->lastLeading - st->lastLength), st->lastLength);
+        return;
+    }
+    UA_Byte length = (UA_Byte)(64 - leading - trailing);
+    writeBits(s, 1, 1);
+    writeBits(s, leading, 6);
+    writeBits(s, (UA_UInt64)(length - 1), 6);
+    writeBits(s, x >> trailing, length);
+    st->lastLeading = leading;
+    st->lastLength = length;
+}
+
+static UA_UInt64
+decodeWord(HistoryBitReader *r, HistoryCodecState *st) {
+    if(readBits(r, 1) == 0)
+        return st->lastWord;
+    if(readBits(r, 1) == 1) {
+        st->lastLeading = (UA_Byte)readBits(r, 6);
+        st->lastLength = (UA_Byte)(readBits(r, 6) + 1);
+    }
+    UA_UInt64 x = readBits(r, st->lastLength) <<
+        (64 - st->lastLeading - st->lastLength);
+    st->lastWord ^= x;
+    return st->lastWord;
+}
+
+static void
+encodeMeta(HistoryBitStream *s, const HistorySampleMeta *meta) {
+    writeBits(s, meta->mask, 7);
+    if(meta->mask & HISTORY_META_OVERFLOW)
+        return;
+    if(meta->mask & HISTORY_META_VALUE)
+        writeBits(s, meta->typeIndex, 5);
+    if(meta->mask & HISTORY_META_STATUS)
+        writeBits(s, meta->status, 32);
+    if(meta->mask & HISTORY_META_SOURCEPICO)
+        writeBits(s, meta->sourcePicoseconds, 16);
+    if(meta->mask & HISTORY_META_SERVERPICO)
+        writeBits(s, meta->serverPicoseconds, 16);
+}
+
+static void
+decodeMeta(HistoryBitReader *r, HistorySampleMeta *meta) {
+    memset(meta, 0, sizeof(HistorySampleMeta));
+    meta->mask = (UA_Byte)readBits(r, 7);
+    if(meta->mask & HISTORY_META_OVERFLOW)
+        return;
+    if(meta->mask & HISTORY_META_VALUE)
+        meta->typeIndex = (UA_Byte)readBits(r, 5);
+    if(meta->mask & HISTORY_META_STATUS)
+        meta->status = (UA_StatusCode)readBits(r, 32);
+    if(meta->mask & HISTORY_META_SOURCEPICO)
+        meta->sourcePicoseconds = (UA_UInt16)readBits(r, 16);
+    if(meta->mask & HISTORY_META_SERVERPICO)
+        meta->serverPicoseconds = (UA_UInt16)readBits(r, 16);
+}
+
+static void
+encodeServerOffset(HistoryBitStream *s, HistoryCodecState *st, UA_Int64 offset) {
+    UA_Int64 diff = (UA_Int64)((UA_UInt64)offset - (UA_UInt64)st->lastServerOffset);
+    if(diff == 0) {
+        writeBits(s, 0, 1);
+    } else if(fitsSigned(diff, 20)) {
+        writeBits(s, 2, 2);
+        writeBits(s, (UA_UInt64)diff, 20);
+    } else {
+        writeBits(s, 3, 2);
+        writeBits(s, (UA_UInt64)offset, 64);
+    }
+    st->lastServerOffset = offset;
+}
+
+static UA_Int64
+decodeServerOffset(HistoryBitReader *r, HistoryCodecState *st) {
+    if(readBits(r, 1) == 0)
+        return st->lastServerOffset;
+    if(readBits(r, 1) == 0)
+        st->lastServerOffset = (UA_Int64)((UA_UInt64)st->lastServerOffset +
+                                          (UA_UInt64)readSigned(r, 20));
+    else
+        st->lastServerOffset = (UA_Int64)readBits(r, 64);
+    return st->lastServerOffset;
+}
+
+/* Append a sample to the chunk. An overflow value is moved into the chunk. */
+static UA_StatusCode
+encodeSample(HistoryChunk *c, HistoryCodecState *st, const HistorySample *s) {
+    /* Reserve everything up front so that the streams are never left with a
+     * partially written sample */
+    UA_StatusCode ret = reserveBits(&c->times, HISTORY_MAXBITS_TIME);
+    ret |= reserveBits(&c->values, HISTORY_MAXBITS_VALUE);
+    ret |= reserveBits(&c->meta, HISTORY_MAXBITS_META);
+    if(ret != UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    if(s->overflow) {
+        UA_DataValue *overflow = (UA_DataValue*)
+            UA_realloc(c->overflow, (c->overflowSize + 1) * sizeof(UA_DataValue));
+        if(!overflow)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        c->overflow = overflow;
+        c->overflow[c->overflowSize] = *s->overflow;
+        c->overflowSize++;
+    }
+
+    encodeTime(c, st, s->time);
+    if(c->count > 0 && HistorySampleMeta_equal(&st->lastMeta, &s->meta)) {
+        writeBits(&c->meta, 0, 1);
+    } else {
+        writeBits(&c->meta, 1, 1);
+        encodeMeta(&c->meta, &s->meta);
+        st->lastMeta = s->meta;
+    }
+    if(!s->overflow) {
+        if((s->meta.mask & HISTORY_META_SOURCETS) &&
+           (s->meta.mask & HISTORY_META_SERVERTS))
+            encodeServerOffset(&c->meta, st, s->serverOffset);
+        if(s->meta.mask & HISTORY_META_VALUE)
+            encodeWord(&c->values, st, s->word);
+    }
+    c->count++;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Decode all samples of the chunk. Overflow values remain owned by the chunk.
+ * The decoder ends in the same state as the encoder after the last sample. */
+static void
+decodeChunk(const HistoryChunk *c, HistorySample *samples, HistoryCodecState *state) {
+    HistoryCodecState st;
+    HistorySample tmp;
+    memset(&st, 0, sizeof(HistoryCodecState));
+    HistoryBitReader times = {c->times.data, 0};
+    HistoryBitReader values = {c->values.data, 0};
+    HistoryBitReader meta = {c->meta.data, 0};
+    size_t overflowPos = 0;
+    for(size_t i = 0; i < c->count; i++) {
+        HistorySample *s = (samples) ? &samples[i] : &tmp;
+        memset(s, 0, sizeof(HistorySample));
+        s->time = decodeTime(c, &times, &st, i);
+        if(readBits(&meta, 1) == 1)
+            decodeMeta(&meta, &st.lastMeta);
+        s->meta = st.lastMeta;
+        if(s->meta.mask & HISTORY_META_OVERFLOW) {
+            s->overflow = &c->overflow[overflowPos++];
+            continue;
+        }
+        if((s->meta.mask & HISTORY_META_SOURCETS) &&
+           (s->meta.mask & HISTORY_META_SERVERTS))
+            s->serverOffset = decodeServerOffset(&meta, &st);
+        if(s->meta.mask & HISTORY_META_VALUE)
+            s->word = decodeWord(&values, &st);
+    }
+    if(state)
+        *state = st;
+}
+
+/*********/
+/* Store */
+/*********/
+
+typedef struct {
+    UA_NodeId nodeId;
+    size_t size; /* Number of samples */
+    size_t chunksSize;
+    HistoryChunk *chunks;
+    HistoryCodecState tail; /* Encoder state after the last sample */
+} HistoryNode;
+
+typedef struct {
+    size_t chunkSize;
+    size_t maxValuesPerNode;
+    UA_DateTime maxAge;
+
+    size_t nodesSize;
+    HistoryNode **nodes;
+    size_t nodesIndexSize;
+    HistoryNode **nodesIndex; /* Open addressing with linear probing */
+
+    /* The last decoded chunk. Reset whenever a chunk changes. */
+    const HistoryChunk *cacheChunk;
+    HistorySample *cache;
+
+    UA_DataValue scratch; /* Returned from getDataValue */
+} UA_MemoryCompressedStoreContext;
+
+static void
+HistoryNode_delete(HistoryNode *node) {
+    UA_NodeId_clear(&node->nodeId);
+    for(size_t i = 0; i < node->chunksSize; i++)
+        HistoryChunk_clear(&node->chunks[i], true);
+    UA_free(node->chunks);
+    UA_free(node);
+}
+
+static void
+UA_MemoryCompressedStoreContext_deleteMembers(UA_MemoryCompressedStoreContext *ctx) {
+    for(size_t i = 0; i < ctx->nodesSize; i++)
+        HistoryNode_delete(ctx->nodes[i]);
+    UA_free(ctx->nodes);
+    UA_free(ctx->nodesIndex);
+    UA_free(ctx->cache);
+    UA_DataValue_clear(&ctx->scratch);
+    ctx->nodes = NULL;
+    ctx->nodesSize = 0;
+    ctx->nodesIndex = NULL;
+    ctx->nodesIndexSize = 0;
+    ctx->cache = NULL;
+    ctx->cacheChunk = NULL;
+}
+
+static size_t
+findNodeSlot(const UA_MemoryCompressedStoreContext *ctx, const UA_NodeId *nodeId,
+             UA_UInt32 hash) {
+    size_t mask = ctx->nodesIndexSize - 1;
+    size_t slot = hash & mask;
+    while(ctx->nodesIndex[slot] &&
+          !UA_NodeId_equal(&ctx->nodesIndex[slot]->nodeId, nodeId))
+        slot = (slot + 1) & mask;
+    return slot;
+}
+
+static HistoryNode *
+findNode(const UA_MemoryCompressedStoreContext *ctx, const UA_NodeId *nodeId) {
+    if(ctx->nodesIndexSize == 0)
+        return NULL;
+    return ctx->nodesIndex[findNodeSlot(ctx, nodeId, UA_NodeId_hash(nodeId))];
+}
+
+static UA_StatusCode
+resizeNodesIndex(UA_MemoryCompressedStoreContext *ctx, size_t newSize) {
+    HistoryNode **index = (HistoryNode**)UA_calloc(newSize, sizeof(HistoryNode*));
+    if(!index)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_free(ctx->nodesIndex);
+    ctx->nodesIndex = index;
+    ctx->nodesIndexSize = newSize;
+    for(size_t i = 0; i < ctx->nodesSize; i++) {
+        HistoryNode *node = ctx->nodes[i];
+        index[findNodeSlot(ctx, &node->nodeId, UA_NodeId_hash(&node->nodeId))] = node;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static HistoryNode *
+getNode(UA_MemoryCompressedStoreContext *ctx, const UA_NodeId *nodeId) {
+    HistoryNode *node = findNode(ctx, nodeId);
+    if(node)
+        return node;
+
+    /* Keep the index at most half full */
+    if((ctx->nodesSize + 1) * 2 > ctx->nodesIndexSize) {
+        size_t newSize = ctx->nodesIndexSize * 2;
+        if(newSize < HISTORY_NODEINDEX_MIN)
+            newSize = HISTORY_NODEINDEX_MIN;
+        if(resizeNodesIndex(ctx, newSize) != UA_STATUSCODE_GOOD)
+            return NULL;
+    }
+    HistoryNode **nodes = (HistoryNode**)
+        UA_realloc(ctx->nodes, (ctx->nodesSize + 1) * sizeof(HistoryNode*));
+    if(!nodes)
+        return NULL;
+    ctx->nodes = nodes;
+    node = (HistoryNode*)UA_calloc(1, sizeof(HistoryNode));
+    if(!node)
+        return NULL;
+    if(UA_NodeId_copy(nodeId, &node->nodeId) != UA_STATUSCODE_GOOD) {
+        UA_free(node);
+        return NULL;
+    }
+    ctx->nodes[ctx->nodesSize] = node;
+    ctx->nodesSize++;
+    ctx->nodesIndex[findNodeSlot(ctx, nodeId, UA_NodeId_hash(nodeId))] = node;
+    return node;
+}
+
+static void
+updateOffsets(HistoryNode *node, size_t from) {
+    size_t offset = (from == 0) ? 0 :
+        node->chunks[from - 1].offset + node->chunks[from - 1].count;
+    for(size_t i = from; i < node->chunksSize; i++) {
+        node->chunks[i].offset = offset;
+        offset += node->chunks[i].count;
+    }
+    node->size = offset;
+}
+
+/* The chunk containing the sample at index */
+static size_t
+findChunk(const HistoryNode *node, size_t index) {
+    size_t min = 0;
+    size_t max = node->chunksSize - 1;
+    while(min < max) {
+        size_t mid = min + (max - min + 1) / 2;
+        if(node->chunks[mid].offset <= index)
+            min = mid;
+        else
+            max = mid - 1;
+    }
+    return min;
+}
+
+static const HistorySample *
+getChunkSamples(UA_MemoryCompressedStoreContext *ctx, const HistoryChunk *c) {
+    if(ctx->cacheChunk != c) {
+        decodeChunk(c, ctx->cache, NULL);
+        ctx->cacheChunk = c;
+    }
+    return ctx->cache;
+}
+
+static const HistorySample *
+getSample(UA_MemoryCompressedStoreContext *ctx, const HistoryNode *node,
+          size_t index) {
+    const HistoryChunk *c = &node->chunks[findChunk(node, index)];
+    return &getChunkSamples(ctx, c)[index - c->offset];
+}
+
+/* Index of the first sample with a timestamp not before time */
+static size_t
+lowerBound(UA_MemoryCompressedStoreContext *ctx, const HistoryNode *node,
+           UA_DateTime time, UA_Boolean *found) {
+    *found = false;
+    if(!node || node->size == 0)
+        return 0;
+
+    /* First chunk that ends at or after the time */
+    size_t min = 0;
+    size_t max = node->chunksSize;
+    while(min < max) {
+        size_t mid = min + (max - min) / 2;
+        if(node->chunks[mid].lastTime < time)
+            min = mid + 1;
+        else
+            max = mid;
+    }
+    if(min == node->chunksSize)
+        return node->size;
+
+    const HistoryChunk *c = &node->chunks[min];
+    const HistorySample *samples = getChunkSamples(ctx, c);
+    size_t lo = 0;
+    size_t hi = c->count;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(samples[mid].time < time)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    *found = (lo < c->count && samples[lo].time == time);
+    return c->offset + lo;
+}
+
+/* Drop the oldest chunks that are outside the retention bounds. The last chunk
+ * is never dropped. */
+static void
+applyRetention(UA_MemoryCompressedStoreContext *ctx, HistoryNode *node) {
+    if(node->chunksSize < 2)
+        return;
+    UA_DateTime newest = node->chunks[node->chunksSize - 1].lastTime;
+    size_t remaining = node->size;
+    size_t drop = 0;
+    while(drop + 1 < node->chunksSize) {
+        HistoryChunk *c = &node->chunks[drop];
+        UA_Boolean tooOld = ctx->maxAge > 0 && c->lastTime < newest - ctx->maxAge;
+        UA_Boolean tooMany = ctx->maxValuesPerNode > 0 &&
+            remaining - c->count >= ctx->maxValuesPerNode;
+        if(!tooOld && !tooMany)
+            break;
+        remaining -= c->count;
+        HistoryChunk_clear(c, true);
+        drop++;
+    }
+    if(drop == 0)
+        return;
+    ctx->cacheChunk = NULL;
+    memmove(node->chunks, &node->chunks[drop],
+            (node->chunksSize - drop) * sizeof(HistoryChunk));
+    node->chunksSize -= drop;
+    updateOffsets(node, 0);
+}
+
+static UA_StatusCode
+appendSample(UA_MemoryCompressedStoreContext *ctx, HistoryNode *node,
+             const HistorySample *s) {
+    HistoryCodecState tail = node->tail;
+    UA_Boolean newChunk = (node->chunksSize == 0 ||
+                           node->chunks[node->chunksSize - 1].count >= ctx->chunkSize);
+    if(newChunk) {
+        HistoryChunk *chunks = (HistoryChunk*)
+            UA_realloc(node->chunks, (node->chunksSize + 1) * sizeof(HistoryChunk));
+        if(!chunks)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        node->chunks = chunks;
+        if(node->chunksSize > 0)
+            HistoryChunk_seal(&node->chunks[node->chunksSize - 1]);
+        memset(&node->chunks[node->chunksSize], 0, sizeof(HistoryChunk));
+        node->chunks[node->chunksSize].offset = node->size;
+        memset(&node->tail, 0, sizeof(HistoryCodecState));
+        node->chunksSize++;
+    }
+    ctx->cacheChunk = NULL;
+    UA_StatusCode ret = encodeSample(&node->chunks[node->chunksSize - 1],
+                                     &node->tail, s);
+    if(ret != UA_STATUSCODE_GOOD) {
+        /* Roll back the chunk that was pushed for the sample */
+        if(newChunk) {
+            node->chunksSize--;
+            HistoryChunk_clear(&node->chunks[node->chunksSize], false);
+        }
+        node->tail = tail;
+        return ret;
+    }
+    node->size++;
+    applyRetention(ctx, node);
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Replace chunk ci by the samples. Overflow values of the samples are moved into
+ * the new chunks. The old chunk is freed without clearing its overflow values.
+ * The chunk is split if the samples do not fit and removed if there are none. */
+static UA_StatusCode
+rewriteChunk(UA_MemoryCompressedStoreContext *ctx, HistoryNode *node, size_t ci,
+             const HistorySample *samples, size_t samplesSize) {
+    ctx->cacheChunk = NULL;
+    UA_Boolean last = (ci == node->chunksSize - 1);
+    size_t parts = (samplesSize > ctx->chunkSize) ? 2 : 1;
+    size_t split = (parts == 2) ? samplesSize / 2 : samplesSize;
+
+    HistoryChunk newChunks[2];
+    HistoryCodecState st;
+    memset(newChunks, 0, sizeof(newChunks));
+    memset(&st, 0, sizeof(HistoryCodecState));
+    UA_StatusCode ret = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < samplesSize && ret == UA_STATUSCODE_GOOD; i++) {
+        if(i == 0 || i == split)
+            memset(&st, 0, sizeof(HistoryCodecState));
+        ret = encodeSample(&newChunks[i < split ? 0 : 1], &st, &samples[i]);
+    }
+    if(ret != UA_STATUSCODE_GOOD) {
+        HistoryChunk_clear(&newChunks[0], false);
+        HistoryChunk_clear(&newChunks[1], false);
+        return ret;
+    }
+
+    if(parts == 2) {
+        HistoryChunk *chunks = (HistoryChunk*)
+            UA_realloc(node->chunks, (node->chunksSize + 1) * sizeof(HistoryChunk));
+        if(!chunks) {
+            HistoryChunk_clear(&newChunks[0], false);
+            HistoryChunk_clear(&newChunks[1], false);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+        node->chunks = chunks;
+    }
+
+    HistoryChunk_clear(&node->chunks[ci], false);
+    if(samplesSize == 0) {
+        memmove(&node->chunks[ci], &node->chunks[ci + 1],
+                (node->chunksSize - ci - 1) * sizeof(HistoryChunk));
+        node->chunksSize--;
+        /* Continue appending to the previous chunk */
+        if(last && node->chunksSize > 0)
+            decodeChunk(&node->chunks[node->chunksSize - 1], NULL, &node->tail);
+    } else {
+        if(parts == 2) {
+            memmove(&node->chunks[ci + 2], &node->chunks[ci + 1],
+                    (node->chunksSize - ci - 1) * sizeof(HistoryChunk));
+            node->chunksSize++;
+        }
+        for(size_t i = 0; i < parts; i++) {
+            node->chunks[ci + i] = newChunks[i];
+            if(!last || i + 1 < parts)
+                HistoryChunk_seal(&node->chunks[ci + i]);
+        }
+        if(last)
+            node->tail = st;
+    }
+    updateOffsets(node, ci);
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Decode chunk ci into a new array with room for one more sample */
+static HistorySample *
+decodeChunkCopy(const HistoryNode *node, size_t ci) {
+    const HistoryChunk *c = &node->chunks[ci];
+    HistorySample *samples = (HistorySample*)
+        UA_malloc((c->count + 1) * sizeof(HistorySample));
+    if(samples)
+        decodeChunk(c, samples, NULL);
+    return samples;
+}
+
+static UA_StatusCode
+insertSample(UA_MemoryCompressedStoreContext *ctx, HistoryNode *node,
+             size_t index, const HistorySample *s) {
+    if(index >= node->size)
+        return appendSample(ctx, node, s);
+    size_t ci = findChunk(node, index);
+    HistorySample *samples = decodeChunkCopy(node, ci);
+    if(!samples)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    size_t count = node->chunks[ci].count;
+    size_t pos = index - node->chunks[ci].offset;
+    memmove(&samples[pos + 1], &samples[pos], (count - pos) * sizeof(HistorySample));
+    samples[pos] = *s;
+    UA_StatusCode ret = rewriteChunk(ctx, node, ci, samples, count + 1);
+    UA_free(samples);
+    if(ret == UA_STATUSCODE_GOOD)
+        applyRetention(ctx, node);
+    return ret;
+}
+
+static UA_StatusCode
+replaceSample(UA_MemoryCompressedStoreContext *ctx, HistoryNode *node,
+              size_t index, const HistorySample *s) {
+    size_t ci = findChunk(node, index);
+    HistorySample *samples = decodeChunkCopy(node, ci);
+    if(!samples)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    size_t pos = index - node->chunks[ci].offset;
+
+    /* Move the old overflow value out. rewriteChunk frees the overflow array of
+     * the chunk. The chunk still owns the value if the rewrite fails. */
+    UA_DataValue old;
+    UA_DataValue_init(&old);
+    if(samples[pos].overflow)
+        old = *samples[pos].overflow;
+    samples[pos] = *s;
+    UA_StatusCode ret = rewriteChunk(ctx, node, ci, samples, node->chunks[ci].count);
+    if(ret == UA_STATUSCODE_GOOD)
+        UA_DataValue_clear(&old);
+    UA_free(samples);
+    return ret;
+}
+
+/* Remove the samples [first, end) */
+static UA_StatusCode
+removeSamples(UA_MemoryCompressedStoreContext *ctx, HistoryNode *node,
+              size_t first, size_t end) {
+    /* Back to front, so that the chunk indices stay valid */
+    size_t ci = findChunk(node, end - 1);
+    while(true) {
+        HistoryChunk *c = &node->chunks[ci];
+        size_t from = (first > c->offset) ? first - c->offset : 0;
+        size_t to = (end < c->offset + c->count) ? end - c->offset : c->count;
+        HistorySample *samples = decodeChunkCopy(node, ci);
+        if(!samples)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+
+        /* The overflow values are in the order of the samples. The removed
+         * ones are [overflowFrom, overflowTo). */
+        size_t overflowFrom = 0;
+        size_t overflowTo = 0;
+        for(size_t i = 0; i < to; i++) {
+            if(!samples[i].overflow)
+                continue;
+            if(i < from)
+                overflowFrom++;
+            overflowTo++;
+        }
+
+        /* Take the overflow values from the chunk. rewriteChunk moves the kept
+         * values into the new chunk. The removed values are cleared only once
+         * the new chunk is in place. */
+        UA_DataValue *overflow = c->overflow;
+        size_t overflowSize = c->overflowSize;
+        c->overflow = NULL;
+        c->overflowSize = 0;
+        memmove(&samples[from], &samples[to], (c->count - to) * sizeof(HistorySample));
+        UA_StatusCode ret = rewriteChunk(ctx, node, ci, samples, c->count - (to - from));
+        UA_free(samples);
+        if(ret != UA_STATUSCODE_GOOD) {
+            node->chunks[ci].overflow = overflow;
+            node->chunks[ci].overflowSize = overflowSize;
+            return ret;
+        }
+        for(size_t i = overflowFrom; i < overflowTo; i++)
+            UA_DataValue_clear(&overflow[i]);
+        UA_free(overflow);
+        if(ci == 0 || node->chunks[ci - 1].offset + node->chunks[ci - 1].count <= first)
+            break;
+        ci--;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/*************/
+/* Interface */
+/*************/
+
+static size_t
+getEnd_backend_memoryCompressed(UA_Server *server,
+                                void *context,
+                                const UA_NodeId *sessionId,
+                                void *sessionContext,
+                                const UA_NodeId *nodeId) {
+    const HistoryNode *node = findNode((UA_MemoryCompressedStoreContext*)context, nodeId);
+    return node ? node->size : 0;
+}
+
+static size_t
+lastIndex_backend_memoryCompressed(UA_Server *server,
+                                   void *context,
+                                   const UA_NodeId *sessionId,
+                                   void *sessionContext,
+                                   const UA_NodeId *nodeId) {
+    const HistoryNode *node = findNode((UA_MemoryCompressedStoreContext*)context, nodeId);
+    if(!node || node->size == 0)
+        return 0;
+    return node->size - 1;
+}
+
+static size_t
+firstIndex_backend_memoryCompressed(UA_Server *server,
+                                    void *context,
+                                    const UA_NodeId *sessionId,
+                                    void *sessionContext,
+                                    const UA_NodeId *nodeId) {
+    return 0;
+}
+
+static size_t
+resultSize_backend_memoryCompressed(UA_Server *server,
+                                    void *context,
+                                    const UA_NodeId *sessionId,
+                                    void *sessionContext,
+                                    const UA_NodeId *nodeId,
+                                    size_t startIndex,
+                                    size_t endIndex) {
+    size_t end = getEnd_backend_memoryCompressed(server, context, sessionId,
+                                                 sessionContext, nodeId);
+    if(end == 0 || startIndex == end || endIndex == end)
+        return 0;
+    return endIndex - startIndex + 1;
+}
+
+static size_t
+getDateTimeMatch_backend_memoryCompressed(UA_Server *server,
+                                          void *context,
+                                          const UA_NodeId *sessionId,
+                                          void *sessionContext,
+                                          const UA_NodeId *nodeId,
+                                          const UA_DateTime timestamp,
+                                          const MatchStrategy strategy) {
+    UA_MemoryCompressedStoreContext *ctx = (UA_MemoryCompressedStoreContext*)context;
+    const HistoryNode *node = findNode(ctx, nodeId);
+    size_t end = node ? node->size : 0;
+    UA_Boolean found;
+    size_t current = lowerBound(ctx, node, timestamp, &found);
+
+    if((strategy == MATCH_EQUAL ||
+        strategy == MATCH_EQUAL_OR_AFTER ||
+        strategy == MATCH_EQUAL_OR_BEFORE) && found)
+        return current;
+    switch(strategy) {
+    case MATCH_AFTER:
+        if(found)
+            return current + 1;
+        return current;
+    case MATCH_EQUAL_OR_AFTER:
+        return current;
+    case MATCH_EQUAL_OR_BEFORE:
+        /* found aka "equal" is handled before */
+    case MATCH_BEFORE:
+        if(current > 0)
+            return current - 1;
+        return end;
+    default:
+        break;
+    }
+    return end;
+}
+
+static UA_StatusCode
+serverSetHistoryData_backend_memoryCompressed(UA_Server *server,
+                                              void *context,
+                                              const UA_NodeId *sessionId,
+                                              void *sessionContext,
+                                              const UA_NodeId *nodeId,
+                                              UA_Boolean historizing,
+                                              const UA_DataValue *value) {
+    UA_MemoryCompressedStoreContext *ctx = (UA_MemoryCompressedStoreContext*)context;
+    HistoryNode *node = getNode(ctx, nodeId);
+    if(!node)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    UA_DateTime timestamp = getKeyTime(value);
+    UA_DataValue overflow;
+    HistorySample s;
+    UA_StatusCode ret = HistorySample_init(&s, timestamp, value, &overflow);
+    if(ret != UA_STATUSCODE_GOOD)
+        return ret;
+
+    /* Fast path: in-order append */
+    if(node->size == 0 || timestamp >= node->chunks[node->chunksSize - 1].lastTime) {
+        ret = appendSample(ctx, node, &s);
+    } else {
+        UA_Boolean found;
+        size_t index = lowerBound(ctx, node, timestamp, &found);
+        ret = insertSample(ctx, node, index, &s);
+    }
+    if(ret != UA_STATUSCODE_GOOD && s.overflow)
+        UA_DataValue_clear(&overflow);
+    return ret;
+}
+
+static UA_Boolean
+boundSupported_backend_memoryCompressed(UA_Server *server,
+                                        void *context,
+                                        const UA_NodeId *sessionId,
+                                        void *sessionContext,
+                                        const UA_NodeId *nodeId) {
+    return true;
+}
+
+static UA_Boolean
+timestampsToReturnSupported_backend_memoryCompressed(UA_Server *server,
+                                                     void *context,
+                                                     const UA_NodeId *sessionId,
+                                                     void *sessionContext,
+                                                     const UA_NodeId *nodeId,
+                                                     const UA_TimestampsToReturn timestampsToReturn) {
+    UA_MemoryCompressedStoreContext *ctx = (UA_MemoryCompressedStoreContext*)context;
+    const HistoryNode *node = findNode(ctx, nodeId);
+    if(!node || node->size == 0)
+        return true;
+
+    const HistorySample *s = getSample(ctx, node, 0);
+    UA_Boolean hasSource, hasServer;
+    if(s->overflow) {
+        hasSource = s->overflow->hasSourceTimestamp;
+        hasServer = s->overflow->hasServerTimestamp;
+    } else {
+        hasSource = (s->meta.mask & HISTORY_META_SOURCETS) != 0;
+        hasServer = (s->meta.mask & HISTORY_META_SERVERTS) != 0;
+    }
+    if(timestampsToReturn == UA_TIMESTAMPSTORETURN_NEITHER ||
+       timestampsToReturn == UA_TIMESTAMPSTORETURN_INVALID ||
+       (timestampsToReturn == UA_TIMESTAMPSTORETURN_SERVER && !hasServer) ||
+       (timestampsToReturn == UA_TIMESTAMPSTORETURN_SOURCE && !hasSource) ||
+       (timestampsToReturn == UA_TIMESTAMPSTORETURN_BOTH && !(hasSource && hasServer)))
+        return false;
+    return true;
+}
+
+/* The returned value is valid until the next call */
+static const UA_DataValue*
+getDataValue_backend_memoryCompressed(UA_Server *server,
+                                      void *context,
+                                      const UA_NodeId *sessionId,
+                                      void *sessionContext,
+                                      const UA_NodeId *nodeId,
+                                      size_t index) {
+    UA_MemoryCompressedStoreContext *ctx = (UA_MemoryCompressedStoreContext*)context;
+    const HistoryNode *node = findNode(ctx, nodeId);
+    if(!node || index >= node->size)
+        return NULL;
+    UA_DataValue_clear(&ctx->scratch);
+    if(HistorySample_toDataValue(getSample(ctx, node, index),
+                                 &ctx->scratch) != UA_STATUSCODE_GOOD)
+        return NULL;
+    return &ctx->scratch;
+}
+
+static UA_StatusCode
+copySample(const HistorySample *s, UA_DataValue *dst, const UA_NumericRange range) {
+    if(range.dimensionsSize == 0)
+        return HistorySample_toDataValue(s, dst);
+    UA_DataValue tmp;
+    UA_StatusCode ret = HistorySample_toDataValue(s, &tmp);
+    if(ret != UA_STATUSCODE_GOOD)
+        return ret;
+    *dst = tmp;
+    UA_Variant_init(&dst->value);
+    if(tmp.hasValue)
+        ret = UA_Variant_copyRange(&tmp.value, &dst->value, range);
+    else
+        ret = UA_STATUSCODE_BADDATAUNAVAILABLE;
+    UA_Variant_clear(&tmp.value);
+    return ret;
+}
+
+static UA_StatusCode
+copyDataValues_backend_memoryCompressed(UA_Server *server,
+                                        void *context,
+                                        const UA_NodeId *sessionId,
+                                        void *sessionContext,
+                                        const UA_NodeId *nodeId,
+                                        size_t startIndex,
+                                        size_t endIndex,
+                                        UA_Boolean reverse,
+                                        size_t maxValues,
+                                        UA_NumericRange range,
+                                        UA_Boolean releaseContinuationPoints,
+                                        const UA_ByteString *continuationPoint,
+                                        UA_ByteString *outContinuationPoint,
+                                        size_t *providedValues,
+                                        UA_DataValue *values) {
+    size_t skip = 0;
+    if(continuationPoint->length > 0) {
+        if(continuationPoint->length == sizeof(size_t))
+            skip = *((size_t*)(continuationPoint->data));
+        else
+            return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+    }
+    UA_MemoryCompressedStoreContext *ctx = (UA_MemoryCompressedStoreContext*)context;
+    const HistoryNode *node = findNode(ctx, nodeId);
+    size_t end = node ? node->size : 0;
+    size_t index = startIndex;
+    size_t counter = 0;
+    size_t skipedValues = 0;
+    if(reverse) {
+        while(index >= endIndex && index < end && counter < maxValues) {
+            if(skipedValues++ >= skip) {
+                copySample(getSample(ctx, node, index), &values[counter], range);
+                ++counter;
+            }
+            --index;
+        }
+    } else {
+        while(index <= endIndex && index < end && counter < maxValues) {
+            if(skipedValues++ >= skip) {
+                copySample(getSample(ctx, node, index), &values[counter], range);
+                ++counter;
+            }
+            ++index;
+        }
+    }
+
+    if(providedValues)
+        *providedValues = counter;
+
+    if((!reverse && (endIndex - startIndex - skip + 1) > counter) ||
+       (reverse && (startIndex - endIndex - skip + 1) > counter)) {
+        outContinuationPoint->data = (UA_Byte*)UA_malloc(sizeof(size_t));
+        if(!outContinuationPoint->data)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        outContinuationPoint->length = sizeof(size_t);
+        *((size_t*)(outContinuationPoint->data)) = skip + counter;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+insertDataValue_backend_memoryCompressed(UA_Server *server,
+                                         void *hdbContext,
+                                         const UA_NodeId *sessionId,
+                                         void *sessionContext,
+                                         const UA_NodeId *nodeId,
+                                         const UA_DataValue *value) {
+    if(!value->hasSourceTimestamp && !value->hasServerTimestamp)
+        return UA_STATUSCODE_BADINVALIDTIMESTAMP;
+    UA_MemoryCompressedStoreContext *ctx = (UA_MemoryCompressedStoreContext*)hdbContext;
+    HistoryNode *node = getNode(ctx, nodeId);
+    if(!node)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    const UA_DateTime timestamp = getKeyTime(value);
+    UA_Boolean found;
+    size_t index = lowerBound(ctx, node, timestamp, &found);
+    if(found)
+        return UA_STATUSCODE_BADENTRYEXISTS;
+
+    UA_DataValue overflow;
+    HistorySample s;
+    UA_StatusCode ret = HistorySample_init(&s, timestamp, value, &overflow);
+    if(ret != UA_STATUSCODE_GOOD)
+        return ret;
+    ret = insertSample(ctx, node, index, &s);
+    if(ret != UA_STATUSCODE_GOOD && s.overflow)
+        UA_DataValue_clear(&overflow);
+    return ret;
+}
+
+static UA_StatusCode
+replaceDataValue_backend_memoryCompressed(UA_Server *server,
+                                          void *hdbContext,
+                                          const UA_NodeId *sessionId,
+                                          void *sessionContext,
+                                          const UA_NodeId *nodeId,
+                                          const UA_DataValue *value) {
+    if(!value->hasSourceTimestamp && !value->hasServerTimestamp)
+        return UA_STATUSCODE_BADINVALIDTIMESTAMP;
+    UA_MemoryCompressedStoreContext *ctx = (UA_MemoryCompressedStoreContext*)hdbContext;
+    HistoryNode *node = findNode(ctx, nodeId);
+    if(!node)
+        return UA_STATUSCODE_BADNOENTRYEXISTS;
+
+    const UA_DateTime timestamp = getKeyTime(value);
+    UA_Boolean found;
+    size_t index = lowerBound(ctx, node, timestamp, &found);
+    if(!found)
+        return UA_STATUSCODE_BADNOENTRYEXISTS;
+
+    UA_DataValue overflow;
+    HistorySample s;
+    UA_StatusCode ret = HistorySample_init(&s, timestamp, value, &overflow);
+    if(ret != UA_STATUSCODE_GOOD)
+        return ret;
+    ret = replaceSample(ctx, node, index, &s);
+    if(ret != UA_STATUSCODE_GOOD && s.overflow)
+        UA_DataValue_clear(&overflow);
+    return ret;
+}
+
+static UA_StatusCode
+updateDataValue_backend_memoryCompressed(UA_Server *server,
+                                         void *hdbContext,
+                                         const UA_NodeId *sessionId,
+                                         void *sessionContext,
+                                         const UA_NodeId *nodeId,
+                                         const UA_DataValue *value) {
+    /* we first try to replace, because it is cheap */
+    UA_StatusCode ret =
+        replaceDataValue_backend_memoryCompressed(server, hdbContext, sessionId,
+                                                  sessionContext, nodeId, value);
+    if(ret == UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_GOODENTRYREPLACED;
+
+    ret = insertDataValue_backend_memoryCompressed(server, hdbContext, sessionId,
+                                                   sessionContext, nodeId, value);
+    if(ret == UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_GOODENTRYINSERTED;
+    return ret;
+}
+
+static UA_StatusCode
+removeDataValue_backend_memoryCompressed(UA_Server *server,
+                                         void *hdbContext,
+                                         const UA_NodeId *sessionId,
+                                         void *sessionContext,
+                                         const UA_NodeId *nodeId,
+                                         UA_DateTime startTimestamp,
+                                         UA_DateTime endTimestamp) {
+    if(startTimestamp > endTimestamp)
+        return UA_STATUSCODE_BADTIMESTAMPNOTSUPPORTED;
+    UA_MemoryCompressedStoreContext *ctx = (UA_MemoryCompressedStoreContext*)hdbContext;
+    HistoryNode *node = findNode(ctx, nodeId);
+    if(!node || node->size == 0)
+        return UA_STATUSCODE_BADNODATA;
+
+    /* The first index which will be deleted */
+    size_t index1;
+    /* The first index which is not deleted */
+    size_t index2;
+    if(startTimestamp == endTimestamp) {
+        index1 = getDateTimeMatch_backend_memoryCompressed(server, hdbContext, sessionId,
+                                                           sessionContext, nodeId,
+                                                           startTimestamp, MATCH_EQUAL);
+        if(index1 == node->size)
+            return UA_STATUSCODE_BADNODATA;
+        index2 = index1 + 1;
+    } else {
+        index1 = getDateTimeMatch_backend_memoryCompressed(server, hdbContext, sessionId,
+                                                           sessionContext, nodeId,
+                                                           startTimestamp, MATCH_EQUAL_OR_AFTER);
+        index2 = getDateTimeMatch_backend_memoryCompressed(server, hdbContext, sessionId,
+                                                           sessionContext, nodeId,
+                                                           endTimestamp, MATCH_BEFORE);
+        if(index2 == node->size || index1 == node->size || index1 > index2)
+            return UA_STATUSCODE_BADNODATA;
+        ++index2;
+    }
+    return removeSamples(ctx, node, index1, index2);
+}
+
+static void
+deleteMembers_backend_memoryCompressed(UA_HistoryDataBackend *backend) {
+    if(backend == NULL || backend->context == NULL)
+        return;
+    UA_MemoryCompressedStoreContext_deleteMembers((UA_MemoryCompressedStoreContext*)
+                                                  backend->context);
+}
+
+UA_HistoryDataBackend
+UA_HistoryDataBackend_MemoryCompressed(size_t chunkSize, size_t maxValuesPerNode,
+                                       UA_DateTime maxAge) {
+    if(chunkSize == 0)
+        chunkSize = UA_HISTORY_COMPRESSED_CHUNKSIZE;
+    UA_HistoryDataBackend result;
+    memset(&result, 0, sizeof(UA_HistoryDataBackend));
+    UA_MemoryCompressedStoreContext *ctx = (UA_MemoryCompressedStoreContext*)
+        UA_calloc(1, sizeof(UA_MemoryCompressedStoreContext));
+    if(!ctx)
+        return result;
+    ctx->cache = (HistorySample*)UA_calloc(chunkSize, sizeof(HistorySample));
+    if(!ctx->cache) {
+        UA_free(ctx);
+        return result;
+    }
+    ctx->chunkSize = chunkSize;
+    ctx->maxValuesPerNode = maxValuesPerNode;
+    ctx->maxAge = maxAge;
+    result.serverSetHistoryData = &serverSetHistoryData_backend_memoryCompressed;
+    result.resultSize = &resultSize_backend_memoryCompressed;
+    result.getEnd = &getEnd_backend_memoryCompressed;
+    result.lastIndex = &lastIndex_backend_memoryCompressed;
+    result.firstIndex = &firstIndex_backend_memoryCompressed;
+    result.getDateTimeMatch = &getDateTimeMatch_backend_memoryCompressed;
+    result.copyDataValues = &copyDataValues_backend_memoryCompressed;
+    result.getDataValue = &getDataValue_backend_memoryCompressed;
+    result.boundSupported = &boundSupported_backend_memoryCompressed;
+    result.timestampsToReturnSupported = &timestampsToReturnSupported_backend_memoryCompressed;
+    result.insertDataValue = &insertDataValue_backend_memoryCompressed;
+    result.updateDataValue = &updateDataValue_backend_memoryCompressed;
+    result.replaceDataValue = &replaceDataValue_backend_memoryCompressed;
+    result.removeDataValue = &removeDataValue_backend_memoryCompressed;
+    result.deleteMembers = &deleteMembers_backend_memoryCompressed;
+    result.getHistoryData = NULL;
+    result.context = ctx;
+    return result;
+}
+
+void
+UA_HistoryDataBackend_MemoryCompressed_deleteMembers(UA_HistoryDataBackend *backend) {
+    UA_MemoryCompressedStoreContext *ctx =
+        (UA_MemoryCompressedStoreContext*)backend->context;
+    if(ctx) {
+        UA_MemoryCompressedStoreContext_deleteMembers(ctx);
+        UA_free(ctx);
+    }
+    memset(backend, 0, sizeof(UA_HistoryDataBackend));
+}
@@ -265,10 +265,21 @@ getHistoryData_service_default(const UA_HistoryDataBackend* backend,
         outResult[counter].hasStatus = true;
         outResult[counter].status = UA_STATUSCODE_BADBOUNDNOTFOUND;
         outResult[counter].hasSourceTimestamp = true;
-        if (start == LLONG_MIN && storeEnd != backend->firstIndex(server, backend->context, sessionId, sessionContext, nodeId)) {
-            outResult[counter].sourceTimestamp = backend->getDataValue(server, backend->context, sessionId, sessionContext, nodeId, endIndex)->sourceTimestamp - UA_DATETIME_SEC;
-        } else if (end == LLONG_MIN && storeEnd != backend->firstIndex(server, backend->context, sessionId, sessionContext, nodeId)) {
-            outResult[counter].sourceTimestamp = backend->getDataValue(server, backend->context, sessionId, sessionContext, nodeId, endIndex)->sourceTimestamp + UA_DATETIME_SEC;
+        if ((start == LLONG_MIN || end == LLONG_MIN)
+                && storeEnd != backend->firstIndex(server, backend->context, sessionId, sessionContext, nodeId)) {
+            /* Backends that decode or load their values may fail here */
+            const UA_DataValue *boundValue = backend->getDataValue(server, backend->context, sessionId, sessionContext, nodeId, endIndex);
+            if (!boundValue) {
+                UA_ByteString_deleteMembers(&backendOutContinuationPoint);
+                UA_Array_delete(outResult, *resultSize, &UA_TYPES[UA_TYPES_DATAVALUE]);
+                *result = NULL;
+                *resultSize = 0;
+                return UA_STATUSCODE_BADINTERNALERROR;
+            }
+            if (start == LLONG_MIN)
+                outResult[counter].sourceTimestamp = boundValue->sourceTimestamp - UA_DATETIME_SEC;
+            else
+                outResult[counter].sourceTimestamp = boundValue->sourceTimestamp + UA_DATETIME_SEC;
         } else {
             outResult[counter].sourceTimestamp = end;
         }
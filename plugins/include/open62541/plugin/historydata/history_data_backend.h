@@ -214,7 +214,8 @@ struct UA_HistoryDataBackend {
      * hdbContext is the context of the UA_HistoryDataBackend.
      * sessionId and sessionContext identify the session that wants to read historical data.
      * nodeId is the node id of the node for which the data value shall be returned.
-     * index is the index in the database for which the data value is requested. */
+     * index is the index in the database for which the data value is requested.
+     * Returns NULL if the value cannot be provided. */
     const UA_DataValue*
     (*getDataValue)(UA_Server *server,
                     void *hdbContext,
@@ -0,0 +1,48 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef UA_HISTORYDATABACKEND_FILE_H_
+#define UA_HISTORYDATABACKEND_FILE_H_
+
+#include "history_data_backend.h"
+
+_UA_BEGIN_DECLS
+
+#define UA_HISTORY_FILE_SEGMENTSIZE (4 * 1024 * 1024)
+
+/* Persistent history backend that appends the values of every node to
+ * memory-mapped segment files of up to segmentSize bytes
+ * (UA_HISTORY_FILE_SEGMENTSIZE if zero) in the given directory. A segment
+ * file starts small and grows as values are appended. Only a sparse time index
+ * is kept in memory. Reads decode only the requested values. The segment file
+ * that a node appends to stays mapped. Older segment files are mapped on
+ * demand and only a bounded number of them stays mapped. The disk space is
+ * allocated before a segment file is created or grown. If that fails, the
+ * value is not stored.
+ *
+ * Existing segment files in the directory are opened and indexed. Files with
+ * an invalid header are removed, files that cannot be read are skipped. A
+ * record that was not completely written before a crash is detected by its
+ * checksum and discarded together with everything that follows in its
+ * segment.
+ *
+ * Values are appended in the order of their timestamps. Older values are
+ * rejected and the HistoryUpdate service is not supported. With
+ * maxSegmentsPerNode > 0, the oldest segment file of a node is removed when a
+ * new one is started.
+ *
+ * If the directory cannot be opened, the context of the returned backend is
+ * NULL. */
+UA_HistoryDataBackend UA_EXPORT
+UA_HistoryDataBackend_File(const char *directory, size_t segmentSize,
+                           size_t maxSegmentsPerNode);
+
+/* Unmaps the segment files. They remain in the directory. */
+void UA_EXPORT
+UA_HistoryDataBackend_File_deleteMembers(UA_HistoryDataBackend *backend);
+
+_UA_END_DECLS
+
+#endif /* UA_HISTORYDATABACKEND_FILE_H_ */
@@ -0,0 +1,35 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef UA_HISTORYDATABACKEND_MEMORY_COMPRESSED_H_
+#define UA_HISTORYDATABACKEND_MEMORY_COMPRESSED_H_
+
+#include "history_data_backend.h"
+
+_UA_BEGIN_DECLS
+
+#define UA_HISTORY_COMPRESSED_CHUNKSIZE 256
+
+/* In-memory history backend for long-running, high-frequency historizing.
+ *
+ * The values of every node are kept in chunks of up to chunkSize samples
+ * (UA_HISTORY_COMPRESSED_CHUNKSIZE if zero). Timestamps are stored
+ * delta-of-delta encoded and numeric scalar values XOR encoded in separate
+ * columns. Values of other types are kept as a copy next to the chunk.
+ *
+ * maxValuesPerNode and maxAge bound the retention per node. Zero means
+ * unbounded. maxAge is measured from the newest value of the node. The oldest
+ * values are dropped a whole chunk at a time. So up to one chunk more than the
+ * bound can be retained. */
+UA_HistoryDataBackend UA_EXPORT
+UA_HistoryDataBackend_MemoryCompressed(size_t chunkSize, size_t maxValuesPerNode,
+                                       UA_DateTime maxAge);
+
+void UA_EXPORT
+UA_HistoryDataBackend_MemoryCompressed_deleteMembers(UA_HistoryDataBackend *backend);
+
+_UA_END_DECLS
+
+#endif /* UA_HISTORYDATABACKEND_MEMORY_COMPRESSED_H_ */
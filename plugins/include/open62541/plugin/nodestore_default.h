@@ -18,6 +18,20 @@ _UA_BEGIN_DECLS
 UA_EXPORT UA_StatusCode
 UA_Nodestore_HashMap(UA_Nodestore *ns);
 
+#if UA_MULTITHREADING >= 200
+/* The concurrent HashMap Nodestore has the same layout as the HashMap
+ * Nodestore. But getNode, getNodeCopy and iterate do not take a lock and can be
+ * called from many threads in parallel. Changes to the Nodestore are
+ * serialized internally and replace the slot content atomically. Nodes that
+ * are replaced or removed are freed once no reader can access them any more
+ * (epoch-based reclamation). This is the default Nodestore of the server
+ * configuration with UA_MULTITHREADING >= 200. The services of the server are
+ * still serialized by the server lock. Lock-free reads are available to the
+ * application through the Nodestore interface. */
+UA_EXPORT UA_StatusCode
+UA_Nodestore_HashMapConcurrent(UA_Nodestore *ns);
+#endif
+
 /* The ZipTree Nodestore holds all nodes in RAM in a tree structure. The lookup
  * time is about O(log n). Adding/removing nodes does not require resizing of
  * the underlying array with the linear overhead.
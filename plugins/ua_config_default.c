@@ -40,13 +40,23 @@ UA_DURATIONRANGE(UA_Duration min, UA_Duration max) {
     return range;
 }
 
+/* With internal threads, use the Nodestore that can be read without a lock */
+static UA_StatusCode
+setDefaultNodestore(UA_Nodestore *ns) {
+#if UA_MULTITHREADING >= 200
+    return UA_Nodestore_HashMapConcurrent(ns);
+#else
+    return UA_Nodestore_HashMap(ns);
+#endif
+}
+
 UA_Server *
 UA_Server_new() {
     UA_ServerConfig config;
     memset(&config, 0, sizeof(UA_ServerConfig));
     /* Set a default logger and NodeStore for the initialization */
     config.logger = UA_Log_Stdout_;
-    UA_Nodestore_HashMap(&config.nodestore);
+    setDefaultNodestore(&config.nodestore);
     return UA_Server_newWithConfig(&config);
 }
 
@@ -119,7 +129,7 @@ setDefaultConfig(UA_ServerConfig *conf) {
         return UA_STATUSCODE_BADINVALIDARGUMENT;
 
     if(conf->nodestore.context == NULL)
-        UA_Nodestore_HashMap(&conf->nodestore);
+        setDefaultNodestore(&conf->nodestore);
 
     /* --> Start setting the default static config <-- */
     conf->nThreads = 1;
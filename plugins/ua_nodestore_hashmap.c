@@ -8,6 +8,10 @@
 
 #include <open62541/plugin/nodestore_default.h>
 
+#if UA_MULTITHREADING >= 200
+#include <pthread.h>
+#endif
+
 #ifndef container_of
 #define container_of(ptr, type, member) \
     (type *)((uintptr_t)ptr - offsetof(type,member))
@@ -143,37 +147,37 @@ expand(UA_NodeMap *ns) {
     return UA_STATUSCODE_GOOD;
 }
 
-static UA_NodeMapEntry *
-createEntry(UA_NodeClass nodeClass) {
-    size_t size = sizeof(UA_NodeMapEntry) - sizeof(UA_Node);
+/* Returns zero for an invalid NodeClass */
+static size_t
+nodeClassSize(UA_NodeClass nodeClass) {
     switch(nodeClass) {
     case UA_NODECLASS_OBJECT:
-        size += sizeof(UA_ObjectNode);
-        break;
+        return sizeof(UA_ObjectNode);
     case UA_NODECLASS_VARIABLE:
-        size += sizeof(UA_VariableNode);
-        break;
+        return sizeof(UA_VariableNode);
     case UA_NODECLASS_METHOD:
-        size += sizeof(UA_MethodNode);
-        break;
+        return sizeof(UA_MethodNode);
     case UA_NODECLASS_OBJECTTYPE:
-        size += sizeof(UA_ObjectTypeNode);
-        break;
+        return sizeof(UA_ObjectTypeNode);
     case UA_NODECLASS_VARIABLETYPE:
-        size += sizeof(UA_VariableTypeNode);
-        break;
+        return sizeof(UA_VariableTypeNode);
     case UA_NODECLASS_REFERENCETYPE:
-        size += sizeof(UA_ReferenceTypeNode);
-        break;
+        return sizeof(UA_ReferenceTypeNode);
     case UA_NODECLASS_DATATYPE:
-        size += sizeof(UA_DataTypeNode);
-        break;
+        return sizeof(UA_DataTypeNode);
     case UA_NODECLASS_VIEW:
-        size += sizeof(UA_ViewNode);
-        break;
+        return sizeof(UA_ViewNode);
     default:
-        return NULL;
+        return 0;
     }
+}
+
+static UA_NodeMapEntry *
+createEntry(UA_NodeClass nodeClass) {
+    size_t nodeSize = nodeClassSize(nodeClass);
+    if(nodeSize == 0)
+        return NULL;
+    size_t size = sizeof(UA_NodeMapEntry) - sizeof(UA_Node) + nodeSize;
     UA_NodeMapEntry *entry = (UA_NodeMapEntry*)UA_calloc(1, size);
     if(!entry)
         return NULL;
@@ -454,3 +458,572 @@ UA_Nodestore_HashMap(UA_Nodestore *ns) {
     ns->iterate = UA_NodeMap_iterate;
     return UA_STATUSCODE_GOOD;
 }
+
+#if UA_MULTITHREADING >= 200
+
+/* Concurrent HashMap Nodestore
+ * ----------------------------
+ * Same hash-map layout as above. But readers (getNode, getNodeCopy, iterate)
+ * take no lock. Writers (insertNode, replaceNode, removeNode) are serialized by
+ * a mutex and publish every change with an atomic store to a slot. When the
+ * hash-map is resized, a new table is built on the side and replaces the old
+ * one with an atomic pointer swap.
+ *
+ * Entries and tables that are no longer reachable are "retired" and freed only
+ * once no reader can still hold a pointer to them. This is tracked with epochs.
+ * A reader registers with the current epoch in a counter before accessing the
+ * table and deregisters afterwards. The counters are striped over several
+ * cache lines to avoid contention between the reader threads. The global epoch
+ * is advanced (by a writer) only when no reader of the previous epoch is left.
+ * Memory retired in epoch e can be freed once the global epoch reaches e+2.
+ * Readers keep the node alive beyond their critical section with an atomic
+ * reference count. Retired entries are freed when it has dropped to zero.
+ *
+ * Every entry gets a unique version number when it is inserted into the table.
+ * A node copy remembers the version it was made from. replaceNode compares the
+ * version and not the pointer to the original entry. The memory of a retired
+ * entry can be reused for a new entry while a copy is held (ABA). */
+
+#define UA_CONCURRENTNODEMAP_STRIPES 64
+
+typedef struct UA_ConcurrentNodeMapEntry {
+    UA_UInt64 version;     /* Set before the entry is published */
+    UA_UInt64 origVersion; /* the version this is a copy from (or 0) */
+    struct UA_ConcurrentNodeMapEntry *retiredNext;
+    UA_UInt32 retiredEpoch;
+    volatile UA_Boolean retired; /* No longer reachable from the table */
+    volatile uint32_t refCount;
+    UA_Node node;
+} UA_ConcurrentNodeMapEntry;
+
+typedef struct {
+    UA_ConcurrentNodeMapEntry * volatile entry;
+    volatile UA_UInt32 nodeIdHash; /* Only used as a filter by the readers */
+} UA_ConcurrentNodeMapSlot;
+
+typedef struct UA_ConcurrentNodeMapTable {
+    struct UA_ConcurrentNodeMapTable *retiredNext;
+    UA_UInt32 retiredEpoch;
+    UA_UInt32 size;
+    UA_ConcurrentNodeMapSlot slots[];
+} UA_ConcurrentNodeMapTable;
+
+/* Number of readers in the even/odd epochs. Padded to a cache line. */
+typedef struct {
+    volatile uint32_t readers[2];
+    UA_Byte padding[64 - (2 * sizeof(uint32_t))];
+} UA_ConcurrentNodeMapStripe;
+
+typedef struct {
+    UA_ConcurrentNodeMapTable * volatile table;
+    volatile UA_UInt32 epoch;
+    UA_ConcurrentNodeMapStripe stripes[UA_CONCURRENTNODEMAP_STRIPES];
+
+    /* Only accessed with the writeMutex */
+    pthread_mutex_t writeMutex;
+    UA_UInt32 count;
+    UA_UInt64 versionCounter;
+    UA_ConcurrentNodeMapEntry *retiredEntries;
+    UA_ConcurrentNodeMapTable *retiredTables;
+} UA_ConcurrentNodeMap;
+
+#define UA_CONCURRENTNODEMAP_TOMBSTONE ((UA_ConcurrentNodeMapEntry*)0x01)
+
+/**********/
+/* Epochs */
+/**********/
+
+static UA_ConcurrentNodeMapStripe *
+readerStripe(UA_ConcurrentNodeMap *ns) {
+    pthread_t self = pthread_self();
+    UA_UInt32 h = UA_ByteString_hash(0, (const UA_Byte*)&self, sizeof(pthread_t));
+    return &ns->stripes[h % UA_CONCURRENTNODEMAP_STRIPES];
+}
+
+static UA_UInt32
+readerEnter(UA_ConcurrentNodeMap *ns, UA_ConcurrentNodeMapStripe *stripe) {
+    while(true) {
+        UA_UInt32 epoch = ns->epoch;
+        UA_atomic_addUInt32(&stripe->readers[epoch & 1], 1); /* Full barrier */
+        if(ns->epoch == epoch)
+            return epoch;
+        /* The epoch was advanced in the meantime. Retry. */
+        UA_atomic_subUInt32(&stripe->readers[epoch & 1], 1);
+    }
+}
+
+static void
+readerLeave(UA_ConcurrentNodeMapStripe *stripe, UA_UInt32 epoch) {
+    UA_atomic_subUInt32(&stripe->readers[epoch & 1], 1);
+}
+
+/* Called with the writeMutex. Advances the epoch if no reader of the previous
+ * epoch is left. */
+static void
+tryAdvanceEpoch(UA_ConcurrentNodeMap *ns) {
+    UA_UInt32 epoch = ns->epoch;
+    UA_UInt32 previous = (epoch + 1) & 1; /* Same parity as epoch - 1 */
+    UA_atomic_sync();
+    for(size_t i = 0; i < UA_CONCURRENTNODEMAP_STRIPES; i++) {
+        /* Read with an atomic operation to synchronize with readerLeave */
+        if(UA_atomic_addUInt32(&ns->stripes[i].readers[previous], 0) != 0)
+            return;
+    }
+    ns->epoch = epoch + 1;
+    UA_atomic_sync();
+}
+
+static void
+deleteConcurrentEntry(UA_ConcurrentNodeMapEntry *entry) {
+    UA_Node_clear(&entry->node);
+    UA_free(entry);
+}
+
+/* Called with the writeMutex. Frees the retired memory that can no longer be
+ * accessed by a reader. */
+static void
+reclaim(UA_ConcurrentNodeMap *ns) {
+    tryAdvanceEpoch(ns);
+    tryAdvanceEpoch(ns);
+    UA_UInt32 epoch = ns->epoch;
+
+    UA_ConcurrentNodeMapEntry **e = &ns->retiredEntries;
+    while(*e) {
+        UA_ConcurrentNodeMapEntry *entry = *e;
+        if((UA_Int32)(epoch - entry->retiredEpoch) < 2 ||
+           UA_atomic_addUInt32(&entry->refCount, 0) > 0) {
+            e = &entry->retiredNext;
+            continue;
+        }
+        *e = entry->retiredNext;
+        deleteConcurrentEntry(entry);
+    }
+
+    UA_ConcurrentNodeMapTable **t = &ns->retiredTables;
+    while(*t) {
+        UA_ConcurrentNodeMapTable *table = *t;
+        if((UA_Int32)(epoch - table->retiredEpoch) < 2) {
+            t = &table->retiredNext;
+            continue;
+        }
+        *t = table->retiredNext;
+        UA_free(table);
+    }
+}
+
+/* Called with the writeMutex after the entry was removed from the table */
+static void
+retireEntry(UA_ConcurrentNodeMap *ns, UA_ConcurrentNodeMapEntry *entry) {
+    entry->retiredEpoch = ns->epoch;
+    entry->retiredNext = ns->retiredEntries;
+    ns->retiredEntries = entry;
+    UA_atomic_sync();
+    entry->retired = true;
+}
+
+/*********************/
+/* HashMap Utilities */
+/*********************/
+
+static UA_ConcurrentNodeMapTable *
+newConcurrentTable(UA_UInt32 size) {
+    return (UA_ConcurrentNodeMapTable*)
+        UA_calloc(1, sizeof(UA_ConcurrentNodeMapTable) +
+                  (size * sizeof(UA_ConcurrentNodeMapSlot)));
+}
+
+/* Lock-free lookup for the readers. The slot content can change concurrently.
+ * So the entry pointer is loaded only once. */
+static UA_ConcurrentNodeMapEntry *
+findConcurrentEntry(const UA_ConcurrentNodeMapTable *table, const UA_NodeId *nodeid) {
+    UA_UInt32 h = UA_NodeId_hash(nodeid);
+    UA_UInt32 size = table->size;
+    UA_UInt64 idx = mod(h, size); /* Use 64bit container to avoid overflow */
+    UA_UInt32 hash2 = mod2(h, size);
+    UA_UInt32 startIdx = (UA_UInt32)idx;
+
+    do {
+        const UA_ConcurrentNodeMapSlot *slot = &table->slots[(UA_UInt32)idx];
+        UA_ConcurrentNodeMapEntry *entry = slot->entry;
+        if(entry > UA_CONCURRENTNODEMAP_TOMBSTONE) {
+            if(slot->nodeIdHash == h && UA_NodeId_equal(&entry->node.nodeId, nodeid))
+                return entry;
+        } else if(entry == NULL) {
+            return NULL; /* No further entry possible */
+        }
+
+        idx += hash2;
+        if(idx >= size)
+            idx -= size;
+    } while((UA_UInt32)idx != startIdx);
+
+    return NULL;
+}
+
+/* For the writers. Returns an occupied slot with the NodeId (exists = true) or
+ * a free slot where it can be inserted (exists = false). */
+static UA_ConcurrentNodeMapSlot *
+findConcurrentSlot(UA_ConcurrentNodeMapTable *table, const UA_NodeId *nodeid,
+                   UA_Boolean *exists) {
+    UA_UInt32 h = UA_NodeId_hash(nodeid);
+    UA_UInt32 size = table->size;
+    UA_UInt64 idx = mod(h, size); /* Use 64bit container to avoid overflow */
+    UA_UInt32 hash2 = mod2(h, size);
+    UA_UInt32 startIdx = (UA_UInt32)idx;
+
+    *exists = false;
+    UA_ConcurrentNodeMapSlot *candidate = NULL;
+    do {
+        UA_ConcurrentNodeMapSlot *slot = &table->slots[(UA_UInt32)idx];
+        if(slot->entry > UA_CONCURRENTNODEMAP_TOMBSTONE) {
+            if(slot->nodeIdHash == h &&
+               UA_NodeId_equal(&slot->entry->node.nodeId, nodeid)) {
+                *exists = true;
+                return slot;
+            }
+        } else {
+            if(!candidate)
+                candidate = slot;
+            if(slot->entry == NULL)
+                return candidate; /* No matching node can come afterwards */
+        }
+
+        idx += hash2;
+        if(idx >= size)
+            idx -= size;
+    } while((UA_UInt32)idx != startIdx);
+
+    return candidate;
+}
+
+/* Called with the writeMutex. Builds a new table with about 50% occupancy and
+ * publishes it. Readers of the old table are not affected. */
+static UA_StatusCode
+expandConcurrent(UA_ConcurrentNodeMap *ns) {
+    UA_ConcurrentNodeMapTable *otable = ns->table;
+    UA_UInt32 osize = otable->size;
+    UA_UInt32 count = ns->count;
+    /* Resize only when table after removal of unused elements is either too
+       full or too empty */
+    if(count * 2 < osize && (count * 8 > osize || osize <= UA_NODEMAP_MINSIZE))
+        return UA_STATUSCODE_GOOD;
+
+    UA_UInt32 nsize = primes[higher_prime_index(count * 2)];
+    UA_ConcurrentNodeMapTable *ntable = newConcurrentTable(nsize);
+    if(!ntable)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    ntable->size = nsize;
+
+    for(size_t i = 0, j = 0; i < osize && j < count; ++i) {
+        UA_ConcurrentNodeMapSlot *oslot = &otable->slots[i];
+        if(oslot->entry <= UA_CONCURRENTNODEMAP_TOMBSTONE)
+            continue;
+        UA_Boolean exists;
+        UA_ConcurrentNodeMapSlot *s =
+            findConcurrentSlot(ntable, &oslot->entry->node.nodeId, &exists);
+        UA_assert(s && !exists);
+        s->nodeIdHash = oslot->nodeIdHash;
+        s->entry = oslot->entry;
+        ++j;
+    }
+
+    /* Publish the new table and retire the old one */
+    UA_atomic_xchg((void * volatile *)&ns->table, ntable);
+    otable->retiredEpoch = ns->epoch;
+    otable->retiredNext = ns->retiredTables;
+    ns->retiredTables = otable;
+    return UA_STATUSCODE_GOOD;
+}
+
+/***********************/
+/* Interface functions */
+/***********************/
+
+static UA_Node *
+UA_ConcurrentNodeMap_newNode(void *context, UA_NodeClass nodeClass) {
+    size_t nodeSize = nodeClassSize(nodeClass);
+    if(nodeSize == 0)
+        return NULL;
+    UA_ConcurrentNodeMapEntry *entry = (UA_ConcurrentNodeMapEntry*)
+        UA_calloc(1, sizeof(UA_ConcurrentNodeMapEntry) - sizeof(UA_Node) + nodeSize);
+    if(!entry)
+        return NULL;
+    entry->node.nodeClass = nodeClass;
+    return &entry->node;
+}
+
+static void
+UA_ConcurrentNodeMap_deleteNode(void *context, UA_Node *node) {
+    UA_ConcurrentNodeMapEntry *entry =
+        container_of(node, UA_ConcurrentNodeMapEntry, node);
+    UA_assert(&entry->node == node);
+    deleteConcurrentEntry(entry);
+}
+
+static const UA_Node *
+UA_ConcurrentNodeMap_getNode(void *context, const UA_NodeId *nodeid) {
+    UA_ConcurrentNodeMap *ns = (UA_ConcurrentNodeMap*)context;
+    UA_ConcurrentNodeMapStripe *stripe = readerStripe(ns);
+    UA_UInt32 epoch = readerEnter(ns, stripe);
+    UA_ConcurrentNodeMapEntry *entry = findConcurrentEntry(ns->table, nodeid);
+    if(entry)
+        UA_atomic_addUInt32(&entry->refCount, 1);
+    readerLeave(stripe, epoch);
+    return (entry) ? &entry->node : NULL;
+}
+
+static void
+UA_ConcurrentNodeMap_releaseNode(void *context, const UA_Node *node) {
+    if(!node)
+        return;
+    UA_ConcurrentNodeMap *ns = (UA_ConcurrentNodeMap*)context;
+    UA_ConcurrentNodeMapEntry *entry =
+        container_of(node, UA_ConcurrentNodeMapEntry, node);
+    UA_assert(&entry->node == node);
+    UA_assert(entry->refCount > 0);
+    /* Read the flag before the decrement. Afterwards the entry can be freed by
+     * a concurrent writer. */
+    UA_Boolean retired = entry->retired;
+    if(UA_atomic_subUInt32(&entry->refCount, 1) > 0 || !retired)
+        return;
+
+    /* The last reference to a retired entry was released. Free it now if no
+     * writer is active. Otherwise the next writer cleans up. */
+    if(pthread_mutex_trylock(&ns->writeMutex) != 0)
+        return;
+    reclaim(ns);
+    pthread_mutex_unlock(&ns->writeMutex);
+}
+
+static UA_StatusCode
+UA_ConcurrentNodeMap_getNodeCopy(void *context, const UA_NodeId *nodeid,
+                                 UA_Node **outNode) {
+    const UA_Node *node = UA_ConcurrentNodeMap_getNode(context, nodeid);
+    if(!node)
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    UA_ConcurrentNodeMapEntry *entry =
+        container_of(node, UA_ConcurrentNodeMapEntry, node);
+    UA_StatusCode retval = UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_Node *newNode = UA_ConcurrentNodeMap_newNode(context, node->nodeClass);
+    if(newNode) {
+        retval = UA_Node_copy(node, newNode);
+        if(retval == UA_STATUSCODE_GOOD) {
+            /* Store the version of the original */
+            UA_ConcurrentNodeMapEntry *newEntry =
+                container_of(newNode, UA_ConcurrentNodeMapEntry, node);
+            newEntry->origVersion = entry->version;
+            *outNode = newNode;
+        } else {
+            UA_ConcurrentNodeMap_deleteNode(context, newNode);
+        }
+    }
+    UA_ConcurrentNodeMap_releaseNode(context, node);
+    return retval;
+}
+
+static UA_StatusCode
+UA_ConcurrentNodeMap_removeNode(void *context, const UA_NodeId *nodeid) {
+    UA_ConcurrentNodeMap *ns = (UA_ConcurrentNodeMap*)context;
+    pthread_mutex_lock(&ns->writeMutex);
+    UA_Boolean exists;
+    UA_ConcurrentNodeMapSlot *slot = findConcurrentSlot(ns->table, nodeid, &exists);
+    if(!exists) {
+        pthread_mutex_unlock(&ns->writeMutex);
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    }
+
+    UA_ConcurrentNodeMapEntry *entry = (UA_ConcurrentNodeMapEntry*)
+        UA_atomic_xchg((void * volatile *)&slot->entry, UA_CONCURRENTNODEMAP_TOMBSTONE);
+    retireEntry(ns, entry);
+    --ns->count;
+    /* Downsize the hashmap if it is very empty */
+    if(ns->count * 8 < ns->table->size && ns->table->size > UA_NODEMAP_MINSIZE)
+        expandConcurrent(ns); /* Can fail. Just continue with the bigger hashmap. */
+    reclaim(ns);
+    pthread_mutex_unlock(&ns->writeMutex);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+UA_ConcurrentNodeMap_insertNode(void *context, UA_Node *node,
+                                UA_NodeId *addedNodeId) {
+    UA_ConcurrentNodeMap *ns = (UA_ConcurrentNodeMap*)context;
+    UA_ConcurrentNodeMapEntry *newEntry =
+        container_of(node, UA_ConcurrentNodeMapEntry, node);
+    pthread_mutex_lock(&ns->writeMutex);
+    if(ns->table->size * 3 <= ns->count * 4) {
+        if(expandConcurrent(ns) != UA_STATUSCODE_GOOD) {
+            pthread_mutex_unlock(&ns->writeMutex);
+            deleteConcurrentEntry(newEntry);
+            return UA_STATUSCODE_BADINTERNALERROR;
+        }
+    }
+
+    UA_ConcurrentNodeMapTable *table = ns->table;
+    UA_ConcurrentNodeMapSlot *slot;
+    UA_Boolean exists = false;
+    if(node->nodeId.identifierType == UA_NODEIDTYPE_NUMERIC &&
+       node->nodeId.identifier.numeric == 0) {
+        /* Create a random nodeid. See the comment for the non-concurrent
+         * HashMap above. */
+        UA_UInt32 size = table->size;
+        UA_UInt64 identifier = mod(50000 + size+1, UA_UINT32_MAX);
+        UA_UInt32 increase = mod2(ns->count+1, size);
+        UA_UInt32 startId = (UA_UInt32)identifier;
+        do {
+            node->nodeId.identifier.numeric = (UA_UInt32)identifier;
+            slot = findConcurrentSlot(table, &node->nodeId, &exists);
+            if(slot && !exists)
+                break;
+            identifier += increase;
+            if(identifier >= size)
+                identifier -= size;
+        } while((UA_UInt32)identifier != startId);
+    } else {
+        slot = findConcurrentSlot(table, &node->nodeId, &exists);
+    }
+
+    if(!slot || exists) {
+        pthread_mutex_unlock(&ns->writeMutex);
+        deleteConcurrentEntry(newEntry);
+        return UA_STATUSCODE_BADNODEIDEXISTS;
+    }
+
+    /* Copy the NodeId */
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    if(addedNodeId) {
+        retval = UA_NodeId_copy(&node->nodeId, addedNodeId);
+        if(retval != UA_STATUSCODE_GOOD) {
+            pthread_mutex_unlock(&ns->writeMutex);
+            deleteConcurrentEntry(newEntry);
+            return retval;
+        }
+    }
+
+    /* Insert the node. The entry pointer is published last. */
+    newEntry->version = ++ns->versionCounter;
+    slot->nodeIdHash = UA_NodeId_hash(&node->nodeId);
+    UA_atomic_xchg((void * volatile *)&slot->entry, newEntry);
+    ++ns->count;
+    reclaim(ns);
+    pthread_mutex_unlock(&ns->writeMutex);
+    return retval;
+}
+
+static UA_StatusCode
+UA_ConcurrentNodeMap_replaceNode(void *context, UA_Node *node) {
+    UA_ConcurrentNodeMap *ns = (UA_ConcurrentNodeMap*)context;
+    UA_ConcurrentNodeMapEntry *newEntry =
+        container_of(node, UA_ConcurrentNodeMapEntry, node);
+    UA_UInt64 origVersion = newEntry->origVersion;
+    newEntry->origVersion = 0;
+
+    /* Find the node */
+    pthread_mutex_lock(&ns->writeMutex);
+    UA_Boolean exists;
+    UA_ConcurrentNodeMapSlot *slot =
+        findConcurrentSlot(ns->table, &node->nodeId, &exists);
+    if(!exists) {
+        pthread_mutex_unlock(&ns->writeMutex);
+        deleteConcurrentEntry(newEntry);
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    }
+
+    /* Replace the entry if it was not updated since the copy was made. The
+     * writers are serialized. So the slot cannot change after the check. */
+    UA_ConcurrentNodeMapEntry *oldEntry = slot->entry;
+    if(oldEntry->version != origVersion) {
+        pthread_mutex_unlock(&ns->writeMutex);
+        deleteConcurrentEntry(newEntry);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    newEntry->version = ++ns->versionCounter;
+    UA_atomic_xchg((void * volatile *)&slot->entry, newEntry);
+
+    retireEntry(ns, oldEntry);
+    reclaim(ns);
+    pthread_mutex_unlock(&ns->writeMutex);
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+UA_ConcurrentNodeMap_iterate(void *context, UA_NodestoreVisitor visitor,
+                             void *visitorContext) {
+    UA_ConcurrentNodeMap *ns = (UA_ConcurrentNodeMap*)context;
+    UA_ConcurrentNodeMapStripe *stripe = readerStripe(ns);
+    UA_UInt32 epoch = readerEnter(ns, stripe);
+    UA_ConcurrentNodeMapTable *table = ns->table;
+    for(UA_UInt32 i = 0; i < table->size; ++i) {
+        UA_ConcurrentNodeMapEntry *entry = table->slots[i].entry;
+        if(entry <= UA_CONCURRENTNODEMAP_TOMBSTONE)
+            continue;
+        /* The visitor can delete the node. So refcount here. */
+        UA_atomic_addUInt32(&entry->refCount, 1);
+        visitor(visitorContext, &entry->node);
+        UA_ConcurrentNodeMap_releaseNode(context, &entry->node);
+    }
+    readerLeave(stripe, epoch);
+}
+
+static void
+UA_ConcurrentNodeMap_delete(void *context) {
+    UA_ConcurrentNodeMap *ns = (UA_ConcurrentNodeMap*)context;
+    UA_ConcurrentNodeMapTable *table = ns->table;
+    for(UA_UInt32 i = 0; i < table->size; ++i) {
+        UA_ConcurrentNodeMapEntry *entry = table->slots[i].entry;
+        if(entry <= UA_CONCURRENTNODEMAP_TOMBSTONE)
+            continue;
+        /* On debugging builds, check that all nodes were release */
+        UA_assert(entry->refCount == 0);
+        deleteConcurrentEntry(entry);
+    }
+    UA_free(table);
+
+    /* No more readers. Free all retired memory. */
+    while(ns->retiredEntries) {
+        UA_ConcurrentNodeMapEntry *entry = ns->retiredEntries;
+        ns->retiredEntries = entry->retiredNext;
+        deleteConcurrentEntry(entry);
+    }
+    while(ns->retiredTables) {
+        table = ns->retiredTables;
+        ns->retiredTables = table->retiredNext;
+        UA_free(table);
+    }
+
+    pthread_mutex_destroy(&ns->writeMutex);
+    UA_free(ns);
+}
+
+UA_StatusCode
+UA_Nodestore_HashMapConcurrent(UA_Nodestore *ns) {
+    /* Allocate and initialize the nodemap */
+    UA_ConcurrentNodeMap *nodemap = (UA_ConcurrentNodeMap*)
+        UA_calloc(1, sizeof(UA_ConcurrentNodeMap));
+    if(!nodemap)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_UInt32 size = primes[higher_prime_index(UA_NODEMAP_MINSIZE)];
+    nodemap->table = newConcurrentTable(size);
+    if(!nodemap->table) {
+        UA_free(nodemap);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    nodemap->table->size = size;
+    pthread_mutex_init(&nodemap->writeMutex, NULL);
+
+    /* Populate the nodestore */
+    ns->context = nodemap;
+    ns->clear = UA_ConcurrentNodeMap_delete;
+    ns->newNode = UA_ConcurrentNodeMap_newNode;
+    ns->deleteNode = UA_ConcurrentNodeMap_deleteNode;
+    ns->getNode = UA_ConcurrentNodeMap_getNode;
+    ns->releaseNode = UA_ConcurrentNodeMap_releaseNode;
+    ns->getNodeCopy = UA_ConcurrentNodeMap_getNodeCopy;
+    ns->insertNode = UA_ConcurrentNodeMap_insertNode;
+    ns->replaceNode = UA_ConcurrentNodeMap_replaceNode;
+    ns->removeNode = UA_ConcurrentNodeMap_removeNode;
+    ns->iterate = UA_ConcurrentNodeMap_iterate;
+    return UA_STATUSCODE_GOOD;
+}
+
+#endif /* UA_MULTITHREADING >= 200 */
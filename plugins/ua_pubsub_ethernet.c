@@ -6,6 +6,11 @@
  *   Copyright 2019 (c) Wind River Systems, Inc.
  */
 
+/* Enable the declaration of recvmmsg */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+# define _GNU_SOURCE
+#endif
+
 #include <open62541/plugin/log_stdout.h>
 #include <open62541/plugin/pubsub_ethernet.h>
 #include <open62541/util.h>
@@ -23,6 +28,14 @@
 #define ETHERTYPE_UADP 0xb62c
 #endif
 
+/* Receive several frames with a single system call. The declaration might not
+ * be visible if the system headers were included before _GNU_SOURCE was set
+ * (e.g. in the amalgamation). */
+#if defined(__linux__) && defined(__USE_GNU) && defined(MSG_WAITFORONE)
+#define UA_PUBSUB_ETHERNET_RECVMMSG
+#define UA_PUBSUB_ETHERNET_RECVMMSG_BATCH 32
+#endif
+
 /* Ethernet network layer specific internal data */
 typedef struct {
     int ifindex;
@@ -414,6 +427,86 @@ UA_PubSubChannelEthernet_receive(UA_PubSubChannel *channel, UA_ByteString *messa
     return UA_STATUSCODE_GOOD;
 }
 
+#ifdef UA_PUBSUB_ETHERNET_RECVMMSG
+/**
+ * Receive all pending frames up to the number of provided buffers. Only the
+ * first frame is waited for. Frames for other targets are dropped.
+ *
+ * @param timeout in usec
+ * @return
+ */
+static UA_StatusCode
+UA_PubSubChannelEthernet_receiveMultiple(UA_PubSubChannel *channel, UA_ByteString *messages,
+                                         size_t messagesSize, size_t *received,
+                                         UA_ExtensionObject *transportSettings,
+                                         UA_UInt32 timeout) {
+    UA_PubSubChannelDataEthernet *channelDataEthernet =
+        (UA_PubSubChannelDataEthernet *) channel->handle;
+    *received = 0;
+
+    /* Sleep in a select call until the first frame arrives */
+    fd_set fdset;
+    FD_ZERO(&fdset);
+    UA_fd_set(channel->sockfd, &fdset);
+    struct timeval tmptv = {(long int)(timeout / 1000000),
+                            (long int)(timeout % 1000000)};
+    int resultsize = UA_select(channel->sockfd+1, &fdset, NULL, NULL, &tmptv);
+    if(resultsize == 0)
+        return UA_STATUSCODE_GOODNONCRITICALTIMEOUT;
+    if(resultsize == -1)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    struct ether_header eth_hdr[UA_PUBSUB_ETHERNET_RECVMMSG_BATCH];
+    struct iovec iovs[UA_PUBSUB_ETHERNET_RECVMMSG_BATCH][2];
+    struct mmsghdr msgs[UA_PUBSUB_ETHERNET_RECVMMSG_BATCH];
+
+    /* Take the pending frames without blocking until the buffers are full or
+     * no more data is available */
+    size_t total = 0;
+    while(total < messagesSize) {
+        size_t batch = messagesSize - total;
+        if(batch > UA_PUBSUB_ETHERNET_RECVMMSG_BATCH)
+            batch = UA_PUBSUB_ETHERNET_RECVMMSG_BATCH;
+        memset(msgs, 0, sizeof(struct mmsghdr) * batch);
+        for(size_t i = 0; i < batch; i++) {
+            iovs[i][0].iov_base = &eth_hdr[i];
+            iovs[i][0].iov_len = sizeof(struct ether_header);
+            iovs[i][1].iov_base = messages[total + i].data;
+            iovs[i][1].iov_len = messages[total + i].length;
+            msgs[i].msg_hdr.msg_iov = iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 2;
+        }
+        int n = recvmmsg(channel->sockfd, msgs, (unsigned int)batch, MSG_DONTWAIT, NULL);
+        if(n <= 0)
+            break;
+
+        /* Keep only the frames that match our target. Move the buffers of the
+         * dropped frames to the end so they can be reused. */
+        size_t kept = 0;
+        for(size_t i = 0; i < (size_t)n; i++) {
+            if(msgs[i].msg_len < sizeof(struct ether_header) ||
+               memcmp(eth_hdr[i].ether_dhost, channelDataEthernet->targetAddress,
+                      ETH_ALEN) != 0)
+                continue;
+            UA_ByteString *msg = &messages[total + kept];
+            if(kept != i) {
+                UA_ByteString tmp = *msg;
+                *msg = messages[total + i];
+                messages[total + i] = tmp;
+            }
+            msg->length = msgs[i].msg_len - sizeof(struct ether_header);
+            kept++;
+        }
+        total += kept;
+        if((size_t)n < batch)
+            break;
+    }
+
+    *received = total;
+    return UA_STATUSCODE_GOOD;
+}
+#endif
+
 /**
  * Close channel and free the channel data.
  *
@@ -442,6 +535,9 @@ TransportLayerEthernet_addChannel(UA_PubSubConnectionConfig *connectionConfig) {
         pubSubChannel->unregist = UA_PubSubChannelEthernet_unregist;
         pubSubChannel->send = UA_PubSubChannelEthernet_send;
         pubSubChannel->receive = UA_PubSubChannelEthernet_receive;
+#ifdef UA_PUBSUB_ETHERNET_RECVMMSG
+        pubSubChannel->receiveMultiple = UA_PubSubChannelEthernet_receiveMultiple;
+#endif
         pubSubChannel->close = UA_PubSubChannelEthernet_close;
         pubSubChannel->connectionConfig = connectionConfig;
     }
@@ -7,10 +7,23 @@
  * Copyright (c) 2020 Fraunhofer IOSB (Author: Julius Pfrommer)
  */
 
+/* Enable the declaration of recvmmsg */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+# define _GNU_SOURCE
+#endif
+
 #include <open62541/plugin/log_stdout.h>
 #include <open62541/plugin/pubsub_udp.h>
 #include <open62541/util.h>
 
+/* Receive several datagrams with a single system call where possible. The
+ * declaration might not be visible if the system headers were included before
+ * _GNU_SOURCE was set (e.g. in the amalgamation). Fall back to recvfrom then. */
+#if defined(__linux__) && defined(__USE_GNU) && defined(MSG_WAITFORONE)
+# define UA_PUBSUB_UDP_RECVMMSG
+# define UA_PUBSUB_UDP_RECVMMSG_BATCH 32
+#endif
+
 /* UDP multicast network layer specific internal data */
 typedef struct {
     int ai_family;                    /* Protocol family for socket. IPv4/IPv6 */
@@ -108,6 +121,13 @@ UA_PubSubChannelUDPMC_open(const UA_PubSubConnectionConfig *connectionConfig) {
         return NULL;
     }
 
+    /* Remove the brackets around an IPv6 address */
+    if(hostname.length > 2 && hostname.data[0] == '[' &&
+       hostname.data[hostname.length - 1] == ']') {
+        hostname.data++;
+        hostname.length -= 2;
+    }
+
     UA_STACKARRAY(char, addressAsChar, sizeof(char) * hostname.length +1);
     memcpy(addressAsChar, hostname.data, hostname.length);
     addressAsChar[hostname.length] = 0;
@@ -170,20 +190,19 @@ UA_PubSubChannelUDPMC_open(const UA_PubSubConnectionConfig *connectionConfig) {
         UA_free(newChannel);
         return NULL;
     }
-    memcpy(channelDataUDPMC->ai_addr, rp->ai_addr, sizeof(*rp->ai_addr));
+    memcpy(channelDataUDPMC->ai_addr, rp->ai_addr, rp->ai_addrlen);
     newChannel->handle = channelDataUDPMC; /* Link channel and internal channel data */
 
-    /* Set loop back data to your host */
+    /* Set loop back data to your host. IPv6 only accepts an int. */
+    int enableLoopback = channelDataUDPMC->enableLoopback;
 #if UA_IPV6
     if(UA_setsockopt(newChannel->sockfd,
                      requestResult->ai_family == PF_INET6 ? IPPROTO_IPV6 : IPPROTO_IP,
                      requestResult->ai_family == PF_INET6 ? IPV6_MULTICAST_LOOP : IP_MULTICAST_LOOP,
-                     (const char *)&channelDataUDPMC->enableLoopback,
-                     sizeof (channelDataUDPMC->enableLoopback)) < 0)
+                     (const char *)&enableLoopback, sizeof(enableLoopback)) < 0)
 #else
     if(UA_setsockopt(newChannel->sockfd, IPPROTO_IP, IP_MULTICAST_LOOP,
-                     (const char *)&channelDataUDPMC->enableLoopback,
-                     sizeof (channelDataUDPMC->enableLoopback)) < 0)
+                     (const char *)&enableLoopback, sizeof(enableLoopback)) < 0)
 #endif
     {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
@@ -444,6 +463,24 @@ UA_PubSubChannelUDPMC_send(UA_PubSubChannel *channel, UA_ExtensionObject *transp
     return UA_STATUSCODE_GOOD;
 }
 
+/* Wait in a select call until a message is available or the timeout (in usec)
+ * is reached. A zero timeout only polls the socket. */
+static UA_StatusCode
+UA_PubSubChannelUDPMC_wait(UA_PubSubChannel *channel, UA_UInt32 timeout) {
+    fd_set fdset;
+    FD_ZERO(&fdset);
+    UA_fd_set(channel->sockfd, &fdset);
+    struct timeval tmptv = {(long int)(timeout / 1000000),
+                            (long int)(timeout % 1000000)};
+    int resultsize = UA_select(channel->sockfd+1, &fdset, NULL,
+                               NULL, &tmptv);
+    if(resultsize == 0)
+        return UA_STATUSCODE_GOODNONCRITICALTIMEOUT;
+    if(resultsize == -1)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return UA_STATUSCODE_GOOD;
+}
+
 /**
  * Receive messages. The regist function should be called before.
  *
@@ -458,42 +495,95 @@ UA_PubSubChannelUDPMC_receive(UA_PubSubChannel *channel, UA_ByteString *message,
                      "PubSub Connection receive failed. Invalid state.");
         return UA_STATUSCODE_BADINTERNALERROR;
     }
-    UA_PubSubChannelDataUDPMC *channelConfigUDPMC = (UA_PubSubChannelDataUDPMC *) channel->handle;
 
     if(timeout > 0) {
-        fd_set fdset;
-        FD_ZERO(&fdset);
-        UA_fd_set(channel->sockfd, &fdset);
-        struct timeval tmptv = {(long int)(timeout / 1000000),
-                                (long int)(timeout % 1000000)};
-        int resultsize = UA_select(channel->sockfd+1, &fdset, NULL,
-                                NULL, &tmptv);
-        if(resultsize == 0) {
+        UA_StatusCode res = UA_PubSubChannelUDPMC_wait(channel, timeout);
+        if(res != UA_STATUSCODE_GOOD) {
             message->length = 0;
-            return UA_STATUSCODE_GOODNONCRITICALTIMEOUT;
-        }
-        if (resultsize == -1) {
-            message->length = 0;
-            return UA_STATUSCODE_BADINTERNALERROR;
+            return res;
         }
     }
 
-    if(channelConfigUDPMC->ai_family == PF_INET){
-        ssize_t messageLength;
-        messageLength = UA_recvfrom(channel->sockfd, message->data, message->length, 0, NULL, NULL);
-        if(messageLength > 0){
-            message->length = (size_t) messageLength;
-        } else {
-            message->length = 0;
-        }
-#if UA_IPV6
+    /* The sender address is not taken. So IPv4 and IPv6 are received alike. */
+    ssize_t messageLength;
+    messageLength = UA_recvfrom(channel->sockfd, message->data, message->length, 0, NULL, NULL);
+    if(messageLength > 0){
+        message->length = (size_t) messageLength;
     } else {
-        //TODO implement recieve for IPv6
-#endif
+        message->length = 0;
     }
     return UA_STATUSCODE_GOOD;
 }
 
+/**
+ * Receive all pending messages up to the number of provided buffers. Only the
+ * first message is waited for. The regist function should be called before.
+ *
+ * @param timeout in usec | on windows platforms are only multiples of 1000usec possible
+ * @return
+ */
+static UA_StatusCode
+UA_PubSubChannelUDPMC_receiveMultiple(UA_PubSubChannel *channel, UA_ByteString *messages,
+                                      size_t messagesSize, size_t *received,
+                                      UA_ExtensionObject *transportSettings,
+                                      UA_UInt32 timeout) {
+    *received = 0;
+    if(!(channel->state == UA_PUBSUB_CHANNEL_PUB || channel->state == UA_PUBSUB_CHANNEL_PUB_SUB)) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
+                     "PubSub Connection receive failed. Invalid state.");
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    if(messagesSize == 0)
+        return UA_STATUSCODE_GOOD;
+
+    UA_StatusCode res = UA_PubSubChannelUDPMC_wait(channel, timeout);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    /* The sender address is not taken. So IPv4 and IPv6 are received alike. */
+    size_t total = 0;
+#ifdef UA_PUBSUB_UDP_RECVMMSG
+    /* The socket is readable. Take the pending datagrams in batches without
+     * blocking until the buffers are full or no more data is available. */
+    struct mmsghdr msgs[UA_PUBSUB_UDP_RECVMMSG_BATCH];
+    struct iovec iovs[UA_PUBSUB_UDP_RECVMMSG_BATCH];
+    while(total < messagesSize) {
+        size_t batch = messagesSize - total;
+        if(batch > UA_PUBSUB_UDP_RECVMMSG_BATCH)
+            batch = UA_PUBSUB_UDP_RECVMMSG_BATCH;
+        memset(msgs, 0, sizeof(struct mmsghdr) * batch);
+        for(size_t i = 0; i < batch; i++) {
+            iovs[i].iov_base = messages[total + i].data;
+            iovs[i].iov_len = messages[total + i].length;
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int n = recvmmsg(channel->sockfd, msgs, (unsigned int)batch, MSG_DONTWAIT, NULL);
+        if(n <= 0)
+            break;
+        for(size_t i = 0; i < (size_t)n; i++)
+            messages[total + i].length = msgs[i].msg_len;
+        total += (size_t)n;
+        if((size_t)n < batch)
+            break;
+    }
+#else
+    /* Poll the socket between the reads so that no call blocks */
+    while(total < messagesSize) {
+        if(total > 0 && UA_PubSubChannelUDPMC_wait(channel, 0) != UA_STATUSCODE_GOOD)
+            break;
+        ssize_t messageLength = UA_recvfrom(channel->sockfd, messages[total].data,
+                                            messages[total].length, 0, NULL, NULL);
+        if(messageLength <= 0)
+            break;
+        messages[total].length = (size_t)messageLength;
+        total++;
+    }
+#endif
+    *received = total;
+    return UA_STATUSCODE_GOOD;
+}
+
 /**
  * Close channel and free the channel data.
  *
@@ -529,6 +619,7 @@ TransportLayerUDPMC_addChannel(UA_PubSubConnectionConfig *connectionConfig) {
         pubSubChannel->unregist = UA_PubSubChannelUDPMC_unregist;
         pubSubChannel->send = UA_PubSubChannelUDPMC_send;
         pubSubChannel->receive = UA_PubSubChannelUDPMC_receive;
+        pubSubChannel->receiveMultiple = UA_PubSubChannelUDPMC_receiveMultiple;
         pubSubChannel->close = UA_PubSubChannelUDPMC_close;
         pubSubChannel->connectionConfig = connectionConfig;
     }
@@ -33,6 +33,8 @@ UA_Client_init(UA_Client* client) {
     UA_SecureChannel_init(&client->channel, &client->config.localConnectionConfig);
     client->connectStatus = UA_STATUSCODE_GOOD;
     UA_Timer_init(&client->timer);
+    UA_IdIndex_init(&client->asyncServiceCallsIndex,
+                    offsetof(AsyncServiceCall, requestId));
     notifyClientState(client);
 }
 
@@ -90,6 +92,12 @@ UA_Client_deleteMembers(UA_Client *client) {
     UA_Client_Subscriptions_clean(client);
 #endif
 
+    /* Delete the async service index */
+    UA_IdIndex_clear(&client->asyncServiceCallsIndex);
+    UA_free(client->asyncServiceTimeouts);
+    client->asyncServiceTimeouts = NULL;
+    client->asyncServiceTimeoutsCapacity = 0;
+
     /* Delete the timed work */
     UA_Timer_deleteMembers(&client->timer);
 }
@@ -222,16 +230,118 @@ sendSymmetricServiceRequest(UA_Client *client, const void *request,
 static const UA_NodeId
 serviceFaultId = {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_SERVICEFAULT_ENCODING_DEFAULTBINARY}};
 
-/* Look for the async callback in the linked list, execute and delete it */
+/***********************/
+/* Async Service Index */
+/***********************/
+
+/* The pending async service calls are indexed by their RequestId. The calls
+ * with a timeout are additionally kept in a min-heap ordered by their
+ * deadline. The heap has room for half the index size. */
+
+/* Make room for one more call before the request is sent */
 static UA_StatusCode
-processAsyncResponse(UA_Client *client, UA_UInt32 requestId, const UA_NodeId *responseTypeId,
-                     const UA_ByteString *responseMessage, size_t *offset) {
-    /* Find the callback */
-    AsyncServiceCall *ac;
-    LIST_FOREACH(ac, &client->asyncServiceCalls, pointers) {
-        if(ac->requestId == requestId)
+reserveAsyncServiceCall(UA_Client *client) {
+    UA_StatusCode retval = UA_IdIndex_reserve(&client->asyncServiceCallsIndex, 1);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    /* Grow the heap with the index. It is not shrunk. */
+    size_t capacity = client->asyncServiceCallsIndex.slotsSize / 2;
+    if(capacity <= client->asyncServiceTimeoutsCapacity)
+        return UA_STATUSCODE_GOOD;
+    AsyncServiceCall **timeouts = (AsyncServiceCall**)
+        UA_realloc(client->asyncServiceTimeouts, capacity * sizeof(AsyncServiceCall*));
+    if(!timeouts)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    client->asyncServiceTimeouts = timeouts;
+    client->asyncServiceTimeoutsCapacity = capacity;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+asyncServiceHeapSet(UA_Client *client, size_t index, AsyncServiceCall *ac) {
+    client->asyncServiceTimeouts[index] = ac;
+    ac->timeoutIndex = index;
+}
+
+static void
+asyncServiceHeapUp(UA_Client *client, size_t index) {
+    AsyncServiceCall *ac = client->asyncServiceTimeouts[index];
+    while(index > 0) {
+        size_t parent = (index - 1) / 2;
+        AsyncServiceCall *p = client->asyncServiceTimeouts[parent];
+        if(p->deadline <= ac->deadline)
+            break;
+        asyncServiceHeapSet(client, index, p);
+        index = parent;
+    }
+    asyncServiceHeapSet(client, index, ac);
+}
+
+static void
+asyncServiceHeapDown(UA_Client *client, size_t index) {
+    AsyncServiceCall *ac = client->asyncServiceTimeouts[index];
+    size_t size = client->asyncServiceTimeoutsSize;
+    while(true) {
+        size_t child = (2 * index) + 1;
+        if(child >= size)
+            break;
+        if(child + 1 < size && client->asyncServiceTimeouts[child + 1]->deadline <
+           client->asyncServiceTimeouts[child]->deadline)
+            child++;
+        AsyncServiceCall *c = client->asyncServiceTimeouts[child];
+        if(ac->deadline <= c->deadline)
             break;
+        asyncServiceHeapSet(client, index, c);
+        index = child;
     }
+    asyncServiceHeapSet(client, index, ac);
+}
+
+/* Room for the call has to be reserved before */
+static void
+addAsyncServiceCall(UA_Client *client, AsyncServiceCall *ac) {
+    UA_IdIndex_insert(&client->asyncServiceCallsIndex, ac);
+    LIST_INSERT_HEAD(&client->asyncServiceCalls, ac, pointers);
+
+    if(ac->timeout) {
+        asyncServiceHeapSet(client, client->asyncServiceTimeoutsSize, ac);
+        client->asyncServiceTimeoutsSize++;
+        asyncServiceHeapUp(client, ac->timeoutIndex);
+    }
+}
+
+static AsyncServiceCall *
+findAsyncServiceCall(const UA_Client *client, UA_UInt32 requestId) {
+    return (AsyncServiceCall*)
+        UA_IdIndex_find(&client->asyncServiceCallsIndex, requestId);
+}
+
+static void
+removeAsyncServiceCall(UA_Client *client, AsyncServiceCall *ac) {
+    UA_IdIndex_remove(&client->asyncServiceCallsIndex, ac);
+    LIST_REMOVE(ac, pointers);
+
+    /* Remove from the heap */
+    if(ac->timeout) {
+        size_t pos = ac->timeoutIndex;
+        client->asyncServiceTimeoutsSize--;
+        if(pos < client->asyncServiceTimeoutsSize) {
+            asyncServiceHeapSet(client, pos,
+                                client->asyncServiceTimeouts[client->asyncServiceTimeoutsSize]);
+            asyncServiceHeapUp(client, pos);
+            asyncServiceHeapDown(client, client->asyncServiceTimeouts[pos]->timeoutIndex);
+        }
+    }
+}
+
+/* Look for the async callback in the index, execute and delete it */
+static UA_StatusCode
+processAsyncResponse(UA_Client *client, UA_UInt32 requestId, const UA_NodeId *responseTypeId,
+                     const UA_ByteString *responseMessage, size_t responseMessageSize,
+                     size_t *offset) {
+    /* Find the callback */
+    AsyncServiceCall *ac = findAsyncServiceCall(client, requestId);
 
     /* Part 6, 6.7.6: After the security validation is complete the receiver
      * shall verify the RequestId and the SequenceNumber. If these checks fail a
@@ -242,7 +352,7 @@ processAsyncResponse(UA_Client *client, UA_UInt32 requestId, const UA_NodeId *re
         return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
 
     /* Dequeue ac. We might disconnect (remove all ac) in the callback. */
-    LIST_REMOVE(ac, pointers);
+    removeAsyncServiceCall(client, ac);
 
     /* Verify the type of the response */
     UA_Response response;
@@ -266,8 +376,9 @@ processAsyncResponse(UA_Client *client, UA_UInt32 requestId, const UA_NodeId *re
     }
 
     /* Decode the response */
-    retval = UA_decodeBinary(responseMessage, offset, &response, responseType,
-                             client->config.customDataTypes);
+    retval = UA_decodeBinarySegments(responseMessage, responseMessageSize, offset,
+                                     &response, responseType,
+                                     client->config.customDataTypes);
 
  process:
     if(retval != UA_STATUSCODE_GOOD) {
@@ -298,7 +409,7 @@ processAsyncResponse(UA_Client *client, UA_UInt32 requestId, const UA_NodeId *re
 static void
 processServiceResponse(void *application, UA_SecureChannel *channel,
                        UA_MessageType messageType, UA_UInt32 requestId,
-                       UA_ByteString *message) {
+                       UA_ByteString *message, size_t messageSize) {
     SyncResponseDescription *rd = (SyncResponseDescription*)application;
 
     /* Process ACK response */
@@ -326,14 +437,17 @@ processServiceResponse(void *application, UA_SecureChannel *channel,
     /* Decode the data type identifier of the response */
     size_t offset = 0;
     UA_NodeId responseId;
-    UA_StatusCode retval = UA_NodeId_decodeBinary(message, &offset, &responseId);
+    UA_StatusCode retval =
+        UA_decodeBinarySegments(message, messageSize, &offset, &responseId,
+                                &UA_TYPES[UA_TYPES_NODEID], NULL);
     if(retval != UA_STATUSCODE_GOOD)
         goto finish;
 
     /* Got an asynchronous response. Don't expected a synchronous response
      * (responseType NULL) or the id does not match. */
     if(!rd->responseType || requestId != rd->requestId) {
-        retval = processAsyncResponse(rd->client, requestId, &responseId, message, &offset);
+        retval = processAsyncResponse(rd->client, requestId, &responseId,
+                                      message, messageSize, &offset);
         goto finish;
     }
 
@@ -345,9 +459,10 @@ processServiceResponse(void *application, UA_SecureChannel *channel,
     if(!UA_NodeId_equal(&responseId, &expectedNodeId)) {
         if(UA_NodeId_equal(&responseId, &serviceFaultId)) {
             UA_init(rd->response, rd->responseType);
-            retval = UA_decodeBinary(message, &offset, rd->response,
-                                     &UA_TYPES[UA_TYPES_SERVICEFAULT],
-                                     rd->client->config.customDataTypes);
+            retval = UA_decodeBinarySegments(message, messageSize, &offset,
+                                             rd->response,
+                                             &UA_TYPES[UA_TYPES_SERVICEFAULT],
+                                             rd->client->config.customDataTypes);
             if(retval != UA_STATUSCODE_GOOD)
                 ((UA_ResponseHeader*)rd->response)->serviceResult = retval;
             UA_LOG_INFO(&rd->client->config.logger, UA_LOGCATEGORY_CLIENT,
@@ -371,8 +486,9 @@ processServiceResponse(void *application, UA_SecureChannel *channel,
 #endif
 
     /* Decode the response */
-    retval = UA_decodeBinary(message, &offset, rd->response, rd->responseType,
-                             rd->client->config.customDataTypes);
+    retval = UA_decodeBinarySegments(message, messageSize, &offset, rd->response,
+                                     rd->responseType,
+                                     rd->client->config.customDataTypes);
 
 finish:
     UA_NodeId_deleteMembers(&responseId);
@@ -493,7 +609,7 @@ UA_Client_AsyncService_cancel(UA_Client *client, AsyncServiceCall *ac,
 void UA_Client_AsyncService_removeAll(UA_Client *client, UA_StatusCode statusCode) {
     AsyncServiceCall *ac, *ac_tmp;
     LIST_FOREACH_SAFE(ac, &client->asyncServiceCalls, pointers, ac_tmp) {
-        LIST_REMOVE(ac, pointers);
+        removeAsyncServiceCall(client, ac);
         UA_Client_AsyncService_cancel(client, ac, statusCode);
         UA_free(ac);
     }
@@ -521,8 +637,15 @@ __UA_Client_AsyncServiceEx(UA_Client *client, const void *request,
     ac->userdata = userdata;
     ac->timeout = timeout;
 
+    /* Make room in the index before the request goes out */
+    UA_StatusCode retval = reserveAsyncServiceCall(client);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_free(ac);
+        return retval;
+    }
+
     /* Call the service and set the requestId */
-    UA_StatusCode retval = sendSymmetricServiceRequest(client, request, requestType, &ac->requestId);
+    retval = sendSymmetricServiceRequest(client, request, requestType, &ac->requestId);
     if(retval != UA_STATUSCODE_GOOD) {
         UA_free(ac);
         closeSecureChannel(client);
@@ -531,9 +654,10 @@ __UA_Client_AsyncServiceEx(UA_Client *client, const void *request,
     }
 
     ac->start = UA_DateTime_nowMonotonic();
+    ac->deadline = ac->start + (UA_DateTime)(ac->timeout * UA_DATETIME_MSEC);
 
     /* Store the entry for async processing */
-    LIST_INSERT_HEAD(&client->asyncServiceCalls, ac, pointers);
+    addAsyncServiceCall(client, ac);
     if(requestId)
         *requestId = ac->requestId;
 
@@ -586,18 +710,17 @@ UA_Client_removeCallback(UA_Client *client, UA_UInt64 callbackId) {
     UA_Timer_removeCallback(&client->timer, callbackId);
 }
 
+/* Only the expired calls at the top of the heap are touched */
 static void
 asyncServiceTimeoutCheck(UA_Client *client) {
-    AsyncServiceCall *ac, *ac_tmp;
     UA_DateTime now = UA_DateTime_nowMonotonic();
-    LIST_FOREACH_SAFE(ac, &client->asyncServiceCalls, pointers, ac_tmp) {
-        if(!ac->timeout)
-           continue;
-        if(ac->start + (UA_DateTime)(ac->timeout * UA_DATETIME_MSEC) <= now) {
-            LIST_REMOVE(ac, pointers);
-            UA_Client_AsyncService_cancel(client, ac, UA_STATUSCODE_BADTIMEOUT);
-            UA_free(ac);
-        }
+    while(client->asyncServiceTimeoutsSize > 0) {
+        AsyncServiceCall *ac = client->asyncServiceTimeouts[0];
+        if(ac->deadline > now)
+            break;
+        removeAsyncServiceCall(client, ac);
+        UA_Client_AsyncService_cancel(client, ac, UA_STATUSCODE_BADTIMEOUT);
+        UA_free(ac);
     }
 }
 
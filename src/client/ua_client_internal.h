@@ -56,9 +56,13 @@ typedef struct UA_Client_Subscription {
     UA_UInt32 maxKeepAliveCount;
     UA_Client_StatusChangeNotificationCallback statusChangeCallback;
     UA_Client_DeleteSubscriptionCallback deleteCallback;
+    UA_Client_DataChangeBatchNotificationCallback dataChangeBatchCallback;
+    void **batchContexts; /* Reused for the contexts passed to the batch callback */
+    size_t batchContextsSize;
     UA_UInt32 sequenceNumber;
     UA_DateTime lastActivity;
     LIST_HEAD(, UA_Client_MonitoredItem) monitoredItems;
+    UA_IdIndex monitoredItemsIndex; /* Hash index by clientHandle */
 } UA_Client_Subscription;
 
 void
@@ -88,6 +92,8 @@ typedef struct AsyncServiceCall {
     void *userdata;
     UA_DateTime start;
     UA_UInt32 timeout;
+    UA_DateTime deadline; /* start + timeout */
+    size_t timeoutIndex;  /* Position in the asyncServiceTimeouts heap */
     void *responsedata;
 } AsyncServiceCall;
 
@@ -145,6 +151,10 @@ struct UA_Client {
 
     /* Async Service */
     LIST_HEAD(, AsyncServiceCall) asyncServiceCalls;
+    UA_IdIndex asyncServiceCallsIndex;       /* Hash index by requestId */
+    AsyncServiceCall **asyncServiceTimeouts; /* Min-heap ordered by deadline */
+    size_t asyncServiceTimeoutsSize;
+    size_t asyncServiceTimeoutsCapacity;
     LIST_HEAD(, CustomCallback) customCallbacks;
 
     /* Subscriptions */
@@ -43,7 +43,12 @@ __Subscriptions_create_handler(UA_Client *client, void *data, UA_UInt32 requestI
     newSub->lastActivity = UA_DateTime_nowMonotonic();
     newSub->publishingInterval = response->revisedPublishingInterval;
     newSub->maxKeepAliveCount = response->revisedMaxKeepAliveCount;
+    newSub->dataChangeBatchCallback = NULL;
+    newSub->batchContexts = NULL;
+    newSub->batchContextsSize = 0;
     LIST_INIT(&newSub->monitoredItems);
+    UA_IdIndex_init(&newSub->monitoredItemsIndex,
+                    offsetof(UA_Client_MonitoredItem, clientHandle));
     LIST_INSERT_HEAD(&client->subscriptions, newSub, listEntry);
 
 cleanup:
@@ -211,6 +216,8 @@ UA_Client_Subscription_deleteInternal(UA_Client *client, UA_Client_Subscription
 
     /* Remove */
     LIST_REMOVE(sub, listEntry);
+    UA_IdIndex_clear(&sub->monitoredItemsIndex);
+    UA_free(sub->batchContexts);
     UA_free(sub);
 }
 
@@ -388,15 +395,41 @@ UA_Client_Subscriptions_deleteSingle(UA_Client *client, UA_UInt32 subscriptionId
     return retval;
 }
 
+UA_StatusCode
+UA_Client_Subscriptions_setDataChangeBatchCallback(UA_Client *client, UA_UInt32 subscriptionId,
+                                                   UA_Client_DataChangeBatchNotificationCallback callback) {
+    UA_Client_Subscription *sub = findSubscription(client, subscriptionId);
+    if(!sub)
+        return UA_STATUSCODE_BADSUBSCRIPTIONIDINVALID;
+    sub->dataChangeBatchCallback = callback;
+    return UA_STATUSCODE_GOOD;
+}
+
 /******************/
 /* MonitoredItems */
 /******************/
 
+static UA_Client_MonitoredItem *
+findMonitoredItemByClientHandle(const UA_Client_Subscription *sub, UA_UInt32 clientHandle) {
+    return (UA_Client_MonitoredItem*)
+        UA_IdIndex_find(&sub->monitoredItemsIndex, clientHandle);
+}
+
+/* Room for the MonitoredItem has to be reserved before */
+static void
+addMonitoredItem(UA_Client_Subscription *sub, UA_Client_MonitoredItem *mon) {
+    UA_IdIndex_insert(&sub->monitoredItemsIndex, mon);
+    LIST_INSERT_HEAD(&sub->monitoredItems, mon, listEntry);
+}
+
 static void
 UA_Client_MonitoredItem_remove(UA_Client *client, UA_Client_Subscription *sub,
                                UA_Client_MonitoredItem *mon) {
+    UA_IdIndex_remove(&sub->monitoredItemsIndex, mon);
+
     // NOLINTNEXTLINE
     LIST_REMOVE(mon, listEntry);
+
     if(mon->deleteCallback)
         mon->deleteCallback(client, sub->subscriptionId, sub->context,
                             mon->monitoredItemId, mon->context);
@@ -433,6 +466,41 @@ MonitoredItems_CreateData_deleteItems(UA_Client_MonitoredItem **mis,
     }
 }
 
+/* The server has created MonitoredItems that cannot be added locally. Delete
+ * them on the server so that they do not leak there. The results of the items
+ * are set to the local error. */
+static void
+MonitoredItems_deleteCreated(UA_Client *client, UA_Client_Subscription *sub,
+                             UA_CreateMonitoredItemsResponse *response,
+                             UA_StatusCode res) {
+    UA_STACKARRAY(UA_UInt32, ids, response->resultsSize);
+    size_t idsSize = 0;
+    for(size_t i = 0; i < response->resultsSize; i++) {
+        if(response->results[i].statusCode != UA_STATUSCODE_GOOD)
+            continue;
+        ids[idsSize++] = response->results[i].monitoredItemId;
+        response->results[i].statusCode = res;
+    }
+    if(idsSize == 0)
+        return;
+
+    UA_DeleteMonitoredItemsRequest request;
+    UA_DeleteMonitoredItemsRequest_init(&request);
+    request.subscriptionId = sub->subscriptionId;
+    request.monitoredItemIds = ids;
+    request.monitoredItemIdsSize = idsSize;
+    UA_StatusCode retval =
+        __UA_Client_AsyncService(client, &request,
+                                 &UA_TYPES[UA_TYPES_DELETEMONITOREDITEMSREQUEST], NULL,
+                                 &UA_TYPES[UA_TYPES_DELETEMONITOREDITEMSRESPONSE],
+                                 NULL, NULL);
+    if(retval != UA_STATUSCODE_GOOD)
+        UA_LOG_WARNING(&client->config.logger, UA_LOGCATEGORY_CLIENT,
+                       "Subscription %" PRIu32 " | Could not delete %lu MonitoredItems "
+                       "on the server that were not added locally",
+                       sub->subscriptionId, (unsigned long)idsSize);
+}
+
 static void
 __MonitoredItems_create_handler(UA_Client *client, CustomCallback *cc, UA_UInt32 requestId,
                                 UA_CreateMonitoredItemsResponse *response) {
@@ -455,6 +523,14 @@ __MonitoredItems_create_handler(UA_Client *client, CustomCallback *cc, UA_UInt32
         return;
     }
 
+    /* Make room in the clientHandle index. Usually the room was reserved
+     * before the request was sent. If that is no longer enough and the index
+     * cannot grow, the created MonitoredItems are removed again. */
+    UA_StatusCode res =
+        UA_IdIndex_reserve(&sub->monitoredItemsIndex, request->itemsToCreateSize);
+    if(res != UA_STATUSCODE_GOOD)
+        MonitoredItems_deleteCreated(client, sub, response, res);
+
     /* Add internally */
     for(size_t i = 0; i < request->itemsToCreateSize; i++) {
         if(response->results[i].statusCode != UA_STATUSCODE_GOOD) {
@@ -475,7 +551,7 @@ __MonitoredItems_create_handler(UA_Client *client, CustomCallback *cc, UA_UInt32
             (UA_Client_DataChangeNotificationCallback)(uintptr_t)handlingCallbacks[i];
         newMon->isEventMonitoredItem =
             (request->itemsToCreate[i].itemToMonitor.attributeId == UA_ATTRIBUTEID_EVENTNOTIFIER);
-        LIST_INSERT_HEAD(&sub->monitoredItems, newMon, listEntry);
+        addMonitoredItem(sub, newMon);
 
         UA_LOG_DEBUG(&client->config.logger, UA_LOGCATEGORY_CLIENT,
                     "Subscription %" PRIu32 " | Added a MonitoredItem with handle %" PRIu32,
@@ -513,6 +589,13 @@ MonitoredItems_CreateData_prepare(UA_Client_MonitoredItem **mis,
             return UA_STATUSCODE_BADOUTOFMEMORY;
     }
 
+    /* Make room in the clientHandle index before the request goes out */
+    UA_StatusCode retval =
+        UA_IdIndex_reserve(&data->sub->monitoredItemsIndex,
+                           data->request->itemsToCreateSize);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
     /* Set the clientHandle */
     for(size_t i = 0; i < data->request->itemsToCreateSize; i++)
         data->request->itemsToCreate[i].requestedParameters.clientHandle =
@@ -964,18 +1047,47 @@ UA_Client_Subscriptions_nextSequenceNumber(UA_UInt32 sequenceNumber) {
     return nextSequenceNumber;
 }
 
+/* Resolve the MonitoredItem contexts and call the batch callback once */
+static void
+processDataChangeNotificationBatch(UA_Client *client, UA_Client_Subscription *sub,
+                                   UA_DataChangeNotification *dataChangeNotification) {
+    size_t size = dataChangeNotification->monitoredItemsSize;
+    if(size > sub->batchContextsSize) {
+        void **contexts = (void**)UA_realloc(sub->batchContexts, size * sizeof(void*));
+        if(!contexts) {
+            UA_LOG_WARNING(&client->config.logger, UA_LOGCATEGORY_CLIENT,
+                           "Subscription %" PRIu32 " | Dropped a DataChangeNotification "
+                           "since the memory for the batch callback could not be "
+                           "allocated", sub->subscriptionId);
+            return;
+        }
+        sub->batchContexts = contexts;
+        sub->batchContextsSize = size;
+    }
+
+    for(size_t j = 0; j < size; ++j) {
+        UA_Client_MonitoredItem *mon = findMonitoredItemByClientHandle(sub,
+            dataChangeNotification->monitoredItems[j].clientHandle);
+        sub->batchContexts[j] = (mon && !mon->isEventMonitoredItem) ? mon->context : NULL;
+    }
+
+    sub->dataChangeBatchCallback(client, sub->subscriptionId, sub->context,
+                                 dataChangeNotification, sub->batchContexts);
+}
+
 static void
 processDataChangeNotification(UA_Client *client, UA_Client_Subscription *sub,
                               UA_DataChangeNotification *dataChangeNotification) {
+    if(sub->dataChangeBatchCallback) {
+        processDataChangeNotificationBatch(client, sub, dataChangeNotification);
+        return;
+    }
+
     for(size_t j = 0; j < dataChangeNotification->monitoredItemsSize; ++j) {
         UA_MonitoredItemNotification *min = &dataChangeNotification->monitoredItems[j];
 
         /* Find the MonitoredItem */
-        UA_Client_MonitoredItem *mon;
-        LIST_FOREACH(mon, &sub->monitoredItems, listEntry) {
-            if(mon->clientHandle == min->clientHandle)
-                break;
-        }
+        UA_Client_MonitoredItem *mon = findMonitoredItemByClientHandle(sub, min->clientHandle);
 
         if(!mon) {
             UA_LOG_DEBUG(&client->config.logger, UA_LOGCATEGORY_CLIENT,
@@ -1004,11 +1116,8 @@ processEventNotification(UA_Client *client, UA_Client_Subscription *sub,
         UA_EventFieldList *eventFieldList = &eventNotificationList->events[j];
 
         /* Find the MonitoredItem */
-        UA_Client_MonitoredItem *mon;
-        LIST_FOREACH(mon, &sub->monitoredItems, listEntry) {
-            if(mon->clientHandle == eventFieldList->clientHandle)
-                break;
-        }
+        UA_Client_MonitoredItem *mon =
+            findMonitoredItemByClientHandle(sub, eventFieldList->clientHandle);
 
         if(!mon) {
             UA_LOG_DEBUG(&client->config.logger, UA_LOGCATEGORY_CLIENT,
@@ -20,6 +20,17 @@ _UA_BEGIN_DECLS
 
 #ifdef UA_ENABLE_PUBSUB /* conditional compilation */
 
+/* Scratch memory for the publish cycle of a WriterGroup. The arena is reset
+ * at the start of every cycle. Allocations that do not fit are served from
+ * the heap, and the arena grows to the high-water mark on the next reset. So
+ * once the message layout is stable, publishing does not call malloc. */
+typedef struct {
+    UA_Byte *data;
+    size_t size;
+    size_t used;
+    size_t required; /* Bytes requested in the current cycle */
+} UA_PubSubArena;
+
 /* forward declarations */
 struct UA_WriterGroup;
 typedef struct UA_WriterGroup UA_WriterGroup;
@@ -69,6 +80,11 @@ typedef struct UA_PubSubConnection{
     UA_UInt16 configurationFreezeCounter;
     /* This flag is 'read only' and is set internally based on the PubSub state. */
     UA_Boolean configurationFrozen;
+    /* Index of the DataSetReaders of all ReaderGroups by (PublisherId,
+     * WriterGroupId, DataSetWriterId) to dispatch received DataSetMessages.
+     * Open addressing with linear probing. The size is a power of two. */
+    struct UA_DataSetReader **readerIndex;
+    size_t readerIndexSize;
 } UA_PubSubConnection;
 
 UA_StatusCode
@@ -139,6 +155,9 @@ struct UA_WriterGroup{
     UA_UInt16 sequenceNumber; /* Increased after every succressuly sent message */
     /* This flag is 'read only' and is set internally based on the PubSub state. */
     UA_Boolean configurationFrozen;
+    /* Reused across the publish cycles of the non-RT levels */
+    UA_PubSubArena arena;
+    UA_ByteString sendBuffer;
 };
 
 UA_StatusCode
@@ -228,6 +247,9 @@ struct UA_ReaderGroup {
     UA_PubSubState state;
     /* This flag is 'read only' and is set internally based on the PubSub state. */
     UA_Boolean configurationFrozen;
+    /* Preallocated buffers that the subscribe callback receives into. Allocated
+     * on the first callback execution. */
+    UA_ByteString *receiveBuffers;
 };
 
 /* Copy configuration of ReaderGroup */
@@ -238,6 +260,11 @@ UA_ReaderGroupConfig_copy(const UA_ReaderGroupConfig *src, UA_ReaderGroupConfig
 UA_StatusCode
 UA_Server_processNetworkMessage(UA_Server *server, UA_NetworkMessage* pMsg, UA_PubSubConnection *pConnection);
 
+/* Rebuild the DataSetReader index of the connection. Called when readers are
+ * added, removed, reconfigured or frozen. */
+UA_StatusCode
+UA_PubSubConnection_updateReaderIndex(UA_PubSubConnection *connection);
+
 /* Prototypes for internal util functions - some functions maybe removed later
  *(currently moved from public to internal)*/
 UA_ReaderGroup *UA_ReaderGroup_findRGbyId(UA_Server *server, UA_NodeId identifier);
@@ -52,8 +52,226 @@ static UA_Boolean UA_NetworkMessage_ExtendedFlags1Enabled(const UA_NetworkMessag
 static UA_Boolean UA_NetworkMessage_ExtendedFlags2Enabled(const UA_NetworkMessage* src);
 static UA_Boolean UA_DataSetMessageHeader_DataSetFlags2Enabled(const UA_DataSetMessageHeader* src);
 
+static void
+freeCopyOps(UA_NetworkMessageCopyOp *ops, size_t opsSize) {
+    /* The storage of decoded values belongs to the copy program */
+    for(size_t i = 0; i < opsSize; i++) {
+        if(ops[i].target)
+            UA_free(ops[i].data);
+    }
+    UA_free(ops);
+}
+
+void
+UA_NetworkMessage_clearCopyProgram(UA_NetworkMessageOffsetBuffer *buffer) {
+    freeCopyOps(buffer->copyOps, buffer->copyOpsSize);
+    buffer->copyOps = NULL;
+    buffer->copyOpsSize = 0;
+    buffer->copyLength = 0;
+}
+
+/* Append a copy step for a scalar. Only possible if the binary encoding of the
+ * type is identical to the memory layout. */
+static UA_Boolean
+addCopyOp(UA_NetworkMessageCopyOp *ops, size_t *opsSize, size_t offset,
+          void *data, const UA_DataType *type) {
+    if(!data || !type || !type->overlayable)
+        return false;
+    UA_NetworkMessageCopyOp *op = &ops[*opsSize];
+    memset(op, 0, sizeof(UA_NetworkMessageCopyOp));
+    op->offset = offset;
+    op->data = data;
+    op->length = type->memSize;
+    (*opsSize)++;
+    return true;
+}
+
+/* The builtin type used for the binary encoding of a scalar in a Variant.
+ * Enumerations are encoded as Int32. Returns NULL for all other non-builtin
+ * types. They are wrapped in an ExtensionObject and cannot be copied. */
+static const UA_DataType *
+variantEncodingType(const UA_DataType *type) {
+    if(!type)
+        return NULL;
+    if(type->typeKind <= UA_DATATYPEKIND_DIAGNOSTICINFO)
+        return &UA_TYPES[type->typeKind];
+    if(type->typeKind == UA_DATATYPEKIND_ENUM)
+        return &UA_TYPES[UA_TYPES_INT32];
+    return NULL;
+}
+
+UA_StatusCode
+UA_NetworkMessage_compileBufferedMessage(UA_NetworkMessageOffsetBuffer *buffer) {
+    UA_NetworkMessage_clearCopyProgram(buffer);
+    if(buffer->offsetsSize == 0)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+
+    UA_NetworkMessageCopyOp *ops = (UA_NetworkMessageCopyOp*)
+        UA_calloc(buffer->offsetsSize, sizeof(UA_NetworkMessageCopyOp));
+    if(!ops)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    size_t opsSize = 0;
+    for(size_t i = 0; i < buffer->offsetsSize; i++) {
+        UA_NetworkMessageOffset *o = &buffer->offsets[i];
+        UA_DataValue *v = o->offsetData.value.value;
+        UA_Boolean compiled = false;
+        switch(o->contentType) {
+        case UA_PUBSUB_OFFSETTYPE_DATASETMESSAGE_SEQUENCENUMBER:
+        case UA_PUBSUB_OFFSETTYPE_NETWORKMESSAGE_SEQUENCENUMBER:
+            compiled = (v && v->value.type == &UA_TYPES[UA_TYPES_UINT16] &&
+                        addCopyOp(ops, &opsSize, o->offset, v->value.data, v->value.type));
+            break;
+        case UA_PUBSUB_OFFSETTYPE_PAYLOAD_DATAVALUE:
+            /* Skip the encoding masks of the DataValue and the Variant. They
+             * don't change as long as only the value is set. */
+            compiled = (v && v->hasValue && !v->hasStatus &&
+                        !v->hasSourceTimestamp && !v->hasServerTimestamp &&
+                        !v->hasSourcePicoseconds && !v->hasServerPicoseconds &&
+                        UA_Variant_isScalar(&v->value) &&
+                        addCopyOp(ops, &opsSize, o->offset + 2, v->value.data,
+                                  variantEncodingType(v->value.type)));
+            break;
+        case UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT:
+            /* Skip the encoding mask of the Variant */
+            compiled = (v && UA_Variant_isScalar(&v->value) &&
+                        addCopyOp(ops, &opsSize, o->offset + 1, v->value.data,
+                                  variantEncodingType(v->value.type)));
+            break;
+        default:
+            break;
+        }
+        if(!compiled ||
+           ops[opsSize-1].offset + ops[opsSize-1].length > buffer->buffer.length) {
+            freeCopyOps(ops, opsSize);
+            return UA_STATUSCODE_BADNOTSUPPORTED;
+        }
+    }
+
+    buffer->copyOps = ops;
+    buffer->copyOpsSize = opsSize;
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_NetworkMessage_compileBufferedNwMessage(UA_NetworkMessageOffsetBuffer *buffer) {
+    UA_NetworkMessage_clearCopyProgram(buffer);
+    UA_NetworkMessage *nm = buffer->nm;
+    if(!nm || buffer->offsetsSize == 0)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+
+    UA_NetworkMessageCopyOp *ops = (UA_NetworkMessageCopyOp*)
+        UA_calloc(buffer->offsetsSize, sizeof(UA_NetworkMessageCopyOp));
+    if(!ops)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    size_t opsSize = 0;
+    size_t copyLength = 0;
+    size_t payloadCounter = 0;
+    UA_DataSetMessage *dsm = nm->payload.dataSetPayload.dataSetMessages; /* Considering one DSM in RT */
+    for(size_t i = 0; i < buffer->offsetsSize; i++) {
+        UA_NetworkMessageOffset *o = &buffer->offsets[i];
+        UA_Boolean compiled = false;
+        switch(o->contentType) {
+        case UA_PUBSUB_OFFSETTYPE_PUBLISHERID:
+            switch(nm->publisherIdType) {
+            case UA_PUBLISHERDATATYPE_BYTE:
+                compiled = addCopyOp(ops, &opsSize, o->offset, &nm->publisherId.publisherIdByte,
+                                     &UA_TYPES[UA_TYPES_BYTE]);
+                break;
+            case UA_PUBLISHERDATATYPE_UINT16:
+                compiled = addCopyOp(ops, &opsSize, o->offset, &nm->publisherId.publisherIdUInt16,
+                                     &UA_TYPES[UA_TYPES_UINT16]);
+                break;
+            case UA_PUBLISHERDATATYPE_UINT32:
+                compiled = addCopyOp(ops, &opsSize, o->offset, &nm->publisherId.publisherIdUInt32,
+                                     &UA_TYPES[UA_TYPES_UINT32]);
+                break;
+            case UA_PUBLISHERDATATYPE_UINT64:
+                compiled = addCopyOp(ops, &opsSize, o->offset, &nm->publisherId.publisherIdUInt64,
+                                     &UA_TYPES[UA_TYPES_UINT64]);
+                break;
+            default:
+                break;
+            }
+            break;
+        case UA_PUBSUB_OFFSETTYPE_WRITERGROUPID:
+            compiled = addCopyOp(ops, &opsSize, o->offset, &nm->groupHeader.writerGroupId,
+                                 &UA_TYPES[UA_TYPES_UINT16]);
+            break;
+        case UA_PUBSUB_OFFSETTYPE_DATASETWRITERID:
+            compiled = addCopyOp(ops, &opsSize, o->offset,
+                                 nm->payloadHeader.dataSetPayloadHeader.dataSetWriterIds,
+                                 &UA_TYPES[UA_TYPES_UINT16]);
+            break;
+        case UA_PUBSUB_OFFSETTYPE_NETWORKMESSAGE_SEQUENCENUMBER:
+            compiled = addCopyOp(ops, &opsSize, o->offset, &nm->groupHeader.sequenceNumber,
+                                 &UA_TYPES[UA_TYPES_UINT16]);
+            break;
+        case UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT: {
+            if(!dsm || payloadCounter >= dsm->data.keyFrameData.fieldCount)
+                break;
+            UA_DataValue *field = &dsm->data.keyFrameData.dataSetFields[payloadCounter];
+            /* Decode with the type from the encoding byte. The generic
+             * decoding also returns an enumeration as Int32. */
+            const UA_DataType *type = variantEncodingType(field->value.type);
+            if(!type || !type->overlayable || !UA_Variant_isScalar(&field->value))
+                break;
+            /* Decode into storage of the copy program. The field is bound to
+             * it once the entire program has been compiled. */
+            void *storage = UA_malloc(type->memSize);
+            if(!storage)
+                break;
+            memcpy(storage, field->value.data, type->memSize);
+            compiled = addCopyOp(ops, &opsSize, o->offset + 1, storage, type);
+            if(!compiled) {
+                UA_free(storage);
+                break;
+            }
+            ops[opsSize-1].target = field;
+            ops[opsSize-1].type = type;
+            payloadCounter++;
+            break;
+        }
+        default:
+            break;
+        }
+        if(!compiled) {
+            freeCopyOps(ops, opsSize);
+            return UA_STATUSCODE_BADNOTSUPPORTED;
+        }
+        if(ops[opsSize-1].offset + ops[opsSize-1].length > copyLength)
+            copyLength = ops[opsSize-1].offset + ops[opsSize-1].length;
+    }
+
+    /* Point the fields to the storage of the copy program without taking
+     * ownership. The sampled value of the field is still owned by the
+     * DataValue of the offset. */
+    for(size_t i = 0; i < opsSize; i++) {
+        if(!ops[i].target)
+            continue;
+        UA_Variant_setScalar(&ops[i].target->value, ops[i].data, ops[i].type);
+        ops[i].target->value.storageType = UA_VARIANT_DATA_NODELETE;
+    }
+
+    buffer->copyOps = ops;
+    buffer->copyOpsSize = opsSize;
+    buffer->copyLength = copyLength;
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_StatusCode
 UA_NetworkMessage_updateBufferedMessage(UA_NetworkMessageOffsetBuffer *buffer){
+    /* Run the precompiled copy program */
+    if(buffer->copyOps) {
+        UA_Byte *data = buffer->buffer.data;
+        for(size_t i = 0; i < buffer->copyOpsSize; i++) {
+            const UA_NetworkMessageCopyOp *op = &buffer->copyOps[i];
+            memcpy(&data[op->offset], op->data, op->length);
+        }
+        return UA_STATUSCODE_GOOD;
+    }
+
     UA_StatusCode rv = UA_STATUSCODE_GOOD;
     for (size_t i = 0; i < buffer->offsetsSize; ++i) {
         const UA_Byte *bufEnd = &buffer->buffer.data[buffer->buffer.length];
@@ -81,6 +299,25 @@ UA_NetworkMessage_updateBufferedMessage(UA_NetworkMessageOffsetBuffer *buffer){
 UA_StatusCode
 UA_NetworkMessage_updateBufferedNwMessage(UA_NetworkMessageOffsetBuffer *buffer,
                                           const UA_ByteString *src){
+    /* Run the precompiled copy program */
+    if(buffer->copyOps) {
+        if(src->length < buffer->copyLength)
+            return UA_STATUSCODE_BADDECODINGERROR;
+        for(size_t i = 0; i < buffer->copyOpsSize; i++) {
+            UA_NetworkMessageCopyOp *op = &buffer->copyOps[i];
+            if(op->target) {
+                /* The Variant must contain a scalar of the expected type */
+                if(src->data[op->offset - 1] != (UA_Byte)(op->type->typeKind + 1))
+                    return UA_STATUSCODE_BADDECODINGERROR;
+                UA_Variant_setScalar(&op->target->value, op->data, op->type);
+                op->target->value.storageType = UA_VARIANT_DATA_NODELETE;
+                op->target->hasValue = true;
+            }
+            memcpy(op->data, &src->data[op->offset], op->length);
+        }
+        return UA_STATUSCODE_GOOD;
+    }
+
     UA_StatusCode rv = UA_STATUSCODE_GOOD;
     size_t payloadCounter = 0;
     UA_DataSetMessage* dsm = buffer->nm->payload.dataSetPayload.dataSetMessages; // Considering one DSM in RT TODO: Clarify multiple DSM
@@ -1447,13 +1684,22 @@ UA_DataSetMessage_calcSizeBinary(UA_DataSetMessage* p, UA_NetworkMessageOffsetBu
         } else if(p->header.fieldEncoding == UA_FIELDENCODING_DATAVALUE) {
             for (UA_UInt16 i = 0; i < p->data.keyFrameData.fieldCount; i++) {
                 if (offsetBuffer) {
+                    /* Every offset gets its own DataValue. The field array of
+                     * the DataSetMessage does not outlive the offsets. The
+                     * value is shared with the field (static value source). */
+                    UA_DataValue *dv = UA_DataValue_new();
+                    if(!dv)
+                        return 0;
                     size_t pos = offsetBuffer->offsetsSize;
-                    if(!increaseOffsetArray(offsetBuffer))
+                    if(!increaseOffsetArray(offsetBuffer)) {
+                        UA_free(dv);
                         return 0;
+                    }
+                    *dv = p->data.keyFrameData.dataSetFields[i];
+                    dv->value.storageType = UA_VARIANT_DATA_NODELETE;
                     offsetBuffer->offsets[pos].offset = size;
                     offsetBuffer->offsets[pos].contentType = UA_PUBSUB_OFFSETTYPE_PAYLOAD_DATAVALUE;
-                    //TODO check value source, change implementation to 'variant'
-                    offsetBuffer->offsets[pos].offsetData.value.value = p->data.keyFrameData.dataSetFields;
+                    offsetBuffer->offsets[pos].offsetData.value.value = dv;
                 }
                 size += UA_calcSizeBinary(&p->data.keyFrameData.dataSetFields[i], &UA_TYPES[UA_TYPES_DATAVALUE]);
             }
@@ -212,12 +212,30 @@ typedef struct {
     size_t offset;
 } UA_NetworkMessageOffset;
 
+/* Step of the precompiled copy program for a frozen message layout. The value
+ * at the offset is copied between the message buffer and the memory location
+ * with a single memcpy. Only used for scalars with a binary encoding identical
+ * to the memory layout (overlayable types). */
+typedef struct {
+    size_t offset;      /* Position of the value in the message buffer */
+    void *data;         /* Memory location of the value */
+    size_t length;      /* Binary size of the value */
+    UA_DataValue *target; /* Decoding: DataValue that points to the decoded value */
+    const UA_DataType *type; /* Decoding: Expected type of the Variant */
+} UA_NetworkMessageCopyOp;
+
 typedef struct {
     UA_ByteString buffer; /* The precomputed message buffer */
     UA_NetworkMessageOffset *offsets; /* Offsets for changes in the message buffer */
     size_t offsetsSize;
     UA_Boolean RTsubscriberEnabled; /* Addtional offsets computation like publisherId, WGId if this bool enabled */
     UA_NetworkMessage *nm; /* The precomputed NetworkMessage for subscriber */
+    /* Copy program that replaces the offsets if all of them could be
+     * compiled. Otherwise NULL and the offsets are processed with the generic
+     * encoding. */
+    UA_NetworkMessageCopyOp *copyOps;
+    size_t copyOpsSize;
+    size_t copyLength; /* Decoding: Minimum length of a received message */
 } UA_NetworkMessageOffsetBuffer;
 
 /**
@@ -260,6 +278,20 @@ UA_StatusCode
 UA_NetworkMessage_updateBufferedNwMessage(UA_NetworkMessageOffsetBuffer *buffer,
                                           const UA_ByteString *src);
 
+/* Compile the offsets of a frozen layout into a copy program for
+ * UA_NetworkMessage_updateBufferedMessage (encoding) or
+ * UA_NetworkMessage_updateBufferedNwMessage (decoding). Returns
+ * UA_STATUSCODE_BADNOTSUPPORTED if an offset cannot be copied directly. The
+ * generic processing is used then. */
+UA_StatusCode
+UA_NetworkMessage_compileBufferedMessage(UA_NetworkMessageOffsetBuffer *buffer);
+
+UA_StatusCode
+UA_NetworkMessage_compileBufferedNwMessage(UA_NetworkMessageOffsetBuffer *buffer);
+
+void
+UA_NetworkMessage_clearCopyProgram(UA_NetworkMessageOffsetBuffer *buffer);
+
 UA_StatusCode
 UA_NetworkMessage_encodeBinary(const UA_NetworkMessage* src,
                                UA_Byte **bufPos, const UA_Byte *bufEnd);
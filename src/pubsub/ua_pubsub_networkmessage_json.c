@@ -434,7 +434,7 @@ static status NetworkMessage_decodeJsonInternal(UA_NetworkMessage *dst, CtxJson
     status found = lookAheadForKey(UA_DECODEKEY_PUBLISHERID, ctx,
                                    parseCtx, &searchResultPublishIdType);
     if(found == UA_STATUSCODE_GOOD) {
-        jsmntok_t publishIdToken = parseCtx->tokenArray[searchResultPublishIdType];
+        JsonToken publishIdToken = parseCtx->tokenArray[searchResultPublishIdType];
         if(publishIdToken.type == JSMN_PRIMITIVE) {
             publishIdTypeIndex = UA_TYPES_UINT64;
             dst->publisherIdType = UA_PUBLISHERDATATYPE_UINT64; //store in biggest possible
@@ -452,7 +452,7 @@ static status NetworkMessage_decodeJsonInternal(UA_NetworkMessage *dst, CtxJson
     found = lookAheadForKey(UA_DECODEKEY_MESSAGES, ctx, parseCtx, &searchResultMessages);
     if(found != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADNOTIMPLEMENTED;
-    jsmntok_t bodyToken = parseCtx->tokenArray[searchResultMessages];
+    JsonToken bodyToken = parseCtx->tokenArray[searchResultMessages];
     if(bodyToken.type != JSMN_ARRAY)
         return UA_STATUSCODE_BADNOTIMPLEMENTED;
     messageCount = (size_t)parseCtx->tokenArray[searchResultMessages].size;
@@ -524,13 +524,10 @@ status UA_NetworkMessage_decodeJson(UA_NetworkMessage *dst, const UA_ByteString
     memset(&ctx, 0, sizeof(CtxJson));
     ParseCtx parseCtx;
     memset(&parseCtx, 0, sizeof(ParseCtx));
-    parseCtx.tokenArray = (jsmntok_t*)UA_malloc(sizeof(jsmntok_t) * UA_JSON_MAXTOKENCOUNT);
-    memset(parseCtx.tokenArray, 0, sizeof(jsmntok_t) * UA_JSON_MAXTOKENCOUNT);
-    status ret = tokenize(&parseCtx, &ctx, src);
-    if(ret != UA_STATUSCODE_GOOD){
-        return ret;
-    }
-    ret = NetworkMessage_decodeJsonInternal(dst, &ctx, &parseCtx);
-    UA_free(parseCtx.tokenArray);
+    JsonTokenizer tokenizer;
+    status ret = tokenize(&parseCtx, &ctx, &tokenizer, src);
+    if(ret == UA_STATUSCODE_GOOD)
+        ret = NetworkMessage_decodeJsonInternal(dst, &ctx, &parseCtx);
+    JsonTokenizer_clear(&tokenizer);
     return ret;
 }
@@ -23,6 +23,9 @@
 #endif
 
 #define UA_MAX_SIZENAME 64  /* Max size of Qualified Name of Subscribed Variable */
+#define UA_PUBSUB_RECEIVEBUFFERSIZE 512 /* Size of a receive buffer */
+#define UA_PUBSUB_RECEIVEBUFFERS 16 /* Number of messages received at once */
+#define UA_PUBSUB_MAXRECEIVEBATCHES 64 /* Max number of batches per callback */
 
 /* Clear ReaderGroup */
 static void
@@ -340,6 +343,9 @@ UA_Server_removeReaderGroup(UA_Server *server, UA_NodeId groupIdentifier) {
     /* Remove readerGroup from Connection */
     LIST_REMOVE(readerGroup, listEntry);
     UA_free(readerGroup);
+
+    /* Update the dispatch index of the connection */
+    UA_PubSubConnection_updateReaderIndex(connection);
     return UA_STATUSCODE_GOOD;
 }
 
@@ -382,6 +388,11 @@ UA_Server_ReaderGroup_clear(UA_Server* server, UA_ReaderGroup *readerGroup) {
         pConn->readerGroupsSize--;
 
     /* Delete ReaderGroup and its members */
+    if(readerGroup->receiveBuffers) {
+        UA_Array_delete(readerGroup->receiveBuffers, UA_PUBSUB_RECEIVEBUFFERS,
+                        &UA_TYPES[UA_TYPES_BYTESTRING]);
+        readerGroup->receiveBuffers = NULL;
+    }
     UA_String_deleteMembers(&readerGroup->config.name);
     UA_NodeId_deleteMembers(&readerGroup->linkedConnection);
     UA_NodeId_deleteMembers(&readerGroup->identifier);
@@ -505,6 +516,10 @@ UA_Server_freezeReaderGroupConfiguration(UA_Server *server, const UA_NodeId read
          */
     }
 
+    /* The readers of the connection can no longer change. Update the dispatch
+     * index. */
+    UA_PubSubConnection_updateReaderIndex(pubSubConnection);
+
     if(rg->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE) {
         if(dsrCount > 1) {
             UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
@@ -581,11 +596,18 @@ UA_Server_freezeReaderGroupConfiguration(UA_Server *server, const UA_NodeId read
             return UA_STATUSCODE_BADINTERNALERROR;
         }
 
+        UA_NetworkMessage_clearCopyProgram(&dataSetReader->bufferedMessage);
         memset(&dataSetReader->bufferedMessage, 0, sizeof(UA_NetworkMessageOffsetBuffer));
         dataSetReader->bufferedMessage.RTsubscriberEnabled = UA_TRUE;
         /* Fix the offsets necessary to decode */
         UA_NetworkMessage_calcSizeBinary(networkMessage, &dataSetReader->bufferedMessage);
         dataSetReader->bufferedMessage.nm = networkMessage;
+
+        /* Compile the offsets into a copy program. Fall back to the generic
+         * decoding if the layout contains values that cannot be copied. */
+        if(UA_NetworkMessage_compileBufferedNwMessage(&dataSetReader->bufferedMessage) != UA_STATUSCODE_GOOD)
+            UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                         "PubSub-RT: Fixed message layout is decoded field by field");
     }
 
     return UA_STATUSCODE_GOOD;
@@ -613,9 +635,11 @@ UA_Server_unfreezeReaderGroupConfiguration(UA_Server *server, const UA_NodeId re
 
     if(rg->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE) {
         dataSetReader = LIST_FIRST(&rg->readers);
+        UA_NetworkMessage_clearCopyProgram(&dataSetReader->bufferedMessage);
         if(dataSetReader->bufferedMessage.offsetsSize > 0){
             for (size_t i = 0; i < dataSetReader->bufferedMessage.offsetsSize; i++) {
-                if(dataSetReader->bufferedMessage.offsets[i].contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT){
+                if(dataSetReader->bufferedMessage.offsets[i].contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT ||
+                   dataSetReader->bufferedMessage.offsets[i].contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_DATAVALUE){
                     UA_DataValue_delete(dataSetReader->bufferedMessage.offsets[i].offsetData.value.value);
                 }
             }
@@ -650,92 +674,144 @@ UA_Server_setReaderGroupDisabled(UA_Server *server, const UA_NodeId readerGroupI
     return UA_ReaderGroup_setPubSubState(server, UA_PUBSUBSTATE_DISABLED, rg);
 }
 
-static UA_StatusCode
-checkReaderIdentifier(UA_Server *server, UA_NetworkMessage *pMsg, UA_DataSetReader *reader) {
-    if(!pMsg->groupHeaderEnabled &&
-       !pMsg->groupHeader.writerGroupIdEnabled &&
-       !pMsg->payloadHeaderEnabled) {
-        UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER,
-                    "Cannot process DataSetReader without WriterGroup"
-                    "and DataSetWriter identifiers");
-        return UA_STATUSCODE_BADNOTIMPLEMENTED;
+/* Get the PublisherId of a NetworkMessage as a pointer to the value and the
+ * matching datatype */
+static const UA_DataType *
+getPublisherId(const UA_NetworkMessage *pMsg, const void **publisherId) {
+    switch(pMsg->publisherIdType) {
+    case UA_PUBLISHERDATATYPE_BYTE:
+        *publisherId = &pMsg->publisherId.publisherIdByte;
+        return &UA_TYPES[UA_TYPES_BYTE];
+    case UA_PUBLISHERDATATYPE_UINT16:
+        *publisherId = &pMsg->publisherId.publisherIdUInt16;
+        return &UA_TYPES[UA_TYPES_UINT16];
+    case UA_PUBLISHERDATATYPE_UINT32:
+        *publisherId = &pMsg->publisherId.publisherIdUInt32;
+        return &UA_TYPES[UA_TYPES_UINT32];
+    case UA_PUBLISHERDATATYPE_UINT64:
+        *publisherId = &pMsg->publisherId.publisherIdUInt64;
+        return &UA_TYPES[UA_TYPES_UINT64];
+    case UA_PUBLISHERDATATYPE_STRING:
+        *publisherId = &pMsg->publisherId.publisherIdString;
+        return &UA_TYPES[UA_TYPES_STRING];
+    default:
+        return NULL;
     }
+}
+
+/* Only readers with a scalar PublisherId of a type that can appear in a
+ * NetworkMessage can receive messages */
+static UA_Boolean
+isReaderIndexable(const UA_DataSetReader *reader) {
+    const UA_Variant *publisherId = &reader->config.publisherId;
+    if(!publisherId->data || !UA_Variant_isScalar(publisherId))
+        return false;
+    return (publisherId->type == &UA_TYPES[UA_TYPES_BYTE] ||
+            publisherId->type == &UA_TYPES[UA_TYPES_UINT16] ||
+            publisherId->type == &UA_TYPES[UA_TYPES_UINT32] ||
+            publisherId->type == &UA_TYPES[UA_TYPES_UINT64] ||
+            publisherId->type == &UA_TYPES[UA_TYPES_STRING]);
+}
 
-    if((reader->config.writerGroupId == pMsg->groupHeader.writerGroupId) &&
-       (reader->config.dataSetWriterId == *pMsg->payloadHeader.dataSetPayloadHeader.dataSetWriterIds)) {
-        UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_SERVER,
-                     "DataSetReader found. Process NetworkMessage");
-        return UA_STATUSCODE_GOOD;
+static UA_UInt32
+readerIndexHash(const UA_DataType *publisherIdType, const void *publisherId,
+                UA_UInt16 writerGroupId, UA_UInt16 dataSetWriterId) {
+    UA_UInt32 hash;
+    if(publisherIdType == &UA_TYPES[UA_TYPES_STRING]) {
+        const UA_String *s = (const UA_String*)publisherId;
+        hash = UA_ByteString_hash(0, s->data, s->length);
+    } else {
+        hash = UA_ByteString_hash(0, (const UA_Byte*)publisherId, publisherIdType->memSize);
     }
+    UA_UInt16 ids[2] = {writerGroupId, dataSetWriterId};
+    return UA_ByteString_hash(hash, (const UA_Byte*)ids, sizeof(ids));
+}
 
-    return UA_STATUSCODE_BADNOTFOUND;
+static UA_Boolean
+readerMatches(const UA_DataSetReader *reader, const UA_DataType *publisherIdType,
+              const void *publisherId, UA_UInt16 writerGroupId,
+              UA_UInt16 dataSetWriterId) {
+    if(reader->config.writerGroupId != writerGroupId ||
+       reader->config.dataSetWriterId != dataSetWriterId ||
+       reader->config.publisherId.type != publisherIdType)
+        return false;
+    if(publisherIdType == &UA_TYPES[UA_TYPES_STRING])
+        return UA_String_equal((const UA_String*)publisherId,
+                               (const UA_String*)reader->config.publisherId.data);
+    return (memcmp(publisherId, reader->config.publisherId.data,
+                   publisherIdType->memSize) == 0);
 }
 
-static UA_StatusCode
-getReaderFromIdentifier(UA_Server *server, UA_NetworkMessage *pMsg,
-                        UA_DataSetReader **dataSetReader, UA_PubSubConnection *pConnection) {
-    UA_StatusCode retval = UA_STATUSCODE_BADNOTFOUND;
-    if(!pMsg->publisherIdEnabled) {
-        UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER,
-                    "Cannot process DataSetReader without PublisherId");
-        return UA_STATUSCODE_BADNOTIMPLEMENTED; /* TODO: Handle DSR without PublisherId */
+UA_StatusCode
+UA_PubSubConnection_updateReaderIndex(UA_PubSubConnection *connection) {
+    /* Count the readers */
+    size_t count = 0;
+    UA_ReaderGroup *readerGroup;
+    UA_DataSetReader *reader;
+    LIST_FOREACH(readerGroup, &connection->readerGroups, listEntry) {
+        LIST_FOREACH(reader, &readerGroup->readers, listEntry) {
+            if(isReaderIndexable(reader))
+                count++;
+        }
     }
 
-    UA_ReaderGroup* readerGroup;
-    LIST_FOREACH(readerGroup, &pConnection->readerGroups, listEntry) {
-        UA_DataSetReader *tmpReader;
-        LIST_FOREACH(tmpReader, &readerGroup->readers, listEntry) {
-            switch (pMsg->publisherIdType) {
-            case UA_PUBLISHERDATATYPE_BYTE:
-                if(tmpReader->config.publisherId.type == &UA_TYPES[UA_TYPES_BYTE] &&
-                   pMsg->publisherIdType == UA_PUBLISHERDATATYPE_BYTE &&
-                   pMsg->publisherId.publisherIdByte == *(UA_Byte*)tmpReader->config.publisherId.data) {
-                    retval = checkReaderIdentifier(server, pMsg, tmpReader);
-                }
-                break;
-            case UA_PUBLISHERDATATYPE_UINT16:
-                if(tmpReader->config.publisherId.type == &UA_TYPES[UA_TYPES_UINT16] &&
-                   pMsg->publisherIdType == UA_PUBLISHERDATATYPE_UINT16 &&
-                   pMsg->publisherId.publisherIdUInt16 == *(UA_UInt16*) tmpReader->config.publisherId.data) {
-                    retval = checkReaderIdentifier(server, pMsg, tmpReader);
-                }
-                break;
-            case UA_PUBLISHERDATATYPE_UINT32:
-                if(tmpReader->config.publisherId.type == &UA_TYPES[UA_TYPES_UINT32] &&
-                   pMsg->publisherIdType == UA_PUBLISHERDATATYPE_UINT32 &&
-                   pMsg->publisherId.publisherIdUInt32 == *(UA_UInt32*)tmpReader->config.publisherId.data) {
-                    retval = checkReaderIdentifier(server, pMsg, tmpReader);
-                }
-                break;
-            case UA_PUBLISHERDATATYPE_UINT64:
-                if(tmpReader->config.publisherId.type == &UA_TYPES[UA_TYPES_UINT64] &&
-                   pMsg->publisherIdType == UA_PUBLISHERDATATYPE_UINT64 &&
-                   pMsg->publisherId.publisherIdUInt64 == *(UA_UInt64*)tmpReader->config.publisherId.data) {
-                    retval = checkReaderIdentifier(server, pMsg, tmpReader);
-                }
-                break;
-            case UA_PUBLISHERDATATYPE_STRING:
-                if(tmpReader->config.publisherId.type == &UA_TYPES[UA_TYPES_STRING] &&
-                   pMsg->publisherIdType == UA_PUBLISHERDATATYPE_STRING &&
-                   UA_String_equal(&pMsg->publisherId.publisherIdString,
-                                   (UA_String*)tmpReader->config.publisherId.data)) {
-                    retval = checkReaderIdentifier(server, pMsg, tmpReader);
-                }
-                break;
-            default:
-                return UA_STATUSCODE_BADINTERNALERROR;
-            }
+    /* Keep the index at most half full */
+    UA_DataSetReader **index = NULL;
+    size_t indexSize = 0;
+    if(count > 0) {
+        indexSize = 16;
+        while(indexSize < count * 2)
+            indexSize <<= 1;
+        index = (UA_DataSetReader**)UA_calloc(indexSize, sizeof(UA_DataSetReader*));
+        if(!index) {
+            /* The old index can point to removed readers. Don't keep it. */
+            UA_free(connection->readerIndex);
+            connection->readerIndex = NULL;
+            connection->readerIndexSize = 0;
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+    }
 
-            if(retval == UA_STATUSCODE_GOOD) {
-                *dataSetReader = tmpReader;
-                return UA_STATUSCODE_GOOD;
-            }
+    /* Insert in the list order. If several readers have the same identifiers,
+     * the first one in the list is found first. */
+    size_t mask = indexSize - 1;
+    LIST_FOREACH(readerGroup, &connection->readerGroups, listEntry) {
+        LIST_FOREACH(reader, &readerGroup->readers, listEntry) {
+            if(!isReaderIndexable(reader))
+                continue;
+            size_t i = readerIndexHash(reader->config.publisherId.type,
+                                       reader->config.publisherId.data,
+                                       reader->config.writerGroupId,
+                                       reader->config.dataSetWriterId) & mask;
+            while(index[i])
+                i = (i + 1) & mask;
+            index[i] = reader;
         }
     }
 
-    UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER,
-                "Dataset reader not found. Check PublisherID, WriterGroupID and DatasetWriterID");
-    return UA_STATUSCODE_BADNOTFOUND;
+    UA_free(connection->readerIndex);
+    connection->readerIndex = index;
+    connection->readerIndexSize = indexSize;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_DataSetReader *
+findReaderInIndex(UA_PubSubConnection *connection, const UA_DataType *publisherIdType,
+                  const void *publisherId, UA_UInt16 writerGroupId,
+                  UA_UInt16 dataSetWriterId) {
+    if(!connection->readerIndex)
+        return NULL;
+    size_t mask = connection->readerIndexSize - 1;
+    size_t i = readerIndexHash(publisherIdType, publisherId,
+                               writerGroupId, dataSetWriterId) & mask;
+    for(UA_DataSetReader *reader = connection->readerIndex[i]; reader;
+        reader = connection->readerIndex[i]) {
+        if(readerMatches(reader, publisherIdType, publisherId,
+                         writerGroupId, dataSetWriterId))
+            return reader;
+        i = (i + 1) & mask;
+    }
+    return NULL;
 }
 
 UA_ReaderGroup *
@@ -768,74 +844,121 @@ UA_DataSetReader *UA_ReaderGroup_findDSRbyId(UA_Server *server, UA_NodeId identi
     return NULL;
 }
 
+/* Decode and dispatch a single received NetworkMessage */
+static void
+UA_ReaderGroup_processMessage(UA_Server *server, UA_ReaderGroup *readerGroup,
+                              UA_PubSubConnection *connection, UA_ByteString *buffer) {
+    if(readerGroup->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE) {
+        /* Considering max DSM as 1
+         * TODO:
+         * Process with the static value source
+         */
+        UA_DataSetReader *dataSetReader = LIST_FIRST(&readerGroup->readers);
+        /* Decode only the necessary offset and update the networkMessage */
+        if(UA_NetworkMessage_updateBufferedNwMessage(&dataSetReader->bufferedMessage, buffer) != UA_STATUSCODE_GOOD) {
+            UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                         "PubSub receive. Unknown field type.");
+            return;
+        }
+
+        /* Check the decoded message is the expected one
+         * TODO: PublisherID check after modification in NM to support all datatypes
+         *  */
+        if((dataSetReader->bufferedMessage.nm->groupHeader.writerGroupId != dataSetReader->config.writerGroupId) ||
+           (*dataSetReader->bufferedMessage.nm->payloadHeader.dataSetPayloadHeader.dataSetWriterIds != dataSetReader->config.dataSetWriterId)) {
+            UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                         "PubSub receive. Unknown message received. Will not be processed.");
+            return;
+        }
+
+        UA_Server_DataSetReader_process(server, dataSetReader,
+                                        dataSetReader->bufferedMessage.nm->payload.dataSetPayload.dataSetMessages);
+
+        /* Delete the payload value of every dsf's decoded */
+        UA_DataSetMessage *dsm = dataSetReader->bufferedMessage.nm->payload.dataSetPayload.dataSetMessages;
+        if(dsm->header.fieldEncoding == UA_FIELDENCODING_VARIANT) {
+            for(UA_UInt16 i = 0; i < dsm->data.keyFrameData.fieldCount; i++) {
+                UA_Variant_deleteMembers(&dsm->data.keyFrameData.dataSetFields[i].value);
+            }
+        }
+        else if(dsm->header.fieldEncoding == UA_FIELDENCODING_DATAVALUE) {
+            for(UA_UInt16 i = 0; i < dsm->data.keyFrameData.fieldCount; i++) {
+                UA_DataValue_deleteMembers(&dsm->data.keyFrameData.dataSetFields[i]);
+            }
+        }
+        return;
+    }
+
+    UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_USERLAND, "Message received:");
+    UA_NetworkMessage currentNetworkMessage;
+    memset(&currentNetworkMessage, 0, sizeof(UA_NetworkMessage));
+    size_t currentPosition = 0;
+    UA_NetworkMessage_decodeBinary(buffer, &currentPosition, &currentNetworkMessage);
+    UA_Server_processNetworkMessage(server, &currentNetworkMessage, connection);
+    UA_NetworkMessage_deleteMembers(&currentNetworkMessage);
+}
+
 /* This callback triggers the collection and reception of NetworkMessages and the
- * contained DataSetMessages. */
+ * contained DataSetMessages. All messages that are pending on the channel are
+ * received into the preallocated buffers and processed in one execution. */
 void UA_ReaderGroup_subscribeCallback(UA_Server *server, UA_ReaderGroup *readerGroup) {
     UA_PubSubConnection *connection =
         UA_PubSubConnection_findConnectionbyId(server, readerGroup->linkedConnection);
-    UA_ByteString buffer;
-    if(UA_ByteString_allocBuffer(&buffer, 512) != UA_STATUSCODE_GOOD) {
-        UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER, "Message buffer alloc failed!");
+    if(!connection || !connection->channel)
         return;
-    }
-
-    connection->channel->receive(connection->channel, &buffer, NULL, 1000);
-    if(buffer.length > 0) {
-        if (readerGroup->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE) {
-            /* Considering max DSM as 1
-             * TODO:
-             * Process with the static value source
-             */
-            UA_DataSetReader *dataSetReader = LIST_FIRST(&readerGroup->readers);
-            /* Decode only the necessary offset and update the networkMessage */
-            if(UA_NetworkMessage_updateBufferedNwMessage(&dataSetReader->bufferedMessage, &buffer) != UA_STATUSCODE_GOOD) {
-                UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER,
-                             "PubSub receive. Unknown field type.");
-                UA_ByteString_deleteMembers(&buffer);
-                return;
-            }
 
-            /* Check the decoded message is the expected one
-             * TODO: PublisherID check after modification in NM to support all datatypes
-             *  */
-            if((dataSetReader->bufferedMessage.nm->groupHeader.writerGroupId != dataSetReader->config.writerGroupId) ||
-               (*dataSetReader->bufferedMessage.nm->payloadHeader.dataSetPayloadHeader.dataSetWriterIds != dataSetReader->config.dataSetWriterId)) {
+    /* Allocate the receive buffers on the first execution */
+    if(!readerGroup->receiveBuffers) {
+        UA_ByteString *buffers = (UA_ByteString*)
+            UA_Array_new(UA_PUBSUB_RECEIVEBUFFERS, &UA_TYPES[UA_TYPES_BYTESTRING]);
+        if(!buffers) {
+            UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER, "Message buffer alloc failed!");
+            return;
+        }
+        for(size_t i = 0; i < UA_PUBSUB_RECEIVEBUFFERS; i++) {
+            if(UA_ByteString_allocBuffer(&buffers[i], UA_PUBSUB_RECEIVEBUFFERSIZE) !=
+               UA_STATUSCODE_GOOD) {
                 UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER,
-                             "PubSub receive. Unknown message received. Will not be processed.");
-                UA_ByteString_deleteMembers(&buffer);
+                            "Message buffer alloc failed!");
+                UA_Array_delete(buffers, UA_PUBSUB_RECEIVEBUFFERS,
+                                &UA_TYPES[UA_TYPES_BYTESTRING]);
                 return;
             }
+        }
+        readerGroup->receiveBuffers = buffers;
+    }
 
-            UA_Server_DataSetReader_process(server, dataSetReader,
-                                            dataSetReader->bufferedMessage.nm->payload.dataSetPayload.dataSetMessages);
+    UA_PubSubChannel *channel = connection->channel;
+    UA_ByteString *buffers = readerGroup->receiveBuffers;
 
-            /* Delete the payload value of every dsf's decoded */
-            UA_DataSetMessage *dsm = dataSetReader->bufferedMessage.nm->payload.dataSetPayload.dataSetMessages;
-            if(dsm->header.fieldEncoding == UA_FIELDENCODING_VARIANT) {
-                for(UA_UInt16 i = 0; i < dsm->data.keyFrameData.fieldCount; i++) {
-                    UA_Variant_deleteMembers(&dsm->data.keyFrameData.dataSetFields[i].value);
-                }
-            }
-            else if(dsm->header.fieldEncoding == UA_FIELDENCODING_DATAVALUE) {
-                for(UA_UInt16 i = 0; i < dsm->data.keyFrameData.fieldCount; i++) {
-                    UA_DataValue_deleteMembers(&dsm->data.keyFrameData.dataSetFields[i]);
-                }
-            }
+    /* Channel without batch receive. Take one message per execution. */
+    if(!channel->receiveMultiple) {
+        buffers[0].length = UA_PUBSUB_RECEIVEBUFFERSIZE;
+        channel->receive(channel, &buffers[0], NULL, 1000);
+        if(buffers[0].length > 0)
+            UA_ReaderGroup_processMessage(server, readerGroup, connection, &buffers[0]);
+        return;
+    }
 
-            UA_ByteString_deleteMembers(&buffer);
+    /* Wait for the first message. Then drain the channel until no more
+     * messages are pending or the maximum number of batches is reached. */
+    UA_UInt32 timeout = 1000;
+    for(size_t batch = 0; batch < UA_PUBSUB_MAXRECEIVEBATCHES; batch++) {
+        for(size_t i = 0; i < UA_PUBSUB_RECEIVEBUFFERS; i++)
+            buffers[i].length = UA_PUBSUB_RECEIVEBUFFERSIZE;
+        size_t received = 0;
+        UA_StatusCode res = channel->receiveMultiple(channel, buffers, UA_PUBSUB_RECEIVEBUFFERS,
+                                                     &received, NULL, timeout);
+        if(res != UA_STATUSCODE_GOOD)
             return;
+        for(size_t i = 0; i < received; i++) {
+            if(buffers[i].length > 0)
+                UA_ReaderGroup_processMessage(server, readerGroup, connection, &buffers[i]);
         }
-
-        UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_USERLAND, "Message received:");
-        UA_NetworkMessage currentNetworkMessage;
-        memset(&currentNetworkMessage, 0, sizeof(UA_NetworkMessage));
-        size_t currentPosition = 0;
-        UA_NetworkMessage_decodeBinary(&buffer, &currentPosition, &currentNetworkMessage);
-        UA_Server_processNetworkMessage(server, &currentNetworkMessage, connection);
-        UA_NetworkMessage_deleteMembers(&currentNetworkMessage);
+        if(received < UA_PUBSUB_RECEIVEBUFFERS)
+            return;
+        timeout = 0;
     }
-
-    UA_ByteString_deleteMembers(&buffer);
 }
 
 /* Add new subscribeCallback. The first execution is triggered directly after
@@ -891,6 +1014,12 @@ UA_Server_addDataSetReader(UA_Server *server, UA_NodeId readerGroupIdentifier,
     LIST_INSERT_HEAD(&readerGroup->readers, newDataSetReader, listEntry);
     readerGroup->readersCount++;
 
+    /* Update the dispatch index of the connection */
+    UA_PubSubConnection *connection =
+        UA_PubSubConnection_findConnectionbyId(server, readerGroup->linkedConnection);
+    if(connection)
+        UA_PubSubConnection_updateReaderIndex(connection);
+
 #ifdef UA_ENABLE_PUBSUB_INFORMATIONMODEL
     addDataSetReaderRepresentation(server, newDataSetReader);
 #endif
@@ -915,7 +1044,17 @@ UA_Server_removeDataSetReader(UA_Server *server, UA_NodeId readerIdentifier) {
     removeDataSetReaderRepresentation(server, dataSetReader);
 #endif
 
+    UA_PubSubConnection *connection = NULL;
+    UA_ReaderGroup *readerGroup =
+        UA_ReaderGroup_findRGbyId(server, dataSetReader->linkedReaderGroup);
+    if(readerGroup)
+        connection = UA_PubSubConnection_findConnectionbyId(server, readerGroup->linkedConnection);
+
     UA_DataSetReader_clear(server, dataSetReader);
+
+    /* Update the dispatch index of the connection */
+    if(connection)
+        UA_PubSubConnection_updateReaderIndex(connection);
     return UA_STATUSCODE_GOOD;
 }
 
@@ -948,6 +1087,10 @@ UA_Server_DataSetReader_updateConfig(UA_Server *server, UA_NodeId dataSetReaderI
     if(currentDataSetReader->config.writerGroupId != config->writerGroupId) {
        UA_PubSubManager_removeRepeatedPubSubCallback(server, currentReaderGroup->subscribeCallbackId);
        currentDataSetReader->config.writerGroupId = config->writerGroupId;
+       UA_PubSubConnection *connection =
+           UA_PubSubConnection_findConnectionbyId(server, currentReaderGroup->linkedConnection);
+       if(connection)
+           UA_PubSubConnection_updateReaderIndex(connection);
        UA_ReaderGroup_subscribeCallback(server, currentReaderGroup);
     }
     else {
@@ -1309,33 +1452,82 @@ UA_DataSetReader_clear(UA_Server *server, UA_DataSetReader *dataSetReader) {
     UA_free(dataSetReader);
 }
 
+/* Without a WriterGroupId in the message, the readers are matched by the
+ * PublisherId and the DataSetWriterId only */
+static UA_DataSetReader *
+findReaderWithoutWriterGroupId(UA_PubSubConnection *connection,
+                               const UA_DataType *publisherIdType,
+                               const void *publisherId, UA_UInt16 dataSetWriterId) {
+    UA_ReaderGroup *readerGroup;
+    UA_DataSetReader *reader;
+    LIST_FOREACH(readerGroup, &connection->readerGroups, listEntry) {
+        LIST_FOREACH(reader, &readerGroup->readers, listEntry) {
+            if(isReaderIndexable(reader) &&
+               readerMatches(reader, publisherIdType, publisherId,
+                             reader->config.writerGroupId, dataSetWriterId))
+                return reader;
+        }
+    }
+    return NULL;
+}
+
 UA_StatusCode
 UA_Server_processNetworkMessage(UA_Server *server, UA_NetworkMessage *pMsg,
                                 UA_PubSubConnection *pConnection) {
-    UA_StatusCode retval = UA_STATUSCODE_GOOD;
     if(!pMsg || !pConnection)
         return UA_STATUSCODE_BADINVALIDARGUMENT;
 
-    /* To Do Handle multiple DataSetMessage for one NetworkMessage */
     /* To Do The condition pMsg->dataSetClassIdEnabled
      * Here some filtering is possible */
 
-    UA_DataSetReader *dataSetReader;
-    retval = getReaderFromIdentifier(server, pMsg, &dataSetReader, pConnection);
-    if(retval != UA_STATUSCODE_GOOD) {
-        return retval;
+    if(!pMsg->publisherIdEnabled) {
+        UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                    "Cannot process DataSetReader without PublisherId");
+        return UA_STATUSCODE_BADNOTIMPLEMENTED; /* TODO: Handle DSR without PublisherId */
     }
 
-    UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_SERVER,
-                 "DataSetReader found with PublisherId");
+    if(!pMsg->payloadHeaderEnabled ||
+       !pMsg->payloadHeader.dataSetPayloadHeader.dataSetWriterIds) {
+        UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                    "Cannot process DataSetReader without DataSetWriter identifiers");
+        return UA_STATUSCODE_BADNOTIMPLEMENTED;
+    }
 
-    UA_Byte anzDataSets = 1;
-    if(pMsg->payloadHeaderEnabled)
-        anzDataSets = pMsg->payloadHeader.dataSetPayloadHeader.count;
+    const void *publisherId = NULL;
+    const UA_DataType *publisherIdType = getPublisherId(pMsg, &publisherId);
+    if(!publisherIdType)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    /* Dispatch every DataSetMessage to the reader of its DataSetWriter. The
+     * index is keyed by the WriterGroupId and can only be used if the message
+     * contains one. */
+    UA_Boolean hasWriterGroupId =
+        pMsg->groupHeaderEnabled && pMsg->groupHeader.writerGroupIdEnabled;
+    size_t processed = 0;
+    UA_Byte anzDataSets = pMsg->payloadHeader.dataSetPayloadHeader.count;
     for(UA_Byte iterator = 0; iterator < anzDataSets; iterator++) {
+        UA_UInt16 dataSetWriterId =
+            pMsg->payloadHeader.dataSetPayloadHeader.dataSetWriterIds[iterator];
+        UA_DataSetReader *dataSetReader = hasWriterGroupId ?
+            findReaderInIndex(pConnection, publisherIdType, publisherId,
+                              pMsg->groupHeader.writerGroupId, dataSetWriterId) :
+            findReaderWithoutWriterGroupId(pConnection, publisherIdType,
+                                           publisherId, dataSetWriterId);
+        if(!dataSetReader) {
+            UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                         "No DataSetReader for DataSetWriterId %" PRIu16, dataSetWriterId);
+            continue;
+        }
         UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_SERVER, "Process Msg with DataSetReader!");
         UA_Server_DataSetReader_process(server, dataSetReader,
                                         &pMsg->payload.dataSetPayload.dataSetMessages[iterator]);
+        processed++;
+    }
+
+    if(processed == 0) {
+        UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                    "Dataset reader not found. Check PublisherID, WriterGroupID and DatasetWriterID");
+        return UA_STATUSCODE_BADNOTFOUND;
     }
 
     /* To Do Handle when dataSetReader parameters are null for publisherId
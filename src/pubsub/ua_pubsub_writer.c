@@ -23,7 +23,7 @@
 #include "ua_types_encoding_binary.h"
 #endif
 
-#define UA_MAX_STACKBUF 512 /* Max size of network messages on the stack */
+#define UA_PUBSUB_ARENA_ALIGN 16 /* Alignment of the blocks taken from the arena */
 
 /* Forward declaration */
 static void
@@ -38,7 +38,61 @@ generateNetworkMessage(UA_PubSubConnection *connection, UA_WriterGroup *wg,
                        UA_NetworkMessage *networkMessage);
 static UA_StatusCode
 UA_DataSetWriter_generateDataSetMessage(UA_Server *server, UA_DataSetMessage *dataSetMessage,
-                                        UA_DataSetWriter *dataSetWriter);
+                                        UA_DataSetWriter *dataSetWriter,
+                                        UA_PubSubArena *arena);
+
+/**********************************************/
+/*               Arena                        */
+/**********************************************/
+
+static void *
+UA_PubSubArena_alloc(UA_PubSubArena *arena, size_t size) {
+    size = (size + UA_PUBSUB_ARENA_ALIGN - 1) & ~(size_t)(UA_PUBSUB_ARENA_ALIGN - 1);
+    arena->required += size;
+    if(arena->used + size > arena->size)
+        return UA_malloc(size); /* Grow on the next reset */
+    void *mem = &arena->data[arena->used];
+    arena->used += size;
+    return mem;
+}
+
+static UA_Boolean
+UA_PubSubArena_contains(const UA_PubSubArena *arena, const void *ptr) {
+    return ((const UA_Byte*)ptr >= arena->data &&
+            (const UA_Byte*)ptr < &arena->data[arena->size]);
+}
+
+/* Free memory from UA_PubSubArena_alloc. Only the overflow allocations from
+ * the heap are actually freed. */
+static void
+UA_PubSubArena_release(UA_PubSubArena *arena, void *ptr) {
+    if(ptr && ptr != UA_EMPTY_ARRAY_SENTINEL && !UA_PubSubArena_contains(arena, ptr))
+        UA_free(ptr);
+}
+
+/* Prepare for the next cycle. All memory taken from the arena must have been
+ * released before. */
+static void
+UA_PubSubArena_reset(UA_PubSubArena *arena) {
+    if(arena->required > arena->size) {
+        /* Leave some headroom for layouts of varying size */
+        size_t newSize = arena->required + (arena->required / 2);
+        UA_Byte *newData = (UA_Byte*)UA_malloc(newSize);
+        if(newData) {
+            UA_free(arena->data);
+            arena->data = newData;
+            arena->size = newSize;
+        }
+    }
+    arena->used = 0;
+    arena->required = 0;
+}
+
+static void
+UA_PubSubArena_clear(UA_PubSubArena *arena) {
+    UA_free(arena->data);
+    memset(arena, 0, sizeof(UA_PubSubArena));
+}
 
 /**********************************************/
 /*               Connection                   */
@@ -120,6 +174,9 @@ UA_PubSubConnection_clear(UA_Server *server, UA_PubSubConnection *connection) {
     UA_ReaderGroup *readerGroups, *tmpReaderGroup;
     LIST_FOREACH_SAFE(readerGroups, &connection->readerGroups, listEntry, tmpReaderGroup)
         UA_Server_removeReaderGroup(server, readerGroups->identifier);
+    UA_free(connection->readerIndex);
+    connection->readerIndex = NULL;
+    connection->readerIndexSize = 0;
 
     UA_NodeId_clear(&connection->identifier);
     if(connection->channel)
@@ -282,6 +339,7 @@ UA_Server_freezeWriterGroupConfiguration(UA_Server *server, const UA_NodeId writ
         /* Generate data set messages  */
         UA_STACKARRAY(UA_UInt16, dsWriterIds, wg->writersCount);
         UA_STACKARRAY(UA_DataSetMessage, dsmStore, wg->writersCount);
+        UA_STACKARRAY(UA_DataSetWriter*, dswStore, wg->writersCount);
         UA_DataSetWriter *dsw;
         LIST_FOREACH(dsw, &wg->writers, listEntry) {
             /* Find the dataset */
@@ -321,13 +379,14 @@ UA_Server_freezeWriterGroupConfiguration(UA_Server *server, const UA_NodeId writ
             }
             /* Generate the DSM */
             UA_StatusCode res =
-                    UA_DataSetWriter_generateDataSetMessage(server, &dsmStore[dsmCount], dsw);
+                    UA_DataSetWriter_generateDataSetMessage(server, &dsmStore[dsmCount], dsw, NULL);
             if(res != UA_STATUSCODE_GOOD) {
                 UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
                                "PubSub RT Offset calculation: DataSetMessage buffering failed");
                 continue;
             }
             dsWriterIds[dsmCount] = dsw->config.dataSetWriterId;
+            dswStore[dsmCount] = dsw;
             dsmCount++;
         }
         UA_NetworkMessage networkMessage;
@@ -339,8 +398,28 @@ UA_Server_freezeWriterGroupConfiguration(UA_Server *server, const UA_NodeId writ
         if(res != UA_STATUSCODE_GOOD)
             return UA_STATUSCODE_BADINTERNALERROR;
 
+        UA_NetworkMessage_clearCopyProgram(&wg->bufferedMessage);
         memset(&wg->bufferedMessage, 0, sizeof(UA_NetworkMessageOffsetBuffer));
         UA_NetworkMessage_calcSizeBinary(&networkMessage, &wg->bufferedMessage);
+
+        /* The sequence numbers are taken from the WriterGroup and the
+         * DataSetWriters in every publish cycle. The messages generated here
+         * live on the stack only. */
+        size_t dsmSeqIndex = 0;
+        for(size_t i = 0; i < wg->bufferedMessage.offsetsSize; i++) {
+            UA_NetworkMessageOffset *o = &wg->bufferedMessage.offsets[i];
+            if(o->contentType == UA_PUBSUB_OFFSETTYPE_NETWORKMESSAGE_SEQUENCENUMBER) {
+                o->offsetData.value.value->value.data = &wg->sequenceNumber;
+            } else if(o->contentType == UA_PUBSUB_OFFSETTYPE_DATASETMESSAGE_SEQUENCENUMBER &&
+                      dsmSeqIndex < dsmCount) {
+                o->offsetData.value.value->value.data =
+                    &dswStore[dsmSeqIndex]->actualDataSetMessageSequenceCount;
+                dsmSeqIndex++;
+            } else {
+                continue;
+            }
+            o->offsetData.value.value->value.storageType = UA_VARIANT_DATA_NODELETE;
+        }
         /* Allocate the buffer. Allocate on the stack if the buffer is small. */
         UA_ByteString buf;
         size_t msgSize = UA_NetworkMessage_calcSizeBinary(&networkMessage, NULL);
@@ -351,6 +430,13 @@ UA_Server_freezeWriterGroupConfiguration(UA_Server *server, const UA_NodeId writ
         const UA_Byte *bufEnd = &wg->bufferedMessage.buffer.data[wg->bufferedMessage.buffer.length];
         UA_Byte *bufPos = wg->bufferedMessage.buffer.data;
         UA_NetworkMessage_encodeBinary(&networkMessage, &bufPos, bufEnd);
+
+        /* Compile the offsets into a copy program. Fall back to the generic
+         * encoding if the layout contains values that cannot be copied. */
+        if(UA_NetworkMessage_compileBufferedMessage(&wg->bufferedMessage) != UA_STATUSCODE_GOOD)
+            UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                         "PubSub-RT: Fixed message layout is encoded field by field");
+
         /* Clean up DSM */
         for(size_t i = 0; i < dsmCount; i++){
             UA_free(dsmStore[i].data.keyFrameData.dataSetFields);
@@ -1063,13 +1149,17 @@ UA_WriterGroup_clear(UA_Server *server, UA_WriterGroup *writerGroup) {
     }
     if(writerGroup->bufferedMessage.offsetsSize > 0){
         for (size_t i = 0; i < writerGroup->bufferedMessage.offsetsSize; i++) {
-            if(writerGroup->bufferedMessage.offsets[i].contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT){
+            if(writerGroup->bufferedMessage.offsets[i].contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT ||
+               writerGroup->bufferedMessage.offsets[i].contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_DATAVALUE){
                 UA_DataValue_delete(writerGroup->bufferedMessage.offsets[i].offsetData.value.value);
             }
         }
         UA_ByteString_deleteMembers(&writerGroup->bufferedMessage.buffer);
         UA_free(writerGroup->bufferedMessage.offsets);
     }
+    UA_NetworkMessage_clearCopyProgram(&writerGroup->bufferedMessage);
+    UA_PubSubArena_clear(&writerGroup->arena);
+    UA_ByteString_clear(&writerGroup->sendBuffer);
     UA_NodeId_clear(&writerGroup->identifier);
 }
 
@@ -1397,15 +1487,80 @@ valueChangedVariant(UA_Variant *oldValue, UA_Variant *newValue){
 }
 #endif
 
+/* Copy the value of a variable with an internal value source into the arena.
+ * This covers readable values of pointer-free types without an onRead callback
+ * and index range. Returns false if the value needs to be read via the Read
+ * service. The timestamps are set as for UA_TIMESTAMPSTORETURN_BOTH. */
+static UA_Boolean
+UA_PubSubDataSetField_sampleValueToArena(UA_Server *server, UA_DataSetField *field,
+                                         UA_DataValue *value, UA_PubSubArena *arena) {
+    const UA_PublishedVariableDataType *pp = &field->config.field.variable.publishParameters;
+    if(pp->attributeId != UA_ATTRIBUTEID_VALUE || pp->indexRange.length > 0)
+        return false;
+
+    UA_Boolean done = false;
+    UA_LOCK(server->serviceMutex);
+    const UA_VariableNode *vn = (const UA_VariableNode*)
+        UA_NODESTORE_GET(server, &pp->publishedVariable);
+    if(!vn) {
+        UA_UNLOCK(server->serviceMutex);
+        return false;
+    }
+    const UA_Variant *src = &vn->value.data.value.value;
+    if(vn->nodeClass != UA_NODECLASS_VARIABLE ||
+       !(vn->accessLevel & UA_ACCESSLEVELMASK_READ) ||
+       vn->valueSource != UA_VALUESOURCE_DATA ||
+       vn->value.data.callback.onRead ||
+       (src->type && !src->type->pointerFree) ||
+       src->arrayDimensionsSize > 0)
+        goto release;
+
+    *value = vn->value.data.value;
+    value->value.storageType = UA_VARIANT_DATA_NODELETE;
+    if(src->type && src->data > UA_EMPTY_ARRAY_SENTINEL) {
+        size_t length = UA_Variant_isScalar(src) ? 1 : src->arrayLength;
+        size_t bytes = length * src->type->memSize;
+        void *mem = UA_PubSubArena_alloc(arena, bytes);
+        if(!mem) {
+            UA_DataValue_init(value);
+            goto release;
+        }
+        memcpy(mem, src->data, bytes);
+        value->value.data = mem;
+        /* Overflow memory from the heap is owned by the DataValue */
+        if(!UA_PubSubArena_contains(arena, mem))
+            value->value.storageType = UA_VARIANT_DATA;
+    }
+
+    UA_DateTime now = UA_DateTime_now();
+    if(!value->hasServerTimestamp) {
+        value->serverTimestamp = now;
+        value->hasServerTimestamp = true;
+    }
+    if(!value->hasSourceTimestamp) {
+        value->sourceTimestamp = now;
+        value->hasSourceTimestamp = true;
+    }
+    done = true;
+
+ release:
+    UA_NODESTORE_RELEASE(server, (const UA_Node*)vn);
+    UA_UNLOCK(server->serviceMutex);
+    return done;
+}
+
 /**
  * Obtain the latest value for a specific DataSetField. This method is currently
- * called inside the DataSetMessage generation process.
+ * called inside the DataSetMessage generation process. With an arena, the
+ * values are sampled without heap allocations where possible.
  */
 static void
 UA_PubSubDataSetField_sampleValue(UA_Server *server, UA_DataSetField *field,
-                                  UA_DataValue *value) {
+                                  UA_DataValue *value, UA_PubSubArena *arena) {
     /* Read the value */
     if(field->config.field.variable.staticValueSourceEnabled == UA_FALSE){
+        if(arena && UA_PubSubDataSetField_sampleValueToArena(server, field, value, arena))
+            return;
         UA_ReadValueId rvid;
         UA_ReadValueId_init(&rvid);
         rvid.nodeId = field->config.field.variable.publishParameters.publishedVariable;
@@ -1413,15 +1568,74 @@ UA_PubSubDataSetField_sampleValue(UA_Server *server, UA_DataSetField *field,
         rvid.indexRange = field->config.field.variable.publishParameters.indexRange;
         *value = UA_Server_read(server, &rvid, UA_TIMESTAMPSTORETURN_BOTH);
     } else {
-        value->value.storageType = UA_VARIANT_DATA_NODELETE;
         *value = field->config.field.variable.staticValueSource;
+        value->value.storageType = UA_VARIANT_DATA_NODELETE;
     }
 }
 
+/* Allocate the field arrays of a KeyFrame from the arena (or from the heap if
+ * no arena is used) */
+static void *
+UA_DataSetMessage_newFieldArray(UA_PubSubArena *arena, size_t size,
+                                const UA_DataType *type) {
+    if(!arena)
+        return UA_Array_new(size, type);
+    if(size == 0)
+        return UA_EMPTY_ARRAY_SENTINEL;
+    void *fields = UA_PubSubArena_alloc(arena, size * type->memSize);
+    if(fields)
+        memset(fields, 0, size * type->memSize);
+    return fields;
+}
+
+/* Clean up a DataSetMessage generated with an arena. In the arena-generated
+ * KeyFrames the field names alias the DataSetField configuration and the
+ * values taken from the arena are marked as UA_VARIANT_DATA_NODELETE. */
+static void
+UA_DataSetMessage_clearArena(UA_DataSetMessage *dsm, UA_PubSubArena *arena) {
+    if(dsm->header.dataSetMessageType != UA_DATASETMESSAGE_DATAKEYFRAME) {
+        UA_DataSetMessage_free(dsm);
+        return;
+    }
+    UA_DataValue *fields = dsm->data.keyFrameData.dataSetFields;
+    if(fields && fields != UA_EMPTY_ARRAY_SENTINEL) {
+        for(size_t i = 0; i < dsm->data.keyFrameData.fieldCount; i++)
+            UA_DataValue_clear(&fields[i]);
+    }
+    UA_PubSubArena_release(arena, fields);
+    UA_PubSubArena_release(arena, dsm->data.keyFrameData.fieldNames);
+    dsm->data.keyFrameData.dataSetFields = NULL;
+    dsm->data.keyFrameData.fieldNames = NULL;
+}
+
+#ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+/* Update the lastValue store. Scalars of pointer-free types are copied into
+ * the storage of the previous sample. So the store allocates only for the first
+ * sample and when the type changes. */
+static void
+storeLastSample(UA_DataValue *last, const UA_DataValue *sample) {
+    const UA_Variant *v = &sample->value;
+    if(sample->hasValue && last->hasValue && UA_Variant_isScalar(v) &&
+       UA_Variant_isScalar(&last->value) && v->type == last->value.type &&
+       v->type->pointerFree && v->arrayDimensionsSize == 0 &&
+       last->value.arrayDimensionsSize == 0 &&
+       last->value.storageType == UA_VARIANT_DATA) {
+        UA_Variant storage = last->value;
+        *last = *sample;
+        last->value = storage;
+        memcpy(storage.data, v->data, v->type->memSize);
+        return;
+    }
+    UA_DataValue_clear(last);
+    UA_DataValue_copy(sample, last);
+}
+#endif
+
 static UA_StatusCode
 UA_PubSubDataSetWriter_generateKeyFrameMessage(UA_Server *server,
                                                UA_DataSetMessage *dataSetMessage,
-                                               UA_DataSetWriter *dataSetWriter) {
+                                               UA_DataSetWriter *dataSetWriter,
+                                               UA_PubSubArena *arena) {
     UA_PublishedDataSet *currentDataSet =
         UA_PublishedDataSet_findPDSbyId(server, dataSetWriter->connectedDataSet);
     if(!currentDataSet)
@@ -1432,15 +1646,20 @@ UA_PubSubDataSetWriter_generateKeyFrameMessage(UA_Server *server,
     dataSetMessage->header.dataSetMessageType = UA_DATASETMESSAGE_DATAKEYFRAME;
     dataSetMessage->data.keyFrameData.fieldCount = currentDataSet->fieldSize;
     dataSetMessage->data.keyFrameData.dataSetFields = (UA_DataValue *)
-            UA_Array_new(currentDataSet->fieldSize, &UA_TYPES[UA_TYPES_DATAVALUE]);
+        UA_DataSetMessage_newFieldArray(arena, currentDataSet->fieldSize,
+                                        &UA_TYPES[UA_TYPES_DATAVALUE]);
     if(!dataSetMessage->data.keyFrameData.dataSetFields)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
 #ifdef UA_ENABLE_JSON_ENCODING
     dataSetMessage->data.keyFrameData.fieldNames = (UA_String *)
-        UA_Array_new(currentDataSet->fieldSize, &UA_TYPES[UA_TYPES_STRING]);
+        UA_DataSetMessage_newFieldArray(arena, currentDataSet->fieldSize,
+                                        &UA_TYPES[UA_TYPES_STRING]);
     if(!dataSetMessage->data.keyFrameData.fieldNames) {
-        UA_DataSetMessage_free(dataSetMessage);
+        if(arena)
+            UA_DataSetMessage_clearArena(dataSetMessage, arena);
+        else
+            UA_DataSetMessage_free(dataSetMessage);
         return UA_STATUSCODE_BADOUTOFMEMORY;
     }
 #endif
@@ -1451,13 +1670,17 @@ UA_PubSubDataSetWriter_generateKeyFrameMessage(UA_Server *server,
     TAILQ_FOREACH(dsf, &currentDataSet->fields, listEntry) {
 #ifdef UA_ENABLE_JSON_ENCODING
         /* Set the field name alias */
-        UA_String_copy(&dsf->config.field.variable.fieldNameAlias,
-                       &dataSetMessage->data.keyFrameData.fieldNames[counter]);
+        if(arena)
+            dataSetMessage->data.keyFrameData.fieldNames[counter] =
+                dsf->config.field.variable.fieldNameAlias;
+        else
+            UA_String_copy(&dsf->config.field.variable.fieldNameAlias,
+                           &dataSetMessage->data.keyFrameData.fieldNames[counter]);
 #endif
 
         /* Sample the value */
         UA_DataValue *dfv = &dataSetMessage->data.keyFrameData.dataSetFields[counter];
-        UA_PubSubDataSetField_sampleValue(server, dsf, dfv);
+        UA_PubSubDataSetField_sampleValue(server, dsf, dfv, arena);
 
         /* Deactivate statuscode? */
         if(((u64)dataSetWriter->config.dataSetFieldContentMask &
@@ -1480,8 +1703,7 @@ UA_PubSubDataSetWriter_generateKeyFrameMessage(UA_Server *server,
 
 #ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
         /* Update lastValue store */
-        UA_DataValue_clear(&dataSetWriter->lastSamples[counter].value);
-        UA_DataValue_copy(dfv, &dataSetWriter->lastSamples[counter].value);
+        storeLastSample(&dataSetWriter->lastSamples[counter].value, dfv);
 #endif
 
         counter++;
@@ -1512,7 +1734,7 @@ UA_PubSubDataSetWriter_generateDeltaFrameMessage(UA_Server *server,
         /* Sample the value */
         UA_DataValue value;
         UA_DataValue_init(&value);
-        UA_PubSubDataSetField_sampleValue(server, dsf, &value);
+        UA_PubSubDataSetField_sampleValue(server, dsf, &value, NULL);
 
         /* Check if the value has changed */
         if(valueChangedVariant(&dataSetWriter->lastSamples[counter].value.value, &value.value)) {
@@ -1583,7 +1805,8 @@ UA_PubSubDataSetWriter_generateDeltaFrameMessage(UA_Server *server,
  */
 static UA_StatusCode
 UA_DataSetWriter_generateDataSetMessage(UA_Server *server, UA_DataSetMessage *dataSetMessage,
-                                        UA_DataSetWriter *dataSetWriter) {
+                                        UA_DataSetWriter *dataSetWriter,
+                                        UA_PubSubArena *arena) {
     UA_PublishedDataSet *currentDataSet =
         UA_PublishedDataSet_findPDSbyId(server, dataSetWriter->connectedDataSet);
     if(!currentDataSet)
@@ -1757,7 +1980,8 @@ UA_DataSetWriter_generateDataSetMessage(UA_Server *server, UA_DataSetMessage *da
                sizeof(UA_DataSetWriterSample) * dataSetWriter->lastSamplesCount);
 
         dataSetWriter->connectedDataSetVersion = currentDataSet->dataSetMetaData.configurationVersion;
-        UA_PubSubDataSetWriter_generateKeyFrameMessage(server, dataSetMessage, dataSetWriter);
+        UA_PubSubDataSetWriter_generateKeyFrameMessage(server, dataSetMessage,
+                                                       dataSetWriter, arena);
         dataSetWriter->deltaFrameCounter = 0;
         return UA_STATUSCODE_GOOD;
     }
@@ -1776,12 +2000,28 @@ UA_DataSetWriter_generateDataSetMessage(UA_Server *server, UA_DataSetMessage *da
 #endif
     }
 
-    return UA_PubSubDataSetWriter_generateKeyFrameMessage(server, dataSetMessage, dataSetWriter);
+    return UA_PubSubDataSetWriter_generateKeyFrameMessage(server, dataSetMessage,
+                                                          dataSetWriter, arena);
+}
+
+/* Returns a buffer of the requested length that is backed by the send buffer
+ * of the WriterGroup. The send buffer is only reallocated when it grows. */
+static UA_StatusCode
+UA_WriterGroup_getSendBuffer(UA_WriterGroup *wg, size_t length, UA_ByteString *buf) {
+    if(wg->sendBuffer.length < length) {
+        UA_ByteString_clear(&wg->sendBuffer);
+        UA_StatusCode retval = UA_ByteString_allocBuffer(&wg->sendBuffer, length);
+        if(retval != UA_STATUSCODE_GOOD)
+            return retval;
+    }
+    buf->data = wg->sendBuffer.data;
+    buf->length = length;
+    return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
-sendNetworkMessageJson(UA_PubSubConnection *connection, UA_DataSetMessage *dsm,
-                       UA_UInt16 *writerIds, UA_Byte dsmCount,
+sendNetworkMessageJson(UA_PubSubConnection *connection, UA_WriterGroup *wg,
+                       UA_DataSetMessage *dsm, UA_UInt16 *writerIds, UA_Byte dsmCount,
                        UA_ExtensionObject *transportSettings) {
    UA_StatusCode retval = UA_STATUSCODE_BADNOTSUPPORTED;
 #ifdef UA_ENABLE_JSON_ENCODING
@@ -1795,36 +2035,23 @@ sendNetworkMessageJson(UA_PubSubConnection *connection, UA_DataSetMessage *dsm,
     nm.payloadHeader.dataSetPayloadHeader.dataSetWriterIds = writerIds;
     nm.payload.dataSetPayload.dataSetMessages = dsm;
 
-    /* Allocate the buffer. Allocate on the stack if the buffer is small. */
+    /* Take the buffer from the WriterGroup */
     UA_ByteString buf;
     size_t msgSize = UA_NetworkMessage_calcSizeJson(&nm, NULL, 0, NULL, 0, true);
-    size_t stackSize = 1;
-    if(msgSize <= UA_MAX_STACKBUF)
-        stackSize = msgSize;
-    UA_STACKARRAY(UA_Byte, stackBuf, stackSize);
-    buf.data = stackBuf;
-    buf.length = msgSize;
-    if(msgSize > UA_MAX_STACKBUF) {
-        retval = UA_ByteString_allocBuffer(&buf, msgSize);
-        if(retval != UA_STATUSCODE_GOOD)
-            return retval;
-    }
+    retval = UA_WriterGroup_getSendBuffer(wg, msgSize, &buf);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
 
     /* Encode the message */
     UA_Byte *bufPos = buf.data;
     memset(bufPos, 0, msgSize);
     const UA_Byte *bufEnd = &buf.data[buf.length];
     retval = UA_NetworkMessage_encodeJson(&nm, &bufPos, &bufEnd, NULL, 0, NULL, 0, true);
-    if(retval != UA_STATUSCODE_GOOD) {
-        if(msgSize > UA_MAX_STACKBUF)
-            UA_ByteString_clear(&buf);
+    if(retval != UA_STATUSCODE_GOOD)
         return retval;
-    }
 
     /* Send the prepared messages */
     retval = connection->channel->send(connection->channel, transportSettings, &buf);
-    if(msgSize > UA_MAX_STACKBUF)
-        UA_ByteString_clear(&buf);
 #endif
     return retval;
 }
@@ -1921,38 +2148,23 @@ sendNetworkMessage(UA_PubSubConnection *connection, UA_WriterGroup *wg,
     generateNetworkMessage(connection, wg, dsm, writerIds, dsmCount,
                            messageSettings, transportSettings, &nm);
 
-    /* Allocate the buffer. Allocate on the stack if the buffer is small. */
+    /* Take the buffer from the WriterGroup */
     UA_ByteString buf;
     size_t msgSize = UA_NetworkMessage_calcSizeBinary(&nm, NULL);
-    size_t stackSize = 1;
-    if(msgSize <= UA_MAX_STACKBUF)
-        stackSize = msgSize;
-    UA_STACKARRAY(UA_Byte, stackBuf, stackSize);
-    buf.data = stackBuf;
-    buf.length = msgSize;
-    UA_StatusCode retval;
-    if(msgSize > UA_MAX_STACKBUF) {
-        retval = UA_ByteString_allocBuffer(&buf, msgSize);
-        if(retval != UA_STATUSCODE_GOOD)
-            return retval;
-    }
+    UA_StatusCode retval = UA_WriterGroup_getSendBuffer(wg, msgSize, &buf);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
 
     /* Encode the message */
     UA_Byte *bufPos = buf.data;
     memset(bufPos, 0, msgSize);
     const UA_Byte *bufEnd = &buf.data[buf.length];
     retval = UA_NetworkMessage_encodeBinary(&nm, &bufPos, bufEnd);
-    if(retval != UA_STATUSCODE_GOOD) {
-        if(msgSize > UA_MAX_STACKBUF)
-            UA_ByteString_clear(&buf);
+    if(retval != UA_STATUSCODE_GOOD)
         return retval;
-    }
 
     /* Send the prepared messages */
-    retval = connection->channel->send(connection->channel, transportSettings, &buf);
-    if(msgSize > UA_MAX_STACKBUF)
-        UA_ByteString_clear(&buf);
-    return retval;
+    return connection->channel->send(connection->channel, transportSettings, &buf);
 }
 
 /* This callback triggers the collection and publish of NetworkMessages and the
@@ -1991,8 +2203,12 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
         UA_StatusCode res =
             sendBufferedNetworkMessage(server, connection, &writerGroup->bufferedMessage,
                                        &writerGroup->config.transportSettings);
-        if(res == UA_STATUSCODE_GOOD)
+        if(res == UA_STATUSCODE_GOOD) {
             writerGroup->sequenceNumber++;
+            UA_DataSetWriter *dsw;
+            LIST_FOREACH(dsw, &writerGroup->writers, listEntry)
+                dsw->actualDataSetMessageSequenceCount++;
+        }
         return;
     }
 
@@ -2004,6 +2220,10 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
     if(maxDSM == 0)
         maxDSM = 1;
 
+    /* The DataSetMessages of this cycle are generated in the arena */
+    UA_PubSubArena *arena = &writerGroup->arena;
+    UA_PubSubArena_reset(arena);
+
     /* It is possible to put several DataSetMessages into one NetworkMessage.
      * But only if they do not contain promoted fields. NM with only DSM are
      * sent out right away. The others are kept in a buffer for "batching". */
@@ -2023,7 +2243,7 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
 
         /* Generate the DSM */
         UA_StatusCode res =
-            UA_DataSetWriter_generateDataSetMessage(server, &dsmStore[dsmCount], dsw);
+            UA_DataSetWriter_generateDataSetMessage(server, &dsmStore[dsmCount], dsw, arena);
         if(res != UA_STATUSCODE_GOOD) {
             UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
                            "PubSub Publish: DataSetMessage creation failed");
@@ -2040,7 +2260,7 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
                                          &writerGroup->config.messageSettings,
                                          &writerGroup->config.transportSettings);
             } else if(writerGroup->config.encodingMimeType == UA_PUBSUB_ENCODING_JSON) {
-                res = sendNetworkMessageJson(connection, &dsmStore[dsmCount],
+                res = sendNetworkMessageJson(connection, writerGroup, &dsmStore[dsmCount],
                                              &dsw->config.dataSetWriterId, 1,
                                              &writerGroup->config.transportSettings);
             }
@@ -2049,13 +2269,9 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
                 UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
                                "PubSub Publish: Could not send a NetworkMessage");
 
-            if(writerGroup->config.rtLevel == UA_PUBSUB_RT_DIRECT_VALUE_ACCESS) {
-                for(size_t i = 0; i < dsmStore[dsmCount].data.keyFrameData.fieldCount; ++i) {
-                    dsmStore[dsmCount].data.keyFrameData.dataSetFields[i].value.data = NULL;
-                }
-            }
-
-            UA_DataSetMessage_free(&dsmStore[dsmCount]);
+            /* Static value sources are sampled as UA_VARIANT_DATA_NODELETE.
+             * So direct value access needs no special treatment here. */
+            UA_DataSetMessage_clearArena(&dsmStore[dsmCount], arena);
             continue;
         }
 
@@ -2076,7 +2292,7 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
                                       &writerGroup->config.messageSettings,
                                       &writerGroup->config.transportSettings);
         } else if(writerGroup->config.encodingMimeType == UA_PUBSUB_ENCODING_JSON){
-            res3 = sendNetworkMessageJson(connection, &dsmStore[i * maxDSM],
+            res3 = sendNetworkMessageJson(connection, writerGroup, &dsmStore[i * maxDSM],
                                           &dsWriterIds[i * maxDSM], nmDsmCount,
                                           &writerGroup->config.transportSettings);
         }
@@ -2092,7 +2308,7 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
 
     /* Clean up DSM */
     for(size_t i = 0; i < dsmCount; i++)
-        UA_DataSetMessage_free(&dsmStore[i]);
+        UA_DataSetMessage_clearArena(&dsmStore[i], arena);
 }
 
 /* Add new publishCallback. The first execution is triggered directly after
@@ -178,8 +178,12 @@ void UA_Server_delete(UA_Server *server) {
     LIST_FOREACH_SAFE(current, &server->sessions, pointers, temp) {
         UA_Server_removeSession(server, current, UA_DIAGNOSTICEVENT_CLOSE);
     }
+    UA_Server_deleteSessionIndex(server);
     UA_UNLOCK(server->serviceMutex);
     UA_Array_delete(server->namespaces, server->namespacesSize, &UA_TYPES[UA_TYPES_STRING]);
+    referenceTypeIndexClear(server);
+    typeHierarchyCacheClear(server);
+    dataSourceCacheClear(server);
 
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     UA_MonitoredItem *mon, *mon_tmp;
@@ -194,6 +198,10 @@ void UA_Server_delete(UA_Server *server) {
     UA_ConditionList_delete(server);
 #endif//UA_ENABLE_ALARMS_CONDITIONS
 
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    UA_Event_clearNotifierCache(server);
+#endif
+
 #endif
 
 #ifdef UA_ENABLE_PUBSUB
@@ -304,6 +312,10 @@ UA_Server_init(UA_Server *server) {
     LIST_INIT(&server->sessions);
     server->sessionCount = 0;
 
+#ifdef UA_ENABLE_SUBSCRIPTIONS
+    LIST_INIT(&server->samplingGroups);
+#endif
+
 #if UA_MULTITHREADING >= 100
     UA_AsyncManager_init(&server->asyncManager, server);
 #endif
@@ -554,6 +566,14 @@ UA_Server_run_startup(UA_Server *server) {
                        "There has to be at least one endpoint.");
     }
 
+#ifndef UA_READNOCOPY
+    if(server->config.readNoCopy) {
+        UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                       "readNoCopy requires UA_ENABLE_IMMUTABLE_NODES "
+                       "and is ignored");
+    }
+#endif
+
     /* Initialized discovery */
 #ifdef UA_ENABLE_DISCOVERY
     UA_DiscoveryManager_init(&server->discoveryManager, server);
@@ -623,7 +643,13 @@ static void
 serverExecuteRepeatedCallback(UA_Server *server, UA_ApplicationCallback cb,
                         void *callbackApplication, void *data) {
 #if UA_MULTITHREADING >= 200
-    UA_WorkQueue_enqueue(&server->workQueue, cb, callbackApplication, data);
+    UA_StatusCode retval =
+        UA_WorkQueue_enqueue(&server->workQueue, cb, callbackApplication, data);
+    if(retval != UA_STATUSCODE_GOOD)
+        UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                       "Could not enqueue a repeated callback. Skipping it "
+                       "in this interval with StatusCode %s",
+                       UA_StatusCode_name(retval));
 #else
     cb(callbackApplication, data);
 #endif
@@ -676,8 +702,15 @@ UA_Server_run_iterate(UA_Server *server, UA_Boolean waitInternal) {
     }
 #endif
 
+#if UA_MULTITHREADING >= 100
+    /* Integrate the results of async operations and check their timeout */
+    UA_AsyncManager_process(&server->asyncManager, server);
+#endif
+
 #if UA_MULTITHREADING < 200
     UA_WorkQueue_manuallyProcessDelayed(&server->workQueue);
+#else
+    UA_WorkQueue_processDelayed(&server->workQueue);
 #endif
 
     now = UA_DateTime_nowMonotonic();
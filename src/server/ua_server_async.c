@@ -10,10 +10,14 @@
 
 #if UA_MULTITHREADING >= 100
 
+/* Interval for the timeout check in the server main loop */
+#define UA_ASYNCOPERATION_TIMEOUTCHECK (100 * UA_DATETIME_MSEC)
+
 static void
 UA_AsyncOperation_delete(UA_AsyncOperation *ar) {
     UA_CallMethodRequest_clear(&ar->request);
     UA_CallMethodResult_clear(&ar->response);
+    UA_NodeId_clear(&ar->sessionId);
     UA_free(ar);
 }
 
@@ -57,13 +61,11 @@ UA_AsyncManager_sendAsyncResponse(UA_AsyncManager *am, UA_Server *server,
 }
 
 /* Integrate operation result in the AsyncResponse and send out the response if
- * it is ready. */
+ * it is ready. The result is moved into the AsyncResponse. */
 static void
 integrateOperationResult(UA_AsyncManager *am, UA_Server *server,
-                         UA_AsyncOperation *ao) {
-    /* Grab the open request, so we can continue to construct the response */
-    UA_AsyncResponse *ar = ao->parent;
-
+                         UA_AsyncResponse *ar, size_t index,
+                         UA_CallMethodResult *result) {
     /* Reduce the number of open results */
     ar->opCountdown -= 1;
 
@@ -72,117 +74,293 @@ integrateOperationResult(UA_AsyncManager *am, UA_Server *server,
                  ar->opCountdown);
 
     /* Move the UA_CallMethodResult to UA_CallResponse */
-    ar->response.callResponse.results[ao->index] = ao->response;
-    UA_CallMethodResult_init(&ao->response);
+    ar->response.callResponse.results[index] = *result;
+    UA_CallMethodResult_init(result);
 
     /* Are we done with all operations? */
     if(ar->opCountdown == 0)
         UA_AsyncManager_sendAsyncResponse(am, server, ar);
 }
 
-/* Process all operations in the result queue -> move content over to the
- * AsyncResponse. This is only done by the server thread. */
 static void
-processAsyncResults(UA_Server *server, void *data) {
-    UA_AsyncManager *am = &server->asyncManager;
+integrateTimeout(UA_AsyncManager *am, UA_Server *server,
+                 UA_AsyncResponse *ar, size_t index) {
+    UA_CallMethodResult timeoutResult;
+    UA_CallMethodResult_init(&timeoutResult);
+    timeoutResult.statusCode = UA_STATUSCODE_BADTIMEOUT;
+    integrateOperationResult(am, server, ar, index, &timeoutResult);
+    UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                   "Operation was removed due to a timeout");
+}
+
+/* Hand back a claimed operation. The response has been set by the worker.
+ * Can be called from any thread. The operation must not be accessed
+ * afterwards. */
+static void
+finishOperation(UA_AsyncManager *am, UA_AsyncOperation *ao) {
+    /* Push onto the stack of completed operations. There is no ABA problem as
+     * the server thread only ever takes out the entire stack. The head is only
+     * read through the compare-and-swap. */
+    UA_AsyncOperation *head = NULL;
     while(true) {
-        UA_LOCK(am->queueLock);
-        UA_AsyncOperation *ao = TAILQ_FIRST(&am->resultQueue);
-        if(ao)
-            TAILQ_REMOVE(&am->resultQueue, ao, pointers);
-        UA_UNLOCK(am->queueLock);
-        if(!ao)
+        ao->next = head;
+        UA_AsyncOperation *prev = (UA_AsyncOperation*)
+            UA_atomic_cmpxchg((void * volatile *)&am->resultStack, head, ao);
+        if(prev == head)
             break;
-        UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_SERVER,
-                     "UA_Server_CallMethodResponse: Got Response: OKAY");
-        integrateOperationResult(am, server, ao);
+        head = prev;
+    }
+}
+
+/* Move a dispatched operation forward when the worker returns. If the
+ * timeout has been reported in the meantime, the server thread discards the
+ * result. Returns false if the operation is not dispatched. That is, the
+ * result was already returned or the context is no dispatched operation. */
+static UA_Boolean
+claimOperation(UA_AsyncOperation *ao) {
+    size_t state = UA_atomic_cmpxchgSize(&ao->state, UA_ASYNCOPERATIONSTATE_DISPATCHED,
+                                         UA_ASYNCOPERATIONSTATE_DONE);
+    if(state == UA_ASYNCOPERATIONSTATE_DISPATCHED)
+        return true;
+    return (state == UA_ASYNCOPERATIONSTATE_TIMEDOUT &&
+            UA_atomic_cmpxchgSize(&ao->state, UA_ASYNCOPERATIONSTATE_TIMEDOUT,
+                                  UA_ASYNCOPERATIONSTATE_TIMEDOUTDONE) ==
+            UA_ASYNCOPERATIONSTATE_TIMEDOUT);
+}
+
+/* Take out all completed operations and move their results to the
+ * AsyncResponse. This is only done by the server thread. */
+static void
+processAsyncResults(UA_AsyncManager *am, UA_Server *server) {
+    UA_AsyncOperation *stack = (UA_AsyncOperation*)
+        UA_atomic_xchg((void * volatile *)&am->resultStack, NULL);
+    if(!stack)
+        return;
+
+    /* Reverse the stack to integrate the results in the order of arrival */
+    UA_AsyncOperation *ao = NULL;
+    while(stack) {
+        UA_AsyncOperation *next = stack->next;
+        stack->next = ao;
+        ao = stack;
+        stack = next;
+    }
+
+    /* Remove from the queues of dispatched operations */
+    UA_LOCK(am->queueLock);
+    for(UA_AsyncOperation *op = ao; op; op = op->next) {
+        if(op->state == UA_ASYNCOPERATIONSTATE_TIMEDOUTDONE)
+            TAILQ_REMOVE(&am->timedOutQueue, op, pointers);
+        else
+            TAILQ_REMOVE(&am->dispatchedQueue, op, pointers);
+    }
+    UA_UNLOCK(am->queueLock);
+
+    while(ao) {
+        UA_AsyncOperation *next = ao->next;
+        if(ao->executor)
+            am->executing--;
+        if(ao->state == UA_ASYNCOPERATIONSTATE_DONE) {
+            UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                         "UA_Server_CallMethodResponse: Got Response: OKAY");
+            integrateOperationResult(am, server, ao->parent, ao->index, &ao->response);
+        } else {
+            UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                         "UA_Server_SetAsyncMethodResult: The operation has timed out");
+        }
         UA_AsyncOperation_delete(ao);
         am->opsCount--;
+        ao = next;
     }
 }
 
 /* Check if any operations have timed out */
 static void
-checkTimeouts(UA_Server *server, void *_) {
+checkTimeouts(UA_AsyncManager *am, UA_Server *server) {
     /* Timeouts are not configured */
     if(server->config.asyncOperationTimeout <= 0.0)
         return;
 
-    UA_AsyncManager *am = &server->asyncManager;
     const UA_DateTime tNow = UA_DateTime_now();
+    UA_AsyncOperation *reported = NULL;
+    UA_AsyncOperationQueue timedOut;
+    TAILQ_INIT(&timedOut);
 
     UA_LOCK(am->queueLock);
 
-    /* Loop over the queue of dispatched ops */
+    /* Loop over the queue of dispatched ops. With priorities, the ops are not
+     * dispatched in the order of their timeout. So check all of them. */
     UA_AsyncOperation *op = NULL, *op_tmp = NULL;
     TAILQ_FOREACH_SAFE(op, &am->dispatchedQueue, pointers, op_tmp) {
-        /* The timeout has not passed. Also for all elements following in the queue. */
-        if(tNow <= op->parent->timeout)
-            break;
-
-        /* Mark as timed out and put it into the result queue */
-        op->response.statusCode = UA_STATUSCODE_BADTIMEOUT;
+        if(tNow <= op->timeout)
+            continue;
+
+        /* The worker has returned the result in the meantime. The operation is
+         * integrated from the stack of completed operations. */
+        if(UA_atomic_cmpxchgSize(&op->state, UA_ASYNCOPERATIONSTATE_DISPATCHED,
+                                 UA_ASYNCOPERATIONSTATE_TIMEDOUT) !=
+           UA_ASYNCOPERATIONSTATE_DISPATCHED)
+            continue;
+
+        /* The worker may still access the operation. So it remains until the
+         * worker returns. */
         TAILQ_REMOVE(&am->dispatchedQueue, op, pointers);
-        TAILQ_INSERT_TAIL(&am->resultQueue, op, pointers);
-        UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
-                       "Operation was removed due to a timeout");
+        TAILQ_INSERT_TAIL(&am->timedOutQueue, op, pointers);
+        if(!reported)
+            reported = op;
     }
 
-    /* Loop over the queue of new ops */
-    TAILQ_FOREACH_SAFE(op, &am->newQueue, pointers, op_tmp) {
-        /* The timeout has not passed. Also for all elements following in the queue. */
-        if(tNow <= op->parent->timeout)
-            break;
+    /* Loop over the lanes of new ops */
+    for(size_t i = 0; i < UA_ASYNCOPERATION_PRIORITIES; i++) {
+        TAILQ_FOREACH_SAFE(op, &am->newQueue[i], pointers, op_tmp) {
+            /* The timeout has not passed. Also for all elements following in
+             * the lane. */
+            if(tNow <= op->timeout)
+                break;
+            TAILQ_REMOVE(&am->newQueue[i], op, pointers);
+            TAILQ_INSERT_TAIL(&timedOut, op, pointers);
+        }
+    }
 
-        /* Mark as timed out and put it into the result queue */
-        op->response.statusCode = UA_STATUSCODE_BADTIMEOUT;
-        TAILQ_REMOVE(&am->newQueue, op, pointers);
-        TAILQ_INSERT_TAIL(&am->resultQueue, op, pointers);
-        UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
-                       "Operation was removed due to a timeout");
+    UA_UNLOCK(am->queueLock);
+
+    /* Report the timeout of the dispatched ops. Only the server thread modifies
+     * the queue of timed out ops. */
+    for(op = reported; op; op = TAILQ_NEXT(op, pointers)) {
+        integrateTimeout(am, server, op->parent, op->index);
+        op->parent = NULL;
     }
 
+    /* The new ops were never handed out and can be removed right away */
+    while((op = TAILQ_FIRST(&timedOut))) {
+        TAILQ_REMOVE(&timedOut, op, pointers);
+        integrateTimeout(am, server, op->parent, op->index);
+        UA_AsyncOperation_delete(op);
+        am->opsCount--;
+    }
+}
+
+/* Take out the next operation in the order of priority. The queueLock is
+ * held. */
+static UA_AsyncOperation *
+dispatchNextOperation(UA_AsyncManager *am) {
+    for(size_t i = UA_ASYNCOPERATION_PRIORITIES; i > 0; i--) {
+        UA_AsyncOperation *ao = TAILQ_FIRST(&am->newQueue[i-1]);
+        if(!ao)
+            continue;
+        TAILQ_REMOVE(&am->newQueue[i-1], ao, pointers);
+        TAILQ_INSERT_TAIL(&am->dispatchedQueue, ao, pointers);
+        ao->state = UA_ASYNCOPERATIONSTATE_DISPATCHED;
+        return ao;
+    }
+    return NULL;
+}
+
+#if UA_MULTITHREADING >= 200 && defined(UA_ENABLE_METHODCALLS)
+
+/* Run the method callback of an operation in a worker thread */
+static void
+executeAsyncOperation(UA_Server *server, UA_AsyncOperation *ao) {
+    UA_LOCK(server->serviceMutex);
+    UA_Session *session = UA_Server_getSessionById(server, &ao->sessionId);
+    if(session)
+        Operation_CallMethod(server, session, NULL, &ao->request, &ao->response);
+    else
+        ao->response.statusCode = UA_STATUSCODE_BADSESSIONIDINVALID;
+    UA_UNLOCK(server->serviceMutex);
+    if(claimOperation(ao))
+        finishOperation(&server->asyncManager, ao);
+}
+
+/* Dispatch new operations to the worker threads. The number of operations
+ * with the workers is bounded. So that later operations of a higher priority
+ * don't queue up behind them in the FIFO rings of the workers. */
+static void
+dispatchToExecutor(UA_AsyncManager *am, UA_Server *server) {
+    size_t limit = 2 * server->workQueue.workersSize;
+    if(!server->config.asyncOperationExecutor || am->executing >= limit)
+        return;
+
+    /* Take out the operations under a single lock */
+    UA_AsyncOperation *batch = NULL, **last = &batch;
+    UA_LOCK(am->queueLock);
+    for(; am->executing < limit; am->executing++) {
+        UA_AsyncOperation *ao = dispatchNextOperation(am);
+        if(!ao)
+            break;
+        ao->executor = true;
+        ao->next = NULL;
+        *last = ao;
+        last = &ao->next;
+    }
     UA_UNLOCK(am->queueLock);
 
+    /* The next pointer is reused once the operation is finished */
+    while(batch) {
+        UA_AsyncOperation *next = batch->next;
+        UA_StatusCode res =
+            UA_WorkQueue_enqueue(&server->workQueue,
+                                 (UA_ApplicationCallback)executeAsyncOperation,
+                                 server, batch);
+        if(res != UA_STATUSCODE_GOOD) {
+            /* Fail the operation instead of executing it in the server
+             * thread */
+            batch->response.statusCode = res;
+            if(claimOperation(batch))
+                finishOperation(am, batch);
+        }
+        batch = next;
+    }
+}
+
+#endif
+
+void
+UA_AsyncManager_process(UA_AsyncManager *am, UA_Server *server) {
     /* Integrate async results and send out complete responses */
-    processAsyncResults(server, NULL);
+    processAsyncResults(am, server);
+
+    UA_DateTime now = UA_DateTime_nowMonotonic();
+    if(now >= am->nextTimeoutCheck) {
+        checkTimeouts(am, server);
+        am->nextTimeoutCheck = now + UA_ASYNCOPERATION_TIMEOUTCHECK;
+    }
+
+#if UA_MULTITHREADING >= 200 && defined(UA_ENABLE_METHODCALLS)
+    dispatchToExecutor(am, server);
+#endif
 }
 
 void
 UA_AsyncManager_init(UA_AsyncManager *am, UA_Server *server) {
     memset(am, 0, sizeof(UA_AsyncManager));
     TAILQ_INIT(&am->asyncResponses);
-    TAILQ_INIT(&am->newQueue);
+    for(size_t i = 0; i < UA_ASYNCOPERATION_PRIORITIES; i++)
+        TAILQ_INIT(&am->newQueue[i]);
     TAILQ_INIT(&am->dispatchedQueue);
-    TAILQ_INIT(&am->resultQueue);
+    TAILQ_INIT(&am->timedOutQueue);
     UA_LOCK_INIT(am->queueLock);
+}
 
-    /* Add a regular callback for cleanup and sending finished responses at a
-     * 100s interval. */
-    UA_Server_addRepeatedCallback(server, (UA_ServerCallback)checkTimeouts,
-                                  NULL, 100.0, &am->checkTimeoutCallbackId);
+static void
+deleteQueue(UA_AsyncOperationQueue *queue) {
+    UA_AsyncOperation *ao;
+    while((ao = TAILQ_FIRST(queue))) {
+        TAILQ_REMOVE(queue, ao, pointers);
+        UA_AsyncOperation_delete(ao);
+    }
 }
 
 void
 UA_AsyncManager_clear(UA_AsyncManager *am, UA_Server *server) {
-    UA_Server_removeCallback(server, am->checkTimeoutCallbackId);
-
-    UA_AsyncOperation *ar;
-
-    /* Clean up queues */
+    /* Clean up queues. The completed operations are also still in the queue of
+     * dispatched (or timed out) operations. */
     UA_LOCK(am->queueLock);
-    while((ar = TAILQ_FIRST(&am->newQueue))) {
-        TAILQ_REMOVE(&am->resultQueue, ar, pointers);
-        UA_AsyncOperation_delete(ar);
-    }
-    while((ar = TAILQ_FIRST(&am->dispatchedQueue))) {
-        TAILQ_REMOVE(&am->resultQueue, ar, pointers);
-        UA_AsyncOperation_delete(ar);
-    }
-    while((ar = TAILQ_FIRST(&am->resultQueue))) {
-        TAILQ_REMOVE(&am->resultQueue, ar, pointers);
-        UA_AsyncOperation_delete(ar);
-    }
+    for(size_t i = 0; i < UA_ASYNCOPERATION_PRIORITIES; i++)
+        deleteQueue(&am->newQueue[i]);
+    deleteQueue(&am->dispatchedQueue);
+    deleteQueue(&am->timedOutQueue);
+    am->resultStack = NULL;
     UA_UNLOCK(am->queueLock);
 
     /* Remove responses */
@@ -238,7 +416,8 @@ UA_AsyncManager_removeAsyncResponse(UA_AsyncManager *am, UA_AsyncResponse *ar) {
 UA_StatusCode
 UA_AsyncManager_createAsyncOp(UA_AsyncManager *am, UA_Server *server,
                               UA_AsyncResponse *ar, size_t opIndex,
-                              const UA_CallMethodRequest *opRequest) {
+                              const UA_CallMethodRequest *opRequest,
+                              UA_Byte priority) {
     if(server->config.maxAsyncOperationQueueSize != 0 &&
        am->opsCount >= server->config.maxAsyncOperationQueueSize) {
         UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
@@ -255,22 +434,27 @@ UA_AsyncManager_createAsyncOp(UA_AsyncManager *am, UA_Server *server,
     }
 
     UA_StatusCode result = UA_CallMethodRequest_copy(opRequest, &ao->request);
+    result |= UA_NodeId_copy(&ar->sessionId, &ao->sessionId);
     if(result != UA_STATUSCODE_GOOD) {
         UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_SERVER,
-                     "UA_Server_SetAsyncMethodResult: UA_CallMethodRequest_copy failed.");                
-        UA_free(ao);
+                     "UA_Server_SetAsyncMethodResult: UA_CallMethodRequest_copy failed.");
+        UA_AsyncOperation_delete(ao);
         return result;
     }
 
     UA_CallMethodResult_init(&ao->response);
     ao->index = opIndex;
     ao->parent = ar;
+    ao->timeout = ar->timeout;
+    ao->priority = priority;
+    if(ao->priority >= UA_ASYNCOPERATION_PRIORITIES)
+        ao->priority = UA_ASYNCOPERATION_PRIORITIES - 1;
 
     UA_LOCK(am->queueLock);
-    TAILQ_INSERT_TAIL(&am->newQueue, ao, pointers);
+    TAILQ_INSERT_TAIL(&am->newQueue[ao->priority], ao, pointers);
+    UA_UNLOCK(am->queueLock);
     am->opsCount++;
     ar->opCountdown++;
-    UA_UNLOCK(am->queueLock);
 
     if(server->config.asyncOperationNotifyCallback)
         server->config.asyncOperationNotifyCallback(server);
@@ -278,30 +462,40 @@ UA_AsyncManager_createAsyncOp(UA_AsyncManager *am, UA_Server *server,
     return UA_STATUSCODE_GOOD;
 }
 
+size_t
+UA_Server_getAsyncOperations(UA_Server *server, UA_AsyncOperationEntry *ops,
+                             size_t opsSize) {
+    UA_AsyncManager *am = &server->asyncManager;
+    size_t count = 0;
+    UA_LOCK(am->queueLock);
+    for(; count < opsSize; count++) {
+        UA_AsyncOperation *ao = dispatchNextOperation(am);
+        if(!ao)
+            break;
+        ops[count].type = UA_ASYNCOPERATIONTYPE_CALL;
+        ops[count].request = (UA_AsyncOperationRequest*)&ao->request;
+        ops[count].context = (void*)ao;
+        ops[count].timeout = ao->timeout;
+    }
+    UA_UNLOCK(am->queueLock);
+    return count;
+}
+
 /* Get and remove next Method Call Request */
 UA_Boolean
 UA_Server_getAsyncOperationNonBlocking(UA_Server *server, UA_AsyncOperationType *type,
                                        const UA_AsyncOperationRequest **request,
                                        void **context, UA_DateTime *timeout) {
-    UA_AsyncManager *am = &server->asyncManager;
-
-    UA_Boolean bRV = false;
+    UA_AsyncOperationEntry entry;
     *type = UA_ASYNCOPERATIONTYPE_INVALID;
-    UA_LOCK(am->queueLock);
-    UA_AsyncOperation *ao = TAILQ_FIRST(&am->newQueue);
-    if(ao) {
-        TAILQ_REMOVE(&am->newQueue, ao, pointers);
-        TAILQ_INSERT_TAIL(&am->dispatchedQueue, ao, pointers);
-        *type = UA_ASYNCOPERATIONTYPE_CALL;
-        *request = (UA_AsyncOperationRequest*)&ao->request;
-        *context = (void*)ao;
-        if(timeout)
-            *timeout = ao->parent->timeout;
-        bRV = true;
-    }
-    UA_UNLOCK(am->queueLock);
-
-    return bRV;
+    if(UA_Server_getAsyncOperations(server, &entry, 1) == 0)
+        return false;
+    *type = entry.type;
+    *request = entry.request;
+    *context = entry.context;
+    if(timeout)
+        *timeout = entry.timeout;
+    return true;
 }
 
 UA_Boolean
@@ -316,8 +510,6 @@ void
 UA_Server_setAsyncOperationResult(UA_Server *server,
                                   const UA_AsyncOperationResponse *response,
                                   void *context) {
-    UA_AsyncManager *am = &server->asyncManager;
-
     UA_AsyncOperation *ao = (UA_AsyncOperation*)context;
     if(!ao) {
         /* Something went wrong. Not a good AsyncOp. */
@@ -326,30 +518,16 @@ UA_Server_setAsyncOperationResult(UA_Server *server,
         return;
     }
 
-    UA_LOCK(am->queueLock);
-
-    /* See if the operation is still in the dispatched queue. Otherwise it has
-     * been removed due to a timeout.
-     *
-     * TODO: Add a tree-structure for the dispatch queue. The linear lookup does
-     * not scale. */
-    UA_Boolean found = false;
-    UA_AsyncOperation *op = NULL;
-    TAILQ_FOREACH(op, &am->dispatchedQueue, pointers) {
-        if(op == ao) {
-            found = true;
-            break;
-        }
-    }
-
-    if(!found) {
+    /* Reject a second result for the same operation */
+    if(!claimOperation(ao)) {
         UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
-                       "UA_Server_SetAsyncMethodResult: The operation has timed out");
-        UA_UNLOCK(am->queueLock);
+                       "UA_Server_SetAsyncMethodResult: The operation is not "
+                       "dispatched or its result was already set");
         return;
     }
 
-    /* Copy the result into the internal AsyncOperation */
+    /* Copy the result into the internal AsyncOperation. Only the worker
+     * accesses the response until the operation is finished. */
     UA_StatusCode result =
         UA_CallMethodResult_copy(&response->callMethodResult, &ao->response);
     if(result != UA_STATUSCODE_GOOD) {
@@ -358,11 +536,7 @@ UA_Server_setAsyncOperationResult(UA_Server *server,
         ao->response.statusCode = UA_STATUSCODE_BADOUTOFMEMORY;
     }
 
-    /* Move to the result queue */
-    TAILQ_REMOVE(&am->dispatchedQueue, ao, pointers);
-    TAILQ_INSERT_TAIL(&am->resultQueue, ao, pointers);
-
-    UA_UNLOCK(am->queueLock);
+    finishOperation(&server->asyncManager, ao);
 
     UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_SERVER,
                  "Set the result from the worker thread");
@@ -389,6 +563,26 @@ UA_Server_setMethodNodeAsync(UA_Server *server, const UA_NodeId id,
                               (UA_EditNodeCallback)setMethodNodeAsync, &isAsync);
 }
 
+static UA_StatusCode
+setMethodNodeAsyncPriority(UA_Server *server, UA_Session *session,
+                           UA_Node *node, UA_Byte *priority) {
+    UA_MethodNode *method = (UA_MethodNode*)node;
+    if(method->nodeClass != UA_NODECLASS_METHOD)
+        return UA_STATUSCODE_BADNODECLASSINVALID;
+    method->asyncPriority = *priority;
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_Server_setMethodNodeAsyncPriority(UA_Server *server, const UA_NodeId id,
+                                     UA_Byte priority) {
+    if(priority >= UA_ASYNCOPERATION_PRIORITIES)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    return UA_Server_editNode(server, &server->adminSession, &id,
+                              (UA_EditNodeCallback)setMethodNodeAsyncPriority,
+                              &priority);
+}
+
 UA_StatusCode
 UA_Server_processServiceOperationsAsync(UA_Server *server, UA_Session *session,
                                         UA_UInt32 requestId, UA_UInt32 requestHandle,
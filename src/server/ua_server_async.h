@@ -26,15 +26,33 @@ _UA_BEGIN_DECLS
 struct UA_AsyncResponse;
 typedef struct UA_AsyncResponse UA_AsyncResponse;
 
+/* The state of an operation is only moved forward. A worker and the timeout
+ * check race to move a dispatched operation forward with a compare-and-swap.
+ * So that neither needs to look the operation up in a queue. */
+#define UA_ASYNCOPERATIONSTATE_NEW 0
+#define UA_ASYNCOPERATIONSTATE_DISPATCHED 1 /* Taken out by a worker */
+#define UA_ASYNCOPERATIONSTATE_DONE 2       /* Result set by the worker */
+#define UA_ASYNCOPERATIONSTATE_TIMEDOUT 3   /* Timeout reported to the client
+                                             * while dispatched */
+#define UA_ASYNCOPERATIONSTATE_TIMEDOUTDONE 4 /* Result set by the worker after
+                                               * the timeout was reported */
+
 /* A single operation (of a larger request) */
 typedef struct UA_AsyncOperation {
     TAILQ_ENTRY(UA_AsyncOperation) pointers;
+    struct UA_AsyncOperation *next; /* In the stack of completed operations */
     UA_CallMethodRequest request;
     UA_CallMethodResult	response;
+    UA_NodeId sessionId;      /* For the built-in executor */
+    UA_DateTime timeout;
     size_t index;             /* Index of the operation in the array of ops in
                                * request/response */
-    UA_AsyncResponse *parent; /* Always non-NULL. The parent is only removed
-                               * when its operations are removed */
+    UA_AsyncResponse *parent; /* The parent is only removed when its operations
+                               * are removed. Set to NULL when the timeout was
+                               * reported while the operation is dispatched. */
+    volatile size_t state;
+    UA_Byte priority;
+    UA_Boolean executor;      /* Dispatched to the built-in executor */
 } UA_AsyncOperation;
 
 struct UA_AsyncResponse {
@@ -61,21 +79,33 @@ typedef struct {
     size_t asyncResponsesCount;
 
     /* Operations for the workers. The queues are all FIFO: Put in at the tail,
-     * take out at the head.*/
+     * take out at the head. */
     UA_LOCK_TYPE(queueLock)
-    UA_AsyncOperationQueue newQueue;        /* New operations for the workers */    
-    UA_AsyncOperationQueue dispatchedQueue; /* Operations taken by a worker. When a result is
-                                             * returned, we search for the op here to see if it
-                                             * is still "alive" (not timed out). */
-    UA_AsyncOperationQueue resultQueue;     /* Results to be integrated */
-    size_t opsCount; /* How many operations are transient (in one of the three queues)? */
-
-    UA_UInt64 checkTimeoutCallbackId; /* Registered repeated callbacks */
+    UA_AsyncOperationQueue newQueue[UA_ASYNCOPERATION_PRIORITIES]; /* New
+                                             * operations. One lane per
+                                             * priority. */
+    UA_AsyncOperationQueue dispatchedQueue; /* Operations taken by a worker */
+    UA_AsyncOperationQueue timedOutQueue;   /* Dispatched operations that have
+                                             * timed out. They are removed when
+                                             * the worker returns. */
+
+    /* Completed operations. The workers push onto the stack without a lock.
+     * The server thread takes out the entire stack at once. */
+    UA_AsyncOperation * volatile resultStack;
+
+    /* Only accessed by the server thread */
+    size_t opsCount;  /* How many operations are transient? */
+    size_t executing; /* Operations dispatched to the built-in executor */
+    UA_DateTime nextTimeoutCheck;
 } UA_AsyncManager;
 
 void UA_AsyncManager_init(UA_AsyncManager *am, UA_Server *server);
 void UA_AsyncManager_clear(UA_AsyncManager *am, UA_Server *server);
 
+/* Integrate the completed operations, check for timeouts and dispatch
+ * operations to the built-in executor. Called from the server main loop. */
+void UA_AsyncManager_process(UA_AsyncManager *am, UA_Server *server);
+
 UA_StatusCode
 UA_AsyncManager_createAsyncResponse(UA_AsyncManager *am, UA_Server *server,
                                     const UA_NodeId *sessionId,
@@ -91,7 +121,8 @@ UA_AsyncManager_removeAsyncResponse(UA_AsyncManager *am, UA_AsyncResponse *ar);
 UA_StatusCode
 UA_AsyncManager_createAsyncOp(UA_AsyncManager *am, UA_Server *server,
                               UA_AsyncResponse *ar, size_t opIndex,
-                              const UA_CallMethodRequest *opRequest);
+                              const UA_CallMethodRequest *opRequest,
+                              UA_Byte priority);
 
 typedef void (*UA_AsyncServiceOperation)(UA_Server *server, UA_Session *session,
                                          UA_UInt32 requestId, UA_UInt32 requestHandle,
@@ -63,10 +63,13 @@ sendServiceFault(UA_SecureChannel *channel, UA_UInt32 requestId, UA_UInt32 reque
  /* This is not an ERR message, the connection is not closed afterwards */
 static UA_StatusCode
 decodeHeaderSendServiceFault(UA_SecureChannel *channel, const UA_ByteString *msg,
-                             size_t offset, const UA_DataType *responseType,
+                             size_t msgSize, size_t offset,
+                             const UA_DataType *responseType,
                              UA_UInt32 requestId, UA_StatusCode error) {
     UA_RequestHeader requestHeader;
-    UA_StatusCode retval = UA_RequestHeader_decodeBinary(msg, &offset, &requestHeader);
+    UA_StatusCode retval =
+        UA_decodeBinarySegments(msg, msgSize, &offset, &requestHeader,
+                                &UA_TYPES[UA_TYPES_REQUESTHEADER], NULL);
     if(retval != UA_STATUSCODE_GOOD)
         return retval;
     retval = sendServiceFault(channel,  requestId, requestHeader.requestHandle,
@@ -671,20 +674,39 @@ processMSGDecoded(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 reques
     }
 #endif
 
-    /* Dispatch the synchronous service call and send the response */
+    /* Dispatch the synchronous service call and take the nodes that the
+     * response points into (see the readNoCopy option) */
     UA_LOCK(server->serviceMutex);
     service(server, session, request, response);
+    const UA_Node **pinnedNodes = session->pinnedNodes;
+    size_t pinnedNodesSize = session->pinnedNodesSize;
+    session->pinnedNodes = NULL;
+    session->pinnedNodesSize = 0;
     UA_UNLOCK(server->serviceMutex);
-    return sendResponse(server, session, channel, requestId, response, responseType);
+
+    /* Send the response */
+    retval = sendResponse(server, session, channel, requestId, response, responseType);
+
+    /* Release the nodes once the response is encoded */
+    if(pinnedNodesSize > 0) {
+        UA_LOCK(server->serviceMutex);
+        for(size_t i = 0; i < pinnedNodesSize; i++)
+            UA_NODESTORE_RELEASE(server, pinnedNodes[i]);
+        UA_UNLOCK(server->serviceMutex);
+    }
+    UA_free((void*)pinnedNodes);
+    return retval;
 }
 
 static UA_StatusCode
-processMSG(UA_Server *server, UA_SecureChannel *channel,
-           UA_UInt32 requestId, const UA_ByteString *msg) {
+processMSG(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 requestId,
+           const UA_ByteString *msg, size_t msgSize) {
     /* Decode the nodeid */
     size_t offset = 0;
     UA_NodeId requestTypeId;
-    UA_StatusCode retval = UA_NodeId_decodeBinary(msg, &offset, &requestTypeId);
+    UA_StatusCode retval =
+        UA_decodeBinarySegments(msg, msgSize, &offset, &requestTypeId,
+                                &UA_TYPES[UA_TYPES_NODEID], NULL);
     if(retval != UA_STATUSCODE_GOOD)
         return retval;
     if(requestTypeId.namespaceIndex != 0 ||
@@ -710,7 +732,7 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
                                 "Unknown request with type identifier %" PRIi32,
                                 requestTypeId.identifier.numeric);
         }
-        return decodeHeaderSendServiceFault(channel, msg, requestPos,
+        return decodeHeaderSendServiceFault(channel, msg, msgSize, requestPos,
                                             &UA_TYPES[UA_TYPES_SERVICEFAULT],
                                             requestId, UA_STATUSCODE_BADSERVICEUNSUPPORTED);
     }
@@ -718,12 +740,13 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
 
     /* Decode the request */
     UA_Request request;
-    retval = UA_decodeBinary(msg, &offset, &request, requestType, server->config.customDataTypes);
+    retval = UA_decodeBinarySegments(msg, msgSize, &offset, &request, requestType,
+                                     server->config.customDataTypes);
     if(retval != UA_STATUSCODE_GOOD) {
         UA_LOG_DEBUG_CHANNEL(&server->config.logger, channel,
                              "Could not decode the request with StatusCode %s",
                              UA_StatusCode_name(retval));
-        return decodeHeaderSendServiceFault(channel, msg, requestPos,
+        return decodeHeaderSendServiceFault(channel, msg, msgSize, requestPos,
                                             responseType, requestId, retval);
     }
 
@@ -768,22 +791,22 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
 static void
 processSecureChannelMessage(void *application, UA_SecureChannel *channel,
                             UA_MessageType messagetype, UA_UInt32 requestId,
-                            UA_ByteString *message) {
+                            UA_ByteString *segments, size_t segmentsSize) {
     UA_Server *server = (UA_Server*)application;
 
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
     switch(messagetype) {
     case UA_MESSAGETYPE_HEL:
         UA_LOG_TRACE_CHANNEL(&server->config.logger, channel, "Process a HEL message");
-        retval = processHEL(server, channel, message);
+        retval = processHEL(server, channel, segments);
         break;
     case UA_MESSAGETYPE_OPN:
         UA_LOG_TRACE_CHANNEL(&server->config.logger, channel, "Process an OPN message");
-        retval = decryptProcessOPN(server, channel, message);
+        retval = decryptProcessOPN(server, channel, segments);
         break;
     case UA_MESSAGETYPE_MSG:
         UA_LOG_TRACE_CHANNEL(&server->config.logger, channel, "Process a MSG");
-        retval = processMSG(server, channel, requestId, message);
+        retval = processMSG(server, channel, requestId, segments, segmentsSize);
         break;
     case UA_MESSAGETYPE_CLO:
         UA_LOG_TRACE_CHANNEL(&server->config.logger, channel, "Process a CLO");
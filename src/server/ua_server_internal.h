@@ -35,6 +35,13 @@ _UA_BEGIN_DECLS
 #define UA_THREADSAFE UA_DEPRECATED
 #endif
 
+/* Read responses can point into the nodes (config.readNoCopy) only if the
+ * nodes are never edited in place. Otherwise a callback of a later operation
+ * in the same request could change a value the response points into. */
+#ifdef UA_ENABLE_IMMUTABLE_NODES
+#define UA_READNOCOPY
+#endif
+
 #ifdef UA_ENABLE_PUBSUB
 #include "ua_pubsub_manager.h"
 #endif
@@ -75,9 +82,63 @@ typedef struct channel_entry {
 typedef struct session_list_entry {
     UA_DelayedCallback cleanupCallback;
     LIST_ENTRY(session_list_entry) pointers;
+    struct session_list_entry *nextByToken; /* Hash chain of sessionsByToken */
+    struct session_list_entry *nextById;    /* Hash chain of sessionsById */
+    size_t timeoutIndex;    /* Position in the sessionTimeouts heap */
+    UA_DateTime timeoutKey; /* validTill when the entry was last sorted into
+                             * the heap. The lifetime is only ever extended.
+                             * So the key is a lower bound for validTill. */
     UA_Session session;
 } session_list_entry;
 
+/* Every ReferenceType in the hierarchy below References gets a small integer
+ * index. Sets of ReferenceTypes are bitsets over these indices. */
+#define UA_REFERENCETYPESET_MAX 128
+
+typedef struct {
+    UA_UInt32 bits[UA_REFERENCETYPESET_MAX / 32];
+} UA_ReferenceTypeSet;
+
+#define UA_REFERENCETYPEINDEX_UNBUILT 0 /* Initial state and after changes to
+                                         * the hierarchy */
+#define UA_REFERENCETYPEINDEX_VALID 1
+#define UA_REFERENCETYPEINDEX_FAILED 2  /* Too many ReferenceTypes */
+
+typedef struct {
+    UA_Byte state;
+    UA_Byte refTypesSize;
+    UA_NodeId refTypes[UA_REFERENCETYPESET_MAX];
+    UA_ReferenceTypeSet subtypes[UA_REFERENCETYPESET_MAX]; /* Including the
+                                                            * type itself */
+    /* Open addressing hash index by NodeId. Contains the position in refTypes
+     * plus one. Zero for empty slots. */
+    UA_Byte slots[2 * UA_REFERENCETYPESET_MAX];
+} UA_ReferenceTypeIndex;
+
+/* The supertypes of recently tested DataTypes, ObjectTypes and VariableTypes
+ * are cached. The cache is direct-mapped by the hash of the type NodeId.
+ * Entries are dropped when a HasSubtype reference of the type or of one of its
+ * supertypes changes. */
+#define UA_TYPEHIERARCHYCACHE_SIZE 64
+
+typedef struct {
+    UA_NodeId typeId; /* Null for empty entries */
+    size_t supertypesSize;
+    UA_NodeId *supertypes; /* All direct and indirect supertypes */
+} UA_TypeHierarchyCacheEntry;
+
+/* Variables with a DataSource can be configured to cache the last value read
+ * from the DataSource. The entries are kept in a chained hash table by the
+ * NodeId of the variable. */
+typedef struct UA_DataSourceCacheEntry {
+    struct UA_DataSourceCacheEntry *next; /* Hash chain */
+    UA_NodeId nodeId;
+    UA_Double maxAge;     /* Configured maximum age in ms */
+    UA_DateTime readTime; /* Server time of the cached read. Zero if empty. */
+    UA_UInt64 generation; /* Changes with every invalidation and update */
+    UA_DataValue value;
+} UA_DataSourceCacheEntry;
+
 typedef enum {
     UA_SERVERLIFECYCLE_FRESH,
     UA_SERVERLIFECYLE_RUNNING
@@ -104,6 +165,12 @@ struct UA_Server {
     /* Session Management */
     LIST_HEAD(session_list, session_list_entry) sessions;
     UA_UInt32 sessionCount;
+    session_list_entry **sessionsByToken; /* Hash index by authentication token */
+    session_list_entry **sessionsById;    /* Hash index by SessionId */
+    session_list_entry **sessionTimeouts; /* Min-heap ordered by timeoutKey */
+    size_t sessionTimeoutsSize;
+    size_t sessionsHashSize; /* Number of buckets in the hash indexes (a power
+                              * of two) and capacity of the heap */
     UA_Session adminSession; /* Local access to the services (for startup and
                               * maintenance) uses this Session with all possible
                               * access rights (Session Id: 1) */
@@ -122,6 +189,24 @@ struct UA_Server {
      * the parent and member instantiation */
     UA_Boolean bootstrapNS0;
 
+    /* Incremented whenever references are added or removed. Caches derived
+     * from the node hierarchy are invalid once the version has changed. */
+    UA_UInt32 referenceVersion;
+
+    /* Index of the ReferenceType hierarchy. Rebuilt on demand when HasSubtype
+     * references between ReferenceTypes have changed. */
+    UA_ReferenceTypeIndex referenceTypeIndex;
+
+    /* Supertypes of the recently tested types */
+    UA_TypeHierarchyCacheEntry typeHierarchyCache[UA_TYPEHIERARCHYCACHE_SIZE];
+    size_t typeHierarchyCacheSize; /* Number of used entries */
+
+    /* Cached DataSource values */
+    UA_DataSourceCacheEntry **dataSourceCache;
+    size_t dataSourceCacheSize;    /* Number of buckets (a power of two) */
+    size_t dataSourceCacheEntries; /* Number of configured variables */
+    UA_UInt64 dataSourceCacheGeneration; /* Last assigned entry generation */
+
     /* Discovery */
 #ifdef UA_ENABLE_DISCOVERY
     UA_DiscoveryManager discoveryManager;
@@ -136,11 +221,18 @@ struct UA_Server {
     /* To be cast to UA_LocalMonitoredItem to get the callback and context */
     LIST_HEAD(LocalMonitoredItems, UA_MonitoredItem) localMonitoredItems;
     UA_UInt32 lastLocalMonitoredItemId;
+    /* MonitoredItems are sampled in groups of the same sampling interval */
+    LIST_HEAD(, UA_SamplingGroup) samplingGroups;
 
 #ifdef UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS
     LIST_HEAD(conditionSourcelisthead, UA_ConditionSource) headConditionSource;
 #endif//UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS
 
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    /* Notifier nodes for recent event origins */
+    UA_EventNotifierCacheEntry eventNotifierCache[UA_EVENTNOTIFIERCACHE_SIZE];
+#endif
+
 #endif
 
     /* Publish/Subscribe */
@@ -208,6 +300,11 @@ UA_Server_removeSessionByToken(UA_Server *server, const UA_NodeId *token,
 void
 UA_Server_cleanupSessions(UA_Server *server, UA_DateTime nowMonotonic);
 
+/* Frees the hash indexes and the timeout heap. All sessions have to be removed
+ * before. */
+void
+UA_Server_deleteSessionIndex(UA_Server *server);
+
 UA_Session *
 getSessionByToken(UA_Server *server, const UA_NodeId *token);
 
@@ -254,6 +351,61 @@ isNodeInTree(UA_Server *server, const UA_NodeId *leafNode,
              const UA_NodeId *nodeToFind, const UA_NodeId *referenceTypeIds,
              size_t referenceTypeIdsSize);
 
+/* Get the set of the ReferenceType (and its subtypes if includeSubtypes).
+ * Returns false if the ReferenceType is not in the index. The set remains
+ * valid until the next call, as the index is rebuilt here if it is
+ * outdated. */
+UA_Boolean
+getReferenceTypeSet(UA_Server *server, const UA_NodeId *refType,
+                    UA_Boolean includeSubtypes, UA_ReferenceTypeSet *set);
+
+/* Test whether the ReferenceType is contained in the set */
+UA_Boolean
+isReferenceTypeInSet(UA_Server *server, const UA_NodeId *refType,
+                     const UA_ReferenceTypeSet *set);
+
+/* Mark the index as outdated if the reference changes the ReferenceType
+ * hierarchy */
+void
+referenceTypeIndexUpdate(UA_Server *server, const UA_Node *node,
+                         const UA_NodeId *referenceTypeId);
+
+void
+referenceTypeIndexClear(UA_Server *server);
+
+/* Drop the cached supertypes that are changed by adding or removing the
+ * reference */
+void
+typeHierarchyCacheUpdate(UA_Server *server, const UA_Node *node,
+                         const UA_NodeId *referenceTypeId, UA_Boolean isForward,
+                         const UA_NodeId *targetId);
+
+/* Drop the cached supertypes of a deleted type and of the types below it. The
+ * references to the type need not be removed with the node. */
+void
+typeHierarchyCacheRemove(UA_Server *server, const UA_Node *node);
+
+void
+typeHierarchyCacheClear(UA_Server *server);
+
+/* Matches ReferenceTypes against a ReferenceType (and its subtypes). Uses the
+ * index and falls back to walking up the hierarchy if the ReferenceType is
+ * not indexed. */
+typedef struct {
+    const UA_NodeId *refType; /* NULL matches all ReferenceTypes */
+    UA_Boolean includeSubtypes;
+    UA_Boolean indexed;
+    UA_ReferenceTypeSet set;
+} UA_ReferenceTypeMatch;
+
+void
+UA_ReferenceTypeMatch_init(UA_Server *server, UA_ReferenceTypeMatch *match,
+                           const UA_NodeId *refType, UA_Boolean includeSubtypes);
+
+UA_Boolean
+UA_ReferenceTypeMatch_test(UA_Server *server, const UA_ReferenceTypeMatch *match,
+                           const UA_NodeId *refType);
+
 /* Returns an array with the hierarchy of nodes. The start nodes can be returned
  * as well. The returned array starts at the leaf and continues "upwards" or
  * "downwards". Duplicate entries are removed. The parameter `walkDownwards`
@@ -407,12 +559,24 @@ register_server_with_discovery_server(UA_Server *server,
 
 /* Read a node attribute in the context of a "checked-out" node. So the
  * attribute will not be copied when possible. The variant then points into the
- * node and has UA_VARIANT_DATA_NODELETE set. */
+ * node and has UA_VARIANT_DATA_NODELETE set. A cached DataSource value is used
+ * if it is younger than maxAge (in ms). */
 void
 ReadWithNode(const UA_Node *node, UA_Server *server, UA_Session *session,
-             UA_TimestampsToReturn timestampsToReturn,
+             UA_TimestampsToReturn timestampsToReturn, UA_Double maxAge,
              const UA_ReadValueId *id, UA_DataValue *v);
 
+/* Drop the cached DataSource value of the variable */
+void
+dataSourceCacheInvalidate(UA_Server *server, const UA_NodeId *nodeId);
+
+/* Remove the variable from the DataSource cache */
+void
+dataSourceCacheRemove(UA_Server *server, const UA_NodeId *nodeId);
+
+void
+dataSourceCacheClear(UA_Server *server);
+
 UA_StatusCode
 readValueAttribute(UA_Server *server, UA_Session *session,
                    const UA_VariableNode *vn, UA_DataValue *v);
@@ -460,6 +624,12 @@ void
 Operation_Browse(UA_Server *server, UA_Session *session, const UA_UInt32 *maxrefs,
                  const UA_BrowseDescription *descr, UA_BrowseResult *result);
 
+#ifdef UA_ENABLE_METHODCALLS
+void
+Operation_CallMethod(UA_Server *server, UA_Session *session, void *context,
+                     const UA_CallMethodRequest *request, UA_CallMethodResult *result);
+#endif
+
 UA_DataValue
 UA_Server_readWithSession(UA_Server *server, UA_Session *session,
                           const UA_ReadValueId *item,
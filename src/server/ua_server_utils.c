@@ -93,14 +93,365 @@ isNodeInTreeNoCircular(UA_Server *server, const UA_NodeId *leafNode, const UA_No
     return false;
 }
 
+/************************/
+/* Type Hierarchy Cache */
+/************************/
+
+static UA_Boolean
+isCachedTypeClass(UA_NodeClass nodeClass) {
+    return (nodeClass == UA_NODECLASS_DATATYPE ||
+            nodeClass == UA_NODECLASS_OBJECTTYPE ||
+            nodeClass == UA_NODECLASS_VARIABLETYPE);
+}
+
+static void
+UA_TypeHierarchyCacheEntry_clear(UA_TypeHierarchyCacheEntry *entry) {
+    UA_NodeId_clear(&entry->typeId);
+    UA_Array_delete(entry->supertypes, entry->supertypesSize,
+                    &UA_TYPES[UA_TYPES_NODEID]);
+    memset(entry, 0, sizeof(UA_TypeHierarchyCacheEntry));
+}
+
+void
+typeHierarchyCacheClear(UA_Server *server) {
+    for(size_t i = 0; i < UA_TYPEHIERARCHYCACHE_SIZE; i++)
+        UA_TypeHierarchyCacheEntry_clear(&server->typeHierarchyCache[i]);
+    server->typeHierarchyCacheSize = 0;
+}
+
+static UA_Boolean
+containsSupertype(const UA_TypeHierarchyCacheEntry *entry, const UA_NodeId *id) {
+    for(size_t i = 0; i < entry->supertypesSize; i++) {
+        if(UA_NodeId_equal(&entry->supertypes[i], id))
+            return true;
+    }
+    return false;
+}
+
+/* Walk up the HasSubtype references in breadth-first order. The array of
+ * supertypes is also the queue of nodes to visit. Supertypes that were already
+ * found are skipped. So the walk terminates also for circular references. */
+static UA_StatusCode
+computeSupertypes(UA_Server *server, const UA_NodeId *typeId,
+                  UA_TypeHierarchyCacheEntry *entry) {
+    memset(entry, 0, sizeof(UA_TypeHierarchyCacheEntry));
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    size_t capacity = 0;
+    size_t visited = 0;
+    const UA_NodeId *current = typeId;
+    while(current && retval == UA_STATUSCODE_GOOD) {
+        const UA_Node *node = UA_NODESTORE_GET(server, current);
+        if(node) {
+            for(size_t i = 0; i < node->referencesSize; i++) {
+                UA_NodeReferenceKind *rk = &node->references[i];
+                if(!rk->isInverse || !UA_NodeId_equal(&rk->referenceTypeId, &subtypeId))
+                    continue;
+                for(size_t j = 0; j < rk->refTargetsSize; j++) {
+                    const UA_ExpandedNodeId *target = &rk->refTargets[j].targetId;
+                    if(target->serverIndex != 0 || target->namespaceUri.data != NULL ||
+                       UA_NodeId_equal(&target->nodeId, typeId) ||
+                       containsSupertype(entry, &target->nodeId))
+                        continue;
+                    if(entry->supertypesSize == capacity) {
+                        size_t newCapacity = (capacity == 0) ? 8 : capacity * 2;
+                        UA_NodeId *newSupertypes = (UA_NodeId*)
+                            UA_realloc(entry->supertypes, newCapacity * sizeof(UA_NodeId));
+                        if(!newSupertypes) {
+                            retval = UA_STATUSCODE_BADOUTOFMEMORY;
+                            break;
+                        }
+                        entry->supertypes = newSupertypes;
+                        capacity = newCapacity;
+                    }
+                    retval = UA_NodeId_copy(&target->nodeId,
+                                            &entry->supertypes[entry->supertypesSize]);
+                    if(retval != UA_STATUSCODE_GOOD)
+                        break;
+                    entry->supertypesSize++;
+                }
+                if(retval != UA_STATUSCODE_GOOD)
+                    break;
+            }
+            UA_NODESTORE_RELEASE(server, node);
+        }
+        current = (visited < entry->supertypesSize) ?
+            &entry->supertypes[visited++] : NULL;
+    }
+
+    if(retval == UA_STATUSCODE_GOOD)
+        retval = UA_NodeId_copy(typeId, &entry->typeId);
+    if(retval != UA_STATUSCODE_GOOD)
+        UA_TypeHierarchyCacheEntry_clear(entry);
+    return retval;
+}
+
+/* Returns the cache entry with the supertypes of the type. Returns NULL if the
+ * node is not a DataType, ObjectType or VariableType. The entry is valid until
+ * the next change to the cache. */
+static const UA_TypeHierarchyCacheEntry *
+getSupertypes(UA_Server *server, const UA_NodeId *typeId) {
+    UA_TypeHierarchyCacheEntry *slot = &server->typeHierarchyCache
+        [UA_NodeId_hash(typeId) % UA_TYPEHIERARCHYCACHE_SIZE];
+    if(!UA_NodeId_isNull(&slot->typeId) && UA_NodeId_equal(&slot->typeId, typeId))
+        return slot;
+
+    const UA_Node *node = UA_NODESTORE_GET(server, typeId);
+    if(!node)
+        return NULL;
+    UA_Boolean isType = isCachedTypeClass(node->nodeClass);
+    UA_NODESTORE_RELEASE(server, node);
+    if(!isType)
+        return NULL;
+
+    UA_TypeHierarchyCacheEntry entry;
+    if(computeSupertypes(server, typeId, &entry) != UA_STATUSCODE_GOOD)
+        return NULL;
+    if(UA_NodeId_isNull(&slot->typeId))
+        server->typeHierarchyCacheSize++;
+    else
+        UA_TypeHierarchyCacheEntry_clear(slot);
+    *slot = entry;
+    return slot;
+}
+
+/* Drop the entries of the type and of all types below it */
+static void
+typeHierarchyCacheDrop(UA_Server *server, const UA_NodeId *typeId) {
+    for(size_t i = 0; i < UA_TYPEHIERARCHYCACHE_SIZE; i++) {
+        UA_TypeHierarchyCacheEntry *entry = &server->typeHierarchyCache[i];
+        if(UA_NodeId_isNull(&entry->typeId))
+            continue;
+        if(!UA_NodeId_equal(&entry->typeId, typeId) &&
+           !containsSupertype(entry, typeId))
+            continue;
+        UA_TypeHierarchyCacheEntry_clear(entry);
+        server->typeHierarchyCacheSize--;
+    }
+}
+
+void
+typeHierarchyCacheUpdate(UA_Server *server, const UA_Node *node,
+                         const UA_NodeId *referenceTypeId, UA_Boolean isForward,
+                         const UA_NodeId *targetId) {
+    if(server->typeHierarchyCacheSize == 0 || !isCachedTypeClass(node->nodeClass) ||
+       !UA_NodeId_equal(referenceTypeId, &subtypeId))
+        return;
+
+    /* The supertypes change for the subtype side of the reference */
+    typeHierarchyCacheDrop(server, isForward ? targetId : &node->nodeId);
+}
+
+void
+typeHierarchyCacheRemove(UA_Server *server, const UA_Node *node) {
+    if(server->typeHierarchyCacheSize == 0 || !isCachedTypeClass(node->nodeClass))
+        return;
+    typeHierarchyCacheDrop(server, &node->nodeId);
+}
+
 UA_Boolean
 isNodeInTree(UA_Server *server, const UA_NodeId *leafNode, const UA_NodeId *nodeToFind,
              const UA_NodeId *referenceTypeIds, size_t referenceTypeIdsSize) {
+    if(referenceTypeIdsSize == 1 && UA_NodeId_equal(referenceTypeIds, &subtypeId)) {
+        /* Use the index for the hierarchy of ReferenceTypes. All subtypes of an
+         * indexed ReferenceType are indexed as well. */
+        UA_ReferenceTypeSet set;
+        if(getReferenceTypeSet(server, nodeToFind, true, &set))
+            return isReferenceTypeInSet(server, leafNode, &set);
+
+        /* Use the cached supertypes for the other type hierarchies */
+        if(UA_NodeId_equal(leafNode, nodeToFind))
+            return true;
+        const UA_TypeHierarchyCacheEntry *entry = getSupertypes(server, leafNode);
+        if(entry)
+            return containsSupertype(entry, nodeToFind);
+    }
+
     struct ref_history visitedRefs = {NULL, leafNode, 0};
     return isNodeInTreeNoCircular(server, leafNode, nodeToFind, &visitedRefs,
                                   referenceTypeIds, referenceTypeIdsSize);
 }
 
+/***************************/
+/* ReferenceType Hierarchy */
+/***************************/
+
+static const UA_NodeId referencesId = {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_REFERENCES}};
+
+#define UA_REFERENCETYPEINDEX_SLOTS (2 * UA_REFERENCETYPESET_MAX)
+
+static UA_Byte *
+findReferenceTypeSlot(UA_ReferenceTypeIndex *rti, const UA_NodeId *refType) {
+    size_t mask = UA_REFERENCETYPEINDEX_SLOTS - 1;
+    size_t slot = UA_NodeId_hash(refType) & mask;
+    while(rti->slots[slot] != 0 &&
+          !UA_NodeId_equal(&rti->refTypes[rti->slots[slot] - 1], refType))
+        slot = (slot + 1) & mask;
+    return &rti->slots[slot];
+}
+
+static UA_Boolean
+referenceTypeSetContains(const UA_ReferenceTypeSet *set, size_t index) {
+    return (set->bits[index / 32] & ((UA_UInt32)1 << (index % 32))) != 0;
+}
+
+static void
+referenceTypeSetAdd(UA_ReferenceTypeSet *set, size_t index) {
+    set->bits[index / 32] |= (UA_UInt32)1 << (index % 32);
+}
+
+void
+referenceTypeIndexClear(UA_Server *server) {
+    UA_ReferenceTypeIndex *rti = &server->referenceTypeIndex;
+    for(size_t i = 0; i < rti->refTypesSize; i++)
+        UA_NodeId_clear(&rti->refTypes[i]);
+    memset(rti, 0, sizeof(UA_ReferenceTypeIndex));
+}
+
+/* Add the ReferenceType to the index if it is not yet contained. Returns the
+ * position or -1 if the index is full. */
+static int
+addReferenceType(UA_ReferenceTypeIndex *rti, const UA_NodeId *refType) {
+    UA_Byte *slot = findReferenceTypeSlot(rti, refType);
+    if(*slot != 0)
+        return *slot - 1;
+    if(rti->refTypesSize >= UA_REFERENCETYPESET_MAX ||
+       UA_NodeId_copy(refType, &rti->refTypes[rti->refTypesSize]) != UA_STATUSCODE_GOOD)
+        return -1;
+    *slot = ++rti->refTypesSize;
+    return *slot - 1;
+}
+
+/* Collect the ReferenceTypes below References in breadth-first order and
+ * compute the transitive closure of their subtypes */
+static void
+buildReferenceTypeIndex(UA_Server *server) {
+    UA_ReferenceTypeIndex *rti = &server->referenceTypeIndex;
+    referenceTypeIndexClear(server);
+    rti->state = UA_REFERENCETYPEINDEX_VALID;
+
+    const UA_Node *root = UA_NODESTORE_GET(server, &referencesId);
+    if(!root)
+        return;
+    UA_Boolean isRefType = (root->nodeClass == UA_NODECLASS_REFERENCETYPE);
+    UA_NODESTORE_RELEASE(server, root);
+    if(!isRefType)
+        return;
+    addReferenceType(rti, &referencesId);
+
+    /* The set of a ReferenceType first contains its direct subtypes */
+    for(size_t i = 0; i < rti->refTypesSize; i++) {
+        referenceTypeSetAdd(&rti->subtypes[i], i);
+        const UA_Node *node = UA_NODESTORE_GET(server, &rti->refTypes[i]);
+        if(!node)
+            continue;
+        for(size_t j = 0; j < node->referencesSize; j++) {
+            UA_NodeReferenceKind *rk = &node->references[j];
+            if(rk->isInverse || !UA_NodeId_equal(&rk->referenceTypeId, &subtypeId))
+                continue;
+            for(size_t k = 0; k < rk->refTargetsSize; k++) {
+                const UA_ExpandedNodeId *target = &rk->refTargets[k].targetId;
+                if(target->serverIndex != 0 || target->namespaceUri.data != NULL)
+                    continue;
+                int index = addReferenceType(rti, &target->nodeId);
+                if(index < 0) {
+                    UA_NODESTORE_RELEASE(server, node);
+                    UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                                   "More than %u ReferenceTypes. The ReferenceType "
+                                   "hierarchy is not indexed.",
+                                   (unsigned)UA_REFERENCETYPESET_MAX);
+                    referenceTypeIndexClear(server);
+                    rti->state = UA_REFERENCETYPEINDEX_FAILED;
+                    return;
+                }
+                referenceTypeSetAdd(&rti->subtypes[i], (size_t)index);
+            }
+        }
+        UA_NODESTORE_RELEASE(server, node);
+    }
+
+    /* Subtypes are added after their supertype. So the closure is mostly
+     * complete after one pass in reverse order. Repeat until nothing changes
+     * for ReferenceTypes with several supertypes. */
+    UA_Boolean changed = true;
+    while(changed) {
+        changed = false;
+        for(size_t i = rti->refTypesSize; i > 0; i--) {
+            UA_ReferenceTypeSet *set = &rti->subtypes[i-1];
+            for(size_t j = 0; j < rti->refTypesSize; j++) {
+                if(j == i-1 || !referenceTypeSetContains(set, j))
+                    continue;
+                for(size_t w = 0; w < UA_REFERENCETYPESET_MAX / 32; w++) {
+                    UA_UInt32 bits = set->bits[w] | rti->subtypes[j].bits[w];
+                    changed |= (bits != set->bits[w]);
+                    set->bits[w] = bits;
+                }
+            }
+        }
+    }
+}
+
+UA_Boolean
+getReferenceTypeSet(UA_Server *server, const UA_NodeId *refType,
+                    UA_Boolean includeSubtypes, UA_ReferenceTypeSet *set) {
+    UA_ReferenceTypeIndex *rti = &server->referenceTypeIndex;
+    if(rti->state == UA_REFERENCETYPEINDEX_UNBUILT)
+        buildReferenceTypeIndex(server);
+    if(rti->state != UA_REFERENCETYPEINDEX_VALID)
+        return false;
+    UA_Byte *slot = findReferenceTypeSlot(rti, refType);
+    if(*slot == 0)
+        return false;
+    if(includeSubtypes) {
+        *set = rti->subtypes[*slot - 1];
+    } else {
+        memset(set, 0, sizeof(UA_ReferenceTypeSet));
+        referenceTypeSetAdd(set, *slot - 1);
+    }
+    return true;
+}
+
+UA_Boolean
+isReferenceTypeInSet(UA_Server *server, const UA_NodeId *refType,
+                     const UA_ReferenceTypeSet *set) {
+    UA_ReferenceTypeIndex *rti = &server->referenceTypeIndex;
+    UA_Byte *slot = findReferenceTypeSlot(rti, refType);
+    return *slot != 0 && referenceTypeSetContains(set, *slot - 1);
+}
+
+void
+referenceTypeIndexUpdate(UA_Server *server, const UA_Node *node,
+                         const UA_NodeId *referenceTypeId) {
+    if(node->nodeClass == UA_NODECLASS_REFERENCETYPE &&
+       UA_NodeId_equal(referenceTypeId, &subtypeId))
+        server->referenceTypeIndex.state = UA_REFERENCETYPEINDEX_UNBUILT;
+}
+
+void
+UA_ReferenceTypeMatch_init(UA_Server *server, UA_ReferenceTypeMatch *match,
+                           const UA_NodeId *refType, UA_Boolean includeSubtypes) {
+    memset(match, 0, sizeof(UA_ReferenceTypeMatch));
+    if(UA_NodeId_isNull(refType))
+        return;
+    match->refType = refType;
+    match->includeSubtypes = includeSubtypes;
+    if(includeSubtypes)
+        match->indexed = getReferenceTypeSet(server, refType, true, &match->set);
+}
+
+UA_Boolean
+UA_ReferenceTypeMatch_test(UA_Server *server, const UA_ReferenceTypeMatch *match,
+                           const UA_NodeId *refType) {
+    if(!match->refType)
+        return true;
+    if(match->indexed)
+        return isReferenceTypeInSet(server, refType, &match->set);
+    if(UA_NodeId_equal(refType, match->refType))
+        return true;
+    if(!match->includeSubtypes)
+        return false;
+    return isNodeInTree(server, refType, match->refType, &subtypeId, 1);
+}
+
 const UA_Node *
 getNodeType(UA_Server *server, const UA_Node *node) {
     /* The reference to the parent is different for variable and variabletype */
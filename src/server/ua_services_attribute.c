@@ -107,11 +107,50 @@ readIsAbstractAttribute(const UA_Node *node, UA_Variant *v) {
     return UA_Variant_setScalarCopy(v, isAbstract, &UA_TYPES[UA_TYPES_BOOLEAN]);
 }
 
+/* Hold the node until the response is sent and point the DataValue into the
+ * node instead of copying the value. Only values that are costly to copy are
+ * referenced. */
+static UA_Boolean
+readValueNoCopy(UA_Server *server, UA_Session *session,
+                const UA_VariableNode *vn, UA_DataValue *v) {
+    const UA_Variant *value = &vn->value.data.value.value;
+    if(!value->type || (UA_Variant_isScalar(value) && value->type->pointerFree))
+        return false;
+    size_t pinnedSize = session->pinnedNodesSize;
+    if(pinnedSize >= UA_SESSION_MAXPINNEDNODES)
+        return false;
+
+    /* Grow the array in powers of two */
+    if((pinnedSize & (pinnedSize - 1)) == 0) {
+        size_t newSize = (pinnedSize == 0) ? 1 : pinnedSize * 2;
+        const UA_Node **pinned = (const UA_Node**)
+            UA_realloc((void*)session->pinnedNodes, newSize * sizeof(UA_Node*));
+        if(!pinned)
+            return false;
+        session->pinnedNodes = pinned;
+    }
+
+    /* Take an additional reference for the response */
+    const UA_Node *node = UA_NODESTORE_GET(server, &vn->nodeId);
+    if(node != (const UA_Node*)vn) {
+        if(node)
+            UA_NODESTORE_RELEASE(server, node);
+        return false;
+    }
+    session->pinnedNodes[pinnedSize] = node;
+    session->pinnedNodesSize++;
+
+    *v = vn->value.data.value;
+    v->value.storageType = UA_VARIANT_DATA_NODELETE;
+    return true;
+}
+
 static UA_StatusCode
 readValueAttributeFromNode(UA_Server *server, UA_Session *session,
                            const UA_VariableNode *vn, UA_DataValue *v,
-                           UA_NumericRange *rangeptr) {
+                           UA_NumericRange *rangeptr, UA_Boolean noCopy) {
     /* Update the value by the user callback */
+    UA_Boolean updated = false;
     if(vn->value.data.callback.onRead) {
         UA_UNLOCK(server->serviceMutex);
         vn->value.data.callback.onRead(server, &session->sessionId,
@@ -121,28 +160,215 @@ readValueAttributeFromNode(UA_Server *server, UA_Session *session,
         vn = (const UA_VariableNode*)UA_NODESTORE_GET(server, &vn->nodeId);
         if(!vn)
             return UA_STATUSCODE_BADNODEIDUNKNOWN;
+        updated = true;
     }
 
     /* Set the result */
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
     if(rangeptr)
-        return UA_Variant_copyRange(&vn->value.data.value.value, &v->value, *rangeptr);
-    UA_StatusCode retval = UA_DataValue_copy(&vn->value.data.value, v);
+        retval = UA_Variant_copyRange(&vn->value.data.value.value, &v->value, *rangeptr);
+    else if(!noCopy || !readValueNoCopy(server, session, vn, v))
+        retval = UA_DataValue_copy(&vn->value.data.value, v);
 
     /* Clean up */
-    if(vn->value.data.callback.onRead)
+    if(updated)
         UA_NODESTORE_RELEASE(server, (const UA_Node *)vn);
     return retval;
 }
 
+/********************/
+/* DataSource Cache */
+/********************/
+
+#define UA_DATASOURCECACHE_SIZE_MIN 16
+
+static UA_DataSourceCacheEntry **
+dataSourceCacheBucket(UA_DataSourceCacheEntry **table, size_t size,
+                      const UA_NodeId *nodeId) {
+    return &table[UA_NodeId_hash(nodeId) & (size - 1)];
+}
+
+static UA_DataSourceCacheEntry *
+findDataSourceCacheEntry(UA_Server *server, const UA_NodeId *nodeId) {
+    if(server->dataSourceCacheEntries == 0)
+        return NULL;
+    UA_DataSourceCacheEntry *entry =
+        *dataSourceCacheBucket(server->dataSourceCache,
+                               server->dataSourceCacheSize, nodeId);
+    for(; entry; entry = entry->next) {
+        if(UA_NodeId_equal(&entry->nodeId, nodeId))
+            return entry;
+    }
+    return NULL;
+}
+
+/* Make room for one more entry. The hash table is rebuilt with twice the size
+ * once it is fully loaded. */
+static UA_StatusCode
+dataSourceCacheReserve(UA_Server *server) {
+    if(server->dataSourceCacheEntries < server->dataSourceCacheSize)
+        return UA_STATUSCODE_GOOD;
+
+    size_t newSize = server->dataSourceCacheSize * 2;
+    if(newSize < UA_DATASOURCECACHE_SIZE_MIN)
+        newSize = UA_DATASOURCECACHE_SIZE_MIN;
+    UA_DataSourceCacheEntry **table = (UA_DataSourceCacheEntry**)
+        UA_calloc(newSize, sizeof(UA_DataSourceCacheEntry*));
+    if(!table)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    for(size_t i = 0; i < server->dataSourceCacheSize; i++) {
+        UA_DataSourceCacheEntry *entry, *next = server->dataSourceCache[i];
+        while((entry = next)) {
+            next = entry->next;
+            UA_DataSourceCacheEntry **b =
+                dataSourceCacheBucket(table, newSize, &entry->nodeId);
+            entry->next = *b;
+            *b = entry;
+        }
+    }
+    UA_free(server->dataSourceCache);
+    server->dataSourceCache = table;
+    server->dataSourceCacheSize = newSize;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+UA_DataSourceCacheEntry_delete(UA_DataSourceCacheEntry *entry) {
+    UA_NodeId_clear(&entry->nodeId);
+    UA_DataValue_clear(&entry->value);
+    UA_free(entry);
+}
+
+void
+dataSourceCacheInvalidate(UA_Server *server, const UA_NodeId *nodeId) {
+    UA_DataSourceCacheEntry *entry = findDataSourceCacheEntry(server, nodeId);
+    if(!entry)
+        return;
+    UA_DataValue_clear(&entry->value);
+    entry->readTime = 0;
+    entry->generation = ++server->dataSourceCacheGeneration;
+}
+
+void
+dataSourceCacheRemove(UA_Server *server, const UA_NodeId *nodeId) {
+    if(server->dataSourceCacheEntries == 0)
+        return;
+    UA_DataSourceCacheEntry **b =
+        dataSourceCacheBucket(server->dataSourceCache,
+                              server->dataSourceCacheSize, nodeId);
+    for(; *b; b = &(*b)->next) {
+        if(!UA_NodeId_equal(&(*b)->nodeId, nodeId))
+            continue;
+        UA_DataSourceCacheEntry *entry = *b;
+        *b = entry->next;
+        UA_DataSourceCacheEntry_delete(entry);
+        server->dataSourceCacheEntries--;
+        return;
+    }
+}
+
+void
+dataSourceCacheClear(UA_Server *server) {
+    for(size_t i = 0; i < server->dataSourceCacheSize; i++) {
+        UA_DataSourceCacheEntry *entry, *next = server->dataSourceCache[i];
+        while((entry = next)) {
+            next = entry->next;
+            UA_DataSourceCacheEntry_delete(entry);
+        }
+    }
+    UA_free(server->dataSourceCache);
+    server->dataSourceCache = NULL;
+    server->dataSourceCacheSize = 0;
+    server->dataSourceCacheEntries = 0;
+}
+
+static UA_StatusCode
+setDataSourceCache(UA_Server *server, const UA_NodeId *nodeId, UA_Double maxAge) {
+    if(maxAge == 0.0) {
+        dataSourceCacheRemove(server, nodeId);
+        return UA_STATUSCODE_GOOD;
+    }
+
+    UA_DataSourceCacheEntry *entry = findDataSourceCacheEntry(server, nodeId);
+    if(entry) {
+        entry->maxAge = maxAge;
+        return UA_STATUSCODE_GOOD;
+    }
+
+    UA_StatusCode retval = dataSourceCacheReserve(server);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    entry = (UA_DataSourceCacheEntry*)UA_calloc(1, sizeof(UA_DataSourceCacheEntry));
+    if(!entry)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    retval = UA_NodeId_copy(nodeId, &entry->nodeId);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_free(entry);
+        return retval;
+    }
+    entry->maxAge = maxAge;
+    entry->generation = ++server->dataSourceCacheGeneration;
+    UA_DataSourceCacheEntry **b =
+        dataSourceCacheBucket(server->dataSourceCache,
+                              server->dataSourceCacheSize, nodeId);
+    entry->next = *b;
+    *b = entry;
+    server->dataSourceCacheEntries++;
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_Server_setVariableNode_dataSourceCache(UA_Server *server, const UA_NodeId nodeId,
+                                          UA_Double maxAge) {
+    if(!(maxAge >= 0.0)) /* Also catches NaN */
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    UA_LOCK(server->serviceMutex);
+    const UA_Node *node = UA_NODESTORE_GET(server, &nodeId);
+    if(!node) {
+        UA_UNLOCK(server->serviceMutex);
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    }
+    UA_NodeClass nodeClass = node->nodeClass;
+    UA_NODESTORE_RELEASE(server, node);
+    UA_StatusCode retval = UA_STATUSCODE_BADNODECLASSINVALID;
+    if(nodeClass == UA_NODECLASS_VARIABLE)
+        retval = setDataSourceCache(server, &nodeId, maxAge);
+    UA_UNLOCK(server->serviceMutex);
+    return retval;
+}
+
 static UA_StatusCode
 readValueAttributeFromDataSource(UA_Server *server, UA_Session *session,
                                  const UA_VariableNode *vn, UA_DataValue *v,
                                  UA_TimestampsToReturn timestamps,
-                                 UA_NumericRange *rangeptr) {
+                                 UA_NumericRange *rangeptr, UA_Double maxAge) {
     if(!vn->value.dataSource.read)
         return UA_STATUSCODE_BADINTERNALERROR;
     UA_Boolean sourceTimeStamp = (timestamps == UA_TIMESTAMPSTORETURN_SOURCE ||
                                   timestamps == UA_TIMESTAMPSTORETURN_BOTH);
+
+    /* Return the cached value if it is younger than both the configured and
+     * the requested maxAge. Values read with an IndexRange are not cached. */
+    UA_DateTime now = UA_DateTime_now();
+    UA_DataSourceCacheEntry *entry = NULL;
+    UA_UInt64 generation = 0;
+    if(!rangeptr)
+        entry = findDataSourceCacheEntry(server, &vn->nodeId);
+    if(entry) {
+        UA_Double age = (UA_Double)(now - entry->readTime) / UA_DATETIME_MSEC;
+        if(entry->readTime != 0 && age < entry->maxAge && age < maxAge) {
+            UA_atomic_addSize(&server->serverStats.dss.cacheHitCount, 1);
+            UA_StatusCode retval = UA_DataValue_copy(&entry->value, v);
+            v->serverTimestamp = entry->readTime;
+            v->hasServerTimestamp = true;
+            return retval;
+        }
+        UA_atomic_addSize(&server->serverStats.dss.cacheMissCount, 1);
+        sourceTimeStamp = true; /* The cached value can be used for all reads */
+        generation = entry->generation;
+    }
+
     UA_DataValue v2;
     UA_DataValue_init(&v2);
     UA_UNLOCK(server->serviceMutex);
@@ -156,13 +382,30 @@ readValueAttributeFromDataSource(UA_Server *server, UA_Session *session,
     } else {
         *v = v2;
     }
+
+    /* Update the cache. The entry is looked up again, as the cache may have
+     * been changed while the lock was released. The value is dropped if the
+     * entry was invalidated, recreated or updated by a concurrent read in the
+     * meantime. Then the value may be older than the cache content. */
+    if(entry && retval == UA_STATUSCODE_GOOD && v->hasValue &&
+       (!v->hasStatus || v->status == UA_STATUSCODE_GOOD)) {
+        entry = findDataSourceCacheEntry(server, &vn->nodeId);
+        if(entry && entry->generation == generation) {
+            UA_DataValue_clear(&entry->value);
+            entry->readTime = 0;
+            entry->generation = ++server->dataSourceCacheGeneration;
+            if(UA_DataValue_copy(v, &entry->value) == UA_STATUSCODE_GOOD)
+                entry->readTime = now;
+        }
+    }
     return retval;
 }
 
 static UA_StatusCode
 readValueAttributeComplete(UA_Server *server, UA_Session *session,
                            const UA_VariableNode *vn, UA_TimestampsToReturn timestamps,
-                           const UA_String *indexRange, UA_DataValue *v) {
+                           const UA_String *indexRange, UA_Double maxAge,
+                           UA_Boolean noCopy, UA_DataValue *v) {
     /* Compute the index range */
     UA_NumericRange range;
     UA_NumericRange *rangeptr = NULL;
@@ -176,9 +419,10 @@ readValueAttributeComplete(UA_Server *server, UA_Session *session,
 
     /* Read the value */
     if(vn->valueSource == UA_VALUESOURCE_DATA)
-        retval = readValueAttributeFromNode(server, session, vn, v, rangeptr);
+        retval = readValueAttributeFromNode(server, session, vn, v, rangeptr, noCopy);
     else
-        retval = readValueAttributeFromDataSource(server, session, vn, v, timestamps, rangeptr);
+        retval = readValueAttributeFromDataSource(server, session, vn, v, timestamps,
+                                                  rangeptr, maxAge);
 
     /* Clean up */
     if(rangeptr)
@@ -189,7 +433,8 @@ readValueAttributeComplete(UA_Server *server, UA_Session *session,
 UA_StatusCode
 readValueAttribute(UA_Server *server, UA_Session *session,
                    const UA_VariableNode *vn, UA_DataValue *v) {
-    return readValueAttributeComplete(server, session, vn, UA_TIMESTAMPSTORETURN_NEITHER, NULL, v);
+    return readValueAttributeComplete(server, session, vn, UA_TIMESTAMPSTORETURN_NEITHER,
+                                      NULL, 0.0, false, v);
 }
 
 static const UA_String binEncoding = {sizeof("Default Binary")-1, (UA_Byte*)"Default Binary"};
@@ -266,13 +511,13 @@ getStructureDefinition(const UA_DataType *type, UA_StructureDefinition *def) {
 }
 #endif
 
-/* Returns a datavalue that may point into the node via the
- * UA_VARIANT_DATA_NODELETE tag. Don't access the returned DataValue once the
- * node has been released! */
-void
-ReadWithNode(const UA_Node *node, UA_Server *server, UA_Session *session,
-             UA_TimestampsToReturn timestampsToReturn,
-             const UA_ReadValueId *id, UA_DataValue *v) {
+/* With noCopy, the value attribute can point into the node via the
+ * UA_VARIANT_DATA_NODELETE tag. The node is then held by the session until the
+ * response is sent. */
+static void
+readNodeAttribute(const UA_Node *node, UA_Server *server, UA_Session *session,
+                  UA_TimestampsToReturn timestampsToReturn, UA_Double maxAge,
+                  const UA_ReadValueId *id, UA_Boolean noCopy, UA_DataValue *v) {
     UA_LOG_DEBUG_SESSION(&server->config.logger, session,
                          "Read the attribute %" PRIi32, id->attributeId);
 
@@ -368,7 +613,8 @@ ReadWithNode(const UA_Node *node, UA_Server *server, UA_Session *session,
             }
         }
         retval = readValueAttributeComplete(server, session, (const UA_VariableNode*)node,
-                                            timestampsToReturn, &id->indexRange, v);
+                                            timestampsToReturn, &id->indexRange,
+                                            maxAge, noCopy, v);
         break;
     }
     case UA_ATTRIBUTEID_DATATYPE:
@@ -480,15 +726,26 @@ ReadWithNode(const UA_Node *node, UA_Server *server, UA_Session *session,
     }
 }
 
+/* Returns a datavalue that may point into the node via the
+ * UA_VARIANT_DATA_NODELETE tag. Don't access the returned DataValue once the
+ * node has been released! */
+void
+ReadWithNode(const UA_Node *node, UA_Server *server, UA_Session *session,
+             UA_TimestampsToReturn timestampsToReturn, UA_Double maxAge,
+             const UA_ReadValueId *id, UA_DataValue *v) {
+    readNodeAttribute(node, server, session, timestampsToReturn, maxAge, id, false, v);
+}
+
 static void
-Operation_Read(UA_Server *server, UA_Session *session, UA_ReadRequest *request,
-               UA_ReadValueId *rvi, UA_DataValue *result) {
+readOperation(UA_Server *server, UA_Session *session, UA_ReadRequest *request,
+              UA_ReadValueId *rvi, UA_Boolean noCopy, UA_DataValue *result) {
     /* Get the node */
     const UA_Node *node = UA_NODESTORE_GET(server, &rvi->nodeId);
 
     /* Perform the read operation */
     if(node) {
-        ReadWithNode(node, server, session, request->timestampsToReturn, rvi, result);
+        readNodeAttribute(node, server, session, request->timestampsToReturn,
+                          request->maxAge, rvi, noCopy, result);
         UA_NODESTORE_RELEASE(server, node);
     } else {
         result->hasStatus = true;
@@ -496,6 +753,22 @@ Operation_Read(UA_Server *server, UA_Session *session, UA_ReadRequest *request,
     }
 }
 
+static void
+Operation_Read(UA_Server *server, UA_Session *session, UA_ReadRequest *request,
+               UA_ReadValueId *rvi, UA_DataValue *result) {
+    readOperation(server, session, request, rvi, false, result);
+}
+
+#ifdef UA_READNOCOPY
+
+static void
+Operation_ReadNoCopy(UA_Server *server, UA_Session *session, UA_ReadRequest *request,
+                     UA_ReadValueId *rvi, UA_DataValue *result) {
+    readOperation(server, session, request, rvi, true, result);
+}
+
+#endif
+
 void
 Service_Read(UA_Server *server, UA_Session *session,
              const UA_ReadRequest *request, UA_ReadResponse *response) {
@@ -523,8 +796,16 @@ Service_Read(UA_Server *server, UA_Session *session,
 
     UA_LOCK_ASSERT(server->serviceMutex, 1);
 
+    /* Point into the nodes for remote sessions. The nodes are released after
+     * the response was sent. */
+    UA_ServiceOperation operation = (UA_ServiceOperation)Operation_Read;
+#ifdef UA_READNOCOPY
+    if(server->config.readNoCopy && session != &server->adminSession)
+        operation = (UA_ServiceOperation)Operation_ReadNoCopy;
+#endif
+
     response->responseHeader.serviceResult =
-        UA_Server_processServiceOperations(server, session, (UA_ServiceOperation)Operation_Read,
+        UA_Server_processServiceOperations(server, session, operation,
                                            request,
                                            &request->nodesToReadSize, &UA_TYPES[UA_TYPES_READVALUEID],
                                            &response->resultsSize, &UA_TYPES[UA_TYPES_DATAVALUE]);
@@ -546,7 +827,7 @@ UA_Server_readWithSession(UA_Server *server, UA_Session *session,
     }
 
     /* Perform the read operation */
-    ReadWithNode(node, server, session, timestampsToReturn, item, &dv);
+    ReadWithNode(node, server, session, timestampsToReturn, 0.0, item, &dv);
 
     /* Release the node and return */
     UA_NODESTORE_RELEASE(server, node);
@@ -1237,6 +1518,7 @@ writeValueAttribute(UA_Server *server, UA_Session *session,
                 write(server, &session->sessionId, session->sessionHandle,
                       &node->nodeId, node->context, rangeptr, &adjustedValue);
             UA_LOCK(server->serviceMutex);
+            dataSourceCacheInvalidate(server, &node->nodeId);
         } else {
             retval = UA_STATUSCODE_BADWRITENOTSUPPORTED;
         }
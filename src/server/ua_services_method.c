@@ -340,8 +340,8 @@ Operation_CallMethodAsync(UA_Server *server, UA_Session *session, UA_UInt32 requ
 
     /* Create the Async Request to be taken by workers */
     opResult->statusCode =
-        UA_AsyncManager_createAsyncOp(&server->asyncManager,
-                                      server, *ar, opIndex, opRequest);
+        UA_AsyncManager_createAsyncOp(&server->asyncManager, server, *ar,
+                                      opIndex, opRequest, method->asyncPriority);
 
  cleanup:
     /* Release the method and object node */
@@ -386,7 +386,7 @@ Service_CallAsync(UA_Server *server, UA_Session *session, UA_UInt32 requestId,
 }
 #endif
 
-static void
+void
 Operation_CallMethod(UA_Server *server, UA_Session *session, void *context,
                      const UA_CallMethodRequest *request, UA_CallMethodResult *result) {
     /* Get the method node */
@@ -141,8 +141,7 @@ setMonitoredItemSettings(UA_Server *server, UA_Session *session, UA_MonitoredIte
     UA_MonitoredItem_unregisterSampleCallback(server, mon);
 
     /* Remove the old samples */
-    UA_ByteString_clear(&mon->lastSampledValue);
-    UA_Variant_clear(&mon->lastValue);
+    UA_LastSample_clear(&mon->lastSample);
 
     /* ClientHandle */
     mon->clientHandle = params->clientHandle;
@@ -290,7 +289,12 @@ Operation_CreateMonitoredItem(UA_Server *server, UA_Session *session, struct cre
     /* Add to the subscriptions or the local MonitoredItems */
     if(cmc->sub) {
         newMon->monitoredItemId = ++cmc->sub->lastMonitoredItemId;
-        UA_Subscription_addMonitoredItem(server, cmc->sub, newMon);
+        retval = UA_Subscription_addMonitoredItem(server, cmc->sub, newMon);
+        if(retval != UA_STATUSCODE_GOOD) {
+            result->statusCode = retval;
+            UA_MonitoredItem_delete(server, newMon);
+            return;
+        }
 #ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
         if(newMon->attributeId == UA_ATTRIBUTEID_EVENTNOTIFIER) {
             /* Insert the monitored item into the node's queue */
@@ -540,9 +544,8 @@ Operation_SetMonitoringMode(UA_Server *server, UA_Session *session,
             UA_Notification_delete(notification);
         }
 
-        /* Initialize lastSampledValue */
-        UA_ByteString_clear(&mon->lastSampledValue);
-        UA_Variant_clear(&mon->lastValue);
+        /* Initialize the last sample */
+        UA_LastSample_clear(&mon->lastSample);
     }
 }
 
@@ -1575,6 +1575,8 @@ recursiveDeleteNode(UA_Server *server, UA_Session *session,
     if(removeTargetRefs)
         removeIncomingReferences(server, session, node);
 
+    dataSourceCacheRemove(server, &node->nodeId);
+    typeHierarchyCacheRemove(server, node);
     UA_NODESTORE_REMOVE(server, &node->nodeId);
 }
 
@@ -1688,12 +1690,20 @@ struct AddNodeInfo {
 static UA_StatusCode
 addOneWayReference(UA_Server *server, UA_Session *session,
                    UA_Node *node, const struct AddNodeInfo *info) {
+    server->referenceVersion++;
+    referenceTypeIndexUpdate(server, node, &info->item->referenceTypeId);
+    typeHierarchyCacheUpdate(server, node, &info->item->referenceTypeId,
+                             info->item->isForward, &info->item->targetNodeId.nodeId);
     return UA_Node_addReference(node, info->item, info->browseNameHash);
 }
 
 static UA_StatusCode
 deleteOneWayReference(UA_Server *server, UA_Session *session, UA_Node *node,
                       const UA_DeleteReferencesItem *item) {
+    server->referenceVersion++;
+    referenceTypeIndexUpdate(server, node, &item->referenceTypeId);
+    typeHierarchyCacheUpdate(server, node, &item->referenceTypeId,
+                             item->isForward, &item->targetNodeId.nodeId);
     return UA_Node_deleteReference(node, item);
 }
 
@@ -2022,6 +2032,7 @@ UA_Server_setVariableNode_dataSource(UA_Server *server, const UA_NodeId nodeId,
                                      const UA_DataSource dataSource) {
     UA_LOCK(server->serviceMutex);
     UA_StatusCode retval = setVariableNode_dataSource(server, nodeId, dataSource);
+    dataSourceCacheInvalidate(server, &nodeId);
     UA_UNLOCK(server->serviceMutex);
     return retval;
 }
@@ -16,6 +16,175 @@
 #include "ua_services.h"
 #include "ua_server_internal.h"
 
+/*****************/
+/* Session Index */
+/*****************/
+
+/* The sessions are indexed by their authentication token and SessionId in two
+ * chained hash tables. The buckets are indexed with the NodeId hash. A min-heap
+ * orders the sessions by their timeout. The heap key is only a lower bound for
+ * the actual timeout, as the lifetime of a session is extended with every
+ * request. The heap is corrected lazily during the cleanup. */
+
+#define UA_SESSIONS_HASHSIZE_MIN 16
+
+static session_list_entry **
+sessionBucket(session_list_entry **table, size_t size, const UA_NodeId *id) {
+    return &table[UA_NodeId_hash(id) & (size - 1)];
+}
+
+static void
+sessionHashInsert(UA_Server *server, session_list_entry *sentry) {
+    session_list_entry **b =
+        sessionBucket(server->sessionsByToken, server->sessionsHashSize,
+                      &sentry->session.header.authenticationToken);
+    sentry->nextByToken = *b;
+    *b = sentry;
+    b = sessionBucket(server->sessionsById, server->sessionsHashSize,
+                      &sentry->session.sessionId);
+    sentry->nextById = *b;
+    *b = sentry;
+}
+
+static void
+sessionHashRemove(UA_Server *server, session_list_entry *sentry) {
+    session_list_entry **b =
+        sessionBucket(server->sessionsByToken, server->sessionsHashSize,
+                      &sentry->session.header.authenticationToken);
+    while(*b != sentry)
+        b = &(*b)->nextByToken;
+    *b = sentry->nextByToken;
+    b = sessionBucket(server->sessionsById, server->sessionsHashSize,
+                      &sentry->session.sessionId);
+    while(*b != sentry)
+        b = &(*b)->nextById;
+    *b = sentry->nextById;
+}
+
+static void
+sessionHeapSet(UA_Server *server, size_t index, session_list_entry *sentry) {
+    server->sessionTimeouts[index] = sentry;
+    sentry->timeoutIndex = index;
+}
+
+static void
+sessionHeapUp(UA_Server *server, size_t index) {
+    session_list_entry *sentry = server->sessionTimeouts[index];
+    while(index > 0) {
+        size_t parent = (index - 1) / 2;
+        session_list_entry *p = server->sessionTimeouts[parent];
+        if(p->timeoutKey <= sentry->timeoutKey)
+            break;
+        sessionHeapSet(server, index, p);
+        index = parent;
+    }
+    sessionHeapSet(server, index, sentry);
+}
+
+static void
+sessionHeapDown(UA_Server *server, size_t index) {
+    session_list_entry *sentry = server->sessionTimeouts[index];
+    size_t size = server->sessionTimeoutsSize;
+    while(true) {
+        size_t child = (2 * index) + 1;
+        if(child >= size)
+            break;
+        if(child + 1 < size && server->sessionTimeouts[child + 1]->timeoutKey <
+           server->sessionTimeouts[child]->timeoutKey)
+            child++;
+        session_list_entry *c = server->sessionTimeouts[child];
+        if(sentry->timeoutKey <= c->timeoutKey)
+            break;
+        sessionHeapSet(server, index, c);
+        index = child;
+    }
+    sessionHeapSet(server, index, sentry);
+}
+
+static void
+sessionHeapRemove(UA_Server *server, session_list_entry *sentry) {
+    size_t index = sentry->timeoutIndex;
+    server->sessionTimeoutsSize--;
+    if(index == server->sessionTimeoutsSize)
+        return;
+    sessionHeapSet(server, index, server->sessionTimeouts[server->sessionTimeoutsSize]);
+    sessionHeapUp(server, index);
+    sessionHeapDown(server, server->sessionTimeouts[index]->timeoutIndex);
+}
+
+/* Make room for one more session in the index. The hash tables are rebuilt
+ * with twice the size once they are fully loaded. */
+static UA_StatusCode
+sessionIndexReserve(UA_Server *server) {
+    if(server->sessionTimeoutsSize < server->sessionsHashSize)
+        return UA_STATUSCODE_GOOD;
+
+    size_t newSize = server->sessionsHashSize * 2;
+    if(newSize < UA_SESSIONS_HASHSIZE_MIN)
+        newSize = UA_SESSIONS_HASHSIZE_MIN;
+    session_list_entry **byToken = (session_list_entry**)
+        UA_calloc(newSize, sizeof(session_list_entry*));
+    session_list_entry **byId = (session_list_entry**)
+        UA_calloc(newSize, sizeof(session_list_entry*));
+    session_list_entry **timeouts = (session_list_entry**)
+        UA_realloc(server->sessionTimeouts, newSize * sizeof(session_list_entry*));
+    if(timeouts)
+        server->sessionTimeouts = timeouts;
+    if(!byToken || !byId || !timeouts) {
+        UA_free(byToken);
+        UA_free(byId);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+
+    UA_free(server->sessionsByToken);
+    UA_free(server->sessionsById);
+    server->sessionsByToken = byToken;
+    server->sessionsById = byId;
+    server->sessionsHashSize = newSize;
+    session_list_entry *sentry;
+    LIST_FOREACH(sentry, &server->sessions, pointers)
+        sessionHashInsert(server, sentry);
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_Server_deleteSessionIndex(UA_Server *server) {
+    UA_free(server->sessionsByToken);
+    UA_free(server->sessionsById);
+    UA_free(server->sessionTimeouts);
+    server->sessionsByToken = NULL;
+    server->sessionsById = NULL;
+    server->sessionTimeouts = NULL;
+    server->sessionTimeoutsSize = 0;
+    server->sessionsHashSize = 0;
+}
+
+static session_list_entry *
+findSessionByToken(UA_Server *server, const UA_NodeId *token) {
+    if(server->sessionsHashSize == 0)
+        return NULL;
+    session_list_entry *sentry =
+        *sessionBucket(server->sessionsByToken, server->sessionsHashSize, token);
+    for(; sentry; sentry = sentry->nextByToken) {
+        if(UA_NodeId_equal(&sentry->session.header.authenticationToken, token))
+            return sentry;
+    }
+    return NULL;
+}
+
+static session_list_entry *
+findSessionById(UA_Server *server, const UA_NodeId *sessionId) {
+    if(server->sessionsHashSize == 0)
+        return NULL;
+    session_list_entry *sentry =
+        *sessionBucket(server->sessionsById, server->sessionsHashSize, sessionId);
+    for(; sentry; sentry = sentry->nextById) {
+        if(UA_NodeId_equal(&sentry->session.sessionId, sessionId))
+            return sentry;
+    }
+    return NULL;
+}
+
 /* Delayed callback to free the session memory */
 static void
 removeSessionCallback(UA_Server *server, session_list_entry *entry) {
@@ -62,6 +231,8 @@ UA_Server_removeSession(UA_Server *server, session_list_entry *sentry,
     /* Detach the session from the session manager and make the capacity
      * available */
     LIST_REMOVE(sentry, pointers);
+    sessionHashRemove(server, sentry);
+    sessionHeapRemove(server, sentry);
     UA_atomic_subUInt32(&server->sessionCount, 1);
     UA_atomic_subSize(&server->serverStats.ss.currentSessionCount, 1);
 
@@ -98,24 +269,30 @@ UA_StatusCode
 UA_Server_removeSessionByToken(UA_Server *server, const UA_NodeId *token,
                                UA_DiagnosticEvent event) {
     UA_LOCK_ASSERT(server->serviceMutex, 1);
-    session_list_entry *entry;
-    LIST_FOREACH(entry, &server->sessions, pointers) {
-        if(UA_NodeId_equal(&entry->session.header.authenticationToken, token)) {
-            UA_Server_removeSession(server, entry, event);
-            return UA_STATUSCODE_GOOD;
-        }
-    }
-    return UA_STATUSCODE_BADSESSIONIDINVALID;
+    session_list_entry *entry = findSessionByToken(server, token);
+    if(!entry)
+        return UA_STATUSCODE_BADSESSIONIDINVALID;
+    UA_Server_removeSession(server, entry, event);
+    return UA_STATUSCODE_GOOD;
 }
 
 void
 UA_Server_cleanupSessions(UA_Server *server, UA_DateTime nowMonotonic) {
     UA_LOCK_ASSERT(server->serviceMutex, 1);
-    session_list_entry *sentry, *temp;
-    LIST_FOREACH_SAFE(sentry, &server->sessions, pointers, temp) {
-        /* Session has timed out? */
-        if(sentry->session.validTill >= nowMonotonic)
+    while(server->sessionTimeoutsSize > 0) {
+        /* No session with an earlier timeout */
+        session_list_entry *sentry = server->sessionTimeouts[0];
+        if(sentry->timeoutKey >= nowMonotonic)
+            break;
+
+        /* The lifetime was extended in the meantime. Sort back in. */
+        if(sentry->session.validTill >= nowMonotonic) {
+            sentry->timeoutKey = sentry->session.validTill;
+            sessionHeapDown(server, 0);
             continue;
+        }
+
+        /* Session has timed out */
         UA_LOG_INFO_SESSION(&server->config.logger, &sentry->session, "Session has timed out");
         UA_Server_removeSession(server, sentry, UA_DIAGNOSTICEVENT_TIMEOUT);
     }
@@ -129,46 +306,36 @@ UA_Session *
 getSessionByToken(UA_Server *server, const UA_NodeId *token) {
     UA_LOCK_ASSERT(server->serviceMutex, 1);
 
-    session_list_entry *current = NULL;
-    LIST_FOREACH(current, &server->sessions, pointers) {
-        /* Token does not match */
-        if(!UA_NodeId_equal(&current->session.header.authenticationToken, token))
-            continue;
-
-        /* Session has timed out */
-        if(UA_DateTime_nowMonotonic() > current->session.validTill) {
-            UA_LOG_INFO_SESSION(&server->config.logger, &current->session,
-                                "Client tries to use a session that has timed out");
-            return NULL;
-        }
+    session_list_entry *current = findSessionByToken(server, token);
+    if(!current)
+        return NULL;
 
-        return &current->session;
+    /* Session has timed out */
+    if(UA_DateTime_nowMonotonic() > current->session.validTill) {
+        UA_LOG_INFO_SESSION(&server->config.logger, &current->session,
+                            "Client tries to use a session that has timed out");
+        return NULL;
     }
 
-    return NULL;
+    return &current->session;
 }
 
 UA_Session *
 UA_Server_getSessionById(UA_Server *server, const UA_NodeId *sessionId) {
     UA_LOCK_ASSERT(server->serviceMutex, 1);
 
-    session_list_entry *current = NULL;
-    LIST_FOREACH(current, &server->sessions, pointers) {
-        /* Token does not match */
-        if(!UA_NodeId_equal(&current->session.sessionId, sessionId))
-            continue;
-
-        /* Session has timed out */
-        if(UA_DateTime_nowMonotonic() > current->session.validTill) {
-            UA_LOG_INFO_SESSION(&server->config.logger, &current->session,
-                                "Client tries to use a session that has timed out");
-            return NULL;
-        }
+    session_list_entry *current = findSessionById(server, sessionId);
+    if(!current)
+        return NULL;
 
-        return &current->session;
+    /* Session has timed out */
+    if(UA_DateTime_nowMonotonic() > current->session.validTill) {
+        UA_LOG_INFO_SESSION(&server->config.logger, &current->session,
+                            "Client tries to use a session that has timed out");
+        return NULL;
     }
 
-    return NULL;
+    return &current->session;
 }
 
 static UA_StatusCode
@@ -219,6 +386,9 @@ UA_Server_createSession(UA_Server *server, UA_SecureChannel *channel,
     if(server->sessionCount >= server->config.maxSessions)
         return UA_STATUSCODE_BADTOOMANYSESSIONS;
 
+    if(sessionIndexReserve(server) != UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
     session_list_entry *newentry = (session_list_entry *)UA_malloc(sizeof(session_list_entry));
     if(!newentry)
         return UA_STATUSCODE_BADOUTOFMEMORY;
@@ -240,6 +410,11 @@ UA_Server_createSession(UA_Server *server, UA_SecureChannel *channel,
     UA_Session_updateLifetime(&newentry->session);
 
     LIST_INSERT_HEAD(&server->sessions, newentry, pointers);
+    sessionHashInsert(server, newentry);
+    newentry->timeoutKey = newentry->session.validTill;
+    sessionHeapSet(server, server->sessionTimeoutsSize, newentry);
+    server->sessionTimeoutsSize++;
+    sessionHeapUp(server, newentry->timeoutIndex);
     *session = &newentry->session;
     return UA_STATUSCODE_GOOD;
 }
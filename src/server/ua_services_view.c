@@ -153,11 +153,16 @@ RefTree_add(RefTree *rt, const UA_ExpandedNodeId *target) {
     return UA_STATUSCODE_GOOD;
 }
 
+/* Test against the list of ReferenceTypes or against the set if all of them
+ * are indexed */
 static UA_Boolean
-relevantReference(const UA_NodeId *refType, size_t relevantRefsSize,
-                  const UA_NodeId *relevantRefs) {
+relevantReference(UA_Server *server, const UA_NodeId *refType,
+                  size_t relevantRefsSize, const UA_NodeId *relevantRefs,
+                  const UA_ReferenceTypeSet *relevantSet) {
     if(!relevantRefs)
         return true;
+    if(relevantSet)
+        return isReferenceTypeInSet(server, refType, relevantSet);
     for(size_t i = 0; i < relevantRefsSize; i++) {
         if(UA_NodeId_equal(refType, &relevantRefs[i]))
             return true;
@@ -168,6 +173,7 @@ relevantReference(const UA_NodeId *refType, size_t relevantRefsSize,
 static UA_StatusCode
 addRelevantReferences(UA_Server *server, RefTree *rt, const UA_NodeId *nodeId,
                       size_t refTypesSize, const UA_NodeId *refTypes,
+                      const UA_ReferenceTypeSet *refTypesSet,
                       UA_BrowseDirection browseDirection) {
     const UA_Node *node = UA_NODESTORE_GET(server, nodeId);
     if(!node)
@@ -184,7 +190,8 @@ addRelevantReferences(UA_Server *server, RefTree *rt, const UA_NodeId *nodeId,
             continue;
 
         /* Is the reference part of the hierarchy of references we look for? */
-        if(!relevantReference(&rk->referenceTypeId, refTypesSize, refTypes))
+        if(!relevantReference(server, &rk->referenceTypeId, refTypesSize,
+                              refTypes, refTypesSet))
             continue;
 
         for(size_t k = 0; k < rk->refTargetsSize; k++) {
@@ -205,6 +212,22 @@ browseRecursive(UA_Server *server,
                 size_t refTypesSize, const UA_NodeId *refTypes,
                 UA_BrowseDirection browseDirection, UA_Boolean includeStartNodes,
                 size_t *resultsSize, UA_ExpandedNodeId **results) {
+    /* Convert the list of ReferenceTypes to a set if all are indexed */
+    UA_ReferenceTypeSet set, *refTypesSet = NULL;
+    if(refTypes) {
+        refTypesSet = &set;
+        memset(&set, 0, sizeof(UA_ReferenceTypeSet));
+        for(size_t i = 0; i < refTypesSize; i++) {
+            UA_ReferenceTypeSet single;
+            if(!getReferenceTypeSet(server, &refTypes[i], false, &single)) {
+                refTypesSet = NULL;
+                break;
+            }
+            for(size_t j = 0; j < UA_REFERENCETYPESET_MAX / 32; j++)
+                set.bits[j] |= single.bits[j];
+        }
+    }
+
     RefTree rt;
     UA_StatusCode retval = RefTree_init(&rt);
     if(retval != UA_STATUSCODE_GOOD)
@@ -217,8 +240,8 @@ browseRecursive(UA_Server *server,
             en.nodeId = startNodes[i];
             retval = RefTree_add(&rt, &en);
         } else {
-            retval = addRelevantReferences(server, &rt, &startNodes[i],
-                                           refTypesSize, refTypes, browseDirection);
+            retval = addRelevantReferences(server, &rt, &startNodes[i], refTypesSize,
+                                           refTypes, refTypesSet, browseDirection);
         }
     }
     if(retval != UA_STATUSCODE_GOOD) {
@@ -235,8 +258,8 @@ browseRecursive(UA_Server *server,
         if(rt.targets[i].namespaceUri.data != NULL)
             continue;
 
-        retval = addRelevantReferences(server, &rt, &rt.targets[i].nodeId,
-                                       refTypesSize, refTypes, browseDirection);
+        retval = addRelevantReferences(server, &rt, &rt.targets[i].nodeId, refTypesSize,
+                                       refTypes, refTypesSet, browseDirection);
         if(retval != UA_STATUSCODE_GOOD) {
             RefTree_clear(&rt);
             return retval;
@@ -261,6 +284,28 @@ referenceSubtypes(UA_Server *server, const UA_NodeId *refType,
     if(UA_NodeId_isNull(refType))
         return UA_STATUSCODE_GOOD;
 
+    /* Take the subtypes from the index */
+    UA_ReferenceTypeSet set;
+    if(getReferenceTypeSet(server, refType, true, &set)) {
+        const UA_ReferenceTypeIndex *rti = &server->referenceTypeIndex;
+        size_t setSize = 0;
+        for(size_t i = 0; i < rti->refTypesSize; i++)
+            setSize += isReferenceTypeInSet(server, &rti->refTypes[i], &set);
+        UA_NodeId *newRefTypes = (UA_NodeId*)
+            UA_realloc(*refTypes, (*refTypesSize + setSize) * sizeof(UA_NodeId));
+        if(!newRefTypes)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        *refTypes = newRefTypes;
+        UA_StatusCode retval = UA_STATUSCODE_GOOD;
+        for(size_t i = 0; i < rti->refTypesSize; i++) {
+            if(!isReferenceTypeInSet(server, &rti->refTypes[i], &set))
+                continue;
+            retval |= UA_NodeId_copy(&rti->refTypes[i], &newRefTypes[*refTypesSize]);
+            (*refTypesSize)++;
+        }
+        return retval;
+    }
+
     /* Browse recursive for the hierarchy of sub-references */
     UA_ExpandedNodeId *rt = NULL;
     size_t rtSize = 0;
@@ -379,9 +424,6 @@ struct ContinuationPoint {
     UA_BrowseDescription browseDescription;
     UA_UInt32 maxReferences;
 
-    size_t relevantReferencesSize;
-    UA_NodeId *relevantReferences;
-
     /* The last point in the node references? */
     size_t referenceKindIndex;
     size_t targetIndex;
@@ -391,8 +433,6 @@ ContinuationPoint *
 ContinuationPoint_clear(ContinuationPoint *cp) {
     UA_ByteString_clear(&cp->identifier);
     UA_BrowseDescription_clear(&cp->browseDescription);
-    UA_Array_delete(cp->relevantReferences, cp->relevantReferencesSize,
-                    &UA_TYPES[UA_TYPES_NODEID]);
     return cp->next;
 }
 
@@ -466,6 +506,12 @@ browseReferences(UA_Server *server, const UA_Node *node,
     size_t referenceKindIndex = cp->referenceKindIndex;
     size_t targetIndex = cp->targetIndex;
 
+    /* Resolve the relevant ReferenceTypes. This is not stored in the
+     * ContinuationPoint, as the hierarchy can change before BrowseNext. */
+    UA_ReferenceTypeMatch relevant;
+    UA_ReferenceTypeMatch_init(server, &relevant, &bd->referenceTypeId,
+                               bd->includeSubtypes);
+
     /* Loop over the node's references */
     const UA_Node *target = NULL;
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
@@ -479,8 +525,7 @@ browseReferences(UA_Server *server, const UA_Node *node,
             continue;
 
         /* Is the reference part of the hierarchy of references we look for? */
-        if(!relevantReference(&rk->referenceTypeId, cp->relevantReferencesSize,
-                              cp->relevantReferences))
+        if(!UA_ReferenceTypeMatch_test(server, &relevant, &rk->referenceTypeId))
             continue;
 
         /* Loop over the targets */
@@ -628,29 +673,11 @@ Operation_Browse(UA_Server *server, UA_Session *session, const UA_UInt32 *maxref
         }
     }
 
-    /* Get the list of relevant reference types */
-    if(!UA_NodeId_isNull(&descr->referenceTypeId)) {
-        if(!descr->includeSubtypes) {
-            cp->relevantReferences = (UA_NodeId*)(uintptr_t)&descr->referenceTypeId;
-            cp->relevantReferencesSize = 1;
-        } else {
-            result->statusCode =
-                referenceSubtypes(server, &descr->referenceTypeId,
-                                  &cp->relevantReferencesSize, &cp->relevantReferences);
-            if(result->statusCode != UA_STATUSCODE_GOOD)
-                return;
-        }
-    }
-
     UA_Boolean done = browseWithContinuation(server, session, cp, result);
 
     /* Exit early if done or an error occurred */
-    if(done || result->statusCode != UA_STATUSCODE_GOOD) {
-        if(descr->includeSubtypes)
-            UA_Array_delete(cp->relevantReferences, cp->relevantReferencesSize,
-                            &UA_TYPES[UA_TYPES_NODEID]);
+    if(done || result->statusCode != UA_STATUSCODE_GOOD)
         return;
-    }
 
     /* Persist the new continuation point */
 
@@ -675,17 +702,6 @@ Operation_Browse(UA_Server *server, UA_Session *session, const UA_UInt32 *maxref
     cp2->targetIndex = cp->targetIndex;
     cp2->maxReferences = cp->maxReferences;
 
-    if(descr->includeSubtypes) {
-        cp2->relevantReferences = cp->relevantReferences;
-        cp2->relevantReferencesSize = cp->relevantReferencesSize;
-    } else {
-        retval = UA_Array_copy(cp->relevantReferences, cp->relevantReferencesSize,
-                               (void**)&cp2->relevantReferences, &UA_TYPES[UA_TYPES_NODEID]);
-        if(retval != UA_STATUSCODE_GOOD)
-            goto cleanup;
-        cp2->relevantReferencesSize = cp->relevantReferencesSize;
-    }
-
     /* Copy the description */
     retval = UA_BrowseDescription_copy(descr, &cp2->browseDescription);
     if(retval != UA_STATUSCODE_GOOD)
@@ -865,6 +881,10 @@ walkBrowsePathElement(UA_Server *server, UA_Session *session,
             return UA_STATUSCODE_BADNOMATCH;
     }
 
+    UA_ReferenceTypeMatch refTypeMatch;
+    UA_ReferenceTypeMatch_init(server, &refTypeMatch, &elem->referenceTypeId,
+                               elem->includeSubtypes);
+
     /* Loop over all Nodes int the current depth level */
     UA_StatusCode res = UA_STATUSCODE_GOOD;
     for(size_t i = 0; i < current->size; i++) {
@@ -915,18 +935,8 @@ walkBrowsePathElement(UA_Server *server, UA_Session *session,
                 continue;
 
             /* Does the reference type match? */
-            if(!all_refs) {
-                if(!elem->includeSubtypes) {
-                    if(!UA_NodeId_equal(&rk->referenceTypeId, &elem->referenceTypeId))
-                        continue;
-                } else {
-                    UA_Boolean match =
-                        isNodeInTree(server, &rk->referenceTypeId,
-                                     &elem->referenceTypeId, &subtypeId, 1);
-                    if(!match)
-                        continue;
-                }
-            }
+            if(!UA_ReferenceTypeMatch_test(server, &refTypeMatch, &rk->referenceTypeId))
+                continue;
 
             /* Retrieve by BrowseName hash */
             UA_ReferenceTarget *rt = ZIP_FIND(UA_ReferenceTargetNameTree,
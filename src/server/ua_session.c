@@ -38,6 +38,11 @@ void UA_Session_deleteMembersCleanup(UA_Session *session, UA_Server* server) {
     }
     session->continuationPoints = NULL;
     session->availableContinuationPoints = UA_MAXCONTINUATIONPOINTS;
+    for(size_t i = 0; i < session->pinnedNodesSize; i++)
+        UA_NODESTORE_RELEASE(server, session->pinnedNodes[i]);
+    UA_free(session->pinnedNodes);
+    session->pinnedNodes = NULL;
+    session->pinnedNodesSize = 0;
 }
 
 void
@@ -9,6 +9,7 @@
 #ifndef UA_SESSION_H_
 #define UA_SESSION_H_
 
+#include <open62541/plugin/nodestore.h>
 #include <open62541/util.h>
 
 #include "ua_securechannel.h"
@@ -17,6 +18,10 @@ _UA_BEGIN_DECLS
 
 #define UA_MAXCONTINUATIONPOINTS 5
 
+/* Maximum number of nodes a single Read response can point into. Further
+ * values are copied. */
+#define UA_SESSION_MAXPINNEDNODES 1024
+
 struct ContinuationPoint;
 typedef struct ContinuationPoint ContinuationPoint;
 
@@ -49,6 +54,9 @@ typedef struct {
     UA_ByteString     serverNonce;
     UA_UInt16 availableContinuationPoints;
     ContinuationPoint *continuationPoints;
+    /* Nodes held until the current response is sent (see readNoCopy) */
+    const UA_Node **pinnedNodes;
+    size_t pinnedNodesSize;
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     UA_UInt32 lastSubscriptionId;
     UA_UInt32 lastSeenSubscriptionId;
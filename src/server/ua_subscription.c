@@ -37,6 +37,8 @@ UA_Subscription_new(UA_Session *session, UA_UInt32 subscriptionId) {
     /* Even if the first publish response is a keepalive the sequence number is 1.
      * This can happen by a subscription without a monitored item (see CTT test scripts). */
     newSub->nextSequenceNumber = 1;
+    UA_IdIndex_init(&newSub->monitoredItemsIndex,
+                    offsetof(UA_MonitoredItem, monitoredItemId));
     TAILQ_INIT(&newSub->retransmissionQueue);
     TAILQ_INIT(&newSub->notificationQueue);
     return newSub;
@@ -61,6 +63,7 @@ UA_Subscription_deleteMembers(UA_Server *server, UA_Subscription *sub) {
     UA_assert(server->numMonitoredItems >= sub->monitoredItemsSize);
     server->numMonitoredItems -= sub->monitoredItemsSize;
     sub->monitoredItemsSize = 0;
+    UA_IdIndex_clear(&sub->monitoredItemsIndex);
 
     /* Delete Retransmission Queue */
     UA_NotificationMessageEntry *nme, *nme_tmp;
@@ -80,12 +83,8 @@ UA_Subscription_deleteMembers(UA_Server *server, UA_Subscription *sub) {
 
 UA_MonitoredItem *
 UA_Subscription_getMonitoredItem(UA_Subscription *sub, UA_UInt32 monitoredItemId) {
-    UA_MonitoredItem *mon;
-    LIST_FOREACH(mon, &sub->monitoredItems, listEntry) {
-        if(mon->monitoredItemId == monitoredItemId)
-            break;
-    }
-    return mon;
+    return (UA_MonitoredItem*)
+        UA_IdIndex_find(&sub->monitoredItemsIndex, monitoredItemId);
 }
 
 UA_StatusCode
@@ -94,11 +93,7 @@ UA_Subscription_deleteMonitoredItem(UA_Server *server, UA_Subscription *sub,
     UA_LOCK_ASSERT(server->serviceMutex, 1);
 
     /* Find the MonitoredItem */
-    UA_MonitoredItem *mon;
-    LIST_FOREACH(mon, &sub->monitoredItems, listEntry) {
-        if(mon->monitoredItemId == monitoredItemId)
-            break;
-    }
+    UA_MonitoredItem *mon = UA_Subscription_getMonitoredItem(sub, monitoredItemId);
     if(!mon)
         return UA_STATUSCODE_BADMONITOREDITEMIDINVALID;
 
@@ -108,6 +103,7 @@ UA_Subscription_deleteMonitoredItem(UA_Server *server, UA_Subscription *sub,
                         mon->monitoredItemId);
 
     /* Remove the MonitoredItem */
+    UA_IdIndex_remove(&sub->monitoredItemsIndex, mon);
     LIST_REMOVE(mon, listEntry);
     UA_assert(sub->monitoredItemsSize > 0);
     UA_assert(server->numMonitoredItems > 0);
@@ -120,11 +116,17 @@ UA_Subscription_deleteMonitoredItem(UA_Server *server, UA_Subscription *sub,
     return UA_STATUSCODE_GOOD;
 }
 
-void
-UA_Subscription_addMonitoredItem(UA_Server *server, UA_Subscription *sub, UA_MonitoredItem *newMon) {
+UA_StatusCode
+UA_Subscription_addMonitoredItem(UA_Server *server, UA_Subscription *sub,
+                                 UA_MonitoredItem *newMon) {
+    UA_StatusCode retval = UA_IdIndex_reserve(&sub->monitoredItemsIndex, 1);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    UA_IdIndex_insert(&sub->monitoredItemsIndex, newMon);
     sub->monitoredItemsSize++;
     server->numMonitoredItems++;
     LIST_INSERT_HEAD(&sub->monitoredItems, newMon, listEntry);
+    return UA_STATUSCODE_GOOD;
 }
 
 static void
@@ -155,6 +155,64 @@ void UA_Notification_delete(UA_Notification *n);
 
 typedef TAILQ_HEAD(NotificationQueue, UA_Notification) NotificationQueue;
 
+/* Values up to this size (in bytes) are stored in the LastSample without
+ * allocating memory */
+#define UA_LASTSAMPLE_INLINESIZE 16
+
+/* The last sample of a data-change MonitoredItem for the change detection.
+ * Scalars and arrays of overlayable types (numerics, Guid, ...) are stored as
+ * raw data and compared in place. The DataValue of all other values is stored
+ * in the binary encoding. Small values are stored inline. The heap buffer for
+ * larger values is reused between samples and only grows. */
+typedef struct {
+    UA_Boolean valid;   /* A sample was stored */
+    UA_Boolean encoded; /* The data is the binary encoding of the DataValue */
+
+    /* DataValue fields (for the in-place comparison) */
+    UA_Boolean hasValue;
+    UA_Boolean hasStatus;
+    UA_Boolean hasSourceTimestamp;
+    UA_Boolean hasSourcePicoseconds;
+    UA_UInt16 sourcePicoseconds;
+    UA_StatusCode status;
+    UA_DateTime sourceTimestamp;
+
+    /* Variant fields (for the in-place comparison) */
+    const UA_DataType *type;
+    UA_Boolean isScalar;
+    UA_Boolean nullArray;
+    size_t arrayLength;
+
+    size_t dataSize;
+    union {
+        UA_Byte bytes[UA_LASTSAMPLE_INLINESIZE];
+        UA_UInt64 align; /* Align for reading the raw numerical values */
+    } inlineData;
+    UA_Byte *buffer; /* Heap buffer for dataSize > UA_LASTSAMPLE_INLINESIZE */
+    size_t bufferSize;
+} UA_LastSample;
+
+/* Frees the heap buffer and forgets the sample. The next sample is always
+ * detected as a change. */
+void UA_LastSample_clear(UA_LastSample *ls);
+
+/* MonitoredItems with the same sampling interval share a single repeated
+ * callback. The callback samples all items of the group under one acquisition
+ * of the service mutex. Items that are removed while the group is sampled are
+ * set to NULL and the array is compacted afterwards. */
+typedef struct UA_SamplingGroup {
+    UA_DelayedCallback delayedFreePointers;
+    LIST_ENTRY(UA_SamplingGroup) listEntry;
+    UA_Double samplingInterval;
+    UA_UInt64 callbackId;
+    UA_MonitoredItem **items;
+    size_t itemsSize;
+    size_t itemsCapacity;
+    UA_UInt32 sampling; /* Number of ongoing sampling passes */
+    UA_Boolean compact; /* Items were removed during sampling */
+    UA_Boolean removed; /* The callback is removed, free after sampling */
+} UA_SamplingGroup;
+
 struct UA_MonitoredItem {
     UA_DelayedCallback delayedFreePointers;
     LIST_ENTRY(UA_MonitoredItem) listEntry;
@@ -191,11 +249,11 @@ struct UA_MonitoredItem {
          * changed at runtime of the MonitoredItem */
         UA_DataChangeFilter dataChangeFilter;
     } filter;
-    UA_Variant lastValue; // TODO: dataEncoding is hardcoded to UA binary
 
     /* Sample Callback */
-    UA_UInt64 sampleCallbackId;
-    UA_ByteString lastSampledValue;
+    UA_SamplingGroup *samplingGroup;
+    size_t samplingGroupIndex; /* Position in samplingGroup->items */
+    UA_LastSample lastSample;
     UA_Boolean sampleCallbackIsRegistered;
 
     /* Notification Queue */
@@ -279,6 +337,7 @@ struct UA_Subscription {
     UA_UInt32 lastMonitoredItemId; /* increase the identifiers */
     LIST_HEAD(, UA_MonitoredItem) monitoredItems;
     UA_UInt32 monitoredItemsSize;
+    UA_IdIndex monitoredItemsIndex; /* Hash index by identifier */
 
     /* Global list of notifications from the MonitoredItems */
     NotificationQueue notificationQueue;
@@ -302,7 +361,9 @@ UA_Subscription * UA_Subscription_new(UA_Session *session, UA_UInt32 subscriptio
 void UA_Subscription_deleteMembers(UA_Server *server, UA_Subscription *sub);
 UA_StatusCode Subscription_registerPublishCallback(UA_Server *server, UA_Subscription *sub);
 void Subscription_unregisterPublishCallback(UA_Server *server, UA_Subscription *sub);
-void UA_Subscription_addMonitoredItem(UA_Server *server, UA_Subscription *sub, UA_MonitoredItem *newMon);
+UA_StatusCode
+UA_Subscription_addMonitoredItem(UA_Server *server, UA_Subscription *sub,
+                                 UA_MonitoredItem *newMon);
 UA_MonitoredItem * UA_Subscription_getMonitoredItem(UA_Subscription *sub, UA_UInt32 monitoredItemId);
 
 UA_StatusCode
@@ -317,6 +378,21 @@ UA_Boolean UA_Subscription_reachedPublishReqLimit(UA_Server *server,  UA_Session
 
 #ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
 
+/* The nodes that emit the events of an origin (the origin and its parents up
+ * to the Server object) are cached. The cache is direct-mapped by the hash of
+ * the origin NodeId. */
+#define UA_EVENTNOTIFIERCACHE_SIZE 64
+
+typedef struct {
+    UA_NodeId origin;
+    UA_UInt32 referenceVersion; /* The server->referenceVersion at creation */
+    UA_Boolean inObjectsFolder;
+    size_t emitNodesSize;
+    UA_ExpandedNodeId *emitNodes;
+} UA_EventNotifierCacheEntry;
+
+void UA_Event_clearNotifierCache(UA_Server *server);
+
 /* Only for unit testing */
 UA_StatusCode
 UA_Server_evaluateWhereClauseContentFilter(
@@ -53,45 +53,170 @@ outOfDeadBand(const void *data1, const void *data2,
     return (v > deadband);
 }
 
+/*************/
+/* LastSample */
+/*************/
+
+void
+UA_LastSample_clear(UA_LastSample *ls) {
+    UA_free(ls->buffer);
+    memset(ls, 0, sizeof(UA_LastSample));
+}
+
+static UA_Byte *
+lastSampleData(UA_LastSample *ls) {
+    if(ls->dataSize <= UA_LASTSAMPLE_INLINESIZE)
+        return ls->inlineData.bytes;
+    return ls->buffer;
+}
+
+/* Make room for the data. The heap buffer only grows. */
+static UA_StatusCode
+lastSampleReserve(UA_LastSample *ls, size_t size) {
+    if(size > UA_LASTSAMPLE_INLINESIZE && size > ls->bufferSize) {
+        UA_Byte *buf = (UA_Byte*)UA_realloc(ls->buffer, size);
+        if(!buf)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        ls->buffer = buf;
+        ls->bufferSize = size;
+    }
+    ls->dataSize = size;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Can the value be compared and stored without encoding? */
+static UA_Boolean
+comparableInPlace(const UA_DataValue *value) {
+    if(!value->hasValue || !value->value.type)
+        return true;
+    return (value->value.type->overlayable && value->value.arrayDimensionsSize == 0);
+}
+
+static size_t
+rawDataSize(const UA_Variant *v) {
+    if(!v->type)
+        return 0;
+    if(UA_Variant_isScalar(v))
+        return v->type->memSize;
+    return v->type->memSize * v->arrayLength;
+}
+
+/* The value must be comparableInPlace */
+static UA_Boolean
+lastSampleEqual(UA_LastSample *ls, const UA_DataValue *value) {
+    if(!ls->valid || ls->encoded)
+        return false;
+
+    /* Compare the DataValue fields */
+    if(ls->hasValue != value->hasValue ||
+       ls->hasStatus != value->hasStatus ||
+       ls->hasSourceTimestamp != value->hasSourceTimestamp ||
+       ls->hasSourcePicoseconds != value->hasSourcePicoseconds)
+        return false;
+    if(value->hasStatus && ls->status != value->status)
+        return false;
+    if(value->hasSourceTimestamp && ls->sourceTimestamp != value->sourceTimestamp)
+        return false;
+    if(value->hasSourcePicoseconds && ls->sourcePicoseconds != value->sourcePicoseconds)
+        return false;
+    if(!value->hasValue)
+        return true;
+
+    /* Compare the Variant */
+    const UA_Variant *v = &value->value;
+    if(ls->type != v->type)
+        return false;
+    if(!v->type)
+        return true;
+    if(ls->isScalar != UA_Variant_isScalar(v) ||
+       ls->arrayLength != v->arrayLength ||
+       ls->nullArray != (v->data == NULL))
+        return false;
+    size_t size = rawDataSize(v);
+    return (ls->dataSize == size && memcmp(lastSampleData(ls), v->data, size) == 0);
+}
+
+/* The value must be comparableInPlace */
+static UA_StatusCode
+lastSampleStore(UA_LastSample *ls, const UA_DataValue *value) {
+    const UA_Variant *v = &value->value;
+    size_t size = (value->hasValue) ? rawDataSize(v) : 0;
+    UA_StatusCode retval = lastSampleReserve(ls, size);
+    if(retval != UA_STATUSCODE_GOOD) {
+        ls->valid = false;
+        return retval;
+    }
+    if(size > 0)
+        memcpy(lastSampleData(ls), v->data, size);
+
+    ls->valid = true;
+    ls->encoded = false;
+    ls->hasValue = value->hasValue;
+    ls->hasStatus = value->hasStatus;
+    ls->hasSourceTimestamp = value->hasSourceTimestamp;
+    ls->hasSourcePicoseconds = value->hasSourcePicoseconds;
+    ls->status = value->status;
+    ls->sourceTimestamp = value->sourceTimestamp;
+    ls->sourcePicoseconds = value->sourcePicoseconds;
+    ls->type = v->type;
+    ls->isScalar = UA_Variant_isScalar(v);
+    ls->nullArray = (v->data == NULL);
+    ls->arrayLength = v->arrayLength;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+lastSampleStoreEncoding(UA_LastSample *ls, const UA_ByteString *encoding) {
+    UA_StatusCode retval = lastSampleReserve(ls, encoding->length);
+    if(retval != UA_STATUSCODE_GOOD) {
+        ls->valid = false;
+        return retval;
+    }
+    memcpy(lastSampleData(ls), encoding->data, encoding->length);
+    ls->valid = true;
+    ls->encoded = true;
+    return UA_STATUSCODE_GOOD;
+}
+
+/********************/
+/* Change Detection */
+/********************/
+
 static UA_Boolean
-updateNeededForFilteredValue(const UA_Variant *value, const UA_Variant *oldValue,
+updateNeededForFilteredValue(UA_LastSample *ls, const UA_Variant *value,
                              const UA_Double deadbandValue) {
-    if(value->arrayLength != oldValue->arrayLength)
+    if(!ls->valid || ls->encoded || !ls->hasValue)
+        return true;
+
+    if(value->type != ls->type)
         return true;
 
-    if(value->type != oldValue->type)
+    if(UA_Variant_isScalar(value) != ls->isScalar ||
+       value->arrayLength != ls->arrayLength)
         return true;
 
     size_t length = 1;
     if(!UA_Variant_isScalar(value))
         length = value->arrayLength;
     uintptr_t data = (uintptr_t)value->data;
+    uintptr_t oldData = (uintptr_t)lastSampleData(ls);
     for(size_t i = 0; i < length; ++i) {
-        if(outOfDeadBand((const void*)data, oldValue->data, value->type, deadbandValue))
+        if(outOfDeadBand((const void*)data, (const void*)oldData,
+                         value->type, deadbandValue))
             return true;
         data += value->type->memSize;
+        oldData += value->type->memSize;
     }
 
     return false;
 }
 
-/* When a change is detected, encoding contains the heap-allocated binary
- * encoded value. The default for changed is false. */
+/* Compare the binary encoding of the value with the last sample. Used for
+ * values that cannot be compared in place. Stores the encoding in the last
+ * sample if a change was detected. */
 static UA_StatusCode
-detectValueChangeWithFilter(UA_Server *server, UA_Session *session, UA_MonitoredItem *mon,
-                            UA_DataValue *value, UA_ByteString *encoding, UA_Boolean *changed) {
-    /* Check for absolute deadband */
-    if(UA_DataType_isNumeric(value->value.type) &&
-       mon->filter.dataChangeFilter.deadbandType == UA_DEADBANDTYPE_ABSOLUTE) {
-        UA_assert(value->value.type);
-        if(mon->filter.dataChangeFilter.trigger == UA_DATACHANGETRIGGER_STATUSVALUE ||
-           mon->filter.dataChangeFilter.trigger == UA_DATACHANGETRIGGER_STATUSVALUETIMESTAMP) {
-            if(!updateNeededForFilteredValue(&value->value, &mon->lastValue,
-                                             mon->filter.dataChangeFilter.deadbandValue))
-                return UA_STATUSCODE_GOOD;
-        }
-    }
-
+detectValueChangeEncoded(UA_MonitoredItem *mon, const UA_DataValue *value,
+                         UA_Boolean *changed) {
     /* Stack-allocate some memory for the value encoding. We might heap-allocate
      * more memory if needed. This is just enough for scalars and small
      * structures. */
@@ -128,29 +253,36 @@ detectValueChangeWithFilter(UA_Server *server, UA_Session *session, UA_Monitored
 
     /* Has the value changed? */
     valueEncoding.length = (uintptr_t)bufPos - (uintptr_t)valueEncoding.data;
-    *changed = (!mon->lastSampledValue.data ||
-                !UA_String_equal(&valueEncoding, &mon->lastSampledValue));
-
-    /* No change */
-    if(!(*changed)) {
-        if(valueEncoding.data != stackValueEncoding)
-            UA_ByteString_clear(&valueEncoding);
-        return UA_STATUSCODE_GOOD;
+    UA_LastSample *ls = &mon->lastSample;
+    *changed = (!ls->valid || !ls->encoded || ls->dataSize != valueEncoding.length ||
+                memcmp(lastSampleData(ls), valueEncoding.data, valueEncoding.length) != 0);
+
+    /* Change detected. Store the encoding. A heap-allocated encoding is moved
+     * into the last sample. */
+    if(*changed) {
+        if(valueEncoding.data != stackValueEncoding &&
+           valueEncoding.length > ls->bufferSize) {
+            UA_free(ls->buffer);
+            ls->buffer = valueEncoding.data;
+            ls->bufferSize = valueEncoding.length;
+            ls->dataSize = valueEncoding.length;
+            ls->valid = true;
+            ls->encoded = true;
+            return UA_STATUSCODE_GOOD;
+        }
+        retval = lastSampleStoreEncoding(ls, &valueEncoding);
     }
 
-    /* Change detected. Copy encoding on the heap if necessary. */
-    if(valueEncoding.data == stackValueEncoding)
-        return UA_ByteString_copy(&valueEncoding, encoding);
-
-    *encoding = valueEncoding;
-    return UA_STATUSCODE_GOOD;
+    if(valueEncoding.data != stackValueEncoding)
+        UA_ByteString_clear(&valueEncoding);
+    return retval;
 }
 
-/* Has this sample changed from the last one? The method may allocate additional
- * space for the encoding buffer. Detect the change in encoding->data. */
+/* Has this sample changed from the last one? If a change was detected, the
+ * sample replaces the last sample of the MonitoredItem. */
 static UA_StatusCode
-    detectValueChange(UA_Server *server, UA_Session *session, UA_MonitoredItem *mon,
-                  UA_DataValue value, UA_ByteString *encoding, UA_Boolean *changed) {
+detectValueChange(UA_Server *server, UA_MonitoredItem *mon,
+                  UA_DataValue value, UA_Boolean *changed) {
     UA_LOCK_ASSERT(server->serviceMutex, 1);
 
     /* Apply Filter */
@@ -164,8 +296,26 @@ static UA_StatusCode
         value.hasSourcePicoseconds = false;
     }
 
-    /* Detect the value change */
-    return detectValueChangeWithFilter(server, session, mon, &value, encoding, changed);
+    /* Check for absolute deadband */
+    if(value.hasValue && UA_DataType_isNumeric(value.value.type) &&
+       mon->filter.dataChangeFilter.deadbandType == UA_DEADBANDTYPE_ABSOLUTE) {
+        if(mon->filter.dataChangeFilter.trigger == UA_DATACHANGETRIGGER_STATUSVALUE ||
+           mon->filter.dataChangeFilter.trigger == UA_DATACHANGETRIGGER_STATUSVALUETIMESTAMP) {
+            if(!updateNeededForFilteredValue(&mon->lastSample, &value.value,
+                                             mon->filter.dataChangeFilter.deadbandValue))
+                return UA_STATUSCODE_GOOD;
+        }
+    }
+
+    /* Values of complex types are compared in the binary encoding */
+    if(!comparableInPlace(&value))
+        return detectValueChangeEncoded(mon, &value, changed);
+
+    /* Compare in place without encoding the value */
+    *changed = !lastSampleEqual(&mon->lastSample, &value);
+    if(!*changed)
+        return UA_STATUSCODE_GOOD;
+    return lastSampleStore(&mon->lastSample, &value);
 }
 
 /* movedValue returns whether the sample was moved to the notification. The
@@ -176,13 +326,10 @@ sampleCallbackWithValue(UA_Server *server, UA_Session *session,
                         UA_DataValue *value, UA_Boolean *movedValue) {
     UA_assert(mon->attributeId != UA_ATTRIBUTEID_EVENTNOTIFIER);
 
-    /* Contains heap-allocated binary encoding of the value if a change was detected */
-    UA_ByteString binValueEncoding = UA_BYTESTRING_NULL;
-
-    /* Has the value changed? Allocates memory in binValueEncoding if necessary.
-     * value is edited internally so we make a shallow copy. */
+    /* Has the value changed? The last sample is replaced if a change is
+     * detected. value is edited internally so we make a shallow copy. */
     UA_Boolean changed = false;
-    UA_StatusCode retval = detectValueChange(server, session, mon, *value, &binValueEncoding, &changed);
+    UA_StatusCode retval = detectValueChange(server, mon, *value, &changed);
     if(retval != UA_STATUSCODE_GOOD) {
         UA_LOG_WARNING_SESSION(&server->config.logger, session, "Subscription %" PRIu32 " | "
                                "MonitoredItem %" PRIi32 " | Value change detection failed with StatusCode %s",
@@ -203,7 +350,7 @@ sampleCallbackWithValue(UA_Server *server, UA_Session *session,
         /* Allocate a new notification */
         UA_Notification *newNotification = (UA_Notification *)UA_malloc(sizeof(UA_Notification));
         if(!newNotification) {
-            UA_ByteString_clear(&binValueEncoding);
+            UA_LastSample_clear(&mon->lastSample);
             return UA_STATUSCODE_BADOUTOFMEMORY;
         }
 
@@ -213,7 +360,7 @@ sampleCallbackWithValue(UA_Server *server, UA_Session *session,
         } else { /* => (value->value.storageType == UA_VARIANT_DATA_NODELETE) */
             retval = UA_DataValue_copy(value, &newNotification->data.value);
             if(retval != UA_STATUSCODE_GOOD) {
-                UA_ByteString_clear(&binValueEncoding);
+                UA_LastSample_clear(&mon->lastSample);
                 UA_free(newNotification);
                 return retval;
             }
@@ -229,26 +376,9 @@ sampleCallbackWithValue(UA_Server *server, UA_Session *session,
         UA_Notification_enqueue(server, sub, mon, newNotification);
     }
 
-    /* Store the encoding for comparison */
-    UA_ByteString_clear(&mon->lastSampledValue);
-    mon->lastSampledValue = binValueEncoding;
-
-    /* Store the value for filter comparison (we don't want to decode
-     * lastSampledValue in every iteration). Don't test the return code here. If
-     * this fails, lastValue is empty and a notification will be forced for the
-     * next deadband comparison. */
-    if((mon->filter.dataChangeFilter.deadbandType == UA_DEADBANDTYPE_NONE ||
-        mon->filter.dataChangeFilter.deadbandType == UA_DEADBANDTYPE_ABSOLUTE ||
-        mon->filter.dataChangeFilter.deadbandType == UA_DEADBANDTYPE_PERCENT) &&
-       (mon->filter.dataChangeFilter.trigger == UA_DATACHANGETRIGGER_STATUS ||
-        mon->filter.dataChangeFilter.trigger == UA_DATACHANGETRIGGER_STATUSVALUE ||
-        mon->filter.dataChangeFilter.trigger == UA_DATACHANGETRIGGER_STATUSVALUETIMESTAMP)) {
-        UA_Variant_clear(&mon->lastValue);
-        UA_Variant_copy(&value->value, &mon->lastValue);
 #ifdef UA_ENABLE_DA
-        mon->lastStatus = value->status;
+    mon->lastStatus = value->status;
 #endif
-    }
 
     /* Call the local callback if the MonitoredItem is not attached to a
      * subscription. Do this at the very end. Because the callback might delete
@@ -304,7 +434,8 @@ monitoredItem_sampleCallback(UA_Server *server, UA_MonitoredItem *monitoredItem)
         rvid.nodeId = monitoredItem->monitoredNodeId;
         rvid.attributeId = monitoredItem->attributeId;
         rvid.indexRange = monitoredItem->indexRange;
-        ReadWithNode(node, server, session, monitoredItem->timestampsToReturn, &rvid, &value);
+        ReadWithNode(node, server, session, monitoredItem->timestampsToReturn,
+                     monitoredItem->samplingInterval, &rvid, &value);
     } else {
         value.hasStatus = true;
         value.status = UA_STATUSCODE_BADNODEIDUNKNOWN;
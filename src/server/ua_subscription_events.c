@@ -130,6 +130,24 @@ UA_Server_createEvent(UA_Server *server, const UA_NodeId eventType,
     return UA_STATUSCODE_GOOD;
 }
 
+static UA_Boolean
+isValidEventType(UA_Server *server, const UA_NodeId *validEventParent,
+                 const UA_NodeId *eventType) {
+    /* check whether the EventType is a Subtype of CondtionType
+     * (Part 9 first implementation) */
+    UA_NodeId conditionTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_CONDITIONTYPE);
+    UA_NodeId hasSubtypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE);
+    if(UA_NodeId_equal(validEventParent, &conditionTypeId) &&
+       isNodeInTree(server, eventType, &conditionTypeId, &hasSubtypeId, 1))
+        return true;
+
+    /*EventType is not a Subtype of CondtionType
+     *(ConditionId Clause won't be present in Events, which are not Conditions)*/
+    /* check whether Valid Event other than Conditions */
+    UA_NodeId baseEventTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEEVENTTYPE);
+    return isNodeInTree(server, eventType, &baseEventTypeId, &hasSubtypeId, 1);
+}
+
 static UA_Boolean
 isValidEvent(UA_Server *server, const UA_NodeId *validEventParent,
              const UA_NodeId *eventId) {
@@ -154,31 +172,11 @@ isValidEvent(UA_Server *server, const UA_NodeId *validEventParent,
         return false;
     }
 
-    const UA_NodeId *tEventType = (UA_NodeId*)tOutVariant.data;
-
-    /* check whether the EventType is a Subtype of CondtionType
-     * (Part 9 first implementation) */
-    UA_NodeId conditionTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_CONDITIONTYPE);
-    UA_NodeId hasSubtypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE);
-
-    if(UA_NodeId_equal(validEventParent, &conditionTypeId) &&
-       isNodeInTree(server, tEventType,
-					&conditionTypeId, &hasSubtypeId, 1)){
-        UA_BrowsePathResult_deleteMembers(&bpr);
-        UA_Variant_clear(&tOutVariant);
-        return true;
-    }
-
-    /*EventType is not a Subtype of CondtionType
-     *(ConditionId Clause won't be present in Events, which are not Conditions)*/
-    /* check whether Valid Event other than Conditions */
-    UA_NodeId baseEventTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEEVENTTYPE);
-    UA_Boolean isSubtypeOfBaseEvent = isNodeInTree(server, tEventType,
-                                                   &baseEventTypeId, &hasSubtypeId, 1);
-
+    UA_Boolean valid = isValidEventType(server, validEventParent,
+                                        (UA_NodeId*)tOutVariant.data);
     UA_BrowsePathResult_clear(&bpr);
     UA_Variant_clear(&tOutVariant);
-    return isSubtypeOfBaseEvent;
+    return valid;
 }
 
 /* Part 4: 7.4.4.5 SimpleAttributeOperand
@@ -246,11 +244,83 @@ resolveSimpleAttributeOperand(UA_Server *server, UA_Session *session, const UA_N
     return v.status;
 }
 
-UA_StatusCode
-UA_Server_evaluateWhereClauseContentFilter(
-    UA_Server *server,
-    const UA_NodeId *eventNode,
-    const UA_ContentFilter *contentFilter) {
+/* The fields of an event without a node representation. The field lists are
+ * searched in order. So the fields set by the server take precedence over the
+ * user-defined fields and those over the defaults. */
+#define UA_EVENTFIELDMAP_LISTS 3
+
+typedef struct {
+    const UA_NodeId *eventType;
+    size_t fieldsSize[UA_EVENTFIELDMAP_LISTS];
+    const UA_EventField *fields[UA_EVENTFIELDMAP_LISTS];
+} UA_EventFieldMap;
+
+static const UA_Variant *
+findEventField(const UA_EventFieldMap *map, size_t browsePathSize,
+               const UA_QualifiedName *browsePath) {
+    for(size_t l = 0; l < UA_EVENTFIELDMAP_LISTS; l++) {
+        for(size_t i = 0; i < map->fieldsSize[l]; i++) {
+            const UA_EventField *field = &map->fields[l][i];
+            if(field->browsePathSize != browsePathSize)
+                continue;
+            size_t j = 0;
+            for(; j < browsePathSize; j++) {
+                if(!UA_QualifiedName_equal(&field->browsePath[j], &browsePath[j]))
+                    break;
+            }
+            if(j == browsePathSize)
+                return &field->value;
+        }
+    }
+    return NULL;
+}
+
+/* Resolve a SimpleAttributeOperand against the fields of an event without a
+ * node representation. Only the Value attribute of a field can be selected. */
+static UA_StatusCode
+resolveFieldMapOperand(UA_Server *server, UA_Session *session, const UA_EventFieldMap *map,
+                       const UA_SimpleAttributeOperand *sao, UA_Variant *value) {
+    /* The attribute of the TypeDefinition node. There is no Condition node for
+     * the ConditionId. */
+    if(sao->browsePathSize == 0) {
+        UA_NodeId conditionTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_CONDITIONTYPE);
+        if(UA_NodeId_equal(&sao->typeDefinitionId, &conditionTypeId))
+            return UA_STATUSCODE_BADNOTSUPPORTED;
+        UA_ReadValueId rvi;
+        UA_ReadValueId_init(&rvi);
+        rvi.nodeId = sao->typeDefinitionId;
+        rvi.indexRange = sao->indexRange;
+        rvi.attributeId = sao->attributeId;
+        UA_DataValue v = UA_Server_readWithSession(server, session, &rvi,
+                                                   UA_TIMESTAMPSTORETURN_NEITHER);
+        if(v.status == UA_STATUSCODE_GOOD && v.hasValue)
+            *value = v.value;
+        return v.status;
+    }
+
+    if(sao->attributeId != UA_ATTRIBUTEID_VALUE)
+        return UA_STATUSCODE_BADATTRIBUTEIDINVALID;
+
+    const UA_Variant *field = findEventField(map, sao->browsePathSize, sao->browsePath);
+    if(!field)
+        return UA_STATUSCODE_BADNOTFOUND;
+
+    if(sao->indexRange.length == 0)
+        return UA_Variant_copy(field, value);
+
+    UA_NumericRange range;
+    UA_StatusCode retval = UA_NumericRange_parse(&range, sao->indexRange);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    retval = UA_Variant_copyRange(field, value, range);
+    UA_free(range.dimensions);
+    return retval;
+}
+
+/* The EventType is read from the event node if it is not given */
+static UA_StatusCode
+evaluateWhereClause(UA_Server *server, const UA_NodeId *eventNode,
+                    const UA_NodeId *eventType, const UA_ContentFilter *contentFilter) {
     if(contentFilter->elements == NULL || contentFilter->elementsSize == 0)
     {
         /* Nothing to do.*/
@@ -318,6 +388,11 @@ UA_Server_evaluateWhereClauseContentFilter(
                 UA_NodeId *pOperandNodeId = (UA_NodeId *) pOperand->value.data;
                 UA_NodeId hasSubtypeId =
                     UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE);
+                if(eventType) {
+                    if(isNodeInTree(server, eventType, pOperandNodeId, &hasSubtypeId, 1))
+                        return UA_STATUSCODE_GOOD;
+                    return UA_STATUSCODE_BADNOMATCH;
+                }
                 UA_QualifiedName eventTypeQualifiedName =
                     UA_QUALIFIEDNAME(0, "EventType");
                 UA_Variant typeNodeIdVariant;
@@ -362,17 +437,26 @@ UA_Server_evaluateWhereClauseContentFilter(
         }
 }
 
+UA_StatusCode
+UA_Server_evaluateWhereClauseContentFilter(
+    UA_Server *server,
+    const UA_NodeId *eventNode,
+    const UA_ContentFilter *contentFilter) {
+    return evaluateWhereClause(server, eventNode, NULL, contentFilter);
+}
+
 /* Filters the given event with the given filter and writes the results into a
- * notification */
+ * notification. The event is either given as a node or as a field map. */
 static UA_StatusCode
 UA_Server_filterEvent(UA_Server *server, UA_Session *session,
-                      const UA_NodeId *eventNode, UA_EventFilter *filter,
-                      UA_EventNotification *notification) {
+                      const UA_NodeId *eventNode, const UA_EventFieldMap *map,
+                      UA_EventFilter *filter, UA_EventNotification *notification) {
     if (filter->selectClausesSize == 0)
         return UA_STATUSCODE_BADEVENTFILTERINVALID;
 
-    UA_StatusCode retVal = UA_Server_evaluateWhereClauseContentFilter(
-        server, eventNode, &filter->whereClause);
+    UA_StatusCode retVal = evaluateWhereClause(server, eventNode,
+                                               map ? map->eventType : NULL,
+                                               &filter->whereClause);
     if(retVal != UA_STATUSCODE_GOOD)
     {
         return retVal;
@@ -407,8 +491,10 @@ UA_Server_filterEvent(UA_Server *server, UA_Session *session,
      * needs to be checked */
     UA_NodeId baseEventTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEEVENTTYPE);
     for(size_t i = 0; i < filter->selectClausesSize; i++) {
-        if(!UA_NodeId_equal(&filter->selectClauses[i].typeDefinitionId, &baseEventTypeId) &&
-           !isValidEvent(server, &filter->selectClauses[i].typeDefinitionId, eventNode)) {
+        const UA_NodeId *typeDef = &filter->selectClauses[i].typeDefinitionId;
+        if(!UA_NodeId_equal(typeDef, &baseEventTypeId) &&
+           !(map ? isValidEventType(server, typeDef, map->eventType) :
+             isValidEvent(server, typeDef, eventNode))) {
             UA_Variant_init(&notification->fields.eventFields[i]);
             /* EventFilterResult currently isn't being used
             notification->result.selectClauseResults[i] = UA_STATUSCODE_BADTYPEDEFINITIONINVALID; */
@@ -416,9 +502,13 @@ UA_Server_filterEvent(UA_Server *server, UA_Session *session,
         }
 
         /* TODO: Put the result into the selectClausResults */
-        resolveSimpleAttributeOperand(server, session, eventNode,
-                                      &filter->selectClauses[i],
-                                      &notification->fields.eventFields[i]);
+        if(map)
+            resolveFieldMapOperand(server, session, map, &filter->selectClauses[i],
+                                   &notification->fields.eventFields[i]);
+        else
+            resolveSimpleAttributeOperand(server, session, eventNode,
+                                          &filter->selectClauses[i],
+                                          &notification->fields.eventFields[i]);
     }
 
     return UA_STATUSCODE_GOOD;
@@ -496,8 +586,9 @@ eventSetStandardFields(UA_Server *server, const UA_NodeId *event,
 
 /* Filters an event according to the filter specified by mon and then adds it to
  * mons notification queue */
-UA_StatusCode
-UA_Event_addEventToMonitoredItem(UA_Server *server, const UA_NodeId *event, UA_MonitoredItem *mon) {
+static UA_StatusCode
+addEventToMonitoredItem(UA_Server *server, const UA_NodeId *event,
+                        const UA_EventFieldMap *map, UA_MonitoredItem *mon) {
     UA_Notification *notification = (UA_Notification *) UA_malloc(sizeof(UA_Notification));
     if(!notification)
         return UA_STATUSCODE_BADOUTOFMEMORY;
@@ -509,7 +600,7 @@ UA_Event_addEventToMonitoredItem(UA_Server *server, const UA_NodeId *event, UA_M
 
     /* Apply the filter */
     UA_StatusCode retval =
-        UA_Server_filterEvent(server, session, event, &mon->filter.eventFilter,
+        UA_Server_filterEvent(server, session, event, map, &mon->filter.eventFilter,
                               &notification->data.event);
     if(retval == UA_STATUSCODE_BADNOMATCH)
     {
@@ -527,6 +618,11 @@ UA_Event_addEventToMonitoredItem(UA_Server *server, const UA_NodeId *event, UA_M
     return UA_STATUSCODE_GOOD;
 }
 
+UA_StatusCode
+UA_Event_addEventToMonitoredItem(UA_Server *server, const UA_NodeId *event, UA_MonitoredItem *mon) {
+    return addEventToMonitoredItem(server, event, NULL, mon);
+}
+
 static const UA_NodeId objectsFolderId = {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_OBJECTSFOLDER}};
 #define EMIT_REFS_ROOT_COUNT 4
 static const UA_NodeId emitReferencesRoots[EMIT_REFS_ROOT_COUNT] =
@@ -535,67 +631,37 @@ static const UA_NodeId emitReferencesRoots[EMIT_REFS_ROOT_COUNT] =
      {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_HASEVENTSOURCE}},
      {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_HASNOTIFIER}}};
 
-UA_StatusCode
-UA_Server_triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
-                       const UA_NodeId origin, UA_ByteString *outEventId,
-                       const UA_Boolean deleteEventNode) {
-    UA_LOCK(server->serviceMutex);
+/**************************/
+/* Event Notifier Caching */
+/**************************/
 
-#if UA_LOGLEVEL <= 200
-    UA_LOG_NODEID_WRAP(&origin,
-                       UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_SERVER,
-                                    "Events: An event is triggered on node %.*s",
-                                    (int)nodeIdStr.length, nodeIdStr.data));
-#endif
+static void
+UA_EventNotifierCacheEntry_clear(UA_EventNotifierCacheEntry *entry) {
+    UA_NodeId_clear(&entry->origin);
+    UA_Array_delete(entry->emitNodes, entry->emitNodesSize,
+                    &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+    memset(entry, 0, sizeof(UA_EventNotifierCacheEntry));
+}
 
-#ifdef UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS
-    UA_Boolean isCallerAC = false;
-    if(isConditionOrBranch(server, &eventNodeId, &origin, &isCallerAC)) {
-        if(!isCallerAC) {
-          UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
-                                 "Condition Events: Please use A&C API to trigger Condition Events 0x%08X",
-                                  UA_STATUSCODE_BADINVALIDARGUMENT);
-          UA_UNLOCK(server->serviceMutex);
-          return UA_STATUSCODE_BADINVALIDARGUMENT;
-        }
-    }
-#endif /*UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS*/
+void
+UA_Event_clearNotifierCache(UA_Server *server) {
+    for(size_t i = 0; i < UA_EVENTNOTIFIERCACHE_SIZE; i++)
+        UA_EventNotifierCacheEntry_clear(&server->eventNotifierCache[i]);
+}
 
-    /* Check that the origin node exists */
-    const UA_Node *originNode = UA_NODESTORE_GET(server, &origin);
-    if(!originNode) {
-        UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND,
-                     "Origin node for event does not exist.");
-        UA_UNLOCK(server->serviceMutex);
-        return UA_STATUSCODE_BADNOTFOUND;
-    }
-    UA_NODESTORE_RELEASE(server, originNode);
+/* Browse the nodes that emit the events of the origin */
+static UA_StatusCode
+computeEventNotifiers(UA_Server *server, const UA_NodeId *origin,
+                      UA_EventNotifierCacheEntry *entry) {
+    memset(entry, 0, sizeof(UA_EventNotifierCacheEntry));
+    entry->referenceVersion = server->referenceVersion;
 
     /* Make sure the origin is in the ObjectsFolder (TODO: or in the ViewsFolder) */
-    if(!isNodeInTree(server, &origin, &objectsFolderId,
-                     emitReferencesRoots, 2)) { /* Only use Organizes and
-                                                 * HasComponent to check if we
-                                                 * are below the ObjectsFolder */
-        UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND,
-                     "Node for event must be in ObjectsFolder!");
-        UA_UNLOCK(server->serviceMutex);
-        return UA_STATUSCODE_BADINVALIDARGUMENT;
-    }
-
-    /* Update the standard fields of the event */
-    UA_StatusCode retval = eventSetStandardFields(server, &eventNodeId, &origin, outEventId);
-    if(retval != UA_STATUSCODE_GOOD) {
-        UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
-                       "Events: Could not set the standard event fields with StatusCode %s",
-                       UA_StatusCode_name(retval));
-        UA_UNLOCK(server->serviceMutex);
-        return retval;
-    }
-
-    /* List of nodes that emit the node. Events propagate upwards (bubble up) in
-     * the node hierarchy. */
-    UA_ExpandedNodeId *emitNodes = NULL;
-    size_t emitNodesSize = 0;
+    entry->inObjectsFolder =
+        isNodeInTree(server, origin, &objectsFolderId,
+                     emitReferencesRoots, 2); /* Only use Organizes and
+                                               * HasComponent to check if we
+                                               * are below the ObjectsFolder */
 
     /* Add the server node to the list of nodes from which the event is emitted.
      * The server node emits all events.
@@ -605,13 +671,14 @@ UA_Server_triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
      * a Server and as such has implied HasEventSource References to every event
      * source in a Server. */
     UA_NodeId emitStartNodes[2];
-    emitStartNodes[0] = origin;
+    emitStartNodes[0] = *origin;
     emitStartNodes[1] = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER);
 
     /* Get all ReferenceTypes over which the events propagate */
     UA_NodeId *emitRefTypes[EMIT_REFS_ROOT_COUNT] = {NULL, NULL, NULL};
     size_t emitRefTypesSize[EMIT_REFS_ROOT_COUNT] = {0, 0, 0, 0};
     size_t totalEmitRefTypesSize = 0;
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
     for (size_t i=0; i<EMIT_REFS_ROOT_COUNT; i++) {
         retval |= referenceSubtypes(server, &emitReferencesRoots[i],
                                     &emitRefTypesSize[i], &emitRefTypes[i]);
@@ -632,12 +699,11 @@ UA_Server_triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
         currIndex += emitRefTypesSize[i];
     }
 
-
     /* Get the list of nodes in the hierarchy that emits the event. */
     retval = browseRecursive(server, 2, emitStartNodes,
                              totalEmitRefTypesSize, totalEmitRefTypes,
                              UA_BROWSEDIRECTION_INVERSE, true,
-                             &emitNodesSize, &emitNodes);
+                             &entry->emitNodesSize, &entry->emitNodes);
     if(retval != UA_STATUSCODE_GOOD) {
         UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
                        "Events: Could not create the list of nodes listening on the "
@@ -645,6 +711,115 @@ UA_Server_triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
         goto cleanup;
     }
 
+    retval = UA_NodeId_copy(origin, &entry->origin);
+
+ cleanup:
+    for (size_t i=0; i<EMIT_REFS_ROOT_COUNT; i++) {
+        UA_Array_delete(emitRefTypes[i], emitRefTypesSize[i], &UA_TYPES[UA_TYPES_NODEID]);
+    }
+    if(retval != UA_STATUSCODE_GOOD)
+        UA_EventNotifierCacheEntry_clear(entry);
+    return retval;
+}
+
+static UA_EventNotifierCacheEntry *
+eventNotifierCacheSlot(UA_Server *server, const UA_NodeId *origin) {
+    return &server->eventNotifierCache[UA_NodeId_hash(origin) % UA_EVENTNOTIFIERCACHE_SIZE];
+}
+
+/* Take the notifiers of the origin out of the cache or browse them. The entry
+ * belongs to the caller until it is given back. So an event triggered from a
+ * callback during the dispatch cannot free the entry while it is in use. */
+static UA_StatusCode
+takeEventNotifiers(UA_Server *server, const UA_NodeId *origin,
+                   UA_EventNotifierCacheEntry *entry) {
+    UA_EventNotifierCacheEntry *slot = eventNotifierCacheSlot(server, origin);
+    if(slot->emitNodesSize > 0 &&
+       slot->referenceVersion == server->referenceVersion &&
+       UA_NodeId_equal(&slot->origin, origin)) {
+        *entry = *slot;
+        memset(slot, 0, sizeof(UA_EventNotifierCacheEntry));
+        return UA_STATUSCODE_GOOD;
+    }
+    return computeEventNotifiers(server, origin, entry);
+}
+
+/* Move the entry (back) into the cache. Outdated entries are dropped. */
+static void
+returnEventNotifiers(UA_Server *server, UA_EventNotifierCacheEntry *entry) {
+    if(entry->referenceVersion != server->referenceVersion) {
+        UA_EventNotifierCacheEntry_clear(entry);
+        return;
+    }
+    UA_EventNotifierCacheEntry *slot = eventNotifierCacheSlot(server, &entry->origin);
+    UA_EventNotifierCacheEntry_clear(slot);
+    *slot = *entry;
+    memset(entry, 0, sizeof(UA_EventNotifierCacheEntry));
+}
+
+UA_StatusCode
+UA_Server_triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
+                       const UA_NodeId origin, UA_ByteString *outEventId,
+                       const UA_Boolean deleteEventNode) {
+    UA_LOCK(server->serviceMutex);
+
+#if UA_LOGLEVEL <= 200
+    UA_LOG_NODEID_WRAP(&origin,
+                       UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                                    "Events: An event is triggered on node %.*s",
+                                    (int)nodeIdStr.length, nodeIdStr.data));
+#endif
+
+#ifdef UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS
+    UA_Boolean isCallerAC = false;
+    if(isConditionOrBranch(server, &eventNodeId, &origin, &isCallerAC)) {
+        if(!isCallerAC) {
+          UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                                 "Condition Events: Please use A&C API to trigger Condition Events 0x%08X",
+                                  UA_STATUSCODE_BADINVALIDARGUMENT);
+          UA_UNLOCK(server->serviceMutex);
+          return UA_STATUSCODE_BADINVALIDARGUMENT;
+        }
+    }
+#endif /*UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS*/
+
+    /* Check that the origin node exists */
+    const UA_Node *originNode = UA_NODESTORE_GET(server, &origin);
+    if(!originNode) {
+        UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND,
+                     "Origin node for event does not exist.");
+        UA_UNLOCK(server->serviceMutex);
+        return UA_STATUSCODE_BADNOTFOUND;
+    }
+    UA_NODESTORE_RELEASE(server, originNode);
+
+    /* Get the list of nodes in the hierarchy that emit the event. Events
+     * propagate upwards (bubble up) in the node hierarchy. */
+    UA_EventNotifierCacheEntry notifiers;
+    UA_StatusCode retval = takeEventNotifiers(server, &origin, &notifiers);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_UNLOCK(server->serviceMutex);
+        return retval;
+    }
+    UA_ExpandedNodeId *emitNodes = notifiers.emitNodes;
+    size_t emitNodesSize = notifiers.emitNodesSize;
+
+    if(!notifiers.inObjectsFolder) {
+        UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND,
+                     "Node for event must be in ObjectsFolder!");
+        retval = UA_STATUSCODE_BADINVALIDARGUMENT;
+        goto cleanup;
+    }
+
+    /* Update the standard fields of the event */
+    retval = eventSetStandardFields(server, &eventNodeId, &origin, outEventId);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                       "Events: Could not set the standard event fields with StatusCode %s",
+                       UA_StatusCode_name(retval));
+        goto cleanup;
+    }
+
     /* Add the event to the listening MonitoredItems at each relevant node */
     for(size_t i = 0; i < emitNodesSize; i++) {
         const UA_ObjectNode *node = (const UA_ObjectNode*)
@@ -698,7 +873,7 @@ UA_Server_triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
             filter = (UA_EventFilter*)historicalEventFilterValue.data;
             UA_EventNotification eventNotification;
             retval = UA_Server_filterEvent(server, &server->adminSession, &eventNodeId,
-                                           filter, &eventNotification);
+                                           NULL, filter, &eventNotification);
             if(retval == UA_STATUSCODE_GOOD) {
                 fieldList = UA_EventFieldList_new();
                 *fieldList = eventNotification.fields;
@@ -729,12 +904,124 @@ UA_Server_triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
     }
 
  cleanup:
-    for (size_t i=0; i<EMIT_REFS_ROOT_COUNT; i++) {
-        UA_Array_delete(emitRefTypes[i], emitRefTypesSize[i], &UA_TYPES[UA_TYPES_NODEID]);
-    }
-    UA_Array_delete(emitNodes, emitNodesSize, &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+    returnEventNotifiers(server, &notifiers);
     UA_UNLOCK(server->serviceMutex);
     return retval;
 }
 
+UA_StatusCode
+UA_Server_emitEvent(UA_Server *server, const UA_NodeId eventType, const UA_NodeId origin,
+                    size_t fieldsSize, const UA_EventField *fields,
+                    UA_ByteString *outEventId) {
+    if(fieldsSize > 0 && !fields)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+
+    UA_LOCK(server->serviceMutex);
+
+    /* Make sure the eventType is a subtype of BaseEventType */
+    UA_NodeId hasSubtypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE);
+    UA_NodeId baseEventTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEEVENTTYPE);
+    if(!isNodeInTree(server, &eventType, &baseEventTypeId, &hasSubtypeId, 1)) {
+        UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND,
+                     "Event type must be a subtype of BaseEventType!");
+        UA_UNLOCK(server->serviceMutex);
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    }
+
+    /* Check that the origin node exists */
+    const UA_Node *originNode = UA_NODESTORE_GET(server, &origin);
+    if(!originNode) {
+        UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND,
+                     "Origin node for event does not exist.");
+        UA_UNLOCK(server->serviceMutex);
+        return UA_STATUSCODE_BADNOTFOUND;
+    }
+    UA_NODESTORE_RELEASE(server, originNode);
+
+    /* Get the nodes that emit the event */
+    UA_EventNotifierCacheEntry notifiers;
+    UA_StatusCode retval = takeEventNotifiers(server, &origin, &notifiers);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_UNLOCK(server->serviceMutex);
+        return retval;
+    }
+    if(!notifiers.inObjectsFolder) {
+        UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND,
+                     "Node for event must be in ObjectsFolder!");
+        returnEventNotifiers(server, &notifiers);
+        UA_UNLOCK(server->serviceMutex);
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    }
+
+    /* The fields set by the server */
+    UA_ByteString eventId = UA_BYTESTRING_NULL;
+    retval = UA_Event_generateEventId(&eventId);
+    if(retval != UA_STATUSCODE_GOOD) {
+        returnEventNotifiers(server, &notifiers);
+        UA_UNLOCK(server->serviceMutex);
+        return retval;
+    }
+    UA_DateTime receiveTime = UA_DateTime_now();
+    UA_QualifiedName names[5] = {
+        UA_QUALIFIEDNAME(0, "EventId"), UA_QUALIFIEDNAME(0, "EventType"),
+        UA_QUALIFIEDNAME(0, "SourceNode"), UA_QUALIFIEDNAME(0, "ReceiveTime"),
+        UA_QUALIFIEDNAME(0, "Time")};
+    UA_EventField standardFields[5];
+    for(size_t i = 0; i < 5; i++) {
+        standardFields[i].browsePathSize = 1;
+        standardFields[i].browsePath = &names[i];
+    }
+    UA_Variant_setScalar(&standardFields[0].value, &eventId,
+                         &UA_TYPES[UA_TYPES_BYTESTRING]);
+    UA_Variant_setScalar(&standardFields[1].value, (void*)(uintptr_t)&eventType,
+                         &UA_TYPES[UA_TYPES_NODEID]);
+    UA_Variant_setScalar(&standardFields[2].value, (void*)(uintptr_t)&origin,
+                         &UA_TYPES[UA_TYPES_NODEID]);
+    UA_Variant_setScalar(&standardFields[3].value, &receiveTime,
+                         &UA_TYPES[UA_TYPES_DATETIME]);
+    UA_Variant_setScalar(&standardFields[4].value, &receiveTime,
+                         &UA_TYPES[UA_TYPES_DATETIME]);
+
+    /* The Time defaults to the ReceiveTime */
+    UA_EventFieldMap map;
+    map.eventType = &eventType;
+    map.fieldsSize[0] = 4;
+    map.fields[0] = standardFields;
+    map.fieldsSize[1] = fieldsSize;
+    map.fields[1] = fields;
+    map.fieldsSize[2] = 1;
+    map.fields[2] = &standardFields[4];
+
+    /* Add the event to the listening MonitoredItems at each relevant node */
+    for(size_t i = 0; i < notifiers.emitNodesSize; i++) {
+        const UA_ObjectNode *node = (const UA_ObjectNode*)
+            UA_NODESTORE_GET(server, &notifiers.emitNodes[i].nodeId);
+        if(!node)
+            continue;
+        if(node->nodeClass != UA_NODECLASS_OBJECT) {
+            UA_NODESTORE_RELEASE(server, (const UA_Node*)node);
+            continue;
+        }
+        for(UA_MonitoredItem *mi = node->monitoredItemQueue; mi != NULL; mi = mi->next) {
+            retval = addEventToMonitoredItem(server, NULL, &map, mi);
+            if(retval != UA_STATUSCODE_GOOD) {
+                UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                               "Events: Could not add the event to a listening node with StatusCode %s",
+                               UA_StatusCode_name(retval));
+            }
+        }
+        UA_NODESTORE_RELEASE(server, (const UA_Node*)node);
+    }
+
+    returnEventNotifiers(server, &notifiers);
+    UA_UNLOCK(server->serviceMutex);
+
+    /* Return the EventId */
+    if(outEventId)
+        *outEventId = eventId;
+    else
+        UA_ByteString_clear(&eventId);
+    return UA_STATUSCODE_GOOD;
+}
+
 #endif /* UA_ENABLE_SUBSCRIPTIONS_EVENTS */
@@ -260,8 +260,7 @@ UA_MonitoredItem_delete(UA_Server *server, UA_MonitoredItem *monitoredItem) {
     if(monitoredItem->listEntry.le_prev != NULL)
         LIST_REMOVE(monitoredItem, listEntry);
     UA_String_clear(&monitoredItem->indexRange);
-    UA_ByteString_clear(&monitoredItem->lastSampledValue);
-    UA_Variant_clear(&monitoredItem->lastValue);
+    UA_LastSample_clear(&monitoredItem->lastSample);
     UA_NodeId_clear(&monitoredItem->monitoredNodeId);
 
     /* No actual callback, just remove the structure */
@@ -358,6 +357,102 @@ UA_MonitoredItem_ensureQueueSpace(UA_Server *server, UA_MonitoredItem *mon) {
     return UA_STATUSCODE_GOOD;
 }
 
+/*******************/
+/* Sampling Groups */
+/*******************/
+
+static void
+UA_SamplingGroup_remove(UA_Server *server, UA_SamplingGroup *sg) {
+    removeCallback(server, sg->callbackId);
+    LIST_REMOVE(sg, listEntry);
+    UA_free(sg->items);
+    sg->items = NULL;
+    sg->itemsSize = 0;
+    sg->itemsCapacity = 0;
+    sg->removed = true;
+
+    /* Free only after sampling has finished. The callback might already be
+     * enqueued for a worker thread. So the memory is reclaimed with the delayed
+     * callbacks. */
+    if(sg->sampling > 0)
+        return;
+    sg->delayedFreePointers.callback = NULL;
+    UA_WorkQueue_enqueueDelayed(&server->workQueue, &sg->delayedFreePointers);
+}
+
+/* Remove the NULL entries left behind by items that were removed during
+ * sampling */
+static void
+UA_SamplingGroup_compact(UA_SamplingGroup *sg) {
+    size_t j = 0;
+    for(size_t i = 0; i < sg->itemsSize; i++) {
+        UA_MonitoredItem *mon = sg->items[i];
+        if(!mon)
+            continue;
+        mon->samplingGroupIndex = j;
+        sg->items[j] = mon;
+        j++;
+    }
+    sg->itemsSize = j;
+    sg->compact = false;
+}
+
+static void
+UA_SamplingGroup_sampleCallback(UA_Server *server, UA_SamplingGroup *sg) {
+    UA_LOCK(server->serviceMutex);
+
+    /* Items that are added during sampling are appended to the array. They are
+     * first sampled in the next pass. */
+    sg->sampling++;
+    size_t itemsSize = sg->itemsSize;
+    for(size_t i = 0; i < itemsSize && !sg->removed; i++) {
+        /* Don't hold a pointer into the array. It can be reallocated when the
+         * service mutex is released for a local MonitoredItem callback. */
+        UA_MonitoredItem *mon = sg->items[i];
+        if(mon)
+            monitoredItem_sampleCallback(server, mon);
+    }
+    sg->sampling--;
+
+    if(sg->sampling == 0) {
+        if(sg->removed) {
+            /* The group was removed during sampling */
+            sg->delayedFreePointers.callback = NULL;
+            UA_WorkQueue_enqueueDelayed(&server->workQueue, &sg->delayedFreePointers);
+        } else if(sg->compact) {
+            UA_SamplingGroup_compact(sg);
+            if(sg->itemsSize == 0)
+                UA_SamplingGroup_remove(server, sg);
+        }
+    }
+
+    UA_UNLOCK(server->serviceMutex);
+}
+
+static UA_SamplingGroup *
+UA_SamplingGroup_get(UA_Server *server, UA_Double samplingInterval) {
+    /* There are typically only few distinct sampling intervals */
+    UA_SamplingGroup *sg;
+    LIST_FOREACH(sg, &server->samplingGroups, listEntry) {
+        if(sg->samplingInterval == samplingInterval)
+            return sg;
+    }
+
+    sg = (UA_SamplingGroup*)UA_calloc(1, sizeof(UA_SamplingGroup));
+    if(!sg)
+        return NULL;
+    sg->samplingInterval = samplingInterval;
+    UA_StatusCode retval =
+        addRepeatedCallback(server, (UA_ServerCallback)UA_SamplingGroup_sampleCallback,
+                            sg, samplingInterval, &sg->callbackId);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_free(sg);
+        return NULL;
+    }
+    LIST_INSERT_HEAD(&server->samplingGroups, sg, listEntry);
+    return sg;
+}
+
 UA_StatusCode
 UA_MonitoredItem_registerSampleCallback(UA_Server *server, UA_MonitoredItem *mon) {
     UA_LOCK_ASSERT(server->serviceMutex, 1);
@@ -368,12 +463,30 @@ UA_MonitoredItem_registerSampleCallback(UA_Server *server, UA_MonitoredItem *mon
     if(mon->attributeId == UA_ATTRIBUTEID_EVENTNOTIFIER)
         return UA_STATUSCODE_GOOD;
 
-    UA_StatusCode retval =
-        addRepeatedCallback(server, (UA_ServerCallback)UA_MonitoredItem_sampleCallback,
-                            mon, mon->samplingInterval, &mon->sampleCallbackId);
-    if(retval == UA_STATUSCODE_GOOD)
-        mon->sampleCallbackIsRegistered = true;
-    return retval;
+    UA_SamplingGroup *sg = UA_SamplingGroup_get(server, mon->samplingInterval);
+    if(!sg)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    /* Grow the items array */
+    if(sg->itemsSize == sg->itemsCapacity) {
+        size_t newCapacity = (sg->itemsCapacity == 0) ? 8 : sg->itemsCapacity * 2;
+        UA_MonitoredItem **newItems = (UA_MonitoredItem**)
+            UA_realloc(sg->items, newCapacity * sizeof(UA_MonitoredItem*));
+        if(!newItems) {
+            if(sg->itemsSize == 0 && sg->sampling == 0)
+                UA_SamplingGroup_remove(server, sg);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+        sg->items = newItems;
+        sg->itemsCapacity = newCapacity;
+    }
+
+    mon->samplingGroup = sg;
+    mon->samplingGroupIndex = sg->itemsSize;
+    sg->items[sg->itemsSize] = mon;
+    sg->itemsSize++;
+    mon->sampleCallbackIsRegistered = true;
+    return UA_STATUSCODE_GOOD;
 }
 
 void
@@ -381,8 +494,29 @@ UA_MonitoredItem_unregisterSampleCallback(UA_Server *server, UA_MonitoredItem *m
     UA_LOCK_ASSERT(server->serviceMutex, 1);
     if(!mon->sampleCallbackIsRegistered)
         return;
-    removeCallback(server, mon->sampleCallbackId);
+
+    UA_SamplingGroup *sg = mon->samplingGroup;
+    UA_assert(sg->items[mon->samplingGroupIndex] == mon);
+    mon->samplingGroup = NULL;
     mon->sampleCallbackIsRegistered = false;
+
+    /* The group is currently sampled. Keep the positions stable. */
+    if(sg->sampling > 0) {
+        sg->items[mon->samplingGroupIndex] = NULL;
+        sg->compact = true;
+        return;
+    }
+
+    /* Move the last item into the free slot */
+    sg->itemsSize--;
+    if(mon->samplingGroupIndex < sg->itemsSize) {
+        UA_MonitoredItem *last = sg->items[sg->itemsSize];
+        last->samplingGroupIndex = mon->samplingGroupIndex;
+        sg->items[mon->samplingGroupIndex] = last;
+    }
+
+    if(sg->itemsSize == 0)
+        UA_SamplingGroup_remove(server, sg);
 }
 
 #endif /* UA_ENABLE_SUBSCRIPTIONS */
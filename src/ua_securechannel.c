@@ -541,59 +541,57 @@ decryptVerifySymmetricChunk(UA_SecureChannel *channel, const UA_SecurityPolicy *
     return res;
 }
 
+/* Number of chunks of a message that can be processed without allocating the
+ * array of segments */
+#define UA_STACKSEGMENTS 8
+
 static UA_StatusCode
-assembleProcessMessage(UA_SecureChannel *channel, UA_ChunkQueue *chunks, size_t chunksSize,
-                       UA_UInt32 requestId, UA_MessageType messageType,
-                       void *application, UA_ProcessMessageCallback callback) {
+processChunkedMessage(UA_SecureChannel *channel, UA_ChunkQueue *chunks, size_t chunksSize,
+                      UA_UInt32 requestId, UA_MessageType messageType,
+                      void *application, UA_ProcessMessageCallback callback) {
     /* Only MSG and CLO messages at this point */
     UA_assert(messageType == UA_MESSAGETYPE_MSG ||
               messageType == UA_MESSAGETYPE_CLO);
 
-    /* Assemble message */
+    /* The chunks are not copied into a contiguous buffer. The message is
+     * decoded from the payload of the individual chunks. */
+    UA_ByteString stackSegments[UA_STACKSEGMENTS];
+    UA_ByteString *segments = stackSegments;
+    if(chunksSize > UA_STACKSEGMENTS) {
+        segments = (UA_ByteString*)UA_malloc(sizeof(UA_ByteString) * chunksSize);
+        if(!segments)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+
+    /* Hide the MessageHeader and SequenceHeader. Compute the full message
+     * length. */
+    size_t messageLength = 0;
+    size_t i = 0;
     UA_Chunk *chunk;
-    UA_ByteString payload;
-    if(chunksSize > 1) {
-        /* Compute the full message length. Omit the MessageHeader and
-         * SequenceHeader. */
-        size_t messageLength = 0;
-        SIMPLEQ_FOREACH(chunk, chunks, pointers)
-            messageLength += chunk->bytes.length - 24;
-        
-        /* Test chunk count against the connection settings */
-        if(channel->config.localMaxMessageSize != 0 &&
-           messageLength > channel->config.localMaxMessageSize)
-            return UA_STATUSCODE_BADRESPONSETOOLARGE;
-        
-        /* Allocate memory for the full message */
-        UA_StatusCode res = UA_ByteString_allocBuffer(&payload, messageLength);
-        if(res != UA_STATUSCODE_GOOD)
-            return res;
-        
-        /* Assemble the full message */
-        size_t curPos = 0;
-        SIMPLEQ_FOREACH(chunk, chunks, pointers) {
-            UA_assert(chunk->bytes.length > 24);
-            memcpy(&payload.data[curPos], chunk->bytes.data + 24,
-                   chunk->bytes.length - 24);
-            curPos += chunk->bytes.length - 24;
-        }
+    SIMPLEQ_FOREACH(chunk, chunks, pointers) {
+        UA_assert(chunk->bytes.length > 24);
+        segments[i].data = chunk->bytes.data + 24;
+        segments[i].length = chunk->bytes.length - 24;
+        messageLength += segments[i].length;
+        i++;
+    }
+    UA_assert(i == chunksSize);
 
-        /* Process the message */
-        callback(application, channel, messageType, requestId, &payload);
-        UA_ByteString_deleteMembers(&payload);
-        return UA_STATUSCODE_GOOD;
+    /* Test the message length against the connection settings */
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    if(chunksSize > 1 && channel->config.localMaxMessageSize != 0 &&
+       messageLength > channel->config.localMaxMessageSize) {
+        res = UA_STATUSCODE_BADRESPONSETOOLARGE;
+        goto cleanup;
     }
-    
-    /* Hide the MessageHeader and SequenceHeader */
-    chunk = SIMPLEQ_FIRST(chunks);
-    payload = chunk->bytes;
-    UA_assert(chunk->bytes.length > 24);
-    payload.data += 24;
-    payload.length -= 24;
-    
+
     /* Process the message */
-    callback(application, channel, messageType, requestId, &payload);
-    return UA_STATUSCODE_GOOD;
+    callback(application, channel, messageType, requestId, segments, chunksSize);
+
+ cleanup:
+    if(segments != stackSegments)
+        UA_free(segments);
+    return res;
 }
 
 static UA_StatusCode
@@ -704,8 +702,8 @@ processSymmetricChunks(UA_SecureChannel *channel, UA_ChunkQueue *doneChunks,
             break;
     }
 
-    return assembleProcessMessage(channel, doneChunks, chunksSize, messageRequestId,
-                                  messageType, application, callback);
+    return processChunkedMessage(channel, doneChunks, chunksSize, messageRequestId,
+                                 messageType, application, callback);
 }
 
 static UA_StatusCode
@@ -724,7 +722,7 @@ processCompleteChunks(UA_SecureChannel *channel, void *application,
             /* Chunks that are processed entirely by the application */
             SIMPLEQ_REMOVE_HEAD(&channel->completeChunks, pointers);
             SIMPLEQ_INSERT_TAIL(&doneChunks, chunk, pointers);
-            callback(application, channel, chunk->messageType, 0, &chunk->bytes);
+            callback(application, channel, chunk->messageType, 0, &chunk->bytes, 1);
             break;
         default: /* MSG and CLO */
             res = processSymmetricChunks(channel, &doneChunks, application, callback);
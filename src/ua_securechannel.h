@@ -192,10 +192,14 @@ UA_MessageContext_abort(UA_MessageContext *mc);
  * Receive Message
  * --------------- */
 
+/* The message body is given as an array of segments. MSG and CLO messages that
+ * span several chunks are not reassembled. Every segment is the payload of one
+ * chunk. Use UA_decodeBinarySegments to decode from the segments. All other
+ * messages have a single segment. */
 typedef void
 (UA_ProcessMessageCallback)(void *application, UA_SecureChannel *channel,
                             UA_MessageType messageType, UA_UInt32 requestId,
-                            UA_ByteString *message);
+                            UA_ByteString *segments, size_t segmentsSize);
 
 /* Process a received buffer. The callback function is called with the message
  * body if the message is complete. The message is removed afterwards. Returns
@@ -18,6 +18,8 @@ _UA_BEGIN_DECLS
 struct UA_TimerEntry;
 typedef struct UA_TimerEntry UA_TimerEntry;
 
+#ifndef UA_ENABLE_TIMER_WHEEL
+
 ZIP_HEAD(UA_TimerZip, UA_TimerEntry);
 typedef struct UA_TimerZip UA_TimerZip;
 
@@ -31,6 +33,56 @@ typedef struct {
     UA_UInt64 idCounter;
 } UA_Timer;
 
+#else
+
+/* Hierarchical timing wheel. Every level has 64 slots. A slot in level 0 spans
+ * one tick of 1ms. A slot in level n spans 64^n ticks. Entries are placed in
+ * the lowest level that reaches their due time. When a level wraps around, the
+ * next slot of the level above is cascaded down. Adding, removing and
+ * rescheduling an entry are O(1).
+ *
+ * Repeated callbacks with the same interval are coalesced into a group. The
+ * group keeps its entries sorted by the next execution time. Only the group
+ * occupies a slot in the wheel, at the time of its first entry. */
+
+#define UA_TIMERWHEEL_BITS 6
+#define UA_TIMERWHEEL_SLOTS (1 << UA_TIMERWHEEL_BITS)
+#define UA_TIMERWHEEL_LEVELS 4
+#define UA_TIMERWHEEL_TICK UA_DATETIME_MSEC
+
+struct UA_TimerNode;
+typedef struct UA_TimerNode UA_TimerNode;
+
+struct UA_TimerGroup;
+typedef struct UA_TimerGroup UA_TimerGroup;
+
+LIST_HEAD(UA_TimerSlot, UA_TimerNode);
+
+/* Only for a single thread. Protect by a mutex if required. */
+typedef struct {
+    struct UA_TimerSlot slots[UA_TIMERWHEEL_LEVELS][UA_TIMERWHEEL_SLOTS];
+    UA_UInt64 occupied[UA_TIMERWHEEL_LEVELS]; /* Bitmap of non-empty slots */
+    UA_UInt64 current; /* The current tick */
+    size_t nodesSize;  /* Number of nodes in the slots */
+    UA_Boolean processing;
+    UA_TimerGroup *processingGroup; /* The group is not freed while its
+                                     * callbacks are executed */
+
+    /* Lookup of the entries by their identifier */
+    UA_TimerEntry **ids;
+    size_t idsSize;
+    size_t entriesSize;
+
+    /* Lookup of the groups by their interval */
+    UA_TimerGroup **groups;
+    size_t groupsSize;
+    size_t groupsCount;
+
+    UA_UInt64 idCounter;
+} UA_Timer;
+
+#endif
+
 void UA_Timer_init(UA_Timer *t);
 
 UA_StatusCode
@@ -0,0 +1,625 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "ua_util_internal.h"
+#include "ua_timer.h"
+
+#define UA_TIMERWHEEL_MASK ((UA_UInt64)UA_TIMERWHEEL_SLOTS - 1)
+
+/* The node is not in a slot */
+#define UA_TIMERNODE_NONE 0xfe
+
+/* The node is in the list that was taken out of the slot being processed */
+#define UA_TIMERNODE_DETACHED 0xff
+
+/* Common header for everything that is placed in the wheel */
+struct UA_TimerNode {
+    LIST_ENTRY(UA_TimerNode) slotEntry;
+    UA_DateTime time; /* The node is due at this time */
+    UA_Byte level;
+    UA_Byte slot;
+    UA_Boolean isGroup;
+};
+
+TAILQ_HEAD(UA_TimerEntryQueue, UA_TimerEntry);
+
+struct UA_TimerEntry {
+    UA_TimerNode node;    /* In the wheel for single-shot callbacks */
+    UA_TimerGroup *group; /* The group for repeated callbacks */
+    TAILQ_ENTRY(UA_TimerEntry) groupEntry;
+    UA_DateTime nextTime; /* The next time when the callback is to be
+                           * executed */
+    UA_UInt64 interval;   /* Interval in 100ns resolution */
+
+    UA_ApplicationCallback callback;
+    void *application;
+    void *data;
+
+    UA_UInt64 id;         /* Id of the entry */
+    UA_TimerEntry *idNext;
+};
+
+/* Repeated callbacks with the same interval. Entries that were executed are
+ * moved to the end. So the list stays sorted with an O(1) reinsertion in most
+ * cases. */
+struct UA_TimerGroup {
+    UA_TimerNode node;    /* In the wheel at the time of the first entry */
+    UA_UInt64 interval;
+    struct UA_TimerEntryQueue entries; /* Sorted by nextTime */
+    UA_TimerGroup *hashNext;
+};
+
+/* Position of the lowest set bit. v must not be zero. */
+static UA_Byte
+lowestBit(UA_UInt64 v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (UA_Byte)__builtin_ctzll(v);
+#else
+    UA_Byte r = 0;
+    while((v & 1) == 0) {
+        v >>= 1;
+        r++;
+    }
+    return r;
+#endif
+}
+
+static UA_UInt64
+toTick(UA_DateTime time) {
+    if(time < 0)
+        return 0;
+    return (UA_UInt64)time / UA_TIMERWHEEL_TICK;
+}
+
+void
+UA_Timer_init(UA_Timer *t) {
+    memset(t, 0, sizeof(UA_Timer));
+}
+
+/*********/
+/* Wheel */
+/*********/
+
+static void
+wheelInsert(UA_Timer *t, UA_TimerNode *n) {
+    /* Restart the empty wheel at the time of the node. But not later than
+     * the current time, so that nodes added later are not placed in the past. */
+    UA_UInt64 tick = toTick(n->time);
+    if(t->nodesSize == 0 && !t->processing) {
+        UA_UInt64 nowTick = toTick(UA_DateTime_nowMonotonic());
+        t->current = (tick < nowTick) ? tick : nowTick;
+    }
+
+    /* Nodes in the past go to the current slot */
+    if(tick < t->current)
+        tick = t->current;
+
+    /* Find the lowest level that reaches the tick. Nodes beyond the highest
+     * level are placed in its farthest slot and cascaded again later. */
+    UA_UInt64 delta = tick - t->current;
+    UA_Byte level = 0;
+    while(level < UA_TIMERWHEEL_LEVELS - 1 &&
+          delta >= ((UA_UInt64)1 << (UA_TIMERWHEEL_BITS * (level + 1))))
+        level++;
+    UA_UInt64 range = (UA_UInt64)1 << (UA_TIMERWHEEL_BITS * UA_TIMERWHEEL_LEVELS);
+    if(delta >= range)
+        tick = t->current + range - 1;
+
+    UA_Byte slot = (UA_Byte)((tick >> (UA_TIMERWHEEL_BITS * level)) & UA_TIMERWHEEL_MASK);
+    LIST_INSERT_HEAD(&t->slots[level][slot], n, slotEntry);
+    t->occupied[level] |= (UA_UInt64)1 << slot;
+    n->level = level;
+    n->slot = slot;
+    t->nodesSize++;
+}
+
+static void
+wheelRemove(UA_Timer *t, UA_TimerNode *n) {
+    if(n->level == UA_TIMERNODE_NONE)
+        return;
+    LIST_REMOVE(n, slotEntry);
+    if(n->level != UA_TIMERNODE_DETACHED) {
+        if(!LIST_FIRST(&t->slots[n->level][n->slot]))
+            t->occupied[n->level] &= ~((UA_UInt64)1 << n->slot);
+        t->nodesSize--;
+    }
+    n->level = UA_TIMERNODE_NONE;
+}
+
+/* Take all nodes out of a slot */
+static void
+wheelDetach(UA_Timer *t, UA_Byte level, UA_Byte slot, struct UA_TimerSlot *list) {
+    LIST_INIT(list);
+    UA_TimerNode *n;
+    while((n = LIST_FIRST(&t->slots[level][slot]))) {
+        LIST_REMOVE(n, slotEntry);
+        LIST_INSERT_HEAD(list, n, slotEntry);
+        n->level = UA_TIMERNODE_DETACHED;
+        t->nodesSize--;
+    }
+    t->occupied[level] &= ~((UA_UInt64)1 << slot);
+}
+
+/* Reinsert the nodes of a slot relative to the current tick */
+static void
+wheelCascade(UA_Timer *t, UA_Byte level, UA_Byte slot) {
+    struct UA_TimerSlot list;
+    wheelDetach(t, level, slot, &list);
+    UA_TimerNode *n;
+    while((n = LIST_FIRST(&list))) {
+        LIST_REMOVE(n, slotEntry);
+        n->level = UA_TIMERNODE_NONE;
+        wheelInsert(t, n);
+    }
+}
+
+/* The next tick where a slot needs to be processed or a level is cascaded.
+ * Skips over empty slots and the rotations of empty levels. */
+static UA_UInt64
+wheelNextTick(const UA_Timer *t, UA_UInt64 nowTick) {
+    if(t->nodesSize == 0)
+        return nowTick;
+
+    UA_UInt64 next = t->current + 1;
+    UA_Byte idx = (UA_Byte)(next & UA_TIMERWHEEL_MASK);
+    if(idx != 0) {
+        /* The next occupied slot in the remaining rotation of level 0 */
+        UA_UInt64 pending = t->occupied[0] >> idx;
+        if(pending) {
+            next += lowestBit(pending);
+            return (next < nowTick) ? next : nowTick;
+        }
+        next = (next | UA_TIMERWHEEL_MASK) + 1;
+    }
+
+    /* Nothing happens until the next cascade of a non-empty level */
+    for(size_t l = 1; l < UA_TIMERWHEEL_LEVELS; l++) {
+        if(t->occupied[l-1] != 0 || t->occupied[l] != 0)
+            break;
+        UA_UInt64 span = (UA_UInt64)1 << (UA_TIMERWHEEL_BITS * (l + 1));
+        next = (next + span - 1) & ~(span - 1);
+    }
+    return (next < nowTick) ? next : nowTick;
+}
+
+/* Returns a lower bound for the earliest due time. It is exact if the earliest
+ * node is in level 0. */
+static UA_DateTime
+wheelNextTime(const UA_Timer *t) {
+    UA_DateTime next = UA_INT64_MAX;
+
+    /* Level 0: The first occupied slot of the rotation has the earliest
+     * nodes of the level */
+    if(t->occupied[0]) {
+        UA_Byte idx = (UA_Byte)(t->current & UA_TIMERWHEEL_MASK);
+        UA_UInt64 rot = t->occupied[0] >> idx;
+        if(idx > 0)
+            rot |= t->occupied[0] << (UA_TIMERWHEEL_SLOTS - idx);
+        UA_Byte slot = (UA_Byte)((idx + lowestBit(rot)) & UA_TIMERWHEEL_MASK);
+        UA_TimerNode *n;
+        LIST_FOREACH(n, &t->slots[0][slot], slotEntry) {
+            if(n->time < next)
+                next = n->time;
+        }
+    }
+
+    /* Higher levels: The nodes are not due before their slot is cascaded */
+    for(size_t l = 1; l < UA_TIMERWHEEL_LEVELS; l++) {
+        if(!t->occupied[l])
+            continue;
+        UA_UInt64 base = t->current >> (UA_TIMERWHEEL_BITS * l);
+        UA_Byte idx = (UA_Byte)(base & UA_TIMERWHEEL_MASK);
+        UA_UInt64 rot = t->occupied[l] >> idx;
+        if(idx > 0)
+            rot |= t->occupied[l] << (UA_TIMERWHEEL_SLOTS - idx);
+        UA_UInt64 d = lowestBit(rot);
+        if(d == 0)
+            d = UA_TIMERWHEEL_SLOTS; /* The current slot is for the next rotation */
+        UA_UInt64 tick = (base + d) << (UA_TIMERWHEEL_BITS * l);
+        if(tick < (UA_UInt64)(UA_INT64_MAX / UA_TIMERWHEEL_TICK) &&
+           (UA_DateTime)(tick * UA_TIMERWHEEL_TICK) < next)
+            next = (UA_DateTime)(tick * UA_TIMERWHEEL_TICK);
+    }
+    return next;
+}
+
+/******************/
+/* Identifier Map */
+/******************/
+
+static UA_StatusCode
+idInsert(UA_Timer *t, UA_TimerEntry *te) {
+    /* Grow the table. Continue with the old table if that fails. */
+    if(t->entriesSize >= t->idsSize) {
+        size_t newSize = (t->idsSize == 0) ? 64 : t->idsSize * 2;
+        UA_TimerEntry **ids = (UA_TimerEntry**)UA_calloc(newSize, sizeof(UA_TimerEntry*));
+        if(ids) {
+            for(size_t i = 0; i < t->idsSize; i++) {
+                UA_TimerEntry *e = t->ids[i];
+                while(e) {
+                    UA_TimerEntry *next = e->idNext;
+                    size_t b = (size_t)(e->id & (newSize - 1));
+                    e->idNext = ids[b];
+                    ids[b] = e;
+                    e = next;
+                }
+            }
+            UA_free(t->ids);
+            t->ids = ids;
+            t->idsSize = newSize;
+        } else if(!t->ids) {
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+    }
+
+    size_t b = (size_t)(te->id & (t->idsSize - 1));
+    te->idNext = t->ids[b];
+    t->ids[b] = te;
+    t->entriesSize++;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_TimerEntry *
+idFind(const UA_Timer *t, UA_UInt64 id) {
+    if(t->idsSize == 0)
+        return NULL;
+    UA_TimerEntry *te = t->ids[id & (t->idsSize - 1)];
+    while(te && te->id != id)
+        te = te->idNext;
+    return te;
+}
+
+static void
+idRemove(UA_Timer *t, UA_TimerEntry *te) {
+    UA_TimerEntry **pp = &t->ids[te->id & (t->idsSize - 1)];
+    while(*pp != te)
+        pp = &(*pp)->idNext;
+    *pp = te->idNext;
+    t->entriesSize--;
+}
+
+/**********/
+/* Groups */
+/**********/
+
+static size_t
+groupHash(UA_UInt64 interval, size_t size) {
+    return (size_t)((interval * 0x9E3779B97F4A7C15ULL) >> 32) & (size - 1);
+}
+
+static UA_TimerGroup *
+groupFind(const UA_Timer *t, UA_UInt64 interval) {
+    if(t->groupsSize == 0)
+        return NULL;
+    UA_TimerGroup *g = t->groups[groupHash(interval, t->groupsSize)];
+    while(g && g->interval != interval)
+        g = g->hashNext;
+    return g;
+}
+
+static UA_TimerGroup *
+groupGet(UA_Timer *t, UA_UInt64 interval) {
+    UA_TimerGroup *g = groupFind(t, interval);
+    if(g)
+        return g;
+
+    /* Grow the table. Continue with the old table if that fails. */
+    if(t->groupsCount >= t->groupsSize) {
+        size_t newSize = (t->groupsSize == 0) ? 16 : t->groupsSize * 2;
+        UA_TimerGroup **groups = (UA_TimerGroup**)UA_calloc(newSize, sizeof(UA_TimerGroup*));
+        if(groups) {
+            for(size_t i = 0; i < t->groupsSize; i++) {
+                g = t->groups[i];
+                while(g) {
+                    UA_TimerGroup *next = g->hashNext;
+                    size_t b = groupHash(g->interval, newSize);
+                    g->hashNext = groups[b];
+                    groups[b] = g;
+                    g = next;
+                }
+            }
+            UA_free(t->groups);
+            t->groups = groups;
+            t->groupsSize = newSize;
+        } else if(!t->groups) {
+            return NULL;
+        }
+    }
+
+    g = (UA_TimerGroup*)UA_calloc(1, sizeof(UA_TimerGroup));
+    if(!g)
+        return NULL;
+    g->node.isGroup = true;
+    g->node.level = UA_TIMERNODE_NONE;
+    g->interval = interval;
+    TAILQ_INIT(&g->entries);
+
+    size_t b = groupHash(interval, t->groupsSize);
+    g->hashNext = t->groups[b];
+    t->groups[b] = g;
+    t->groupsCount++;
+    return g;
+}
+
+/* Insert sorted by the next time. Search from the end, where the entry usually
+ * goes. */
+static void
+groupAddEntry(UA_TimerGroup *g, UA_TimerEntry *te) {
+    te->group = g;
+    UA_TimerEntry *prev = TAILQ_LAST(&g->entries, UA_TimerEntryQueue);
+    while(prev && prev->nextTime > te->nextTime)
+        prev = TAILQ_PREV(prev, UA_TimerEntryQueue, groupEntry);
+    if(prev)
+        TAILQ_INSERT_AFTER(&g->entries, prev, te, groupEntry);
+    else
+        TAILQ_INSERT_HEAD(&g->entries, te, groupEntry);
+}
+
+/* Move the group in the wheel to the time of its first entry. Free the group
+ * when it is empty. Not during the processing of the group. */
+static void
+groupUpdate(UA_Timer *t, UA_TimerGroup *g) {
+    if(g == t->processingGroup)
+        return;
+
+    UA_TimerEntry *first = TAILQ_FIRST(&g->entries);
+    if(!first) {
+        wheelRemove(t, &g->node);
+        UA_TimerGroup **pp = &t->groups[groupHash(g->interval, t->groupsSize)];
+        while(*pp != g)
+            pp = &(*pp)->hashNext;
+        *pp = g->hashNext;
+        t->groupsCount--;
+        UA_free(g);
+        return;
+    }
+
+    if(g->node.level != UA_TIMERNODE_NONE && g->node.time == first->nextTime)
+        return;
+    wheelRemove(t, &g->node);
+    g->node.time = first->nextTime;
+    wheelInsert(t, &g->node);
+}
+
+/* Execute the due entries of the group up to the end of the current tick.
+ * Later entries are processed when the wheel reaches them. */
+static void
+groupProcess(UA_Timer *t, UA_TimerGroup *g, UA_DateTime nowMonotonic,
+             UA_TimerExecutionCallback executionCallback,
+             void *executionApplication) {
+    UA_DateTime tickEnd = (UA_DateTime)((t->current + 1) * UA_TIMERWHEEL_TICK);
+    t->processingGroup = g;
+    UA_TimerEntry *te;
+    while((te = TAILQ_FIRST(&g->entries)) &&
+          te->nextTime <= nowMonotonic && te->nextTime < tickEnd) {
+        /* Set the time for the next execution. Prevent an infinite loop by
+         * forcing the next processing into the next iteration. */
+        TAILQ_REMOVE(&g->entries, te, groupEntry);
+        te->nextTime += (UA_Int64)te->interval;
+        if(te->nextTime < nowMonotonic)
+            te->nextTime = nowMonotonic + 1;
+        groupAddEntry(g, te);
+
+        /* The callback may remove entries of the group */
+        executionCallback(executionApplication, te->callback,
+                          te->application, te->data);
+    }
+    t->processingGroup = NULL;
+    groupUpdate(t, g);
+}
+
+/***********/
+/* Entries */
+/***********/
+
+static UA_StatusCode
+addCallback(UA_Timer *t, UA_ApplicationCallback callback, void *application, void *data,
+            UA_DateTime nextTime, UA_UInt64 interval, UA_Boolean repeated,
+            UA_UInt64 *callbackId) {
+    /* A callback method needs to be present */
+    if(!callback)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    /* Allocate the repeated callback structure */
+    UA_TimerEntry *te = (UA_TimerEntry*)UA_calloc(1, sizeof(UA_TimerEntry));
+    if(!te)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    /* Set the repeated callback */
+    te->interval = interval;
+    te->id = ++t->idCounter;
+    te->callback = callback;
+    te->application = application;
+    te->data = data;
+    te->nextTime = nextTime;
+    te->node.time = nextTime;
+    te->node.level = UA_TIMERNODE_NONE;
+
+    UA_StatusCode retval = idInsert(t, te);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_free(te);
+        return retval;
+    }
+
+    if(repeated) {
+        UA_TimerGroup *g = groupGet(t, interval);
+        if(!g) {
+            idRemove(t, te);
+            UA_free(te);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+        groupAddEntry(g, te);
+        groupUpdate(t, g);
+    } else {
+        wheelInsert(t, &te->node);
+    }
+
+    /* Set the output identifier */
+    if(callbackId)
+        *callbackId = te->id;
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_Timer_addTimedCallback(UA_Timer *t, UA_ApplicationCallback callback,
+                          void *application, void *data, UA_DateTime date,
+                          UA_UInt64 *callbackId) {
+    return addCallback(t, callback, application, data, date, 0, false, callbackId);
+}
+
+UA_StatusCode
+UA_Timer_addRepeatedCallback(UA_Timer *t, UA_ApplicationCallback callback,
+                             void *application, void *data, UA_Double interval_ms,
+                             UA_UInt64 *callbackId) {
+    /* The interval needs to be positive */
+    if(interval_ms <= 0.0)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    UA_UInt64 interval = (UA_UInt64)(interval_ms * UA_DATETIME_MSEC);
+    UA_DateTime nextTime = UA_DateTime_nowMonotonic() + (UA_DateTime)interval;
+    return addCallback(t, callback, application, data, nextTime,
+                       interval, true, callbackId);
+}
+
+UA_StatusCode
+UA_Timer_changeRepeatedCallbackInterval(UA_Timer *t, UA_UInt64 callbackId,
+                                        UA_Double interval_ms) {
+    /* The interval needs to be positive */
+    if(interval_ms <= 0.0)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    UA_TimerEntry *te = idFind(t, callbackId);
+    if(!te)
+        return UA_STATUSCODE_BADNOTFOUND;
+
+    UA_UInt64 interval = (UA_UInt64)(interval_ms * UA_DATETIME_MSEC); /* in 100ns resolution */
+    UA_DateTime nextTime = UA_DateTime_nowMonotonic() + (UA_DateTime)interval;
+
+    /* Single-shot callback */
+    if(!te->group) {
+        wheelRemove(t, &te->node);
+        te->interval = interval;
+        te->nextTime = nextTime;
+        te->node.time = nextTime;
+        wheelInsert(t, &te->node);
+        return UA_STATUSCODE_GOOD;
+    }
+
+    /* Move to the group of the new interval */
+    UA_TimerGroup *g = groupGet(t, interval);
+    if(!g)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_TimerGroup *oldGroup = te->group;
+    TAILQ_REMOVE(&oldGroup->entries, te, groupEntry);
+    te->interval = interval;
+    te->nextTime = nextTime;
+    groupAddEntry(g, te);
+    groupUpdate(t, g);
+    if(oldGroup != g)
+        groupUpdate(t, oldGroup);
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_Timer_removeCallback(UA_Timer *t, UA_UInt64 callbackId) {
+    UA_TimerEntry *te = idFind(t, callbackId);
+    if(!te)
+        return;
+
+    idRemove(t, te);
+    if(te->group) {
+        TAILQ_REMOVE(&te->group->entries, te, groupEntry);
+        groupUpdate(t, te->group);
+    } else {
+        wheelRemove(t, &te->node);
+    }
+    UA_free(te);
+}
+
+UA_DateTime
+UA_Timer_process(UA_Timer *t, UA_DateTime nowMonotonic,
+                 UA_TimerExecutionCallback executionCallback,
+                 void *executionApplication) {
+    UA_UInt64 nowTick = toTick(nowMonotonic);
+    if(t->nodesSize == 0)
+        t->current = nowTick;
+
+    t->processing = true;
+    while(true) {
+        /* Cascade the next slot of the higher levels when the level below
+         * wraps around */
+        for(UA_Byte l = 1; l < UA_TIMERWHEEL_LEVELS; l++) {
+            if(((t->current >> (UA_TIMERWHEEL_BITS * (l - 1))) & UA_TIMERWHEEL_MASK) != 0)
+                break;
+            wheelCascade(t, l, (UA_Byte)((t->current >> (UA_TIMERWHEEL_BITS * l)) &
+                                         UA_TIMERWHEEL_MASK));
+        }
+
+        /* Process the slot of the current tick. Nodes that are added or
+         * rescheduled by the callbacks are not in the detached list. So they
+         * are processed at the earliest in the next iteration. */
+        struct UA_TimerSlot list;
+        wheelDetach(t, 0, (UA_Byte)(t->current & UA_TIMERWHEEL_MASK), &list);
+        UA_TimerNode *n;
+        while((n = LIST_FIRST(&list))) {
+            LIST_REMOVE(n, slotEntry);
+            n->level = UA_TIMERNODE_NONE;
+
+            /* Not due yet */
+            if(n->time > nowMonotonic) {
+                wheelInsert(t, n);
+                continue;
+            }
+
+            if(n->isGroup) {
+                groupProcess(t, (UA_TimerGroup*)n, nowMonotonic,
+                             executionCallback, executionApplication);
+                continue;
+            }
+
+            /* Single-shot callback. Remove first, as the callback can
+             * interact with the timer. */
+            UA_TimerEntry *te = (UA_TimerEntry*)n;
+            idRemove(t, te);
+            executionCallback(executionApplication, te->callback,
+                              te->application, te->data);
+            UA_free(te);
+        }
+
+        if(t->current >= nowTick)
+            break;
+        t->current = wheelNextTick(t, nowTick);
+    }
+    t->processing = false;
+
+    /* Return the timestamp of the earliest next callback */
+    return wheelNextTime(t);
+}
+
+void
+UA_Timer_deleteMembers(UA_Timer *t) {
+    /* Free all entries and groups */
+    for(size_t i = 0; i < t->idsSize; i++) {
+        UA_TimerEntry *te = t->ids[i];
+        while(te) {
+            UA_TimerEntry *next = te->idNext;
+            UA_free(te);
+            te = next;
+        }
+    }
+    for(size_t i = 0; i < t->groupsSize; i++) {
+        UA_TimerGroup *g = t->groups[i];
+        while(g) {
+            UA_TimerGroup *next = g->hashNext;
+            UA_free(g);
+            g = next;
+        }
+    }
+    UA_free(t->ids);
+    UA_free(t->groups);
+    UA_UInt64 idCounter = t->idCounter;
+    UA_Timer_init(t);
+    t->idCounter = idCounter;
+}
@@ -20,6 +20,7 @@
 #include <open62541/types_generated_handling.h>
 
 #include "ua_util_internal.h"
+#include "ua_types_encoding_binary.h"
 #include "libc_time.h"
 #include "pcg_basic.h"
 
@@ -47,34 +48,35 @@ typedef void (*UA_clearSignature)(void *p, const UA_DataType *type);
 extern const UA_copySignature copyJumpTable[UA_DATATYPEKINDS];
 extern const UA_clearSignature clearJumpTable[UA_DATATYPEKINDS];
 
-/* TODO: The standard-defined types are ordered. See if binary search is
- * more efficient. */
+const UA_DataType *
+UA_findDataTypeByNumericId(UA_UInt16 namespaceIndex, UA_UInt32 numericId,
+                           UA_Boolean binaryEncodingId) {
+    /* The hash function and the linear probing must match the generator of the
+     * hash tables */
+    const UA_UInt16 *table = binaryEncodingId ?
+        UA_TYPES_BINARYENCODINGIDHASH : UA_TYPES_TYPEIDHASH;
+    const UA_UInt32 mask = (1u << UA_TYPES_HASHBITS) - 1;
+    UA_UInt32 slot = (UA_UInt32)(numericId * 2654435761u) >> (32 - UA_TYPES_HASHBITS);
+    for(; table[slot] != 0; slot = (slot + 1) & mask) {
+        const UA_DataType *type = &UA_TYPES[table[slot] - 1];
+        UA_UInt32 id = binaryEncodingId ?
+            type->binaryEncodingId : type->typeId.identifier.numeric;
+        if(id == numericId && type->typeId.namespaceIndex == namespaceIndex)
+            return type;
+    }
+    return NULL;
+}
+
 const UA_DataType *
 UA_findDataType(const UA_NodeId *typeId) {
     if(typeId->identifierType != UA_NODEIDTYPE_NUMERIC)
         return NULL;
 
-    /* Always look in built-in types first
-     * (may contain data types from all namespaces) */
-    for(size_t i = 0; i < UA_TYPES_COUNT; ++i) {
-        if(UA_TYPES[i].typeId.identifier.numeric == typeId->identifier.numeric
-           && UA_TYPES[i].typeId.namespaceIndex == typeId->namespaceIndex)
-            return &UA_TYPES[i];
-    }
-
-    /* TODO When other namespace look in custom types, too, requires access to custom types array here! */
-    /*if(typeId->namespaceIndex != 0) {
-        size_t customTypesArraySize;
-        const UA_DataType *customTypesArray;
-        UA_getCustomTypes(&customTypesArraySize, &customTypesArray);
-        for(size_t i = 0; i < customTypesArraySize; ++i) {
-            if(customTypesArray[i].typeId.identifier.numeric == typeId->identifier.numeric
-               && customTypesArray[i].typeId.namespaceIndex == typeId->namespaceIndex)
-                return &customTypesArray[i];
-        }
-    }*/
-
-    return NULL;
+    /* Look in built-in types (may contain data types from all namespaces).
+     * TODO: Look in the custom types, too. This requires access to the custom
+     * types array here. */
+    return UA_findDataTypeByNumericId(typeId->namespaceIndex,
+                                      typeId->identifier.numeric, false);
 }
 
 /***************************/
@@ -41,6 +41,11 @@
 /* Part 6 §5.1.5: Decoders shall support at least 100 nesting levels */
 #define UA_ENCODING_MAX_RECURSION 100
 
+#define UA_CUSTOMTYPES_CACHESIZE 8 /* Power of two */
+
+/* Largest value that is reassembled when it crosses a segment boundary */
+#define UA_DECODE_STITCHSIZE 8
+
 typedef struct {
     /* Pointers to the current position and the last position in the buffer */
     u8 *pos;
@@ -52,6 +57,22 @@ typedef struct {
     const UA_DataTypeArray *customTypes;
     UA_exchangeEncodeBuffer exchangeBufferCallback;
     void *exchangeBufferCallbackHandle;
+
+    /* Cache of custom types found during decoding. The slot is given by the
+     * lowest bits of the binary encoding id. Messages usually contain many
+     * ExtensionObjects of only a few types. */
+    const UA_DataType *customTypesCache[UA_CUSTOMTYPES_CACHESIZE];
+
+    /* Decoding from a message split into segments. The decoding window
+     * [start, end) lies in the current segment or in the stitch buffer. */
+    u8 *start;
+    size_t startOffset; /* Offset of the window start in the message */
+    const UA_ByteString *segments; /* NULL for a contiguous buffer */
+    size_t segmentsSize;
+    size_t segmentsLength; /* Summed length of all segments */
+    size_t segment;        /* Index of the current segment */
+    size_t segmentOffset;  /* Offset of the current segment in the message */
+    u8 stitch[UA_DECODE_STITCHSIZE];
 } Ctx;
 
 typedef status
@@ -116,6 +137,128 @@ encodeWithExchangeBuffer(const void *ptr, const UA_DataType *type, Ctx *ctx) {
 #define ENCODE_WITHEXCHANGE(VAR, TYPE) \
     encodeWithExchangeBuffer((const void*)VAR, &UA_TYPES[TYPE], ctx)
 
+/* Messages that are received in several chunks can be decoded from the chunks
+ * directly without copying them into a contiguous buffer first. When the
+ * current segment is exhausted, the decoding window moves to the next segment.
+ * The (few) primitive values that cross a segment boundary are reassembled in
+ * the stitch buffer. Strings and arrays are copied segment by segment. */
+
+static size_t
+decodeOffset(const Ctx *ctx) {
+    return ctx->startOffset + (size_t)(ctx->pos - ctx->start);
+}
+
+/* Move the decoding window to the offset in the message */
+static void
+decodeSeek(Ctx *ctx, size_t offset) {
+    if(!ctx->segments) {
+        ctx->pos = ctx->start + (offset - ctx->startOffset);
+        return;
+    }
+
+    /* Find the segment containing the offset. Rewind if needed. */
+    if(offset < ctx->segmentOffset) {
+        ctx->segment = 0;
+        ctx->segmentOffset = 0;
+    }
+    while(ctx->segment < ctx->segmentsSize &&
+          offset >= ctx->segmentOffset + ctx->segments[ctx->segment].length) {
+        ctx->segmentOffset += ctx->segments[ctx->segment].length;
+        ctx->segment++;
+    }
+
+    ctx->startOffset = offset;
+    if(ctx->segment == ctx->segmentsSize) {
+        /* Empty window at the end of the message */
+        ctx->start = ctx->stitch;
+        ctx->pos = ctx->stitch;
+        ctx->end = ctx->stitch;
+        return;
+    }
+
+    const UA_ByteString *segment = &ctx->segments[ctx->segment];
+    ctx->start = &segment->data[offset - ctx->segmentOffset];
+    ctx->pos = ctx->start;
+    ctx->end = &segment->data[segment->length];
+}
+
+/* Copy from the segments starting at the offset in the message */
+static status
+decodeCopySegments(const Ctx *ctx, size_t offset, u8 *dst, size_t length) {
+    if(offset + length > ctx->segmentsLength)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    size_t i = ctx->segment;
+    size_t segmentOffset = ctx->segmentOffset;
+    if(offset < segmentOffset) {
+        i = 0;
+        segmentOffset = 0;
+    }
+    for(; length > 0; i++) {
+        const UA_ByteString *segment = &ctx->segments[i];
+        if(offset < segmentOffset + segment->length) {
+            size_t segmentPos = offset - segmentOffset;
+            size_t n = segment->length - segmentPos;
+            if(n > length)
+                n = length;
+            memcpy(dst, &segment->data[segmentPos], n);
+            dst += n;
+            offset += n;
+            length -= n;
+        }
+        segmentOffset += segment->length;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Make length contiguous bytes available at ctx->pos. Called only when the
+ * current decoding window is too short. */
+static status
+decodeStitch(Ctx *ctx, size_t length) {
+    if(!ctx->segments)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    size_t offset = decodeOffset(ctx);
+    decodeSeek(ctx, offset);
+    if(ctx->pos + length <= ctx->end)
+        return UA_STATUSCODE_GOOD;
+
+    /* The value crosses a segment boundary */
+    if(length > UA_DECODE_STITCHSIZE)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    status ret = decodeCopySegments(ctx, offset, ctx->stitch, length);
+    if(ret != UA_STATUSCODE_GOOD)
+        return ret;
+    ctx->start = ctx->stitch;
+    ctx->startOffset = offset;
+    ctx->pos = ctx->stitch;
+    ctx->end = &ctx->stitch[length];
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Copy bytes out of the message (possibly from several segments) */
+static status
+decodeCopy(Ctx *ctx, void *dst, size_t length) {
+    if(ctx->pos + length <= ctx->end) {
+        memcpy(dst, ctx->pos, length);
+        ctx->pos += length;
+        return UA_STATUSCODE_GOOD;
+    }
+    if(!ctx->segments)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    size_t offset = decodeOffset(ctx);
+    status ret = decodeCopySegments(ctx, offset, (u8*)dst, length);
+    if(ret != UA_STATUSCODE_GOOD)
+        return ret;
+    decodeSeek(ctx, offset + length);
+    return UA_STATUSCODE_GOOD;
+}
+
+static size_t
+decodeRemaining(const Ctx *ctx) {
+    if(!ctx->segments)
+        return (size_t)(ctx->end - ctx->pos);
+    return ctx->segmentsLength - decodeOffset(ctx);
+}
+
 /*****************/
 /* Integer Types */
 /*****************/
@@ -184,7 +327,7 @@ ENCODE_BINARY(Boolean) {
 }
 
 DECODE_BINARY(Boolean) {
-    if(ctx->pos + 1 > ctx->end)
+    if(ctx->pos + 1 > ctx->end && decodeStitch(ctx, 1) != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADDECODINGERROR;
     *dst = (*ctx->pos > 0) ? true : false;
     ++ctx->pos;
@@ -201,7 +344,7 @@ ENCODE_BINARY(Byte) {
 }
 
 DECODE_BINARY(Byte) {
-    if(ctx->pos + sizeof(u8) > ctx->end)
+    if(ctx->pos + sizeof(u8) > ctx->end && decodeStitch(ctx, sizeof(u8)) != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADDECODINGERROR;
     *dst = *ctx->pos;
     ++ctx->pos;
@@ -222,7 +365,7 @@ ENCODE_BINARY(UInt16) {
 }
 
 DECODE_BINARY(UInt16) {
-    if(ctx->pos + sizeof(u16) > ctx->end)
+    if(ctx->pos + sizeof(u16) > ctx->end && decodeStitch(ctx, sizeof(u16)) != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADDECODINGERROR;
 #if UA_BINARY_OVERLAYABLE_INTEGER
     memcpy(dst, ctx->pos, sizeof(u16));
@@ -247,7 +390,7 @@ ENCODE_BINARY(UInt32) {
 }
 
 DECODE_BINARY(UInt32) {
-    if(ctx->pos + sizeof(u32) > ctx->end)
+    if(ctx->pos + sizeof(u32) > ctx->end && decodeStitch(ctx, sizeof(u32)) != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADDECODINGERROR;
 #if UA_BINARY_OVERLAYABLE_INTEGER
     memcpy(dst, ctx->pos, sizeof(u32));
@@ -272,7 +415,7 @@ ENCODE_BINARY(UInt64) {
 }
 
 DECODE_BINARY(UInt64) {
-    if(ctx->pos + sizeof(u64) > ctx->end)
+    if(ctx->pos + sizeof(u64) > ctx->end && decodeStitch(ctx, sizeof(u64)) != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADDECODINGERROR;
 #if UA_BINARY_OVERLAYABLE_INTEGER
     memcpy(dst, ctx->pos, sizeof(u64));
@@ -494,7 +637,7 @@ Array_decodeBinary(void *UA_RESTRICT *UA_RESTRICT dst, size_t *out_length,
      * is too small for the array length. This prevents the allocation of very
      * long arrays for bogus messages.*/
     size_t length = (size_t)signed_length;
-    if(ctx->pos + ((type->memSize * length) / 32) > ctx->end)
+    if((type->memSize * length) / 32 > decodeRemaining(ctx))
         return UA_STATUSCODE_BADDECODINGERROR;
 
     /* Allocate memory */
@@ -504,13 +647,12 @@ Array_decodeBinary(void *UA_RESTRICT *UA_RESTRICT dst, size_t *out_length,
 
     if(type->overlayable) {
         /* memcpy overlayable array */
-        if(ctx->end < ctx->pos + (type->memSize * length)) {
+        ret = decodeCopy(ctx, *dst, type->memSize * length);
+        if(ret != UA_STATUSCODE_GOOD) {
             UA_free(*dst);
             *dst = NULL;
-            return UA_STATUSCODE_BADDECODINGERROR;
+            return ret;
         }
-        memcpy(*dst, ctx->pos, type->memSize * length);
-        ctx->pos += type->memSize * length;
     } else {
         /* Decode array members */
         uintptr_t ptr = (uintptr_t)*dst;
@@ -559,10 +701,7 @@ DECODE_BINARY(Guid) {
     ret |= DECODE_DIRECT(&dst->data1, UInt32);
     ret |= DECODE_DIRECT(&dst->data2, UInt16);
     ret |= DECODE_DIRECT(&dst->data3, UInt16);
-    if(ctx->pos + (8*sizeof(u8)) > ctx->end)
-        return UA_STATUSCODE_BADDECODINGERROR;
-    memcpy(dst->data4, ctx->pos, 8*sizeof(u8));
-    ctx->pos += 8;
+    ret |= decodeCopy(ctx, dst->data4, 8*sizeof(u8));
     return ret;
 }
 
@@ -712,7 +851,7 @@ ENCODE_BINARY(ExpandedNodeId) {
 
 DECODE_BINARY(ExpandedNodeId) {
     /* Decode the encoding mask */
-    if(ctx->pos >= ctx->end)
+    if(ctx->pos >= ctx->end && decodeStitch(ctx, 1) != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADDECODINGERROR;
     u8 encoding = *ctx->pos;
 
@@ -792,18 +931,30 @@ UA_findDataTypeByBinaryInternal(const UA_NodeId *typeId, Ctx *ctx) {
 
     /* Always look in built-in types first
      * (may contain data types from all namespaces) */
-    for(size_t i = 0; i < UA_TYPES_COUNT; ++i) {
-        if(UA_TYPES[i].binaryEncodingId == typeId->identifier.numeric &&
-           UA_TYPES[i].typeId.namespaceIndex == typeId->namespaceIndex)
-            return &UA_TYPES[i];
-    }
+    const UA_DataType *type =
+        UA_findDataTypeByNumericId(typeId->namespaceIndex,
+                                   typeId->identifier.numeric, true);
+    if(type)
+        return type;
 
     const UA_DataTypeArray *customTypes = ctx->customTypes;
+    if(!customTypes)
+        return NULL;
+
+    /* Look in the cache of previously found custom types */
+    const UA_DataType **cached = &ctx->customTypesCache[typeId->identifier.numeric &
+                                                         (UA_CUSTOMTYPES_CACHESIZE - 1)];
+    if(*cached && (*cached)->binaryEncodingId == typeId->identifier.numeric &&
+       (*cached)->typeId.namespaceIndex == typeId->namespaceIndex)
+        return *cached;
+
     while(customTypes) {
         for(size_t i = 0; i < customTypes->typesSize; ++i) {
             if(customTypes->types[i].binaryEncodingId == typeId->identifier.numeric &&
-               customTypes->types[i].typeId.namespaceIndex == typeId->namespaceIndex)
-                return &customTypes->types[i];
+               customTypes->types[i].typeId.namespaceIndex == typeId->namespaceIndex) {
+                *cached = &customTypes->types[i];
+                return *cached;
+            }
         }
         customTypes = customTypes->next;
     }
@@ -889,14 +1040,17 @@ ExtensionObject_decodeBinaryContent(UA_ExtensionObject *dst, const UA_NodeId *ty
         return DECODE_DIRECT(&dst->content.encoded.body, String); /* ByteString */
     }
 
+    /* Jump over the length field (TODO: check if the decoded length matches).
+     * Before the allocation, so that nothing leaks on truncated input. */
+    if(ctx->pos + 4 > ctx->end && decodeStitch(ctx, 4) != UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    ctx->pos += 4;
+
     /* Allocate memory */
     dst->content.decoded.data = UA_new(type);
     if(!dst->content.decoded.data)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
-    /* Jump over the length field (TODO: check if the decoded length matches) */
-    ctx->pos += 4;
-
     /* Decode */
     dst->encoding = UA_EXTENSIONOBJECT_DECODED;
     dst->content.decoded.type = type;
@@ -1037,7 +1191,7 @@ static status
 Variant_decodeBinaryUnwrapExtensionObject(UA_Variant *dst, Ctx *ctx) {
     /* Save the position in the ByteString. If unwrapping is not possible, start
      * from here to decode a normal ExtensionObject. */
-    u8 *old_pos = ctx->pos;
+    size_t old_offset = decodeOffset(ctx);
 
     /* Decode the DataType */
     UA_NodeId typeId;
@@ -1058,11 +1212,15 @@ Variant_decodeBinaryUnwrapExtensionObject(UA_Variant *dst, Ctx *ctx) {
     if(encoding == UA_EXTENSIONOBJECT_ENCODED_BYTESTRING &&
        (dst->type = UA_findDataTypeByBinaryInternal(&typeId, ctx)) != NULL) {
         /* Jump over the length field (TODO: check if length matches) */
+        if(ctx->pos + 4 > ctx->end && decodeStitch(ctx, 4) != UA_STATUSCODE_GOOD) {
+            UA_NodeId_clear(&typeId);
+            return UA_STATUSCODE_BADDECODINGERROR;
+        }
         ctx->pos += 4;
     } else {
         /* Reset and decode as ExtensionObject */
         dst->type = &UA_TYPES[UA_TYPES_EXTENSIONOBJECT];
-        ctx->pos = old_pos;
+        decodeSeek(ctx, old_offset);
         UA_NodeId_clear(&typeId);
     }
 
@@ -1631,6 +1789,8 @@ decodeBinaryUnion(void *dst, const UA_DataType *type, Ctx *ctx) {
     ctx->depth++;
     uintptr_t ptr = (uintptr_t)dst;
     status ret;
+    if(ctx->pos + 4 > ctx->end && decodeStitch(ctx, 4) != UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_BADDECODINGERROR;
     UA_UInt32 selection = *(UA_UInt32*) ctx->pos;
     if(selection == 0)
         return decodeBinaryJumpTable[UA_TYPES_UINT32]((void *UA_RESTRICT)ptr, &UA_TYPES[UA_TYPES_UINT32], ctx);
@@ -1698,6 +1858,10 @@ UA_decodeBinary(const UA_ByteString *src, size_t *offset, void *dst,
     ctx.end = &src->data[src->length];
     ctx.depth = 0;
     ctx.customTypes = customTypes;
+    memset(ctx.customTypesCache, 0, sizeof(ctx.customTypesCache));
+    ctx.start = src->data;
+    ctx.startOffset = 0;
+    ctx.segments = NULL;
 
     /* Decode */
     memset(dst, 0, type->memSize); /* Initialize the value */
@@ -1714,6 +1878,44 @@ UA_decodeBinary(const UA_ByteString *src, size_t *offset, void *dst,
     return ret;
 }
 
+status
+UA_decodeBinarySegments(const UA_ByteString *segments, size_t segmentsSize,
+                        size_t *offset, void *dst, const UA_DataType *type,
+                        const UA_DataTypeArray *customTypes) {
+    if(segmentsSize == 1)
+        return UA_decodeBinary(segments, offset, dst, type, customTypes);
+
+    /* Set up the context */
+    Ctx ctx;
+    ctx.depth = 0;
+    ctx.customTypes = customTypes;
+    memset(ctx.customTypesCache, 0, sizeof(ctx.customTypesCache));
+    ctx.segments = segments;
+    ctx.segmentsSize = segmentsSize;
+    ctx.segmentsLength = 0;
+    for(size_t i = 0; i < segmentsSize; i++)
+        ctx.segmentsLength += segments[i].length;
+    ctx.segment = 0;
+    ctx.segmentOffset = 0;
+    if(*offset > ctx.segmentsLength)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    decodeSeek(&ctx, *offset);
+
+    /* Decode */
+    memset(dst, 0, type->memSize); /* Initialize the value */
+    status ret = decodeBinaryJumpTable[type->typeKind](dst, type, &ctx);
+
+    if(ret == UA_STATUSCODE_GOOD) {
+        /* Set the new offset */
+        *offset = decodeOffset(&ctx);
+    } else {
+        /* Clean up */
+        UA_clear(dst, type);
+        memset(dst, 0, type->memSize);
+    }
+    return ret;
+}
+
 /**
  * Compute the Message Size
  * ------------------------
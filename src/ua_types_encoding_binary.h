@@ -65,6 +65,17 @@ UA_decodeBinary(const UA_ByteString *src, size_t *offset, void *dst,
                 const UA_DataType *type, const UA_DataTypeArray *customTypes)
     UA_FUNC_ATTR_WARN_UNUSED_RESULT;
 
+/* Decodes a value from a message that is split into several segments (e.g. the
+ * chunks of a SecureChannel message) without copying the segments into a
+ * contiguous buffer first. The segments are decoded as if they were
+ * concatenated. The offset refers to the position in the concatenated
+ * segments. Otherwise the same as UA_decodeBinary. */
+UA_StatusCode
+UA_decodeBinarySegments(const UA_ByteString *segments, size_t segmentsSize,
+                        size_t *offset, void *dst, const UA_DataType *type,
+                        const UA_DataTypeArray *customTypes)
+    UA_FUNC_ATTR_WARN_UNUSED_RESULT;
+
 /* Returns the number of bytes the value p takes in binary encoding. Returns
  * zero if an error occurs. UA_calcSizeBinary is thread-safe and reentrant since
  * it does not access global (thread-local) variables. */
@@ -74,6 +85,12 @@ UA_calcSizeBinary(const void *p, const UA_DataType *type);
 const UA_DataType *
 UA_findDataTypeByBinary(const UA_NodeId *typeId);
 
+/* Look up a type in UA_TYPES by the numeric identifier of its typeId or its
+ * binary encoding. Uses the hash tables generated with UA_TYPES. */
+const UA_DataType *
+UA_findDataTypeByNumericId(UA_UInt16 namespaceIndex, UA_UInt32 numericId,
+                           UA_Boolean binaryEncodingId);
+
 _UA_END_DECLS
 
 #endif /* UA_TYPES_ENCODING_BINARY_H_ */
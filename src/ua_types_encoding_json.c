@@ -1579,11 +1579,7 @@ UA_calcSizeJson(const void *src, const UA_DataType *type,
  * last parsed token. So the array length has to be checked afterwards. */
 static void
 skipObject(ParseCtx *parseCtx) {
-    int end = parseCtx->tokenArray[parseCtx->index].end;
-    do {
-        parseCtx->index++;
-    } while(parseCtx->index < parseCtx->tokenCount &&
-            parseCtx->tokenArray[parseCtx->index].start < end);
+    parseCtx->index = parseCtx->tokenArray[parseCtx->index].next;
 }
 
 static status
@@ -1618,7 +1614,7 @@ isJsonNull(const CtxJson *ctx, const ParseCtx *parseCtx) {
     return (elem[0] == 'n' && elem[1] == 'u' && elem[2] == 'l' && elem[3] == 'l');
 }
 
-static UA_SByte jsoneq(const char *json, jsmntok_t *tok, const char *searchKey) {
+static UA_SByte jsoneq(const char *json, const JsonToken *tok, const char *searchKey) {
     /* TODO: necessary?
        if(json == NULL
             || tok == NULL 
@@ -2247,138 +2243,37 @@ DECODE_JSON(QualifiedName) {
     return decodeFields(ctx, parseCtx, entries, 2, type);
 }
 
-/* Function for searching ahead of the current token. Used for retrieving the
- * OPC UA type of a token */
-static status
-searchObjectForKeyRec(const char *searchKey, CtxJson *ctx, 
-                      ParseCtx *parseCtx, size_t *resultIndex, UA_UInt16 depth) {
-    UA_StatusCode ret = UA_STATUSCODE_BADNOTFOUND;
-    
-    CHECK_TOKEN_BOUNDS;
-    
-    if(parseCtx->tokenArray[parseCtx->index].type == JSMN_OBJECT) {
-        size_t objectCount = (size_t)parseCtx->tokenArray[parseCtx->index].size;
-        parseCtx->index++; /*Object to first Key*/
-        
-        for(size_t i = 0; i < objectCount; i++) {
-            CHECK_TOKEN_BOUNDS;
-            if(depth == 0) { /* we search only on first layer */
-                if(jsoneq((char*)ctx->pos, &parseCtx->tokenArray[parseCtx->index], searchKey) == 0) {
-                    /*found*/
-                    parseCtx->index++; /*We give back a pointer to the value of the searched key!*/
-                    if (parseCtx->index >= parseCtx->tokenCount)
-                        /* We got invalid json. See https://bugs.chromium.org/p/oss-fuzz/issues/detail?id=14620 */
-                        return UA_STATUSCODE_BADOUTOFRANGE;
-                    *resultIndex = parseCtx->index;
-                    return UA_STATUSCODE_GOOD;
-                }
-            }
-               
-            parseCtx->index++; /* value */
-            CHECK_TOKEN_BOUNDS;
-            
-            if(parseCtx->tokenArray[parseCtx->index].type == JSMN_OBJECT) {
-               ret = searchObjectForKeyRec(searchKey, ctx, parseCtx, resultIndex,
-                                           (UA_UInt16)(depth + 1));
-            } else if(parseCtx->tokenArray[parseCtx->index].type == JSMN_ARRAY) {
-               ret = searchObjectForKeyRec(searchKey, ctx, parseCtx, resultIndex,
-                                           (UA_UInt16)(depth + 1));
-            } else {
-                /* Only Primitive or string */
-                parseCtx->index++;
-            }
-        }
-    } else if(parseCtx->tokenArray[parseCtx->index].type == JSMN_ARRAY) {
-        size_t arraySize = (size_t)parseCtx->tokenArray[parseCtx->index].size;
-        parseCtx->index++; /*Object to first element*/
-        
-        for(size_t i = 0; i < arraySize; i++) {
-            CHECK_TOKEN_BOUNDS;
-            if(parseCtx->tokenArray[parseCtx->index].type == JSMN_OBJECT) {
-               ret = searchObjectForKeyRec(searchKey, ctx, parseCtx, resultIndex,
-                                           (UA_UInt16)(depth + 1));
-            } else if(parseCtx->tokenArray[parseCtx->index].type == JSMN_ARRAY) {
-               ret = searchObjectForKeyRec(searchKey, ctx, parseCtx, resultIndex,
-                                           (UA_UInt16)(depth + 1));
-            } else {
-                /* Only Primitive or string */
-                parseCtx->index++;
-            }
-        }
-    }
-    return ret;
-}
-
+/* Search for a key among the direct members of the object at the current
+ * token. Used for retrieving the OPC UA type of a token before the members are
+ * decoded. Nested values are stepped over with their skip link, so the lookup
+ * is linear in the number of keys of the object and not in its subtree. */
 UA_FUNC_ATTR_WARN_UNUSED_RESULT status
 lookAheadForKey(const char* search, CtxJson *ctx,
                 ParseCtx *parseCtx, size_t *resultIndex) {
-    UA_UInt16 oldIndex = parseCtx->index; /* Save index for later restore */
-    
-    UA_UInt16 depth = 0;
-    UA_StatusCode ret  = searchObjectForKeyRec(search, ctx, parseCtx, resultIndex, depth);
-
-    parseCtx->index = oldIndex; /* Restore index */
-    return ret;
-}
-
-/* Function used to jump over an object which cannot be parsed */
-static status
-jumpOverRec(CtxJson *ctx, ParseCtx *parseCtx,
-            size_t *resultIndex, UA_UInt16 depth) {
-    UA_StatusCode ret = UA_STATUSCODE_BADDECODINGERROR;
     CHECK_TOKEN_BOUNDS;
-    
-    if(parseCtx->tokenArray[parseCtx->index].type == JSMN_OBJECT) {
-        size_t objectCount = (size_t)(parseCtx->tokenArray[parseCtx->index].size);
-        
-        parseCtx->index++; /*Object to first Key*/
-        CHECK_TOKEN_BOUNDS;
-        
-        size_t i;
-        for(i = 0; i < objectCount; i++) {
-            CHECK_TOKEN_BOUNDS;
-             
-            parseCtx->index++; /*value*/
-            CHECK_TOKEN_BOUNDS;
-            
-            if(parseCtx->tokenArray[parseCtx->index].type == JSMN_OBJECT) {
-               jumpOverRec(ctx, parseCtx, resultIndex, (UA_UInt16)(depth + 1));
-            } else if(parseCtx->tokenArray[parseCtx->index].type == JSMN_ARRAY) {
-               jumpOverRec(ctx, parseCtx, resultIndex, (UA_UInt16)(depth + 1));
-            } else {
-                /*Only Primitive or string*/
-                parseCtx->index++;
-            }
-        }
-    } else if(parseCtx->tokenArray[parseCtx->index].type == JSMN_ARRAY) {
-        size_t arraySize = (size_t)(parseCtx->tokenArray[parseCtx->index].size);
-        
-        parseCtx->index++; /*Object to first element*/
-        CHECK_TOKEN_BOUNDS;
-        
-        size_t i;
-        for(i = 0; i < arraySize; i++) {
-            if(parseCtx->tokenArray[parseCtx->index].type == JSMN_OBJECT) {
-               jumpOverRec(ctx, parseCtx, resultIndex, (UA_UInt16)(depth + 1));
-            } else if(parseCtx->tokenArray[parseCtx->index].type == JSMN_ARRAY) {
-               jumpOverRec(ctx, parseCtx, resultIndex, (UA_UInt16)(depth + 1));
-            } else {
-                /*Only Primitive or string*/
-                parseCtx->index++;
-            }
+    const JsonToken *object = &parseCtx->tokenArray[parseCtx->index];
+    if(object->type != JSMN_OBJECT)
+        return UA_STATUSCODE_BADNOTFOUND;
+
+    size_t key = parseCtx->index + 1; /* Object to first Key */
+    for(int i = 0; i < object->size; i++) {
+        /* We got invalid json. See
+         * https://bugs.chromium.org/p/oss-fuzz/issues/detail?id=14620 */
+        if(key + 1 >= parseCtx->tokenCount)
+            return UA_STATUSCODE_BADOUTOFRANGE;
+        if(jsoneq((char*)ctx->pos, &parseCtx->tokenArray[key], search) == 0) {
+            *resultIndex = key + 1; /* Pointer to the value of the searched key */
+            return UA_STATUSCODE_GOOD;
         }
+        key = parseCtx->tokenArray[key + 1].next;
     }
-    return ret;
+    return UA_STATUSCODE_BADNOTFOUND;
 }
 
-static status
-jumpOverObject(CtxJson *ctx, ParseCtx *parseCtx, size_t *resultIndex) {
-    UA_UInt16 oldIndex = parseCtx->index; /* Save index for later restore */
-    UA_UInt16 depth = 0;
-    jumpOverRec(ctx, parseCtx, resultIndex, depth);
-    *resultIndex = parseCtx->index;
-    parseCtx->index = oldIndex; /* Restore index */
-    return UA_STATUSCODE_GOOD;
+/* Get the index of the token after an object which cannot be parsed */
+static void
+jumpOverObject(ParseCtx *parseCtx, size_t *resultIndex) {
+    *resultIndex = parseCtx->tokenArray[parseCtx->index].next;
 }
 
 static status
@@ -2506,7 +2401,7 @@ DECODE_JSON(ExpandedNodeId) {
         dst->namespaceUri = UA_STRING_NULL;
     } else {
         hasNamespace = true;
-        jsmntok_t nsToken = parseCtx->tokenArray[searchResultNamespace];
+        JsonToken nsToken = parseCtx->tokenArray[searchResultNamespace];
         if(nsToken.type == JSMN_STRING)
             isNamespaceString = true;
     }
@@ -2771,8 +2666,8 @@ DECODE_JSON(ExtensionObject) {
 
         /* parse the nodeid */
         /*for restore*/
-        UA_UInt16 index = parseCtx->index;
-        parseCtx->index = (UA_UInt16)searchTypeIdResult;
+        size_t index = parseCtx->index;
+        parseCtx->index = searchTypeIdResult;
         ret = NodeId_decodeJson(&typeId, &UA_TYPES[UA_TYPES_NODEID], ctx, parseCtx, true);
         if(ret != UA_STATUSCODE_GOOD)
             return ret;
@@ -2800,7 +2695,7 @@ DECODE_JSON(ExtensionObject) {
                 return UA_STATUSCODE_BADDECODINGERROR;
             }
             
-            if(searchBodyResult >= (size_t)parseCtx->tokenCount) {
+            if(searchBodyResult >= parseCtx->tokenCount) {
                 /*index not in Tokenarray*/
                 UA_NodeId_deleteMembers(&typeId);
                 return UA_STATUSCODE_BADDECODINGERROR;
@@ -2827,16 +2722,8 @@ DECODE_JSON(ExtensionObject) {
             memcpy(dst->content.encoded.body.data, bodyJsonString, (size_t)sizeOfJsonString);
             
             size_t tokenAfteExtensionObject = 0;
-            jumpOverObject(ctx, parseCtx, &tokenAfteExtensionObject);
-            
-            if(tokenAfteExtensionObject == 0) {
-                /*next object token not found*/
-                UA_NodeId_deleteMembers(&typeId);
-                UA_ByteString_deleteMembers(&dst->content.encoded.body);
-                return UA_STATUSCODE_BADDECODINGERROR;
-            }
-            
-            parseCtx->index = (UA_UInt16)tokenAfteExtensionObject;
+            jumpOverObject(parseCtx, &tokenAfteExtensionObject);
+            parseCtx->index = tokenAfteExtensionObject;
             
             return UA_STATUSCODE_GOOD;
         }
@@ -2904,7 +2791,7 @@ Variant_decodeJsonUnwrapExtensionObject(UA_Variant *dst, const UA_DataType *type
                                         CtxJson *ctx, ParseCtx *parseCtx, UA_Boolean moveToken) {
     (void) type, (void) moveToken;
     /*EXTENSIONOBJECT POSITION!*/
-    UA_UInt16 old_index = parseCtx->index;
+    size_t old_index = parseCtx->index;
     UA_Boolean typeIdFound;
     
     /* Decode the DataType */
@@ -2921,7 +2808,7 @@ Variant_decodeJsonUnwrapExtensionObject(UA_Variant *dst, const UA_DataType *type
     } else {
         typeIdFound = true;
         /* parse the nodeid */
-        parseCtx->index = (UA_UInt16)searchTypeIdResult;
+        parseCtx->index = searchTypeIdResult;
         ret = NodeId_decodeJson(&typeId, &UA_TYPES[UA_TYPES_NODEID], ctx, parseCtx, true);
         if(ret != UA_STATUSCODE_GOOD) {
             UA_NodeId_deleteMembers(&typeId);
@@ -3247,28 +3134,295 @@ decodeJsonSignature getDecodeSignature(u8 index) {
     return decodeJsonJumpTable[index];
 }
 
+/******************/
+/* JSON Tokenizer */
+/******************/
+
+/* Single pass over the input. The state between two pieces of input is the
+ * position inside the current string or primitive, the next allowed grammar
+ * element and the stack of open objects/arrays. */
+
+enum {
+    JSON_LEX_NONE = 0,
+    JSON_LEX_STRING,
+    JSON_LEX_ESCAPE,
+    JSON_LEX_UNICODE,
+    JSON_LEX_PRIMITIVE
+};
+
+enum {
+    JSON_EXPECT_VALUE = 0,     /* Top-level, after a colon or a comma in an array */
+    JSON_EXPECT_VALUE_OR_END,  /* After [ */
+    JSON_EXPECT_KEY,           /* After a comma in an object */
+    JSON_EXPECT_KEY_OR_END,    /* After { */
+    JSON_EXPECT_COLON,         /* After a key */
+    JSON_EXPECT_COMMA_OR_END   /* After a value inside an object/array */
+};
+
+#define JSON_TOKENS_INITIAL 64
+
+void
+JsonTokenizer_init(JsonTokenizer *t) {
+    memset(t, 0, sizeof(JsonTokenizer));
+}
+
+void
+JsonTokenizer_clear(JsonTokenizer *t) {
+    UA_free(t->tokens);
+    JsonTokenizer_init(t);
+}
+
+static UA_StatusCode
+addToken(JsonTokenizer *t, jsmntype_t type, size_t start) {
+    if(t->tokensSize == t->tokensCapacity) {
+        size_t newCapacity = t->tokensCapacity * 2;
+        if(newCapacity == 0)
+            newCapacity = JSON_TOKENS_INITIAL;
+        if(newCapacity > UA_UINT32_MAX)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        JsonToken *tokens = (JsonToken*)
+            UA_realloc(t->tokens, newCapacity * sizeof(JsonToken));
+        if(!tokens)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        t->tokens = tokens;
+        t->tokensCapacity = newCapacity;
+    }
+    JsonToken *tok = &t->tokens[t->tokensSize];
+    tok->type = type;
+    tok->start = (int)start;
+    tok->end = -1;
+    tok->size = 0;
+    t->tokensSize++;
+    tok->next = (UA_UInt32)t->tokensSize;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* The next token starts a value. Count it as an array element. */
+static UA_StatusCode
+beginValue(JsonTokenizer *t) {
+    if(t->expect != JSON_EXPECT_VALUE && t->expect != JSON_EXPECT_VALUE_OR_END)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    if(t->depth > 0) {
+        JsonToken *parent = &t->tokens[t->stack[t->depth - 1]];
+        if(parent->type == JSMN_ARRAY)
+            parent->size++;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+endValue(JsonTokenizer *t) {
+    t->expect = (t->depth > 0) ? JSON_EXPECT_COMMA_OR_END : JSON_EXPECT_VALUE;
+}
+
+static UA_StatusCode
+openContainer(JsonTokenizer *t, jsmntype_t type) {
+    UA_StatusCode ret = beginValue(t);
+    if(ret != UA_STATUSCODE_GOOD)
+        return ret;
+    if(t->depth >= UA_JSON_ENCODING_MAX_RECURSION)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    ret = addToken(t, type, t->pos);
+    if(ret != UA_STATUSCODE_GOOD)
+        return ret;
+    t->stack[t->depth] = (UA_UInt32)(t->tokensSize - 1);
+    t->depth++;
+    t->expect = (type == JSMN_OBJECT) ?
+        JSON_EXPECT_KEY_OR_END : JSON_EXPECT_VALUE_OR_END;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+closeContainer(JsonTokenizer *t, jsmntype_t type) {
+    if(t->depth == 0)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    JsonToken *tok = &t->tokens[t->stack[t->depth - 1]];
+    if(tok->type != type)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    if(t->expect != JSON_EXPECT_COMMA_OR_END &&
+       t->expect != (type == JSMN_OBJECT ? JSON_EXPECT_KEY_OR_END :
+                     JSON_EXPECT_VALUE_OR_END))
+        return UA_STATUSCODE_BADDECODINGERROR;
+    tok->end = (int)t->pos + 1;
+    tok->next = (UA_UInt32)t->tokensSize;
+    t->depth--;
+    endValue(t);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+beginString(JsonTokenizer *t) {
+    UA_StatusCode ret;
+    if(t->expect == JSON_EXPECT_KEY || t->expect == JSON_EXPECT_KEY_OR_END) {
+        ret = addToken(t, JSMN_STRING, t->pos + 1);
+        if(ret != UA_STATUSCODE_GOOD)
+            return ret;
+        t->tokens[t->tokensSize - 1].size = 1; /* The key holds the value */
+        t->tokens[t->stack[t->depth - 1]].size++;
+        t->expect = JSON_EXPECT_COLON;
+    } else {
+        ret = beginValue(t);
+        if(ret != UA_STATUSCODE_GOOD)
+            return ret;
+        ret = addToken(t, JSMN_STRING, t->pos + 1);
+        if(ret != UA_STATUSCODE_GOOD)
+            return ret;
+        endValue(t);
+    }
+    t->lexState = JSON_LEX_STRING;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_Boolean
+isHexChar(UA_Byte c) {
+    return ((c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') ||
+            (c >= 'a' && c <= 'f'));
+}
+
+UA_StatusCode
+JsonTokenizer_feed(JsonTokenizer *t, const UA_Byte *data, size_t length) {
+    /* Token positions are stored as int */
+    if(length > (size_t)UA_INT32_MAX - t->pos)
+        return UA_STATUSCODE_BADDECODINGERROR;
+
+    UA_StatusCode ret = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < length && !t->done; i++, t->pos++) {
+        UA_Byte c = data[i];
+
+        /* Inside a string or primitive */
+        switch(t->lexState) {
+        case JSON_LEX_STRING:
+            if(c == '\"') {
+                t->tokens[t->tokensSize - 1].end = (int)t->pos;
+                t->lexState = JSON_LEX_NONE;
+            } else if(c == '\\') {
+                t->lexState = JSON_LEX_ESCAPE;
+            } else if(c == '\0') {
+                t->done = true; /* The input ends inside the string */
+            }
+            continue;
+        case JSON_LEX_ESCAPE:
+            switch(c) {
+            case '\"': case '/': case '\\': case 'b':
+            case 'f': case 'r': case 'n': case 't':
+                t->lexState = JSON_LEX_STRING;
+                continue;
+            case 'u':
+                t->hexLeft = 4;
+                t->lexState = JSON_LEX_UNICODE;
+                continue;
+            default:
+                return UA_STATUSCODE_BADDECODINGERROR;
+            }
+        case JSON_LEX_UNICODE:
+            if(!isHexChar(c))
+                return UA_STATUSCODE_BADDECODINGERROR;
+            t->hexLeft--;
+            if(t->hexLeft == 0)
+                t->lexState = JSON_LEX_STRING;
+            continue;
+        case JSON_LEX_PRIMITIVE:
+            if(c != '\t' && c != '\r' && c != '\n' && c != ' ' &&
+               c != ',' && c != ']' && c != '}' && c != '\0') {
+                if(c < 32 || c >= 127)
+                    return UA_STATUSCODE_BADDECODINGERROR;
+                continue;
+            }
+            /* The delimiter is processed below */
+            t->tokens[t->tokensSize - 1].end = (int)t->pos;
+            t->lexState = JSON_LEX_NONE;
+            break;
+        default:
+            break;
+        }
+
+        /* Between tokens */
+        switch(c) {
+        case '{':
+            ret = openContainer(t, JSMN_OBJECT);
+            break;
+        case '[':
+            ret = openContainer(t, JSMN_ARRAY);
+            break;
+        case '}':
+            ret = closeContainer(t, JSMN_OBJECT);
+            break;
+        case ']':
+            ret = closeContainer(t, JSMN_ARRAY);
+            break;
+        case '\"':
+            ret = beginString(t);
+            break;
+        case ':':
+            if(t->expect != JSON_EXPECT_COLON)
+                return UA_STATUSCODE_BADDECODINGERROR;
+            t->expect = JSON_EXPECT_VALUE;
+            break;
+        case ',':
+            if(t->depth == 0)
+                break; /* Separator between top-level values */
+            if(t->expect != JSON_EXPECT_COMMA_OR_END)
+                return UA_STATUSCODE_BADDECODINGERROR;
+            t->expect = (t->tokens[t->stack[t->depth - 1]].type == JSMN_OBJECT) ?
+                JSON_EXPECT_KEY : JSON_EXPECT_VALUE;
+            break;
+        case '\t': case '\r': case '\n': case ' ':
+            break;
+        case '\0':
+            t->done = true; /* Null-terminated input */
+            break;
+        /* Primitives are numbers, booleans and null */
+        case '-': case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+        case 't': case 'f': case 'n':
+            ret = beginValue(t);
+            if(ret != UA_STATUSCODE_GOOD)
+                return ret;
+            ret = addToken(t, JSMN_PRIMITIVE, t->pos);
+            endValue(t);
+            t->lexState = JSON_LEX_PRIMITIVE;
+            break;
+        default:
+            return UA_STATUSCODE_BADDECODINGERROR;
+        }
+        if(ret != UA_STATUSCODE_GOOD)
+            return ret;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+JsonTokenizer_finish(JsonTokenizer *t) {
+    if(t->lexState == JSON_LEX_PRIMITIVE) {
+        t->tokens[t->tokensSize - 1].end = (int)t->pos;
+        t->lexState = JSON_LEX_NONE;
+    }
+    if(t->lexState != JSON_LEX_NONE || t->depth > 0)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    return UA_STATUSCODE_GOOD;
+}
+
 status
-tokenize(ParseCtx *parseCtx, CtxJson *ctx, const UA_ByteString *src) {
+tokenize(ParseCtx *parseCtx, CtxJson *ctx, JsonTokenizer *t,
+         const UA_ByteString *src) {
     /* Set up the context */
     ctx->pos = &src->data[0];
     ctx->end = &src->data[src->length];
     ctx->depth = 0;
+    parseCtx->tokenArray = NULL;
     parseCtx->tokenCount = 0;
     parseCtx->index = 0;
 
-    /*Set up tokenizer jsmn*/
-    jsmn_parser p;
-    jsmn_init(&p);
-    parseCtx->tokenCount = (UA_Int32)
-        jsmn_parse(&p, (char*)src->data, src->length,
-                   parseCtx->tokenArray, UA_JSON_MAXTOKENCOUNT);
-    
-    if(parseCtx->tokenCount < 0) {
-        if(parseCtx->tokenCount == JSMN_ERROR_NOMEM)
-            return UA_STATUSCODE_BADOUTOFMEMORY;
-        return UA_STATUSCODE_BADDECODINGERROR;
-    }
-    
+    JsonTokenizer_init(t);
+    status ret = JsonTokenizer_feed(t, src->data, src->length);
+    if(ret != UA_STATUSCODE_GOOD)
+        return ret;
+    ret = JsonTokenizer_finish(t);
+    if(ret != UA_STATUSCODE_GOOD)
+        return ret;
+
+    parseCtx->tokenArray = t->tokens;
+    parseCtx->tokenCount = t->tokensSize;
     return UA_STATUSCODE_GOOD;
 }
 
@@ -3293,11 +3447,8 @@ UA_decodeJson(const UA_ByteString *src, void *dst, const UA_DataType *type) {
     /* Set up the context */
     CtxJson ctx;
     ParseCtx parseCtx;
-    parseCtx.tokenArray = (jsmntok_t*)UA_malloc(sizeof(jsmntok_t) * UA_JSON_MAXTOKENCOUNT);
-    if(!parseCtx.tokenArray)
-        return UA_STATUSCODE_BADOUTOFMEMORY;
-    
-    status ret = tokenize(&parseCtx, &ctx, src);
+    JsonTokenizer tokenizer;
+    status ret = tokenize(&parseCtx, &ctx, &tokenizer, src);
     if(ret != UA_STATUSCODE_GOOD)
         goto cleanup;
 
@@ -3321,7 +3472,7 @@ UA_decodeJson(const UA_ByteString *src, void *dst, const UA_DataType *type) {
     ret = decodeJsonJumpTable[type->typeKind](dst, type, &ctx, &parseCtx, true);
 
     cleanup:
-    UA_free(parseCtx.tokenArray);
+    JsonTokenizer_clear(&tokenizer);
     
     /* sanity check if all Tokens were processed */
     if(!(parseCtx.index == parseCtx.tokenCount ||
@@ -19,8 +19,6 @@
 
 _UA_BEGIN_DECLS
 
-#define UA_JSON_MAXTOKENCOUNT 1000
-    
 size_t
 UA_calcSizeJson(const void *src, const UA_DataType *type,
                 UA_String *namespaces, size_t namespaceSize,
@@ -115,10 +113,50 @@ calcJsonArrEnd(CtxJson *ctx) {
 status
 encodeJsonInternal(const void *src, const UA_DataType *type, CtxJson *ctx);
 
+/* Token of the JSON tokenizer. Type, start, end and size have the jsmn
+ * semantics. For objects and arrays, next is the index of the first token after
+ * the subtree. So a value can be skipped without walking its children. */
+typedef struct {
+    jsmntype_t type;
+    int start;
+    int end;
+    int size;
+    UA_UInt32 next;
+} JsonToken;
+
+/* Incremental JSON tokenizer. The input can be fed in pieces; token positions
+ * are offsets into the concatenation of all pieces. The token array grows on
+ * demand. Apart from the tokens, the state is bounded by the nesting depth. */
+typedef struct {
+    JsonToken *tokens;
+    size_t tokensSize;
+    size_t tokensCapacity;
+
+    size_t pos;       /* Offset of the next input byte */
+    UA_Byte lexState; /* Inside a string or primitive across pieces? */
+    UA_Byte hexLeft;  /* Remaining hex digits of a \uXXXX escape */
+    UA_Byte expect;   /* What the grammar allows next */
+    UA_Boolean done;  /* Input was terminated by a null byte */
+
+    size_t depth;
+    UA_UInt32 stack[UA_JSON_ENCODING_MAX_RECURSION]; /* Open containers */
+} JsonTokenizer;
+
+void JsonTokenizer_init(JsonTokenizer *t);
+void JsonTokenizer_clear(JsonTokenizer *t);
+
+UA_StatusCode
+JsonTokenizer_feed(JsonTokenizer *t, const UA_Byte *data, size_t length);
+
+/* Closes a trailing primitive. Fails if the input ends inside a string or an
+ * open object/array. */
+UA_StatusCode
+JsonTokenizer_finish(JsonTokenizer *t);
+
 typedef struct {
-    jsmntok_t *tokenArray;
-    UA_Int32 tokenCount;
-    UA_UInt16 index;
+    JsonToken *tokenArray;
+    size_t tokenCount;
+    size_t index;
 
     /* Additonal data for special cases such as networkmessage/datasetmessage
      * Currently only used for dataSetWriterIds */
@@ -159,7 +197,11 @@ decodeJsonInternal(void *dst, const UA_DataType *type,
 decodeJsonSignature getDecodeSignature(u8 index);
 UA_StatusCode lookAheadForKey(const char* search, CtxJson *ctx, ParseCtx *parseCtx, size_t *resultIndex);
 jsmntype_t getJsmnType(const ParseCtx *parseCtx);
-UA_StatusCode tokenize(ParseCtx *parseCtx, CtxJson *ctx, const UA_ByteString *src);
+
+/* Tokenizes src in one piece. The tokens are owned by the tokenizer and remain
+ * valid until JsonTokenizer_clear. */
+UA_StatusCode tokenize(ParseCtx *parseCtx, CtxJson *ctx, JsonTokenizer *t,
+                       const UA_ByteString *src);
 UA_Boolean isJsonNull(const CtxJson *ctx, const ParseCtx *parseCtx);
 
 _UA_END_DECLS
@@ -297,3 +297,112 @@ UA_NodeId_print(const UA_NodeId *id, UA_String *output) {
 
     return UA_STATUSCODE_GOOD;
 }
+
+/********************/
+/* Identifier Index */
+/********************/
+
+static UA_UInt32
+idIndexKey(const UA_IdIndex *index, const void *entry) {
+    return *(const UA_UInt32*)((const UA_Byte*)entry + index->keyOffset);
+}
+
+static void **
+idIndexSlot(const UA_IdIndex *index, UA_UInt32 key) {
+    UA_UInt32 mask = index->slotsSize - 1;
+    UA_UInt32 i = key & mask;
+    while(index->slots[i] && idIndexKey(index, index->slots[i]) != key)
+        i = (i + 1) & mask;
+    return &index->slots[i];
+}
+
+/* Rehash the entries into a table of the given size */
+static UA_StatusCode
+idIndexResize(UA_IdIndex *index, UA_UInt32 size) {
+    void **slots = (void**)UA_calloc(size, sizeof(void*));
+    if(!slots)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    void **oldSlots = index->slots;
+    UA_UInt32 oldSize = index->slotsSize;
+    index->slots = slots;
+    index->slotsSize = size;
+    for(UA_UInt32 i = 0; i < oldSize; i++) {
+        if(oldSlots[i])
+            *idIndexSlot(index, idIndexKey(index, oldSlots[i])) = oldSlots[i];
+    }
+    UA_free(oldSlots);
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_IdIndex_init(UA_IdIndex *index, size_t keyOffset) {
+    memset(index, 0, sizeof(UA_IdIndex));
+    index->keyOffset = keyOffset;
+}
+
+void
+UA_IdIndex_clear(UA_IdIndex *index) {
+    UA_free(index->slots);
+    index->slots = NULL;
+    index->slotsSize = 0;
+    index->entriesSize = 0;
+}
+
+void *
+UA_IdIndex_find(const UA_IdIndex *index, UA_UInt32 key) {
+    if(index->slotsSize == 0)
+        return NULL;
+    return *idIndexSlot(index, key);
+}
+
+UA_StatusCode
+UA_IdIndex_reserve(UA_IdIndex *index, size_t count) {
+    size_t needed = (index->entriesSize + count) * 2;
+    if(needed <= index->slotsSize)
+        return UA_STATUSCODE_GOOD;
+    if(needed > UA_UINT32_MAX / 2)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_UInt32 size = UA_IDINDEX_SIZE_MIN;
+    while(size < needed)
+        size *= 2;
+    return idIndexResize(index, size);
+}
+
+void
+UA_IdIndex_insert(UA_IdIndex *index, void *entry) {
+    UA_assert((index->entriesSize + 1) * 2 <= index->slotsSize);
+    void **slot = idIndexSlot(index, idIndexKey(index, entry));
+    UA_assert(*slot == NULL);
+    *slot = entry;
+    index->entriesSize++;
+}
+
+void
+UA_IdIndex_remove(UA_IdIndex *index, void *entry) {
+    UA_UInt32 mask = index->slotsSize - 1;
+    void **slots = index->slots;
+    UA_UInt32 i = (UA_UInt32)(idIndexSlot(index, idIndexKey(index, entry)) - slots);
+    UA_assert(slots[i] == entry);
+
+    /* Move entries of the probe sequence into the gap if their home slot does
+     * not lie (cyclically) between the gap and their current position */
+    UA_UInt32 j = i;
+    while(true) {
+        j = (j + 1) & mask;
+        if(!slots[j])
+            break;
+        UA_UInt32 home = idIndexKey(index, slots[j]) & mask;
+        if(((j - home) & mask) < ((j - i) & mask))
+            continue;
+        slots[i] = slots[j];
+        i = j;
+    }
+    slots[i] = NULL;
+    UA_assert(index->entriesSize > 0);
+    index->entriesSize--;
+
+    /* Shrink the index. Keep the current index if this fails. */
+    if(index->slotsSize > UA_IDINDEX_SIZE_MIN &&
+       index->entriesSize * 8 < index->slotsSize)
+        idIndexResize(index, index->slotsSize / 2);
+}
@@ -57,6 +57,47 @@ void UA_EXPORT
 UA_dump_hex_pkg(UA_Byte* buffer, size_t bufferLen);
 #endif
 
+/**
+ * Identifier Index
+ * ----------------
+ * Open-addressing hash table with linear probing for entries with a UInt32
+ * key. The keys are expected to be assigned sequentially (identifiers,
+ * handles). So the lower bits are used directly as the hash. The table size
+ * is a power of two, the table is kept at most half full and removal shifts
+ * the following entries back (no tombstones). The index does not own the
+ * entries. */
+
+typedef struct {
+    void **slots;
+    UA_UInt32 slotsSize; /* Power of two or zero */
+    UA_UInt32 entriesSize;
+    size_t keyOffset;    /* Offset of the UInt32 key in the entries */
+} UA_IdIndex;
+
+#define UA_IDINDEX_SIZE_MIN 16
+
+void
+UA_IdIndex_init(UA_IdIndex *index, size_t keyOffset);
+
+void
+UA_IdIndex_clear(UA_IdIndex *index);
+
+void *
+UA_IdIndex_find(const UA_IdIndex *index, UA_UInt32 key);
+
+/* Grow the index to take additional entries */
+UA_StatusCode
+UA_IdIndex_reserve(UA_IdIndex *index, size_t count);
+
+/* Room for the entry has to be reserved before. The key must not be used by
+ * another entry in the index. */
+void
+UA_IdIndex_insert(UA_IdIndex *index, void *entry);
+
+/* Remove the entry and shrink the index if it has become sparse */
+void
+UA_IdIndex_remove(UA_IdIndex *index, void *entry);
+
 /* Unions that represent any of the supported request or response message */
 typedef union {
     UA_RequestHeader requestHeader;
@@ -21,14 +21,21 @@ void UA_WorkQueue_init(UA_WorkQueue *wq) {
     SIMPLEQ_INIT(&wq->delayedCallbacks);
 
 #if UA_MULTITHREADING >= 200
-    wq->delayedCallbacks_checkpoint = NULL;
     UA_LOCK_INIT(wq->delayedCallbacks_accessMutex)
-
-    /* Initialize the dispatch queue for worker threads */
-    SIMPLEQ_INIT(&wq->dispatchQueue);
-    UA_LOCK_INIT(wq->dispatchQueue_accessMutex)
+    SIMPLEQ_INIT(&wq->delayedBatch);
+    wq->delayedBatchStage = 0;
+
+    /* Initialize the overflow list */
+    SIMPLEQ_INIT(&wq->overflow);
+    UA_LOCK_INIT(wq->overflow_accessMutex)
+    wq->overflowEnqueued = 0;
+    wq->overflowTaken = 0;
+
+    /* Initialize the condition for sleeping workers */
+    wq->nextWorker = 0;
+    wq->sleepingWorkers = 0;
     pthread_cond_init(&wq->dispatchQueue_condition, NULL);
-    UA_LOCK_INIT(wq->dispatchQueue_conditionMutex)
+    pthread_mutex_init(&wq->dispatchQueue_conditionMutex, NULL);
 #endif
 }
 
@@ -39,32 +46,17 @@ static void UA_WorkQueue_manuallyProcessDelayed(UA_WorkQueue *wq);
 
 void UA_WorkQueue_cleanup(UA_WorkQueue *wq) {
 #if UA_MULTITHREADING >= 200
-    /* Shut down workers */
+    /* Shut down workers. This executes the remaining work in the rings. */
     UA_WorkQueue_stop(wq);
-
-    /* Execute remaining work in the dispatch queue */
-    while(true) {
-        UA_LOCK(wq->dispatchQueue_accessMutex);
-        UA_DelayedCallback *dc = SIMPLEQ_FIRST(&wq->dispatchQueue);
-        if(!dc) {
-            UA_UNLOCK(wq->dispatchQueue_accessMutex);
-            break;
-        }
-        SIMPLEQ_REMOVE_HEAD(&wq->dispatchQueue, next);
-        UA_UNLOCK(wq->dispatchQueue_accessMutex);
-        dc->callback(dc->application, dc->data);
-        UA_free(dc);
-    }
 #endif
 
     /* All workers are shut down. Execute remaining delayed work here. */
     UA_WorkQueue_manuallyProcessDelayed(wq);
 
 #if UA_MULTITHREADING >= 200
-    wq->delayedCallbacks_checkpoint = NULL;
-    UA_LOCK_DESTROY(wq->dispatchQueue_accessMutex);
     pthread_cond_destroy(&wq->dispatchQueue_condition);
-    UA_LOCK_DESTROY(wq->dispatchQueue_conditionMutex);
+    pthread_mutex_destroy(&wq->dispatchQueue_conditionMutex);
+    UA_LOCK_DESTROY(wq->overflow_accessMutex);
     UA_LOCK_DESTROY(wq->delayedCallbacks_accessMutex);
 #endif
 }
@@ -75,39 +67,99 @@ void UA_WorkQueue_cleanup(UA_WorkQueue *wq) {
 
 #if UA_MULTITHREADING >= 200
 
+/* Take out the oldest callback from the ring of a worker. Called concurrently
+ * by all workers. The item is read before the top index is advanced. If the
+ * compare-and-swap fails, another worker has taken the item and the read is
+ * discarded. */
+static UA_Boolean
+takeWork(UA_Worker *w, UA_WorkItem *item) {
+    while(true) {
+        size_t t = w->top;
+        UA_atomic_sync();
+        size_t b = w->bottom;
+        if(t >= b)
+            return false;
+        UA_atomic_sync(); /* Read the item after the bottom index */
+        *item = w->ring[t & (UA_WORKQUEUE_RINGSIZE - 1)];
+        if(UA_atomic_cmpxchgSize(&w->top, t, t + 1) == t)
+            return true;
+    }
+}
+
+/* Take out the oldest callback from the overflow list */
+static UA_Boolean
+takeOverflowWork(UA_WorkQueue *wq, UA_WorkItem *item) {
+    if(wq->overflowTaken == wq->overflowEnqueued)
+        return false;
+    UA_LOCK(wq->overflow_accessMutex);
+    UA_DelayedCallback *dc = SIMPLEQ_FIRST(&wq->overflow);
+    if(dc) {
+        SIMPLEQ_REMOVE_HEAD(&wq->overflow, next);
+        wq->overflowTaken++;
+    }
+    UA_UNLOCK(wq->overflow_accessMutex);
+    if(!dc)
+        return false;
+    item->callback = dc->callback;
+    item->application = dc->application;
+    item->data = dc->data;
+    UA_free(dc);
+    return true;
+}
+
+/* Take from the own ring first. Then steal from the other workers. The
+ * overflow list is taken from when the rings are empty. No new work is put in
+ * the rings while the overflow list is not empty. */
+static UA_Boolean
+takeOrStealWork(UA_WorkQueue *wq, size_t index, UA_WorkItem *item) {
+    for(size_t i = 0; i < wq->workersSize; i++) {
+        if(takeWork(&wq->workers[(index + i) % wq->workersSize], item))
+            return true;
+    }
+    return takeOverflowWork(wq, item);
+}
+
+static UA_Boolean
+hasWork(UA_WorkQueue *wq) {
+    for(size_t i = 0; i < wq->workersSize; i++) {
+        if(wq->workers[i].top < wq->workers[i].bottom)
+            return true;
+    }
+    return (wq->overflowTaken != wq->overflowEnqueued);
+}
+
 static void *
 workerLoop(UA_Worker *worker) {
     UA_WorkQueue *wq = worker->queue;
-    UA_UInt32 *counter = &worker->counter;
+    size_t index = (size_t)(worker - wq->workers);
+    volatile UA_UInt32 *epoch = &worker->epoch;
     volatile UA_Boolean *running = &worker->running;
 
     /* Initialize the (thread local) random seed with the ram address
      * of the worker. Not for security-critical entropy! */
     UA_random_seed((uintptr_t)worker);
 
+    UA_WorkItem item;
     while(*running) {
-        UA_atomic_addUInt32(counter, 1);
-
-        /* Remove a callback from the queue */
-        UA_LOCK(wq->dispatchQueue_accessMutex);
-        UA_DelayedCallback *dc = SIMPLEQ_FIRST(&wq->dispatchQueue);
-        if(dc)
-            SIMPLEQ_REMOVE_HEAD(&wq->dispatchQueue, next);
-        UA_UNLOCK(wq->dispatchQueue_accessMutex);
-
-        /* Nothing to do. Sleep until a callback is dispatched */
-        if(!dc) {
-            UA_LOCK(wq->dispatchQueue_conditionMutex);
-            pthread_cond_wait(&wq->dispatchQueue_condition,
-                              &wq->dispatchQueue_conditionMutex);
-            UA_UNLOCK(wq->dispatchQueue_conditionMutex);
+        /* Enter a new (odd) epoch before the callback is taken out */
+        UA_atomic_addUInt32(epoch, 1);
+        UA_Boolean found = takeOrStealWork(wq, index, &item);
+        if(found)
+            item.callback(item.application, item.data);
+        UA_atomic_addUInt32(epoch, 1);
+        if(found)
             continue;
-        }
 
-        /* Execute */
-        if(dc->callback)
-            dc->callback(dc->application, dc->data);
-        UA_free(dc);
+        /* Nothing to do. Sleep until a callback is enqueued. The rings are
+         * checked again after announcing the sleeping worker. So a concurrent
+         * enqueue either sees the sleeping worker or its work is found here. */
+        pthread_mutex_lock(&wq->dispatchQueue_conditionMutex);
+        UA_atomic_addUInt32(&wq->sleepingWorkers, 1);
+        if(*running && !hasWork(wq))
+            pthread_cond_wait(&wq->dispatchQueue_condition,
+                              &wq->dispatchQueue_conditionMutex);
+        UA_atomic_subUInt32(&wq->sleepingWorkers, 1);
+        pthread_mutex_unlock(&wq->dispatchQueue_conditionMutex);
     }
 
     return NULL;
@@ -124,57 +176,109 @@ UA_WorkQueue_start(UA_WorkQueue *wq, size_t workersCount) {
     if(!wq->workers)
         return UA_STATUSCODE_BADOUTOFMEMORY;
     wq->workersSize = workersCount;
+    wq->nextWorker = 0;
 
     /* Spin up the workers */
     for(size_t i = 0; i < workersCount; ++i) {
         UA_Worker *w = &wq->workers[i];
         w->queue = wq;
-        w->counter = 0;
         w->running = true;
         pthread_create(&w->thread, NULL, (void* (*)(void*))workerLoop, w);
     }
     return UA_STATUSCODE_GOOD;
 }
 
+/* Execute the work in the overflow list in the current thread */
+static void
+processOverflow(UA_WorkQueue *wq) {
+    UA_WorkItem item;
+    while(takeOverflowWork(wq, &item))
+        item.callback(item.application, item.data);
+}
+
 void UA_WorkQueue_stop(UA_WorkQueue *wq) {
-    if(wq->workersSize == 0)
+    if(wq->workersSize == 0) {
+        processOverflow(wq);
         return;
+    }
 
     /* Signal the workers to stop */
     for(size_t i = 0; i < wq->workersSize; ++i)
         wq->workers[i].running = false;
 
     /* Wake up all workers */
+    pthread_mutex_lock(&wq->dispatchQueue_conditionMutex);
     pthread_cond_broadcast(&wq->dispatchQueue_condition);
+    pthread_mutex_unlock(&wq->dispatchQueue_conditionMutex);
 
-    /* Wait for the workers to finish, then clean up */
+    /* Wait for the workers to finish */
     for(size_t i = 0; i < wq->workersSize; ++i)
         pthread_join(wq->workers[i].thread, NULL);
 
+    /* Execute the remaining work in the current thread, then clean up */
+    for(size_t i = 0; i < wq->workersSize; ++i) {
+        UA_Worker *w = &wq->workers[i];
+        for(; w->top < w->bottom; w->top++) {
+            UA_WorkItem *item = &w->ring[w->top & (UA_WORKQUEUE_RINGSIZE - 1)];
+            item->callback(item->application, item->data);
+        }
+    }
+    processOverflow(wq);
+
     UA_free(wq->workers);
     wq->workers = NULL;
     wq->workersSize = 0;
 }
 
-void UA_WorkQueue_enqueue(UA_WorkQueue *wq, UA_ApplicationCallback cb,
-                          void *application, void *data) {
-    UA_DelayedCallback *dc = (UA_DelayedCallback*)UA_malloc(sizeof(UA_DelayedCallback));
-    if(!dc) {
-        cb(application, data); /* Execute immediately if the memory could not be allocated */
+static void
+wakeWorker(UA_WorkQueue *wq) {
+    if(wq->sleepingWorkers == 0)
         return;
+    pthread_mutex_lock(&wq->dispatchQueue_conditionMutex);
+    pthread_cond_signal(&wq->dispatchQueue_condition);
+    pthread_mutex_unlock(&wq->dispatchQueue_conditionMutex);
+}
+
+UA_StatusCode
+UA_WorkQueue_enqueue(UA_WorkQueue *wq, UA_ApplicationCallback cb,
+                     void *application, void *data) {
+    /* Find a ring with free space. Start with the next worker in round-robin
+     * order. Idle workers steal from the other rings. So an imbalance in the
+     * distribution is evened out. Skip the rings while earlier work waits in
+     * the overflow list. */
+    size_t rings = (wq->overflowTaken == wq->overflowEnqueued) ? wq->workersSize : 0;
+    for(size_t i = 0; i < rings; i++) {
+        UA_Worker *w = &wq->workers[wq->nextWorker];
+        wq->nextWorker = (wq->nextWorker + 1) % wq->workersSize;
+        size_t b = w->bottom;
+        if(b - w->top >= UA_WORKQUEUE_RINGSIZE)
+            continue; /* Full */
+
+        UA_WorkItem *item = &w->ring[b & (UA_WORKQUEUE_RINGSIZE - 1)];
+        item->callback = cb;
+        item->application = application;
+        item->data = data;
+        UA_atomic_sync(); /* Write the item before the bottom index */
+        w->bottom = b + 1;
+        UA_atomic_sync(); /* Write the bottom index before testing for sleepers */
+        wakeWorker(wq);
+        return UA_STATUSCODE_GOOD;
     }
 
+    /* No workers or all rings are full. Append to the overflow list. */
+    UA_DelayedCallback *dc = (UA_DelayedCallback*)UA_malloc(sizeof(UA_DelayedCallback));
+    if(!dc)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
     dc->callback = cb;
     dc->application = application;
     dc->data = data;
-
-    /* Enqueue for the worker threads */
-    UA_LOCK(wq->dispatchQueue_accessMutex);
-    SIMPLEQ_INSERT_TAIL(&wq->dispatchQueue, dc, next);
-    UA_UNLOCK(wq->dispatchQueue_accessMutex);
-
-    /* Wake up sleeping workers */
-    pthread_cond_broadcast(&wq->dispatchQueue_condition);
+    UA_LOCK(wq->overflow_accessMutex);
+    SIMPLEQ_INSERT_TAIL(&wq->overflow, dc, next);
+    wq->overflowEnqueued++;
+    UA_UNLOCK(wq->overflow_accessMutex);
+    UA_atomic_sync(); /* Write the list before testing for sleepers */
+    wakeWorker(wq);
+    return UA_STATUSCODE_GOOD;
 }
 
 #endif
@@ -183,79 +287,86 @@ void UA_WorkQueue_enqueue(UA_WorkQueue *wq, UA_ApplicationCallback cb,
 /* Delayed Callbacks */
 /*********************/
 
-#if UA_MULTITHREADING >= 200
-
-/* Delayed Callbacks are called only when all callbacks that were dispatched
- * prior are finished. After every UA_MAX_DELAYED_SAMPLE delayed Callbacks that
- * were added to the queue, we sample the counters from the workers. The
- * counters are compared to the last counters that were sampled. If every worker
- * has proceeded the counter, then we know that all delayed callbacks prior to
- * the last sample-point are safe to execute. */
-
-/* Sample the worker counter for every nth delayed callback. This is used to
- * test that all workers have **finished** their current job before the delayed
- * callback is processed. */
-#define UA_MAX_DELAYED_SAMPLE 100
-
-/* Call only with a held mutex for the delayed callbacks */
 static void
-dispatchDelayedCallbacks(UA_WorkQueue *wq, UA_DelayedCallback *cb) {
-    /* Are callbacks before the last checkpoint ready? */
-    for(size_t i = 0; i < wq->workersSize; ++i) {
-        if(wq->workers[i].counter == wq->workers[i].checkpointCounter)
-            return;
-    }
-
-    /* Dispatch all delayed callbacks up to the checkpoint.
-     * TODO: Move over the entire queue up to the checkpoint in one step. */
-    if(wq->delayedCallbacks_checkpoint != NULL) {
-        UA_DelayedCallback *iter, *tmp_iter;
-        SIMPLEQ_FOREACH_SAFE(iter, &wq->delayedCallbacks, next, tmp_iter) {
-            UA_LOCK(wq->dispatchQueue_accessMutex);
-            SIMPLEQ_INSERT_TAIL(&wq->dispatchQueue, iter, next);
-            UA_UNLOCK(wq->dispatchQueue_accessMutex);
-            if(iter == wq->delayedCallbacks_checkpoint)
-                break;
-        }
+processDelayedQueue(struct UA_DelayedCallbackQueue *queue) {
+    UA_DelayedCallback *dc;
+    while((dc = SIMPLEQ_FIRST(queue))) {
+        SIMPLEQ_REMOVE_HEAD(queue, next);
+        if(dc->callback)
+            dc->callback(dc->application, dc->data);
+        UA_free(dc);
     }
-
-    /* Create the new sample point */
-    for(size_t i = 0; i < wq->workersSize; ++i)
-        wq->workers[i].checkpointCounter = wq->workers[i].counter;
-    wq->delayedCallbacks_checkpoint = cb;
 }
 
-#endif
-
 void
 UA_WorkQueue_enqueueDelayed(UA_WorkQueue *wq, UA_DelayedCallback *cb) {
 #if UA_MULTITHREADING >= 200
-    UA_LOCK(wq->dispatchQueue_accessMutex);
+    UA_LOCK(wq->delayedCallbacks_accessMutex);
 #endif
 
-    SIMPLEQ_INSERT_HEAD(&wq->delayedCallbacks, cb, next);
+    SIMPLEQ_INSERT_TAIL(&wq->delayedCallbacks, cb, next);
+
+#if UA_MULTITHREADING >= 200
+    UA_UNLOCK(wq->delayedCallbacks_accessMutex);
+#endif
+}
 
 #if UA_MULTITHREADING >= 200
-    wq->delayedCallbacks_sinceDispatch++;
-    if(wq->delayedCallbacks_sinceDispatch > UA_MAX_DELAYED_SAMPLE) {
-        dispatchDelayedCallbacks(wq, cb);
-        wq->delayedCallbacks_sinceDispatch = 0;
+
+void
+UA_WorkQueue_processDelayed(UA_WorkQueue *wq) {
+    /* Wait until the workers have taken out all work that was enqueued before
+     * the batch was started. Then sample the epochs. */
+    if(wq->delayedBatchStage == 1) {
+        for(size_t i = 0; i < wq->workersSize; i++) {
+            if(wq->workers[i].top < wq->workers[i].delayedBottom)
+                return;
+        }
+        if(wq->overflowTaken < wq->delayedOverflow)
+            return;
+        UA_atomic_sync();
+        for(size_t i = 0; i < wq->workersSize; i++)
+            wq->workers[i].delayedEpoch = wq->workers[i].epoch;
+        wq->delayedBatchStage = 2;
     }
 
-    UA_UNLOCK(wq->dispatchQueue_accessMutex);
-#endif
+    /* Wait until every worker that was busy has left the sampled epoch. Then
+     * the work enqueued before the batch is finished. */
+    if(wq->delayedBatchStage == 2) {
+        for(size_t i = 0; i < wq->workersSize; i++) {
+            UA_Worker *w = &wq->workers[i];
+            if((w->delayedEpoch & 1) && w->epoch == w->delayedEpoch)
+                return;
+        }
+        processDelayedQueue(&wq->delayedBatch);
+        wq->delayedBatchStage = 0;
+    }
+
+    /* Start the next batch with all delayed callbacks enqueued so far */
+    UA_LOCK(wq->delayedCallbacks_accessMutex);
+    if(SIMPLEQ_EMPTY(&wq->delayedCallbacks)) {
+        UA_UNLOCK(wq->delayedCallbacks_accessMutex);
+        return;
+    }
+    wq->delayedBatch = wq->delayedCallbacks; /* Non-empty, so the last pointer
+                                              * does not point into the head */
+    SIMPLEQ_INIT(&wq->delayedCallbacks);
+    UA_UNLOCK(wq->delayedCallbacks_accessMutex);
+
+    for(size_t i = 0; i < wq->workersSize; i++)
+        wq->workers[i].delayedBottom = wq->workers[i].bottom;
+    wq->delayedOverflow = wq->overflowEnqueued;
+    wq->delayedBatchStage = 1;
 }
 
+#endif
+
 /* Assumes all workers are shut down */
 void UA_WorkQueue_manuallyProcessDelayed(UA_WorkQueue *wq) {
-    UA_DelayedCallback *dc, *dc_tmp;
-    SIMPLEQ_FOREACH_SAFE(dc, &wq->delayedCallbacks, next, dc_tmp) {
-        SIMPLEQ_REMOVE_HEAD(&wq->delayedCallbacks, next);
-        if(dc->callback)
-            dc->callback(dc->application, dc->data);
-        UA_free(dc);
-    }
 #if UA_MULTITHREADING >= 200
-    wq->delayedCallbacks_checkpoint = NULL;
+    /* The current batch was enqueued first */
+    processDelayedQueue(&wq->delayedBatch);
+    wq->delayedBatchStage = 0;
 #endif
+    processDelayedQueue(&wq->delayedCallbacks);
 }
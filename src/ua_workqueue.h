@@ -40,27 +40,57 @@ typedef struct UA_DelayedCallback {
     void *data;
 } UA_DelayedCallback;
 
+SIMPLEQ_HEAD(UA_DelayedCallbackQueue, UA_DelayedCallback);
+
 struct UA_WorkQueue;
 typedef struct UA_WorkQueue UA_WorkQueue;
 
 #if UA_MULTITHREADING >= 200
 
-/* Workers take out callbacks from the work queue and execute them.
+/* Every worker has its own ring of enqueued callbacks. Work is only enqueued
+ * from the thread that runs the server main loop. That thread is the single
+ * producer and only writes the bottom index. The workers take out callbacks at
+ * the top index with a compare-and-swap. A worker first takes from its own ring
+ * and steals from the rings of the other workers when it has run out of work.
  *
- * Future Plans: Use work-stealing to load-balance between cores.
+ * This is the work-stealing deque from Chase and Lev. As the producer never
+ * takes out work from the bottom, the deque reduces to a ring where all
+ * consumers use the "steal" operation.
  * Le, Nhat Minh, et al. "Correct and efficient work-stealing for weak memory
  * models." ACM SIGPLAN Notices. Vol. 48. No. 8. ACM, 2013. */
+
+#define UA_WORKQUEUE_RINGSIZE 256 /* Must be a power of two */
+#define UA_WORKQUEUE_CACHELINE 64
+
+/* The callbacks are stored in the ring by value. So enqueueing work does not
+ * allocate memory. */
+typedef struct {
+    UA_ApplicationCallback callback;
+    void *application;
+    void *data;
+} UA_WorkItem;
+
 typedef struct {
     pthread_t thread;
     volatile UA_Boolean running;
     UA_WorkQueue *queue;
-    UA_UInt32 counter;
-    UA_UInt32 checkpointCounter; /* Counter when the last checkpoint was made
-                                  * for the delayed callbacks */
 
-    /* separate cache lines */
-    char padding[64 - sizeof(void*) - sizeof(pthread_t) -
-                 sizeof(UA_UInt32) - sizeof(UA_Boolean)];
+    /* The epoch counter is odd while the worker takes out and executes a
+     * callback. It is even while the worker is idle. The epochs are sampled for
+     * the delayed callbacks. */
+    volatile UA_UInt32 epoch;
+    UA_UInt32 delayedEpoch; /* Epoch sampled for the current batch of delayed
+                             * callbacks */
+    size_t delayedBottom;   /* Bottom index of the ring sampled for the current
+                             * batch of delayed callbacks */
+
+    /* Separate cache lines for the producer and the consumers */
+    char padding1[UA_WORKQUEUE_CACHELINE];
+    volatile size_t top;    /* Incremented by the consumers */
+    char padding2[UA_WORKQUEUE_CACHELINE - sizeof(size_t)];
+    volatile size_t bottom; /* Incremented by the producer */
+    char padding3[UA_WORKQUEUE_CACHELINE - sizeof(size_t)];
+    UA_WorkItem ring[UA_WORKQUEUE_RINGSIZE];
 } UA_Worker;
 
 #endif
@@ -71,22 +101,39 @@ struct UA_WorkQueue {
 #if UA_MULTITHREADING >= 200
     UA_Worker *workers;
     size_t workersSize;
-
-    /* Work queue */
-    SIMPLEQ_HEAD(, UA_DelayedCallback) dispatchQueue; /* Dispatch queue for the worker threads */
-    UA_LOCK_TYPE(dispatchQueue_accessMutex) /* mutex for access to queue */
-    pthread_cond_t dispatchQueue_condition; /* so the workers don't spin if the queue is empty */
-    UA_LOCK_TYPE(dispatchQueue_conditionMutex) /* mutex for access to condition variable */
+    size_t nextWorker; /* Round-robin distribution of the enqueued work */
+
+    /* Work that did not fit into the rings. Once work has overflowed, later
+     * work is also appended here until the workers have drained the list. The
+     * counters are used to track the overflowed work for the delayed
+     * callbacks. */
+    struct UA_DelayedCallbackQueue overflow;
+    UA_LOCK_TYPE(overflow_accessMutex)
+    volatile size_t overflowEnqueued;
+    volatile size_t overflowTaken;
+
+    /* Idle workers sleep on the condition */
+    volatile UA_UInt32 sleepingWorkers;
+    pthread_cond_t dispatchQueue_condition;
+    pthread_mutex_t dispatchQueue_conditionMutex;
 #endif
 
     /* Delayed callbacks
      * To be executed after all curretly dispatched works has finished */
-    SIMPLEQ_HEAD(, UA_DelayedCallback) delayedCallbacks;
+    struct UA_DelayedCallbackQueue delayedCallbacks;
 #if UA_MULTITHREADING >= 200
     UA_LOCK_TYPE(delayedCallbacks_accessMutex)
-    UA_DelayedCallback *delayedCallbacks_checkpoint;
-    size_t delayedCallbacks_sinceDispatch; /* How many have been added since we
-                                            * tried to dispatch callbacks? */
+
+    /* The delayed callbacks are processed in batches. A batch is taken out of
+     * delayedCallbacks with the current bottom index of every ring and the
+     * count of overflowed work. Once the workers have taken out all callbacks
+     * up to that point, the worker epochs are sampled. The batch is executed
+     * when every worker that was busy at that point has moved on to a new
+     * epoch. */
+    struct UA_DelayedCallbackQueue delayedBatch;
+    size_t delayedOverflow;    /* overflowEnqueued sampled for the batch */
+    UA_Byte delayedBatchStage; /* 0: no batch, 1: wait for the rings,
+                                * 2: wait for the epochs */
 #endif
 };
 
@@ -96,8 +143,8 @@ void UA_WorkQueue_init(UA_WorkQueue *wq);
  * queue has been finished. The ``cb`` pointer is freed afterwards. ``cb`` can
  * have a NULL callback that is not executed.
  *
- * This method checks internally if existing delayed work can be moved from the
- * delayed queue to the worker dispatch queue. */
+ * With worker threads, this can be called from any thread. The delayed
+ * callbacks are executed in batches by UA_WorkQueue_processDelayed. */
 void UA_WorkQueue_enqueueDelayed(UA_WorkQueue *wq, UA_DelayedCallback *cb);
 
 /* Stop the workers, process all enqueued work in the calling thread, clean up
@@ -111,9 +158,19 @@ UA_StatusCode UA_WorkQueue_start(UA_WorkQueue *wq, size_t workersCount);
 
 void UA_WorkQueue_stop(UA_WorkQueue *wq);
 
-/* Enqueue work for the worker threads */
-void UA_WorkQueue_enqueue(UA_WorkQueue *wq, UA_ApplicationCallback cb,
-                          void *application, void *data);
+/* Enqueue work for the worker threads. Only to be called from the thread that
+ * runs the main loop. The callback is never executed in the calling thread.
+ * If no worker is running or all rings are full, it is appended to the
+ * overflow list. Work that is still queued when the workers are stopped is
+ * executed by UA_WorkQueue_stop. Returns an error if the overflow entry cannot
+ * be allocated. Then the callback is not executed. */
+UA_StatusCode
+UA_WorkQueue_enqueue(UA_WorkQueue *wq, UA_ApplicationCallback cb,
+                     void *application, void *data);
+
+/* Execute the batch of delayed callbacks once it is safe and start the next
+ * batch. Only to be called from the thread that runs the main loop. */
+void UA_WorkQueue_processDelayed(UA_WorkQueue *wq);
 
 #else
 
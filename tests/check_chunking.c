@@ -150,6 +150,173 @@ START_TEST(encodeTwoStringsIntoTenChunksShallWork) {
     UA_String_deleteMembers(&string);
 } END_TEST
 
+/* A WriteRequest with strings, arrays, a Guid and a Variant containing an
+ * ExtensionObject (that is unwrapped during decoding) */
+static void
+createWriteRequest(UA_WriteRequest *request) {
+    UA_WriteRequest_init(request);
+    request->requestHeader.timestamp = UA_DateTime_now();
+    request->requestHeader.requestHandle = 42;
+    request->nodesToWriteSize = 3;
+    request->nodesToWrite = (UA_WriteValue*)
+        UA_Array_new(3, &UA_TYPES[UA_TYPES_WRITEVALUE]);
+
+    UA_WriteValue *wv = &request->nodesToWrite[0];
+    wv->nodeId = UA_NODEID_STRING_ALLOC(1, "the.answer");
+    wv->attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_Double d[50];
+    for(size_t i = 0; i < 50; i++)
+        d[i] = (UA_Double)i * 0.5;
+    UA_Variant_setArrayCopy(&wv->value.value, d, 50, &UA_TYPES[UA_TYPES_DOUBLE]);
+    wv->value.hasValue = true;
+
+    wv = &request->nodesToWrite[1];
+    UA_Guid guid = {1, 2, 3, {4, 5, 6, 7, 8, 9, 10, 11}};
+    wv->nodeId = UA_NODEID_GUID(2, guid);
+    wv->attributeId = UA_ATTRIBUTEID_DISPLAYNAME;
+    UA_LocalizedText lt = UA_LOCALIZEDTEXT("en-US", "A rather long display name");
+    UA_Variant_setScalarCopy(&wv->value.value, &lt, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+    wv->value.hasValue = true;
+    wv->value.sourceTimestamp = UA_DateTime_now();
+    wv->value.hasSourceTimestamp = true;
+
+    wv = &request->nodesToWrite[2];
+    wv->nodeId = UA_NODEID_NUMERIC(0, 12345);
+    wv->attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_Argument arg;
+    UA_Argument_init(&arg);
+    arg.name = UA_STRING("argument");
+    arg.dataType = UA_TYPES[UA_TYPES_STRING].typeId;
+    arg.valueRank = UA_VALUERANK_SCALAR;
+    UA_Variant_setScalarCopy(&wv->value.value, &arg, &UA_TYPES[UA_TYPES_ARGUMENT]);
+    wv->value.hasValue = true;
+}
+
+static UA_StatusCode
+encodeWriteRequest(const UA_WriteRequest *request, UA_ByteString *buf) {
+    UA_StatusCode retval =
+        UA_ByteString_allocBuffer(buf, UA_calcSizeBinary(request,
+                                                         &UA_TYPES[UA_TYPES_WRITEREQUEST]));
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    UA_Byte *pos = buf->data;
+    const UA_Byte *end = &buf->data[buf->length];
+    return UA_encodeBinary(request, &UA_TYPES[UA_TYPES_WRITEREQUEST],
+                           &pos, &end, NULL, NULL);
+}
+
+/* Split the buffer into segments of the given size (and a remainder) */
+static size_t
+splitSegments(const UA_ByteString *buf, size_t segmentSize, UA_ByteString *segments) {
+    size_t segmentsSize = 0;
+    for(size_t pos = 0; pos < buf->length; pos += segmentSize) {
+        segments[segmentsSize].data = &buf->data[pos];
+        segments[segmentsSize].length = segmentSize;
+        if(pos + segmentSize > buf->length)
+            segments[segmentsSize].length = buf->length - pos;
+        segmentsSize++;
+    }
+    return segmentsSize;
+}
+
+START_TEST(decodeFromSegmentsShallWork) {
+    UA_WriteRequest request;
+    createWriteRequest(&request);
+    UA_ByteString encoded = UA_BYTESTRING_NULL;
+    UA_StatusCode retval = encodeWriteRequest(&request, &encoded);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_ByteString *segments = (UA_ByteString*)
+        UA_malloc(sizeof(UA_ByteString) * encoded.length);
+    ck_assert_ptr_ne(segments, NULL);
+
+    /* Every segment size splits the values at different positions */
+    for(size_t segmentSize = 1; segmentSize <= 33; segmentSize++) {
+        size_t segmentsSize = splitSegments(&encoded, segmentSize, segments);
+        size_t offset = 0;
+        UA_WriteRequest decoded;
+        retval = UA_decodeBinarySegments(segments, segmentsSize, &offset, &decoded,
+                                         &UA_TYPES[UA_TYPES_WRITEREQUEST], NULL);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(offset, encoded.length);
+        ck_assert_ptr_eq(decoded.nodesToWrite[2].value.value.type,
+                         &UA_TYPES[UA_TYPES_ARGUMENT]);
+
+        /* The re-encoded value is identical */
+        UA_ByteString reencoded = UA_BYTESTRING_NULL;
+        retval = encodeWriteRequest(&decoded, &reencoded);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        ck_assert(UA_ByteString_equal(&encoded, &reencoded));
+        UA_ByteString_clear(&reencoded);
+        UA_WriteRequest_clear(&decoded);
+    }
+
+    UA_free(segments);
+    UA_ByteString_clear(&encoded);
+    UA_WriteRequest_clear(&request);
+} END_TEST
+
+START_TEST(decodeFromTruncatedSegmentsShallFail) {
+    UA_WriteRequest request;
+    createWriteRequest(&request);
+    UA_ByteString encoded = UA_BYTESTRING_NULL;
+    UA_StatusCode retval = encodeWriteRequest(&request, &encoded);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Remove the last bytes. The decoding must not read beyond the segments. */
+    UA_ByteString *segments = (UA_ByteString*)
+        UA_malloc(sizeof(UA_ByteString) * encoded.length);
+    ck_assert_ptr_ne(segments, NULL);
+    for(size_t missing = 1; missing < 16; missing++) {
+        UA_ByteString truncated = {encoded.length - missing, encoded.data};
+        size_t segmentsSize = splitSegments(&truncated, 7, segments);
+        size_t offset = 0;
+        UA_WriteRequest decoded;
+        retval = UA_decodeBinarySegments(segments, segmentsSize, &offset, &decoded,
+                                         &UA_TYPES[UA_TYPES_WRITEREQUEST], NULL);
+        ck_assert_uint_ne(retval, UA_STATUSCODE_GOOD);
+    }
+
+    UA_free(segments);
+    UA_ByteString_clear(&encoded);
+    UA_WriteRequest_clear(&request);
+} END_TEST
+
+START_TEST(decodeTruncatedExtensionObjectShallNotLeak) {
+    UA_Argument arg;
+    UA_Argument_init(&arg);
+    arg.name = UA_STRING("Argument");
+    UA_ExtensionObject eo;
+    UA_ExtensionObject_init(&eo);
+    eo.encoding = UA_EXTENSIONOBJECT_DECODED_NODELETE;
+    eo.content.decoded.type = &UA_TYPES[UA_TYPES_ARGUMENT];
+    eo.content.decoded.data = &arg;
+    UA_ByteString encoded = UA_BYTESTRING_NULL;
+    UA_StatusCode retval = UA_ByteString_allocBuffer(&encoded,
+                           UA_calcSizeBinary(&eo, &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]));
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Byte *pos = encoded.data;
+    const UA_Byte *end = &encoded.data[encoded.length];
+    retval = UA_encodeBinary(&eo, &UA_TYPES[UA_TYPES_EXTENSIONOBJECT],
+                             &pos, &end, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Cut the message in the length field of the content. The content must
+     * not be allocated (and leaked) before the length field is read. */
+    UA_ByteString segments[16];
+    for(size_t length = 5; length < 9; length++) {
+        UA_ByteString truncated = {length, encoded.data};
+        size_t segmentsSize = splitSegments(&truncated, 1, segments);
+        size_t offset = 0;
+        UA_ExtensionObject decoded;
+        retval = UA_decodeBinarySegments(segments, segmentsSize, &offset, &decoded,
+                                         &UA_TYPES[UA_TYPES_EXTENSIONOBJECT], NULL);
+        ck_assert_uint_ne(retval, UA_STATUSCODE_GOOD);
+    }
+
+    UA_ByteString_clear(&encoded);
+} END_TEST
+
 int main(void) {
     Suite *s = suite_create("Chunked encoding");
     TCase *tc_message = tcase_create("encode chunking");
@@ -157,6 +324,11 @@ int main(void) {
     tcase_add_test(tc_message,encodeStringIntoFiveChunksShallWork);
     tcase_add_test(tc_message,encodeTwoStringsIntoTenChunksShallWork);
     suite_add_tcase(s, tc_message);
+    TCase *tc_decode = tcase_create("decode segments");
+    tcase_add_test(tc_decode,decodeFromSegmentsShallWork);
+    tcase_add_test(tc_decode,decodeFromTruncatedSegmentsShallFail);
+    tcase_add_test(tc_decode,decodeTruncatedExtensionObjectShallNotLeak);
+    suite_add_tcase(s, tc_decode);
 
     SRunner *sr = srunner_create(s);
     srunner_set_fork_status(sr, CK_NOFORK);
@@ -4,6 +4,7 @@
 
 #include "ua_timer.h"
 #include "check.h"
+#include "testing_clock.h"
 
 #include <time.h>
 #include <stdio.h>
@@ -57,9 +58,148 @@ START_TEST(benchmarkTimer) {
     UA_Timer_deleteMembers(&timer);
 } END_TEST
 
+static void
+countCallback(void *application, void *data) {
+    (*(size_t*)data)++;
+}
+
+/* Process in steps of 1ms. The next time returned by the timer is never in the
+ * past. */
+static void
+processSteps(UA_Timer *t, UA_DateTime *now, size_t steps) {
+    for(size_t i = 0; i < steps; i++) {
+        *now += UA_DATETIME_MSEC;
+        UA_DateTime next = UA_Timer_process(t, *now, executionCallback, NULL);
+        ck_assert(next > *now);
+    }
+}
+
+START_TEST(repeatedCallbacks) {
+    UA_Timer timer;
+    UA_Timer_init(&timer);
+    UA_DateTime now = UA_DateTime_nowMonotonic();
+
+    /* Callbacks with the same interval share one slot */
+    size_t counts[4] = {0, 0, 0, 0};
+    for(size_t i = 0; i < 3; i++) {
+        UA_StatusCode retval =
+            UA_Timer_addRepeatedCallback(&timer, countCallback, NULL,
+                                         &counts[i], 10.0, NULL);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    UA_UInt64 id;
+    UA_StatusCode retval =
+        UA_Timer_addRepeatedCallback(&timer, countCallback, NULL,
+                                     &counts[3], 25.0, &id);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    processSteps(&timer, &now, 100);
+    ck_assert_uint_eq(counts[0], 10);
+    ck_assert_uint_eq(counts[1], 10);
+    ck_assert_uint_eq(counts[2], 10);
+    ck_assert_uint_eq(counts[3], 4);
+
+    /* Process a larger time step at once. Every missed execution is caught up
+     * once. */
+    now += 95 * UA_DATETIME_MSEC;
+    UA_Timer_process(&timer, now, executionCallback, NULL);
+    ck_assert_uint_eq(counts[0], 11);
+    ck_assert_uint_eq(counts[3], 5);
+
+    /* Change and remove */
+    UA_fakeSleep((UA_UInt32)((now - UA_DateTime_nowMonotonic()) / UA_DATETIME_MSEC));
+    retval = UA_Timer_changeRepeatedCallbackInterval(&timer, id, 10.0);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    processSteps(&timer, &now, 10);
+    ck_assert_uint_eq(counts[3], 6);
+    UA_Timer_removeCallback(&timer, id);
+    processSteps(&timer, &now, 100);
+    ck_assert_uint_eq(counts[3], 6);
+
+    UA_Timer_deleteMembers(&timer);
+} END_TEST
+
+static size_t order[4];
+static size_t orderSize;
+
+static void
+orderCallback(void *application, void *data) {
+    order[orderSize++] = (size_t)(uintptr_t)data;
+}
+
+START_TEST(timedCallbacks) {
+    UA_Timer timer;
+    UA_Timer_init(&timer);
+    UA_DateTime now = UA_DateTime_nowMonotonic();
+    orderSize = 0;
+
+    /* Single-shot callbacks are executed in the order of their time. Also
+     * far in the future. */
+    UA_DateTime times[4] = {now + 50 * UA_DATETIME_MSEC, now + 3 * UA_DATETIME_MSEC,
+                            now + 10 * UA_DATETIME_SEC, now + 3600 * UA_DATETIME_SEC};
+    for(size_t i = 0; i < 4; i++) {
+        UA_StatusCode retval =
+            UA_Timer_addTimedCallback(&timer, orderCallback, NULL,
+                                      (void*)(uintptr_t)i, times[i], NULL);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+
+    UA_DateTime next = UA_Timer_process(&timer, now, executionCallback, NULL);
+    ck_assert(next > now && next <= times[1]);
+    UA_Timer_process(&timer, now + 20 * UA_DATETIME_SEC, executionCallback, NULL);
+    ck_assert_uint_eq(orderSize, 3);
+    ck_assert_uint_eq(order[0], 1);
+    ck_assert_uint_eq(order[1], 0);
+    ck_assert_uint_eq(order[2], 2);
+
+    /* Not yet due */
+    next = UA_Timer_process(&timer, times[3] - 1, executionCallback, NULL);
+    ck_assert_uint_eq(orderSize, 3);
+    ck_assert(next <= times[3]);
+    UA_Timer_process(&timer, times[3], executionCallback, NULL);
+    ck_assert_uint_eq(orderSize, 4);
+    ck_assert_uint_eq(order[3], 3);
+
+    UA_Timer_deleteMembers(&timer);
+} END_TEST
+
+static UA_Timer removeTimer;
+static UA_UInt64 removeIds[3];
+static size_t removeCount;
+
+/* Remove itself and the other callbacks with the same interval */
+static void
+removeCallback(void *application, void *data) {
+    removeCount++;
+    for(size_t i = 0; i < 3; i++)
+        UA_Timer_removeCallback(&removeTimer, removeIds[i]);
+}
+
+START_TEST(removeInCallback) {
+    UA_Timer_init(&removeTimer);
+    UA_DateTime now = UA_DateTime_nowMonotonic();
+    removeCount = 0;
+    for(size_t i = 0; i < 3; i++) {
+        UA_StatusCode retval =
+            UA_Timer_addRepeatedCallback(&removeTimer, removeCallback, NULL,
+                                         NULL, 10.0, &removeIds[i]);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+
+    processSteps(&removeTimer, &now, 100);
+    ck_assert_uint_eq(removeCount, 1);
+    UA_DateTime next = UA_Timer_process(&removeTimer, now, executionCallback, NULL);
+    ck_assert(next == UA_INT64_MAX);
+
+    UA_Timer_deleteMembers(&removeTimer);
+} END_TEST
+
 int main(void) {
     Suite *s  = suite_create("Test Event Timer");
     TCase *tc = tcase_create("test cases");
+    tcase_add_test(tc, repeatedCallbacks);
+    tcase_add_test(tc, timedCallbacks);
+    tcase_add_test(tc, removeInCallback);
     tcase_add_test(tc, benchmarkTimer);
     suite_add_tcase(s, tc);
 
@@ -1498,6 +1498,29 @@ START_TEST(UA_ExtensionObject_encodeDecodeShallWorkOnExtensionObject) {
 }
 END_TEST
 
+START_TEST(UA_findDataType_findsAllTypes) {
+    for(size_t i = 0; i < UA_TYPES_COUNT; i++) {
+        const UA_DataType *type = &UA_TYPES[i];
+        ck_assert_ptr_eq(UA_findDataType(&type->typeId), type);
+        if(type->binaryEncodingId == 0)
+            continue;
+        UA_NodeId encodingId = UA_NODEID_NUMERIC(type->typeId.namespaceIndex,
+                                                 type->binaryEncodingId);
+        ck_assert_ptr_eq(UA_findDataTypeByBinary(&encodingId), type);
+    }
+
+    /* Unknown identifiers and wrong namespaces */
+    UA_NodeId unknown = UA_NODEID_NUMERIC(0, 4242424);
+    ck_assert_ptr_eq(UA_findDataType(&unknown), NULL);
+    ck_assert_ptr_eq(UA_findDataTypeByBinary(&unknown), NULL);
+    UA_NodeId otherNs = UA_TYPES[UA_TYPES_READREQUEST].typeId;
+    otherNs.namespaceIndex = 1;
+    ck_assert_ptr_eq(UA_findDataType(&otherNs), NULL);
+    UA_NodeId stringId = UA_NODEID_STRING(0, "ReadRequest");
+    ck_assert_ptr_eq(UA_findDataType(&stringId), NULL);
+}
+END_TEST
+
 static Suite *testSuite_builtin(void) {
     Suite *s = suite_create("Built-in Data Types 62541-6 Table 1");
 
@@ -1529,6 +1552,7 @@ static Suite *testSuite_builtin(void) {
     tcase_add_test(tc_decode, UA_Variant_decodeWithArrayFlagSetShallSetVTAndAllocateMemoryForArray);
     tcase_add_test(tc_decode, UA_Variant_decodeWithOutDeleteMembersShallFailInCheckMem);
     tcase_add_test(tc_decode, UA_Variant_decodeWithTooSmallSourceShallReturnWithError);
+    tcase_add_test(tc_decode, UA_findDataType_findsAllTypes);
     suite_add_tcase(s, tc_decode);
 
     TCase *tc_encode = tcase_create("encode");
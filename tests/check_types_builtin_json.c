@@ -5611,6 +5611,86 @@ START_TEST(UA_Variant_Malformed2_decode) {
 }
 END_TEST
 
+START_TEST(UA_VariantLargeArray_json_decode) {
+    /* More tokens than fit into a 16bit index */
+    const size_t count = 70000;
+    UA_ByteString buf;
+    ck_assert_int_eq(UA_ByteString_allocBuffer(&buf, 32 + (count * 7)), UA_STATUSCODE_GOOD);
+    size_t pos = (size_t)sprintf((char*)buf.data, "{\"Type\":6,\"Body\":[");
+    for(size_t i = 0; i < count; i++)
+        pos += (size_t)sprintf((char*)&buf.data[pos], (i == 0) ? "%u" : ",%u", (unsigned)i);
+    pos += (size_t)sprintf((char*)&buf.data[pos], "]}");
+    buf.length = pos;
+
+    UA_Variant out;
+    UA_Variant_init(&out);
+    UA_StatusCode retval = UA_decodeJson(&buf, &out, &UA_TYPES[UA_TYPES_VARIANT]);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(out.arrayLength, count);
+    ck_assert_ptr_eq(out.type, &UA_TYPES[UA_TYPES_INT32]);
+    ck_assert_int_eq(((UA_Int32*)out.data)[count - 1], (UA_Int32)(count - 1));
+    UA_Variant_deleteMembers(&out);
+    UA_ByteString_deleteMembers(&buf);
+}
+END_TEST
+
+START_TEST(UA_JsonTokenizer_pieces) {
+    UA_ByteString buf = UA_STRING("{\"Type\":12,\"Body\":[\"a\\u00e4\\\"\",{\"x\":[1,2]},true],"
+                                  "\"Dimension\":[3],\"Empty\":{}}");
+
+    JsonTokenizer whole;
+    JsonTokenizer_init(&whole);
+    ck_assert_int_eq(JsonTokenizer_feed(&whole, buf.data, buf.length), UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(JsonTokenizer_finish(&whole), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(whole.tokensSize, 17);
+
+    /* The skip link of the Body array points to the next key */
+    ck_assert_int_eq(whole.tokens[4].type, JSMN_ARRAY);
+    ck_assert_int_eq(whole.tokens[4].size, 3);
+    ck_assert_uint_eq(whole.tokens[4].next, 12);
+    ck_assert_int_eq(whole.tokens[0].size, 4);
+    ck_assert_uint_eq(whole.tokens[0].next, 17);
+
+    /* Feeding the input byte by byte gives the same tokens */
+    JsonTokenizer pieces;
+    JsonTokenizer_init(&pieces);
+    for(size_t i = 0; i < buf.length; i++)
+        ck_assert_int_eq(JsonTokenizer_feed(&pieces, &buf.data[i], 1), UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(JsonTokenizer_finish(&pieces), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(pieces.tokensSize, whole.tokensSize);
+    ck_assert(memcmp(pieces.tokens, whole.tokens,
+                     whole.tokensSize * sizeof(JsonToken)) == 0);
+
+    JsonTokenizer_clear(&pieces);
+    JsonTokenizer_clear(&whole);
+}
+END_TEST
+
+START_TEST(UA_JsonTokenizer_invalid) {
+    const char *invalid[] = {"{\"a\":1", "{\"a\" 1}", "[1,]", "{\"a\":1,}", "[1}",
+                             "{1:2}", "\"abc", "\"\\x\"", "\"\\u12g4\""};
+    for(size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        JsonTokenizer t;
+        JsonTokenizer_init(&t);
+        UA_StatusCode retval = JsonTokenizer_feed(&t, (const UA_Byte*)invalid[i],
+                                                  strlen(invalid[i]));
+        if(retval == UA_STATUSCODE_GOOD)
+            retval = JsonTokenizer_finish(&t);
+        ck_assert_int_eq(retval, UA_STATUSCODE_BADDECODINGERROR);
+        JsonTokenizer_clear(&t);
+    }
+
+    /* The nesting depth is bounded */
+    UA_Byte deep[UA_JSON_ENCODING_MAX_RECURSION + 1];
+    memset(deep, '[', sizeof(deep));
+    JsonTokenizer t;
+    JsonTokenizer_init(&t);
+    ck_assert_int_eq(JsonTokenizer_feed(&t, deep, sizeof(deep) - 1), UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(JsonTokenizer_feed(&t, deep, 1), UA_STATUSCODE_BADDECODINGERROR);
+    JsonTokenizer_clear(&t);
+}
+END_TEST
+
 START_TEST(UA_JsonHelper) {
     // given
     
@@ -5993,6 +6073,9 @@ static Suite *testSuite_builtin_json(void) {
     
     TCase *tc_json_helper = tcase_create("json_helper");
     tcase_add_test(tc_json_decode, UA_JsonHelper);
+    tcase_add_test(tc_json_decode, UA_VariantLargeArray_json_decode);
+    tcase_add_test(tc_json_decode, UA_JsonTokenizer_pieces);
+    tcase_add_test(tc_json_decode, UA_JsonTokenizer_invalid);
     suite_add_tcase(s, tc_json_helper);
     return s;
 }
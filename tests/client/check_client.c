@@ -33,6 +33,7 @@ addVariable(size_t size) {
     attr.description = UA_LOCALIZEDTEXT("en-US", name);
     attr.displayName = UA_LOCALIZEDTEXT("en-US", name);
     attr.dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
 
     /* Add the variable node to the information model */
     UA_NodeId myIntegerNodeId = UA_NODEID_STRING(1, name);
@@ -47,6 +48,45 @@ addVariable(size_t size) {
     UA_free(array);
 }
 
+#define REFRESHEDLENGTH 64
+
+/* Refresh the value on every read. Every refresh allocates a new array with
+ * all elements set to the number of reads. */
+static void
+refreshOnRead(UA_Server *s, const UA_NodeId *sessionId, void *sessionContext,
+              const UA_NodeId *nodeId, void *nodeContext,
+              const UA_NumericRange *range, const UA_DataValue *value) {
+    UA_UInt32 *reads = (UA_UInt32*)nodeContext;
+    (*reads)++;
+    UA_Int32 array[REFRESHEDLENGTH];
+    for(size_t i = 0; i < REFRESHEDLENGTH; i++)
+        array[i] = (UA_Int32)*reads;
+    UA_Variant val;
+    UA_Variant_setArray(&val, array, REFRESHEDLENGTH, &UA_TYPES[UA_TYPES_INT32]);
+    UA_Server_writeValue(s, *nodeId, val);
+}
+
+static UA_UInt32 refreshedReads;
+
+static void
+addRefreshedVariable(void) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Int32 array[REFRESHEDLENGTH] = {0};
+    UA_Variant_setArray(&attr.value, array, REFRESHEDLENGTH, &UA_TYPES[UA_TYPES_INT32]);
+    attr.dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+    attr.displayName = UA_LOCALIZEDTEXT("en-US", "refreshed.variable");
+    refreshedReads = 0;
+    UA_Server_addVariableNode(server, UA_NODEID_STRING(1, "refreshed.variable"),
+                              UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                              UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                              UA_QUALIFIEDNAME(1, "refreshed.variable"),
+                              UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                              attr, &refreshedReads, NULL);
+    UA_ValueCallback callback = {refreshOnRead, NULL};
+    UA_Server_setVariableNode_valueCallback(server, UA_NODEID_STRING(1, "refreshed.variable"),
+                                            callback);
+}
+
 THREAD_CALLBACK(serverloop) {
     while(running)
         UA_Server_run_iterate(server, true);
@@ -64,6 +104,18 @@ static void setup(void) {
     THREAD_CREATE(server_thread, serverloop);
 }
 
+static void setup_readNoCopy(void) {
+    running = true;
+    server = UA_Server_new();
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_ServerConfig_setDefault(config);
+    config->readNoCopy = true;
+    UA_Server_run_startup(server);
+    addVariable(VARLENGTH);
+    addRefreshedVariable();
+    THREAD_CREATE(server_thread, serverloop);
+}
+
 static void teardown(void) {
     running = false;
     THREAD_JOIN(server_thread);
@@ -169,6 +221,97 @@ START_TEST(Client_read) {
 }
 END_TEST
 
+START_TEST(Client_readNoCopy) {
+    UA_Client *client = UA_Client_new();
+    UA_ClientConfig_setDefault(UA_Client_getConfig(client));
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Read the array twice in one request and with an index range */
+    UA_ReadValueId rvi[3];
+    for(size_t i = 0; i < 3; i++) {
+        UA_ReadValueId_init(&rvi[i]);
+        rvi[i].nodeId = UA_NODEID_STRING(1, "my.variable");
+        rvi[i].attributeId = UA_ATTRIBUTEID_VALUE;
+    }
+    rvi[2].indexRange = UA_STRING("10:11");
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.nodesToRead = rvi;
+    request.nodesToReadSize = 3;
+
+    for(size_t round = 0; round < 2; round++) {
+        UA_ReadResponse response = UA_Client_Service_read(client, request);
+        ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(response.resultsSize, 3);
+        for(size_t i = 0; i < 2; i++) {
+            UA_Variant *val = &response.results[i].value;
+            ck_assert(val->type == &UA_TYPES[UA_TYPES_INT32]);
+            ck_assert_uint_eq(val->arrayLength, VARLENGTH);
+            UA_Int32 *var = (UA_Int32*)val->data;
+            for(size_t j = 0; j < VARLENGTH; j++)
+                ck_assert_int_eq(var[j], (UA_Int32)(j + round));
+        }
+        UA_Variant *range = &response.results[2].value;
+        ck_assert_uint_eq(range->arrayLength, 2);
+        ck_assert_int_eq(((UA_Int32*)range->data)[0], (UA_Int32)(10 + round));
+        UA_ReadResponse_clear(&response);
+
+        /* Replace the value. The previous node is released after sending. */
+        UA_Int32 *array = (UA_Int32*)UA_malloc(VARLENGTH * sizeof(UA_Int32));
+        for(size_t j = 0; j < VARLENGTH; j++)
+            array[j] = (UA_Int32)(j + round + 1);
+        UA_Variant val;
+        UA_Variant_setArray(&val, array, VARLENGTH, &UA_TYPES[UA_TYPES_INT32]);
+        retval = UA_Client_writeValueAttribute(client, rvi[0].nodeId, &val);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        UA_Variant_clear(&val);
+    }
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+}
+END_TEST
+
+/* The onRead callback of the second operation replaces the value that the
+ * result of the first operation was read from */
+START_TEST(Client_readNoCopyRefreshOnRead) {
+    UA_Client *client = UA_Client_new();
+    UA_ClientConfig_setDefault(UA_Client_getConfig(client));
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_ReadValueId rvi[2];
+    for(size_t i = 0; i < 2; i++) {
+        UA_ReadValueId_init(&rvi[i]);
+        rvi[i].nodeId = UA_NODEID_STRING(1, "refreshed.variable");
+        rvi[i].attributeId = UA_ATTRIBUTEID_VALUE;
+    }
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.nodesToRead = rvi;
+    request.nodesToReadSize = 2;
+
+    for(size_t round = 0; round < 2; round++) {
+        UA_ReadResponse response = UA_Client_Service_read(client, request);
+        ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(response.resultsSize, 2);
+        for(size_t i = 0; i < 2; i++) {
+            UA_Variant *val = &response.results[i].value;
+            ck_assert(val->type == &UA_TYPES[UA_TYPES_INT32]);
+            ck_assert_uint_eq(val->arrayLength, REFRESHEDLENGTH);
+            UA_Int32 *var = (UA_Int32*)val->data;
+            for(size_t j = 0; j < REFRESHEDLENGTH; j++)
+                ck_assert_int_eq(var[j], (UA_Int32)(2 * round + i + 1));
+        }
+        UA_ReadResponse_clear(&response);
+    }
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+}
+END_TEST
+
 START_TEST(Client_renewSecureChannel) {
     UA_Client *client = UA_Client_new();
     UA_ClientConfig_setDefault(UA_Client_getConfig(client));
@@ -385,6 +528,12 @@ static Suite* testSuite_Client(void) {
     tcase_add_test(tc_client, Client_endpoints_empty);
     tcase_add_test(tc_client, Client_read);
     suite_add_tcase(s,tc_client);
+    TCase *tc_client_nocopy = tcase_create("Client Read NoCopy");
+    tcase_add_checked_fixture(tc_client_nocopy, setup_readNoCopy, teardown);
+    tcase_add_test(tc_client_nocopy, Client_read);
+    tcase_add_test(tc_client_nocopy, Client_readNoCopy);
+    tcase_add_test(tc_client_nocopy, Client_readNoCopyRefreshOnRead);
+    suite_add_tcase(s,tc_client_nocopy);
     TCase *tc_client_reconnect = tcase_create("Client Reconnect");
     tcase_add_checked_fixture(tc_client_reconnect, setup, teardown);
     tcase_add_test(tc_client_reconnect, Client_renewSecureChannel);
@@ -195,6 +195,85 @@ START_TEST(Client_read_async_timed) {
         UA_Client_delete(client);
     }END_TEST
 
+#define PIPELINED_REQUESTS 64
+
+static UA_StatusCode pipelinedResults[PIPELINED_REQUESTS];
+static size_t pipelinedCalls[PIPELINED_REQUESTS];
+
+static void asyncPipelinedCallback(UA_Client *client, void *userdata,
+        UA_UInt32 requestId, const UA_ReadResponse *response) {
+    size_t i = (uintptr_t)userdata;
+    pipelinedResults[i] = response->responseHeader.serviceResult;
+    pipelinedCalls[i]++;
+}
+
+START_TEST(Client_read_async_timeouts_ordered) {
+        UA_Client *client = UA_Client_new();
+        UA_ClientConfig *clientConfig = UA_Client_getConfig(client);
+        UA_ClientConfig_setDefault(clientConfig);
+#ifdef UA_ENABLE_SUBSCRIPTIONS
+        clientConfig->outStandingPublishRequests = 0;
+#endif
+
+        UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+        UA_Client_recv = client->connection.recv;
+        client->connection.recv = UA_Client_recvTesting;
+
+        UA_ReadRequest rr;
+        UA_ReadRequest_init(&rr);
+
+        UA_ReadValueId rvid;
+        UA_ReadValueId_init(&rvid);
+        rvid.attributeId = UA_ATTRIBUTEID_VALUE;
+        rvid.nodeId = UA_NODEID_NUMERIC(0,
+                UA_NS0ID_SERVER_SERVERSTATUS_CURRENTTIME);
+
+        rr.nodesToRead = &rvid;
+        rr.nodesToReadSize = 1;
+
+        /* Pipeline requests with timeouts in reverse order of sending. Every
+         * fourth request has no timeout. */
+        memset(pipelinedCalls, 0, sizeof(pipelinedCalls));
+        for(size_t i = 0; i < PIPELINED_REQUESTS; i++) {
+            UA_UInt32 timeout = 0;
+            if(i % 4 != 0)
+                timeout = (UA_UInt32)((4 - (i % 4)) * 100) - 50;
+            retval = __UA_Client_AsyncServiceEx(client, &rr,
+                    &UA_TYPES[UA_TYPES_READREQUEST],
+                    (UA_ClientAsyncServiceCallback) asyncPipelinedCallback,
+                    &UA_TYPES[UA_TYPES_READRESPONSE], (void*)(uintptr_t)i,
+                    NULL, timeout);
+            ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        }
+        ck_assert_uint_eq(client->asyncServiceCallsIndex.entriesSize, PIPELINED_REQUESTS);
+        ck_assert_uint_eq(client->asyncServiceTimeoutsSize, PIPELINED_REQUESTS / 4 * 3);
+
+        /* Simulate network cable unplugged (no response from server). Every
+         * 100ms one group of requests times out. */
+        for(size_t step = 1; step <= 3; step++) {
+            UA_Client_recvTesting_result = UA_STATUSCODE_GOODNONCRITICALTIMEOUT;
+            UA_Client_run_iterate(client, 100);
+            for(size_t i = 0; i < PIPELINED_REQUESTS; i++) {
+                UA_Boolean expired = (i % 4 != 0 && 4 - (i % 4) <= step);
+                ck_assert_uint_eq(pipelinedCalls[i], expired ? 1 : 0);
+                if(expired)
+                    ck_assert_uint_eq(pipelinedResults[i], UA_STATUSCODE_BADTIMEOUT);
+            }
+        }
+        ck_assert_uint_eq(client->asyncServiceCallsIndex.entriesSize, PIPELINED_REQUESTS / 4);
+        ck_assert_uint_eq(client->asyncServiceTimeoutsSize, 0);
+
+        /* The remaining requests are answered or cancelled exactly once */
+        UA_Client_disconnect(client);
+        for(size_t i = 0; i < PIPELINED_REQUESTS; i++)
+            ck_assert_uint_eq(pipelinedCalls[i], 1);
+        ck_assert_uint_eq(client->asyncServiceCallsIndex.entriesSize, 0);
+
+        UA_Client_delete(client);
+    }END_TEST
+
 static UA_Boolean inactivityCallbackTriggered = false;
 
 static void inactivityCallback(UA_Client *client) {
@@ -250,6 +329,7 @@ static Suite* testSuite_Client(void) {
     tcase_add_checked_fixture(tc_client, setup, teardown);
     tcase_add_test(tc_client, Client_read_async);
     tcase_add_test(tc_client, Client_read_async_timed);
+    tcase_add_test(tc_client, Client_read_async_timeouts_ordered);
     tcase_add_test(tc_client, Client_connectivity_check);
     tcase_add_test(tc_client, Client_highlevel_async_readValue);
 
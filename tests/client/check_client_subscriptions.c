@@ -434,6 +434,179 @@ START_TEST(Client_subscription_createDataChanges) {
 }
 END_TEST
 
+#define MANY_MONITOREDITEMS 200
+
+static UA_UInt32 manyNotifications[MANY_MONITOREDITEMS];
+static size_t batchCalls;
+static size_t batchNotifications;
+
+static void
+dataChangeHandlerCountContext(UA_Client *client, UA_UInt32 subId, void *subContext,
+                              UA_UInt32 monId, void *monContext, UA_DataValue *value) {
+    (*(UA_UInt32*)monContext)++;
+}
+
+static void
+dataChangeBatchHandler(UA_Client *client, UA_UInt32 subId, void *subContext,
+                       UA_DataChangeNotification *notification, void **monContexts) {
+    batchCalls++;
+    batchNotifications += notification->monitoredItemsSize;
+    for(size_t i = 0; i < notification->monitoredItemsSize; i++) {
+        ck_assert_ptr_ne(monContexts[i], NULL);
+        (*(UA_UInt32*)monContexts[i])++;
+    }
+}
+
+/* Create MANY_MONITOREDITEMS on the server state. The contexts point into
+ * manyNotifications. */
+static UA_CreateMonitoredItemsResponse
+createManyMonitoredItems(UA_Client *client, UA_UInt32 subId) {
+    UA_MonitoredItemCreateRequest items[MANY_MONITOREDITEMS];
+    UA_Client_DataChangeNotificationCallback callbacks[MANY_MONITOREDITEMS];
+    UA_Client_DeleteMonitoredItemCallback deleteCallbacks[MANY_MONITOREDITEMS];
+    void *contexts[MANY_MONITOREDITEMS];
+    for(size_t i = 0; i < MANY_MONITOREDITEMS; i++) {
+        items[i] = UA_MonitoredItemCreateRequest_default(
+            UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_STATE));
+        callbacks[i] = dataChangeHandlerCountContext;
+        deleteCallbacks[i] = NULL;
+        contexts[i] = &manyNotifications[i];
+        manyNotifications[i] = 0;
+    }
+
+    UA_CreateMonitoredItemsRequest createRequest;
+    UA_CreateMonitoredItemsRequest_init(&createRequest);
+    createRequest.subscriptionId = subId;
+    createRequest.timestampsToReturn = UA_TIMESTAMPSTORETURN_BOTH;
+    createRequest.itemsToCreate = items;
+    createRequest.itemsToCreateSize = MANY_MONITOREDITEMS;
+    UA_CreateMonitoredItemsResponse createResponse =
+       UA_Client_MonitoredItems_createDataChanges(client, createRequest, contexts,
+                                                   callbacks, deleteCallbacks);
+    ck_assert_uint_eq(createResponse.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(createResponse.resultsSize, MANY_MONITOREDITEMS);
+    return createResponse;
+}
+
+/* Let the server sample and publish, then receive the notifications */
+static void
+publishManyMonitoredItems(UA_Client *client) {
+    /* manually control the server thread */
+    running = false;
+    THREAD_JOIN(server_thread);
+
+    UA_StatusCode retval = UA_Client_run_iterate(client, 1);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_fakeSleep((UA_UInt32)publishingInterval + 1);
+    UA_Server_run_iterate(server, true);
+    UA_fakeSleep((UA_UInt32)publishingInterval + 1);
+    retval = UA_Client_run_iterate(client, 1);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* run the server in an independent thread again */
+    running = true;
+    THREAD_CREATE(server_thread, serverloop);
+}
+
+START_TEST(Client_subscription_manyMonitoredItems) {
+    UA_Client *client = UA_Client_new();
+    UA_ClientConfig_setDefault(UA_Client_getConfig(client));
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_Client_recv = client->connection.recv;
+    client->connection.recv = UA_Client_recvTesting;
+
+    UA_CreateSubscriptionRequest request = UA_CreateSubscriptionRequest_default();
+    UA_CreateSubscriptionResponse response = UA_Client_Subscriptions_create(client, request,
+                                                                            NULL, NULL, NULL);
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    UA_UInt32 subId = response.subscriptionId;
+
+    UA_CreateMonitoredItemsResponse createResponse = createManyMonitoredItems(client, subId);
+    UA_Client_Subscription *sub = LIST_FIRST(&client->subscriptions);
+    ck_assert_ptr_ne(sub, NULL);
+    ck_assert_uint_eq(sub->monitoredItemsIndex.entriesSize, MANY_MONITOREDITEMS);
+
+    /* Every MonitoredItem is notified once through its own callback */
+    publishManyMonitoredItems(client);
+    for(size_t i = 0; i < MANY_MONITOREDITEMS; i++)
+        ck_assert_uint_eq(manyNotifications[i], 1);
+
+    /* Delete every second MonitoredItem */
+    UA_UInt32 deleteIds[MANY_MONITOREDITEMS / 2];
+    for(size_t i = 0; i < MANY_MONITOREDITEMS / 2; i++)
+        deleteIds[i] = createResponse.results[2 * i].monitoredItemId;
+    UA_CreateMonitoredItemsResponse_deleteMembers(&createResponse);
+
+    UA_DeleteMonitoredItemsRequest deleteRequest;
+    UA_DeleteMonitoredItemsRequest_init(&deleteRequest);
+    deleteRequest.subscriptionId = subId;
+    deleteRequest.monitoredItemIds = deleteIds;
+    deleteRequest.monitoredItemIdsSize = MANY_MONITOREDITEMS / 2;
+    UA_DeleteMonitoredItemsResponse deleteResponse =
+        UA_Client_MonitoredItems_delete(client, deleteRequest);
+    ck_assert_uint_eq(deleteResponse.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    UA_DeleteMonitoredItemsResponse_deleteMembers(&deleteResponse);
+    ck_assert_uint_eq(sub->monitoredItemsIndex.entriesSize, MANY_MONITOREDITEMS / 2);
+
+    /* The remaining MonitoredItems are still found by their clientHandle */
+    UA_Client_MonitoredItem *mon;
+    LIST_FOREACH(mon, &sub->monitoredItems, listEntry) {
+        UA_UInt32 *counter = (UA_UInt32*)mon->context;
+        ck_assert_uint_eq((counter - manyNotifications) % 2, 1);
+    }
+
+    retval = UA_Client_Subscriptions_deleteSingle(client, subId);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+}
+END_TEST
+
+START_TEST(Client_subscription_dataChangeBatch) {
+    UA_Client *client = UA_Client_new();
+    UA_ClientConfig_setDefault(UA_Client_getConfig(client));
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_Client_recv = client->connection.recv;
+    client->connection.recv = UA_Client_recvTesting;
+
+    UA_CreateSubscriptionRequest request = UA_CreateSubscriptionRequest_default();
+    UA_CreateSubscriptionResponse response = UA_Client_Subscriptions_create(client, request,
+                                                                            NULL, NULL, NULL);
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    UA_UInt32 subId = response.subscriptionId;
+
+    retval = UA_Client_Subscriptions_setDataChangeBatchCallback(client, subId + 1,
+                                                                dataChangeBatchHandler);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_BADSUBSCRIPTIONIDINVALID);
+    retval = UA_Client_Subscriptions_setDataChangeBatchCallback(client, subId,
+                                                                dataChangeBatchHandler);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_CreateMonitoredItemsResponse createResponse = createManyMonitoredItems(client, subId);
+    UA_CreateMonitoredItemsResponse_deleteMembers(&createResponse);
+
+    /* All notifications arrive in one batch with the resolved contexts */
+    batchCalls = 0;
+    batchNotifications = 0;
+    publishManyMonitoredItems(client);
+    ck_assert_uint_eq(batchCalls, 1);
+    ck_assert_uint_eq(batchNotifications, MANY_MONITOREDITEMS);
+    for(size_t i = 0; i < MANY_MONITOREDITEMS; i++)
+        ck_assert_uint_eq(manyNotifications[i], 1);
+
+    retval = UA_Client_Subscriptions_deleteSingle(client, subId);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+}
+END_TEST
+
 START_TEST(Client_subscription_createDataChanges_async) {
     UA_UInt32 reqId = 0;
     UA_Client *client = UA_Client_new();
@@ -1100,6 +1273,8 @@ static Suite* testSuite_Client(void) {
     tcase_add_test(tc_client, Client_subscription_connectionClose);
     tcase_add_test(tc_client, Client_subscription_createDataChanges);
     tcase_add_test(tc_client, Client_subscription_createDataChanges_async);
+    tcase_add_test(tc_client, Client_subscription_manyMonitoredItems);
+    tcase_add_test(tc_client, Client_subscription_dataChangeBatch);
     tcase_add_test(tc_client, Client_subscription_keepAlive);
     tcase_add_test(tc_client, Client_subscription_without_notification);
     tcase_add_test(tc_client, Client_subscription_async_sub);
@@ -22,6 +22,7 @@
 
 #include "server/ua_server_internal.h"
 #include "testing_networklayers.h"
+#include "ua_types_encoding_binary.h"
 
 #define RECEIVE_BUFFER_SIZE 65535
 
@@ -78,13 +79,16 @@ UA_debug_dumpGetMessageTypePrefix(UA_UInt32 messageType) {
  * E.g. `GetEndpointsRequest`
  */
 static UA_StatusCode
-UA_debug_dumpSetServiceName(const UA_ByteString *msg, char serviceNameTarget[100]) {
+UA_debug_dumpSetServiceName(const UA_ByteString *msg, size_t msgSize,
+                            char serviceNameTarget[100]) {
     /* At 0, the nodeid starts... */
     size_t offset = 0;
 
     /* Decode the nodeid */
     UA_NodeId requestTypeId;
-    UA_StatusCode retval = UA_NodeId_decodeBinary(msg, &offset, &requestTypeId);
+    UA_StatusCode retval =
+        UA_decodeBinarySegments(msg, msgSize, &offset, &requestTypeId,
+                                &UA_TYPES[UA_TYPES_NODEID], NULL);
     if(retval != UA_STATUSCODE_GOOD)
         return retval;
     if(requestTypeId.identifierType != UA_NODEIDTYPE_NUMERIC || requestTypeId.namespaceIndex != 0) {
@@ -118,11 +122,11 @@ UA_debug_dumpSetServiceName(const UA_ByteString *msg, char serviceNameTarget[100
 static void
 UA_debug_dump_setName(void *application, UA_SecureChannel *channel,
                       UA_MessageType messagetype, UA_UInt32 requestId,
-                      UA_ByteString *message) {
+                      UA_ByteString *message, size_t messageSize) {
     struct UA_dump_filename *dump_filename = (struct UA_dump_filename *)application;
     dump_filename->messageType = UA_debug_dumpGetMessageTypePrefix(messagetype);
     if(messagetype == UA_MESSAGETYPE_MSG)
-        UA_debug_dumpSetServiceName(message, dump_filename->serviceName);
+        UA_debug_dumpSetServiceName(message, messageSize, dump_filename->serviceName);
 }
 
 /**
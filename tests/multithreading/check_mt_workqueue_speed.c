@@ -0,0 +1,154 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Measures the enqueue/dispatch throughput of the work queue for an increasing
+ * number of worker threads. */
+
+#include <open62541/types.h>
+
+#include "ua_workqueue.h"
+
+#include <check.h>
+#include <stdio.h>
+
+#define WORKITEMS 1000000 /* Number of callbacks to dispatch */
+#define DELAYED 1000 /* Number of delayed callbacks */
+
+static volatile UA_UInt32 executed;
+static volatile UA_UInt32 delayedExecuted;
+
+static void
+countCallback(void *application, void *data) {
+    UA_atomic_addUInt32(&executed, 1);
+}
+
+static void
+delayedCallback(void *application, void *data) {
+    /* All work that was enqueued before is finished */
+    ck_assert_uint_ge(executed, (UA_UInt32)(uintptr_t)data);
+    UA_atomic_addUInt32(&delayedExecuted, 1);
+}
+
+START_TEST(workQueueSpeed) {
+    const size_t workers[] = {1, 2, 4, 8, 16, 32};
+    for(size_t w = 0; w < sizeof(workers) / sizeof(workers[0]); w++) {
+        UA_WorkQueue wq;
+        memset(&wq, 0, sizeof(UA_WorkQueue));
+        UA_WorkQueue_init(&wq);
+        UA_StatusCode retval = UA_WorkQueue_start(&wq, workers[w]);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+        executed = 0;
+        delayedExecuted = 0;
+        UA_DateTime begin = UA_DateTime_nowMonotonic();
+        for(size_t i = 0; i < WORKITEMS; i++) {
+            retval = UA_WorkQueue_enqueue(&wq, countCallback, NULL, NULL);
+            ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+            /* Interleave delayed callbacks. They remember how much work was
+             * enqueued before. */
+            if(i % (WORKITEMS / DELAYED) == 0) {
+                UA_DelayedCallback *dc = (UA_DelayedCallback*)
+                    UA_malloc(sizeof(UA_DelayedCallback));
+                ck_assert_ptr_ne(dc, NULL);
+                dc->callback = delayedCallback;
+                dc->application = NULL;
+                dc->data = (void*)(uintptr_t)(i + 1);
+                UA_WorkQueue_enqueueDelayed(&wq, dc);
+                UA_WorkQueue_processDelayed(&wq);
+            }
+        }
+
+        /* Wait until all work is done */
+        while(executed < WORKITEMS || delayedExecuted < DELAYED)
+            UA_WorkQueue_processDelayed(&wq);
+        UA_DateTime end = UA_DateTime_nowMonotonic();
+
+        UA_WorkQueue_cleanup(&wq);
+        ck_assert_uint_eq(executed, WORKITEMS);
+        ck_assert_uint_eq(delayedExecuted, DELAYED);
+
+        double seconds = (double)(end - begin) / UA_DATETIME_SEC;
+        printf("%2u worker(s): %f s, %.0f callbacks/s\n", (unsigned)workers[w],
+               seconds, (double)WORKITEMS / seconds);
+    }
+}
+END_TEST
+
+static volatile UA_Boolean blocked;
+
+static void
+blockingCallback(void *application, void *data) {
+    while(blocked) {}
+    UA_atomic_addUInt32(&executed, 1);
+}
+
+/* Work that does not fit into the rings is never executed in the enqueueing
+ * thread */
+START_TEST(workQueueOverflow) {
+    /* Without workers, the work is executed when the queue is cleaned up */
+    UA_WorkQueue wq;
+    memset(&wq, 0, sizeof(UA_WorkQueue));
+    UA_WorkQueue_init(&wq);
+    executed = 0;
+    for(size_t i = 0; i < 10; i++) {
+        UA_StatusCode retval = UA_WorkQueue_enqueue(&wq, countCallback, NULL, NULL);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    ck_assert_uint_eq(executed, 0);
+    UA_WorkQueue_cleanup(&wq);
+    ck_assert_uint_eq(executed, 10);
+
+    /* The only worker is blocked while its ring overflows */
+    memset(&wq, 0, sizeof(UA_WorkQueue));
+    UA_WorkQueue_init(&wq);
+    UA_StatusCode retval = UA_WorkQueue_start(&wq, 1);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    executed = 0;
+    blocked = true;
+    retval = UA_WorkQueue_enqueue(&wq, blockingCallback, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    const UA_UInt32 total = 3 * UA_WORKQUEUE_RINGSIZE;
+    for(size_t i = 1; i < total; i++) {
+        retval = UA_WorkQueue_enqueue(&wq, countCallback, NULL, NULL);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    ck_assert_uint_eq(executed, 0);
+
+    /* The delayed callback runs after all the overflowed work */
+    delayedExecuted = 0;
+    UA_DelayedCallback *dc = (UA_DelayedCallback*)UA_malloc(sizeof(UA_DelayedCallback));
+    ck_assert_ptr_ne(dc, NULL);
+    dc->callback = delayedCallback;
+    dc->application = NULL;
+    dc->data = (void*)(uintptr_t)total;
+    UA_WorkQueue_enqueueDelayed(&wq, dc);
+    UA_WorkQueue_processDelayed(&wq);
+    blocked = false;
+    while(delayedExecuted < 1)
+        UA_WorkQueue_processDelayed(&wq);
+    ck_assert_uint_eq(executed, total);
+    UA_WorkQueue_cleanup(&wq);
+}
+END_TEST
+
+static Suite * testSuite_workQueue(void) {
+    Suite *s = suite_create("WorkQueue Speed");
+    TCase *tc = tcase_create("Enqueue and Dispatch");
+    tcase_set_timeout(tc, 120);
+    tcase_add_test(tc, workQueueSpeed);
+    tcase_add_test(tc, workQueueOverflow);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_workQueue();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
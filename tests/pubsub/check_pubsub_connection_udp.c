@@ -188,6 +188,75 @@ START_TEST(GetMaximalConnectionConfigurationAndCompareValues){
     UA_PubSubConnectionConfig_clear(&connectionConfig);
     } END_TEST
 
+static void
+receiveMultipleMessages(const char *url) {
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(UA_PubSubConnectionConfig));
+    connectionConfig.name = UA_STRING("UADP Connection");
+    UA_NetworkAddressUrlDataType networkAddressUrl = {UA_STRING_NULL, UA_STRING((char*)(uintptr_t)url)};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.transportProfileUri = UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    UA_NodeId connectionIdent;
+    UA_StatusCode retVal = UA_Server_addPubSubConnection(server, &connectionConfig, &connectionIdent);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    UA_PubSubConnection *connection = UA_PubSubConnection_findConnectionbyId(server, connectionIdent);
+    ck_assert(connection != NULL);
+    UA_PubSubChannel *channel = connection->channel;
+    ck_assert(channel->receiveMultiple != NULL);
+    retVal = channel->regist(channel, NULL, NULL);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    /* Nothing pending */
+    UA_ByteString buffers[8];
+    for(size_t i = 0; i < 8; i++)
+        ck_assert_int_eq(UA_ByteString_allocBuffer(&buffers[i], 64), UA_STATUSCODE_GOOD);
+    size_t received = 0;
+    retVal = channel->receiveMultiple(channel, buffers, 8, &received, NULL, 1000);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOODNONCRITICALTIMEOUT);
+    ck_assert_uint_eq(received, 0);
+
+    /* Send more messages than buffers are available */
+    for(UA_Byte i = 0; i < 12; i++) {
+        UA_Byte data[4] = {i, i, i, i};
+        UA_ByteString msg = {(size_t)(i % 4) + 1, data};
+        ck_assert_int_eq(channel->send(channel, NULL, &msg), UA_STATUSCODE_GOOD);
+    }
+
+    /* The first call fills all buffers */
+    retVal = channel->receiveMultiple(channel, buffers, 8, &received, NULL, 1000000);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(received, 8);
+    for(size_t i = 0; i < 8; i++) {
+        ck_assert_uint_eq(buffers[i].length, (i % 4) + 1);
+        ck_assert_uint_eq(buffers[i].data[0], i);
+    }
+
+    /* The second call takes the remaining messages */
+    for(size_t i = 0; i < 8; i++)
+        buffers[i].length = 64;
+    retVal = channel->receiveMultiple(channel, buffers, 8, &received, NULL, 1000000);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(received, 4);
+    for(size_t i = 0; i < 4; i++)
+        ck_assert_uint_eq(buffers[i].data[0], i + 8);
+
+    for(size_t i = 0; i < 8; i++) {
+        buffers[i].length = 64;
+        UA_ByteString_deleteMembers(&buffers[i]);
+    }
+}
+
+START_TEST(ReceiveMultipleMessages){
+    receiveMultipleMessages("opc.udp://224.0.0.22:4840/");
+} END_TEST
+
+#if UA_IPV6
+START_TEST(ReceiveMultipleMessagesIPv6){
+    receiveMultipleMessages("opc.udp://[ff02::1]:4840/");
+} END_TEST
+#endif
+
 int main(void) {
     TCase *tc_add_pubsub_connections_minimal_config = tcase_create("Create PubSub UDP Connections with minimal valid config");
     tcase_add_checked_fixture(tc_add_pubsub_connections_minimal_config, setup, teardown);
@@ -205,10 +274,18 @@ int main(void) {
     tcase_add_test(tc_add_pubsub_connections_maximal_config, AddSingleConnectionWithMaximalConfiguration);
     tcase_add_test(tc_add_pubsub_connections_maximal_config, GetMaximalConnectionConfigurationAndCompareValues);
 
+    TCase *tc_receive = tcase_create("Receive messages on a PubSub UDP Connection");
+    tcase_add_checked_fixture(tc_receive, setup, teardown);
+    tcase_add_test(tc_receive, ReceiveMultipleMessages);
+#if UA_IPV6
+    tcase_add_test(tc_receive, ReceiveMultipleMessagesIPv6);
+#endif
+
     Suite *s = suite_create("PubSub UDP connection creation");
     suite_add_tcase(s, tc_add_pubsub_connections_minimal_config);
     suite_add_tcase(s, tc_add_pubsub_connections_invalid_config);
     suite_add_tcase(s, tc_add_pubsub_connections_maximal_config);
+    suite_add_tcase(s, tc_receive);
     //suite_add_tcase(s, tc_decode);
 
     SRunner *sr = srunner_create(s);
@@ -1340,6 +1340,282 @@ START_TEST(UA_PubSub_EnDecode_ShallWorkOn2DSVariant) {
 }
 END_TEST
 
+/* The fields of the messages used to test the copy programs. The enumeration
+ * is encoded as Int32. */
+typedef struct {
+    UA_UInt16 sequenceNumber;
+    UA_UInt16 dataSetMessageSequenceNr;
+    UA_UInt32 u32;
+    UA_MessageSecurityMode mode;
+    UA_Double d;
+    UA_DataValue fields[3];
+    UA_UInt16 dataSetWriterId;
+    UA_DataSetMessage dsm;
+} CopyProgramMessage;
+
+static void
+initCopyProgramMessage(UA_NetworkMessage *m, CopyProgramMessage *c,
+                       UA_Boolean dsmSequenceNr) {
+    memset(m, 0, sizeof(UA_NetworkMessage));
+    m->version = 1;
+    m->networkMessageType = UA_NETWORKMESSAGE_DATASET;
+    m->publisherIdEnabled = true;
+    m->publisherIdType = UA_PUBLISHERDATATYPE_UINT16;
+    m->publisherId.publisherIdUInt16 = 4711;
+    m->groupHeaderEnabled = true;
+    m->groupHeader.writerGroupIdEnabled = true;
+    m->groupHeader.writerGroupId = 100;
+    m->groupHeader.sequenceNumberEnabled = true;
+    m->groupHeader.sequenceNumber = c->sequenceNumber;
+    m->payloadHeaderEnabled = true;
+    m->payloadHeader.dataSetPayloadHeader.count = 1;
+    c->dataSetWriterId = 62541;
+    m->payloadHeader.dataSetPayloadHeader.dataSetWriterIds = &c->dataSetWriterId;
+
+    memset(&c->dsm, 0, sizeof(UA_DataSetMessage));
+    c->dsm.header.dataSetMessageValid = true;
+    c->dsm.header.fieldEncoding = UA_FIELDENCODING_VARIANT;
+    c->dsm.header.dataSetMessageType = UA_DATASETMESSAGE_DATAKEYFRAME;
+    c->dsm.header.dataSetMessageSequenceNrEnabled = dsmSequenceNr;
+    c->dsm.header.dataSetMessageSequenceNr = c->dataSetMessageSequenceNr;
+    c->dsm.data.keyFrameData.fieldCount = 3;
+    c->dsm.data.keyFrameData.dataSetFields = c->fields;
+    memset(c->fields, 0, sizeof(c->fields));
+    UA_Variant_setScalar(&c->fields[0].value, &c->u32, &UA_TYPES[UA_TYPES_UINT32]);
+    UA_Variant_setScalar(&c->fields[1].value, &c->mode,
+                         &UA_TYPES[UA_TYPES_MESSAGESECURITYMODE]);
+    UA_Variant_setScalar(&c->fields[2].value, &c->d, &UA_TYPES[UA_TYPES_DOUBLE]);
+    for(size_t i = 0; i < 3; i++) {
+        c->fields[i].hasValue = true;
+        c->fields[i].value.storageType = UA_VARIANT_DATA_NODELETE;
+    }
+    m->payload.dataSetPayload.dataSetMessages = &c->dsm;
+}
+
+static void
+encodeCopyProgramMessage(UA_NetworkMessage *m, UA_ByteString *buf) {
+    UA_StatusCode rv =
+        UA_ByteString_allocBuffer(buf, UA_NetworkMessage_calcSizeBinary(m, NULL));
+    ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+    UA_Byte *bufPos = buf->data;
+    rv = UA_NetworkMessage_encodeBinary(m, &bufPos, &buf->data[buf->length]);
+    ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+}
+
+/* The offsets only point to the values of the message */
+static void
+clearCopyProgramOffsets(UA_NetworkMessageOffsetBuffer *ob) {
+    UA_NetworkMessage_clearCopyProgram(ob);
+    for(size_t i = 0; i < ob->offsetsSize; i++) {
+        switch(ob->offsets[i].contentType) {
+        case UA_PUBSUB_OFFSETTYPE_NETWORKMESSAGE_SEQUENCENUMBER:
+        case UA_PUBSUB_OFFSETTYPE_DATASETMESSAGE_SEQUENCENUMBER:
+        case UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT:
+        case UA_PUBSUB_OFFSETTYPE_PAYLOAD_DATAVALUE:
+            UA_free(ob->offsets[i].offsetData.value.value);
+            break;
+        default:
+            break;
+        }
+    }
+    UA_free(ob->offsets);
+    UA_ByteString_clear(&ob->buffer);
+}
+
+START_TEST(UA_PubSub_CopyProgram_EncodeEqualsGenericEncoding) {
+    CopyProgramMessage c;
+    memset(&c, 0, sizeof(CopyProgramMessage));
+    c.sequenceNumber = 1;
+    c.dataSetMessageSequenceNr = 2;
+    c.u32 = 1000;
+    c.mode = UA_MESSAGESECURITYMODE_SIGN;
+    c.d = 1.5;
+    UA_NetworkMessage m;
+    initCopyProgramMessage(&m, &c, true);
+
+    /* Compute the offsets and compile them */
+    UA_NetworkMessageOffsetBuffer ob;
+    memset(&ob, 0, sizeof(UA_NetworkMessageOffsetBuffer));
+    UA_NetworkMessage_calcSizeBinary(&m, &ob);
+    encodeCopyProgramMessage(&m, &ob.buffer);
+    UA_StatusCode rv = UA_NetworkMessage_compileBufferedMessage(&ob);
+    ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+    ck_assert_ptr_ne(ob.copyOps, NULL);
+    ck_assert_uint_eq(ob.copyOpsSize, ob.offsetsSize);
+
+    /* Change the values. The offsets point to the same memory. */
+    m.groupHeader.sequenceNumber = 11;
+    c.dsm.header.dataSetMessageSequenceNr = 12;
+    c.u32 = 0xdeadbeef;
+    c.mode = UA_MESSAGESECURITYMODE_SIGNANDENCRYPT;
+    c.d = -2.25;
+    rv = UA_NetworkMessage_updateBufferedMessage(&ob);
+    ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+
+    /* The output of the copy program is identical to the generic encoding */
+    UA_ByteString generic;
+    encodeCopyProgramMessage(&m, &generic);
+    ck_assert(UA_ByteString_equal(&ob.buffer, &generic));
+
+    /* Decode the result */
+    UA_NetworkMessage m2;
+    memset(&m2, 0, sizeof(UA_NetworkMessage));
+    size_t offset = 0;
+    rv = UA_NetworkMessage_decodeBinary(&ob.buffer, &offset, &m2);
+    ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(m2.groupHeader.sequenceNumber, 11);
+    UA_DataSetMessage *dsm2 = m2.payload.dataSetPayload.dataSetMessages;
+    ck_assert_uint_eq(dsm2->header.dataSetMessageSequenceNr, 12);
+    ck_assert_uint_eq(dsm2->data.keyFrameData.fieldCount, 3);
+    UA_DataValue *f = dsm2->data.keyFrameData.dataSetFields;
+    ck_assert_ptr_eq(f[0].value.type, &UA_TYPES[UA_TYPES_UINT32]);
+    ck_assert_uint_eq(*(UA_UInt32*)f[0].value.data, 0xdeadbeef);
+    ck_assert_ptr_eq(f[1].value.type, &UA_TYPES[UA_TYPES_INT32]);
+    ck_assert_int_eq(*(UA_Int32*)f[1].value.data, UA_MESSAGESECURITYMODE_SIGNANDENCRYPT);
+    ck_assert_ptr_eq(f[2].value.type, &UA_TYPES[UA_TYPES_DOUBLE]);
+    ck_assert(*(UA_Double*)f[2].value.data == -2.25);
+
+    UA_NetworkMessage_deleteMembers(&m2);
+    UA_ByteString_clear(&generic);
+    clearCopyProgramOffsets(&ob);
+}
+END_TEST
+
+START_TEST(UA_PubSub_CopyProgram_EncodeDataValueFields) {
+    CopyProgramMessage c;
+    memset(&c, 0, sizeof(CopyProgramMessage));
+    c.u32 = 1000;
+    c.mode = UA_MESSAGESECURITYMODE_SIGN;
+    c.d = 1.5;
+    UA_NetworkMessage m;
+    initCopyProgramMessage(&m, &c, false);
+    c.dsm.header.fieldEncoding = UA_FIELDENCODING_DATAVALUE;
+
+    UA_NetworkMessageOffsetBuffer ob;
+    memset(&ob, 0, sizeof(UA_NetworkMessageOffsetBuffer));
+    UA_NetworkMessage_calcSizeBinary(&m, &ob);
+    encodeCopyProgramMessage(&m, &ob.buffer);
+    UA_StatusCode rv = UA_NetworkMessage_compileBufferedMessage(&ob);
+    ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(ob.copyOpsSize, ob.offsetsSize);
+
+    /* Every field is copied from its own value */
+    c.u32 = 0xdeadbeef;
+    c.mode = UA_MESSAGESECURITYMODE_SIGNANDENCRYPT;
+    c.d = -2.25;
+    rv = UA_NetworkMessage_updateBufferedMessage(&ob);
+    ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+    UA_ByteString generic;
+    encodeCopyProgramMessage(&m, &generic);
+    ck_assert(UA_ByteString_equal(&ob.buffer, &generic));
+
+    UA_NetworkMessage m2;
+    memset(&m2, 0, sizeof(UA_NetworkMessage));
+    size_t offset = 0;
+    rv = UA_NetworkMessage_decodeBinary(&ob.buffer, &offset, &m2);
+    ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+    UA_DataValue *f = m2.payload.dataSetPayload.dataSetMessages->data.keyFrameData.dataSetFields;
+    ck_assert_uint_eq(*(UA_UInt32*)f[0].value.data, 0xdeadbeef);
+    ck_assert_int_eq(*(UA_Int32*)f[1].value.data, UA_MESSAGESECURITYMODE_SIGNANDENCRYPT);
+    ck_assert(*(UA_Double*)f[2].value.data == -2.25);
+
+    UA_NetworkMessage_deleteMembers(&m2);
+    UA_ByteString_clear(&generic);
+    clearCopyProgramOffsets(&ob);
+}
+END_TEST
+
+START_TEST(UA_PubSub_CopyProgram_DecodeEqualsGenericDecoding) {
+    /* The expected layout of the received messages */
+    CopyProgramMessage t;
+    memset(&t, 0, sizeof(CopyProgramMessage));
+    UA_NetworkMessage tmpl;
+    initCopyProgramMessage(&tmpl, &t, false);
+    UA_NetworkMessageOffsetBuffer ob;
+    memset(&ob, 0, sizeof(UA_NetworkMessageOffsetBuffer));
+    ob.RTsubscriberEnabled = true;
+    UA_NetworkMessage_calcSizeBinary(&tmpl, &ob);
+    ob.nm = &tmpl;
+    UA_StatusCode rv = UA_NetworkMessage_compileBufferedNwMessage(&ob);
+    ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+    ck_assert_ptr_ne(ob.copyOps, NULL);
+
+    /* Encode a message with the same layout and decode with the program */
+    CopyProgramMessage c;
+    memset(&c, 0, sizeof(CopyProgramMessage));
+    c.sequenceNumber = 7;
+    c.u32 = 123456;
+    c.mode = UA_MESSAGESECURITYMODE_SIGNANDENCRYPT;
+    c.d = 3.75;
+    UA_NetworkMessage m;
+    initCopyProgramMessage(&m, &c, false);
+    UA_ByteString msg;
+    encodeCopyProgramMessage(&m, &msg);
+    rv = UA_NetworkMessage_updateBufferedNwMessage(&ob, &msg);
+    ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(tmpl.groupHeader.sequenceNumber, 7);
+    ck_assert_uint_eq(tmpl.publisherId.publisherIdUInt16, 4711);
+
+    /* The decoded fields are identical to the generic decoding */
+    UA_NetworkMessage m2;
+    memset(&m2, 0, sizeof(UA_NetworkMessage));
+    size_t offset = 0;
+    rv = UA_NetworkMessage_decodeBinary(&msg, &offset, &m2);
+    ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+    UA_DataValue *f = m2.payload.dataSetPayload.dataSetMessages->data.keyFrameData.dataSetFields;
+    for(size_t i = 0; i < 3; i++) {
+        ck_assert(t.fields[i].hasValue);
+        ck_assert_ptr_eq(t.fields[i].value.type, f[i].value.type);
+        ck_assert(memcmp(t.fields[i].value.data, f[i].value.data,
+                         f[i].value.type->memSize) == 0);
+    }
+    ck_assert_int_eq(*(UA_Int32*)t.fields[1].value.data,
+                     UA_MESSAGESECURITYMODE_SIGNANDENCRYPT);
+    ck_assert(*(UA_Double*)t.fields[2].value.data == 3.75);
+
+    /* A field with a different type is rejected */
+    for(size_t i = 0; i < ob.copyOpsSize; i++) {
+        if(ob.copyOps[i].target == &t.fields[1])
+            msg.data[ob.copyOps[i].offset - 1] = UA_TYPES_UINT32 + 1;
+    }
+    rv = UA_NetworkMessage_updateBufferedNwMessage(&ob, &msg);
+    ck_assert_int_eq(rv, UA_STATUSCODE_BADDECODINGERROR);
+
+    UA_NetworkMessage_deleteMembers(&m2);
+    UA_ByteString_clear(&msg);
+    clearCopyProgramOffsets(&ob);
+}
+END_TEST
+
+START_TEST(UA_PubSub_CopyProgram_FailedCompileKeepsFields) {
+    /* The last field cannot be compiled */
+    CopyProgramMessage t;
+    memset(&t, 0, sizeof(CopyProgramMessage));
+    UA_NetworkMessage tmpl;
+    initCopyProgramMessage(&tmpl, &t, false);
+    UA_String str = UA_STRING("not overlayable");
+    UA_Variant_setScalar(&t.fields[2].value, &str, &UA_TYPES[UA_TYPES_STRING]);
+    t.fields[2].value.storageType = UA_VARIANT_DATA_NODELETE;
+    UA_NetworkMessageOffsetBuffer ob;
+    memset(&ob, 0, sizeof(UA_NetworkMessageOffsetBuffer));
+    ob.RTsubscriberEnabled = true;
+    UA_NetworkMessage_calcSizeBinary(&tmpl, &ob);
+    ob.nm = &tmpl;
+    UA_StatusCode rv = UA_NetworkMessage_compileBufferedNwMessage(&ob);
+    ck_assert_int_eq(rv, UA_STATUSCODE_BADNOTSUPPORTED);
+    ck_assert_ptr_eq(ob.copyOps, NULL);
+
+    /* The fields before still point to their original values */
+    ck_assert_ptr_eq(t.fields[0].value.data, &t.u32);
+    ck_assert_ptr_eq(t.fields[0].value.type, &UA_TYPES[UA_TYPES_UINT32]);
+    ck_assert_ptr_eq(t.fields[1].value.data, &t.mode);
+    ck_assert_ptr_eq(t.fields[1].value.type, &UA_TYPES[UA_TYPES_MESSAGESECURITYMODE]);
+    ck_assert_ptr_eq(t.fields[2].value.data, &str);
+
+    clearCopyProgramOffsets(&ob);
+}
+END_TEST
+
 int main(void) {
     TCase *tc_encode = tcase_create("encode");
     tcase_add_test(tc_encode, UA_PubSub_Encode_WithBufferTooSmallShallReturnError);
@@ -1364,12 +1640,19 @@ int main(void) {
 
     TCase *tc_ende2 = tcase_create("encode_decode2DS");
     tcase_add_test(tc_ende2, UA_PubSub_EnDecode_ShallWorkOn2DSVariant);
+
+    TCase *tc_copy = tcase_create("copy_program");
+    tcase_add_test(tc_copy, UA_PubSub_CopyProgram_EncodeEqualsGenericEncoding);
+    tcase_add_test(tc_copy, UA_PubSub_CopyProgram_EncodeDataValueFields);
+    tcase_add_test(tc_copy, UA_PubSub_CopyProgram_DecodeEqualsGenericDecoding);
+    tcase_add_test(tc_copy, UA_PubSub_CopyProgram_FailedCompileKeepsFields);
     
     Suite *s = suite_create("PubSub NetworkMessage");   
     suite_add_tcase(s, tc_encode);
     suite_add_tcase(s, tc_decode);
     suite_add_tcase(s, tc_ende1);
     suite_add_tcase(s, tc_ende2);
+    suite_add_tcase(s, tc_copy);
     
     SRunner *sr = srunner_create(s);
     srunner_set_fork_status(sr, CK_NOFORK);
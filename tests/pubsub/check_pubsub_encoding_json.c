@@ -12,6 +12,7 @@
 #include "ua_pubsub_networkmessage.h"
 
 #include <check.h>
+#include <stdio.h>
 
 START_TEST(UA_PubSub_EncodeAllOptionalFields) {
     UA_NetworkMessage m;
@@ -375,6 +376,41 @@ START_TEST(UA_NetworkMessage_fieldNames_json_decode) {
 }
 END_TEST
 
+START_TEST(UA_NetworkMessage_manyMessages_json_decode) {
+    /* Far more tokens than the former fixed-size token array */
+    const size_t messages = 200;
+    const size_t fields = 10;
+    UA_ByteString buf;
+    ck_assert_int_eq(UA_ByteString_allocBuffer(&buf, 128 + messages * (64 + fields * 40)),
+                     UA_STATUSCODE_GOOD);
+    size_t pos = (size_t)sprintf((char*)buf.data, "{\"MessageId\":\"5ED82C10-50BB-CD07-0120-22521081E8EE\","
+                                 "\"MessageType\":\"ua-data\",\"Messages\":[");
+    for(size_t i = 0; i < messages; i++) {
+        pos += (size_t)sprintf((char*)&buf.data[pos], "%s{\"DataSetWriterId\":%u,\"Payload\":{",
+                               (i == 0) ? "" : ",", (unsigned)i);
+        for(size_t j = 0; j < fields; j++)
+            pos += (size_t)sprintf((char*)&buf.data[pos], "%s\"f%u\":{\"Type\":7,\"Body\":%u}",
+                                   (j == 0) ? "" : ",", (unsigned)j, (unsigned)(i * fields + j));
+        pos += (size_t)sprintf((char*)&buf.data[pos], "}}");
+    }
+    pos += (size_t)sprintf((char*)&buf.data[pos], "]}");
+    buf.length = pos;
+
+    UA_NetworkMessage out;
+    UA_StatusCode retval = UA_NetworkMessage_decodeJson(&out, &buf);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(out.payloadHeader.dataSetPayloadHeader.count, messages);
+    ck_assert_int_eq(out.payloadHeader.dataSetPayloadHeader.dataSetWriterIds[messages - 1],
+                     messages - 1);
+    UA_DataSetMessage *last = &out.payload.dataSetPayload.dataSetMessages[messages - 1];
+    ck_assert_int_eq(last->data.keyFrameData.fieldCount, fields);
+    ck_assert_int_eq(*(UA_UInt32*)last->data.keyFrameData.dataSetFields[fields - 1].value.data,
+                     messages * fields - 1);
+    UA_NetworkMessage_deleteMembers(&out);
+    UA_ByteString_deleteMembers(&buf);
+}
+END_TEST
+
 static Suite *testSuite_networkmessage(void) {
     Suite *s = suite_create("Built-in Data Types 62541-6 Json");
     TCase *tc_json_networkmessage = tcase_create("networkmessage_json");
@@ -386,6 +422,7 @@ static Suite *testSuite_networkmessage(void) {
     tcase_add_test(tc_json_networkmessage, UA_NetworkMessage_json_decode);
     tcase_add_test(tc_json_networkmessage, UA_Networkmessage_DataSetFieldsNull_json_decode);
     tcase_add_test(tc_json_networkmessage, UA_NetworkMessage_fieldNames_json_decode);
+    tcase_add_test(tc_json_networkmessage, UA_NetworkMessage_manyMessages_json_decode);
 
     suite_add_tcase(s, tc_json_networkmessage);
     return s;
@@ -0,0 +1,252 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Checks that the publish cycle of a non-RT WriterGroup runs without heap
+ * allocations once the arena and the send buffer have grown to size. The
+ * allocations are counted by exchanging the malloc singleton. */
+
+#include <open62541/plugin/pubsub_udp.h>
+#include <open62541/server_config_default.h>
+#include <open62541/server_pubsub.h>
+
+#include "ua_pubsub.h"
+
+#include <check.h>
+#include <stdlib.h>
+
+#define WARMUP_CYCLES 3
+#define COUNTED_CYCLES 100
+
+UA_Server *server = NULL;
+UA_NodeId connectionId, publishedDataSetId, writerGroupId, int32NodeId, doubleNodeId;
+UA_PubSubConnection *connection;
+
+static size_t allocations;
+
+static void * countingMalloc(size_t size) {
+    allocations++;
+    return malloc(size);
+}
+
+static void * countingCalloc(size_t nelem, size_t elsize) {
+    allocations++;
+    return calloc(nelem, elsize);
+}
+
+static void * countingRealloc(void *ptr, size_t size) {
+    allocations++;
+    return realloc(ptr, size);
+}
+
+static void countAllocations(void) {
+    UA_globalMalloc = countingMalloc;
+    UA_globalCalloc = countingCalloc;
+    UA_globalRealloc = countingRealloc;
+}
+
+static void useNormalAlloc(void) {
+    UA_globalMalloc = malloc;
+    UA_globalCalloc = calloc;
+    UA_globalRealloc = realloc;
+}
+
+static void
+addVariable(UA_UInt32 id, const char *name, void *value, const UA_DataType *type,
+            UA_NodeId *outId) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    attr.displayName = UA_LOCALIZEDTEXT("en-US", (char*)(uintptr_t)name);
+    attr.dataType = type->typeId;
+    UA_Variant_setScalar(&attr.value, value, type);
+    UA_StatusCode retval =
+        UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, id),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, (char*)(uintptr_t)name),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                  attr, NULL, outId);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+}
+
+static void
+addField(const UA_NodeId *variable) {
+    UA_DataSetFieldConfig dsfConfig;
+    memset(&dsfConfig, 0, sizeof(UA_DataSetFieldConfig));
+    dsfConfig.dataSetFieldType = UA_PUBSUB_DATASETFIELD_VARIABLE;
+    dsfConfig.field.variable.fieldNameAlias = UA_STRING("Field");
+    dsfConfig.field.variable.publishParameters.publishedVariable = *variable;
+    dsfConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_NodeId fieldId;
+    ck_assert_uint_eq(UA_Server_addDataSetField(server, publishedDataSetId,
+                                                &dsfConfig, &fieldId).result,
+                      UA_STATUSCODE_GOOD);
+}
+
+static void setup(void) {
+    server = UA_Server_new();
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_ServerConfig_setDefault(config);
+
+    config->pubsubTransportLayers = (UA_PubSubTransportLayer*)
+        UA_malloc(sizeof(UA_PubSubTransportLayer));
+    config->pubsubTransportLayers[0] = UA_PubSubTransportLayerUDPMP();
+    config->pubsubTransportLayersSize++;
+    UA_Server_run_startup(server);
+
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(UA_PubSubConnectionConfig));
+    connectionConfig.name = UA_STRING("UADP Connection");
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    connectionConfig.enabled = UA_TRUE;
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL, UA_STRING("opc.udp://224.0.0.22:4840/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.publisherId.numeric = 2234;
+    ck_assert_uint_eq(UA_Server_addPubSubConnection(server, &connectionConfig, &connectionId),
+                      UA_STATUSCODE_GOOD);
+    connection = UA_PubSubConnection_findConnectionbyId(server, connectionId);
+    ck_assert_ptr_ne(connection, NULL);
+    ck_assert_uint_eq(connection->channel->regist(connection->channel, NULL, NULL),
+                      UA_STATUSCODE_GOOD);
+
+    UA_PublishedDataSetConfig pdsConfig;
+    memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    pdsConfig.name = UA_STRING("PublishedDataSet");
+    ck_assert_uint_eq(UA_Server_addPublishedDataSet(server, &pdsConfig,
+                                                    &publishedDataSetId).addResult,
+                      UA_STATUSCODE_GOOD);
+
+    UA_Int32 int32Value = 0;
+    UA_Double doubleValue = 0.0;
+    addVariable(50001, "Int32", &int32Value, &UA_TYPES[UA_TYPES_INT32], &int32NodeId);
+    addVariable(50002, "Double", &doubleValue, &UA_TYPES[UA_TYPES_DOUBLE], &doubleNodeId);
+    addField(&int32NodeId);
+    addField(&doubleNodeId);
+}
+
+static void teardown(void) {
+    useNormalAlloc();
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+}
+
+static UA_WriterGroup *
+addWriterGroup(UA_UInt16 maxDSM, size_t writers) {
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(UA_WriterGroupConfig));
+    writerGroupConfig.name = UA_STRING("WriterGroup");
+    writerGroupConfig.publishingInterval = 100000; /* Triggered manually */
+    writerGroupConfig.writerGroupId = 100;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    writerGroupConfig.maxEncapsulatedDataSetMessageCount = maxDSM;
+    UA_UadpWriterGroupMessageDataType *wgm = UA_UadpWriterGroupMessageDataType_new();
+    wgm->networkMessageContentMask = (UA_UadpNetworkMessageContentMask)
+        ((UA_UInt32)UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+         (UA_UInt32)UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+         (UA_UInt32)UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+         (UA_UInt32)UA_UADPNETWORKMESSAGECONTENTMASK_SEQUENCENUMBER |
+         (UA_UInt32)UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER);
+    writerGroupConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+    writerGroupConfig.messageSettings.content.decoded.type =
+        &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE];
+    writerGroupConfig.messageSettings.content.decoded.data = wgm;
+    UA_StatusCode retval =
+        UA_Server_addWriterGroup(server, connectionId, &writerGroupConfig, &writerGroupId);
+    UA_UadpWriterGroupMessageDataType_delete(wgm);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    for(size_t i = 0; i < writers; i++) {
+        UA_DataSetWriterConfig dswConfig;
+        memset(&dswConfig, 0, sizeof(UA_DataSetWriterConfig));
+        dswConfig.name = UA_STRING("DataSetWriter");
+        dswConfig.dataSetWriterId = (UA_UInt16)(62541 + i);
+        UA_NodeId dswId;
+        ck_assert_uint_eq(UA_Server_addDataSetWriter(server, writerGroupId, publishedDataSetId,
+                                                     &dswConfig, &dswId),
+                          UA_STATUSCODE_GOOD);
+    }
+
+    UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, writerGroupId);
+    ck_assert_ptr_ne(wg, NULL);
+    return wg;
+}
+
+/* Receive the next NetworkMessage and check the value of the first field */
+static void
+receiveAndCheck(UA_Int32 expected) {
+    UA_ByteString buffer;
+    ck_assert_uint_eq(UA_ByteString_allocBuffer(&buffer, 512), UA_STATUSCODE_GOOD);
+    UA_StatusCode retval =
+        connection->channel->receive(connection->channel, &buffer, NULL, 1000000);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_gt(buffer.length, 0);
+
+    UA_NetworkMessage nm;
+    memset(&nm, 0, sizeof(UA_NetworkMessage));
+    size_t offset = 0;
+    retval = UA_NetworkMessage_decodeBinary(&buffer, &offset, &nm);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_DataSetMessage *dsm = &nm.payload.dataSetPayload.dataSetMessages[0];
+    ck_assert_uint_eq(dsm->data.keyFrameData.fieldCount, 2);
+    ck_assert_int_eq(*(UA_Int32*)dsm->data.keyFrameData.dataSetFields[0].value.data,
+                     expected);
+    UA_NetworkMessage_deleteMembers(&nm);
+    buffer.length = 512;
+    UA_ByteString_clear(&buffer);
+}
+
+static void
+publishCycles(UA_WriterGroup *wg, size_t messagesPerCycle) {
+    /* The arena and the send buffer grow during the first cycles */
+    for(size_t i = 0; i < WARMUP_CYCLES; i++) {
+        UA_WriterGroup_publishCallback(server, wg);
+        for(size_t j = 0; j < messagesPerCycle; j++)
+            receiveAndCheck(0);
+    }
+
+    for(UA_Int32 i = 1; i <= COUNTED_CYCLES; i++) {
+        UA_Variant value;
+        UA_Variant_setScalar(&value, &i, &UA_TYPES[UA_TYPES_INT32]);
+        ck_assert_uint_eq(UA_Server_writeValue(server, int32NodeId, value),
+                          UA_STATUSCODE_GOOD);
+
+        allocations = 0;
+        countAllocations();
+        UA_WriterGroup_publishCallback(server, wg);
+        useNormalAlloc();
+        ck_assert_uint_eq(allocations, 0);
+
+        for(size_t j = 0; j < messagesPerCycle; j++)
+            receiveAndCheck(i);
+    }
+}
+
+START_TEST(PublishWithoutAllocations) {
+    UA_WriterGroup *wg = addWriterGroup(1, 2);
+    publishCycles(wg, 2);
+} END_TEST
+
+START_TEST(PublishBatchedWithoutAllocations) {
+    UA_WriterGroup *wg = addWriterGroup(10, 4);
+    publishCycles(wg, 1);
+} END_TEST
+
+int main(void) {
+    TCase *tc_allocations = tcase_create("Publish without allocations");
+    tcase_add_checked_fixture(tc_allocations, setup, teardown);
+    tcase_add_test(tc_allocations, PublishWithoutAllocations);
+    tcase_add_test(tc_allocations, PublishBatchedWithoutAllocations);
+
+    Suite *s = suite_create("PubSub publish allocations");
+    suite_add_tcase(s, tc_allocations);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
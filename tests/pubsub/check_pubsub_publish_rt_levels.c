@@ -343,6 +343,11 @@ START_TEST(PublishPDSWithMultipleFieldsAndFixedOffset) {
         dsfConfig.field.variable.staticValueSource.value = variant2;
         ck_assert(UA_Server_addDataSetField(server, publishedDataSetIdent, &dsfConfig, &dataSetFieldIdent).result == UA_STATUSCODE_GOOD);
         ck_assert(UA_Server_freezeWriterGroupConfiguration(server, writerGroupIdent) == UA_STATUSCODE_GOOD);
+        /* Both fields are fixed-size scalars and are compiled into the copy program */
+        UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, writerGroupIdent);
+        ck_assert_ptr_ne(wg, NULL);
+        ck_assert_ptr_ne(wg->bufferedMessage.copyOps, NULL);
+        ck_assert_uint_ge(wg->bufferedMessage.copyOpsSize, 2);
         ck_assert(UA_Server_setWriterGroupOperational(server, writerGroupIdent) == UA_STATUSCODE_GOOD);
         UA_ByteString buffer;
         UA_ByteString_init(&buffer);
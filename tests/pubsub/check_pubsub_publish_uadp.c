@@ -221,11 +221,100 @@ START_TEST(CheckNMandDSMBufferCalculation){
 
     } END_TEST
 
+START_TEST(PublishNotReadableVariable){
+    /* The value of a variable without read access is sampled as by the Read
+     * service */
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Int32 value = 42;
+    UA_Variant_setScalar(&attr.value, &value, &UA_TYPES[UA_TYPES_INT32]);
+    attr.dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+    attr.accessLevel = UA_ACCESSLEVELMASK_WRITE;
+    UA_NodeId variableId;
+    UA_StatusCode retval =
+        UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, 50001),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "Not readable"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                  attr, NULL, &variableId);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_PublishedDataSetConfig publishedDataSetConfig;
+    memset(&publishedDataSetConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    publishedDataSetConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    publishedDataSetConfig.name = UA_STRING("Not readable PDS");
+    UA_NodeId publishedDataSetId;
+    UA_Server_addPublishedDataSet(server, &publishedDataSetConfig, &publishedDataSetId);
+
+    UA_DataSetFieldConfig dataSetFieldConfig;
+    memset(&dataSetFieldConfig, 0, sizeof(UA_DataSetFieldConfig));
+    dataSetFieldConfig.dataSetFieldType = UA_PUBSUB_DATASETFIELD_VARIABLE;
+    dataSetFieldConfig.field.variable.fieldNameAlias = UA_STRING("Not readable");
+    dataSetFieldConfig.field.variable.publishParameters.publishedVariable = variableId;
+    dataSetFieldConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_Server_addDataSetField(server, publishedDataSetId,
+                              &dataSetFieldConfig, &dataSetFieldIdent);
+
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(UA_WriterGroupConfig));
+    writerGroupConfig.name = UA_STRING("Demo WriterGroup");
+    writerGroupConfig.publishingInterval = 10;
+    writerGroupConfig.enabled = UA_FALSE;
+    writerGroupConfig.writerGroupId = 100;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    UA_UadpWriterGroupMessageDataType *wgm = UA_UadpWriterGroupMessageDataType_new();
+    wgm->networkMessageContentMask = UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER;
+    writerGroupConfig.messageSettings.content.decoded.data = wgm;
+    writerGroupConfig.messageSettings.content.decoded.type =
+            &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE];
+    writerGroupConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+    UA_Server_addWriterGroup(server, connection1, &writerGroupConfig, &writerGroupIdent);
+    UA_Server_setWriterGroupOperational(server, writerGroupIdent);
+    UA_UadpWriterGroupMessageDataType_delete(wgm);
+
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(UA_DataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("Test DataSetWriter");
+    dataSetWriterConfig.dataSetWriterId = 10;
+    dataSetWriterConfig.keyFrameCount = 1;
+    UA_Server_addDataSetWriter(server, writerGroupIdent, publishedDataSetId,
+                               &dataSetWriterConfig, &dataSetWriterIdent);
+
+    UA_PubSubConnection *connection = UA_PubSubConnection_findConnectionbyId(server, connection1);
+    ck_assert_ptr_ne(connection, NULL);
+    retval = connection->channel->regist(connection->channel, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    //change publish interval triggers implicit one publish callback run
+    writerGroupConfig.publishingInterval = 100000;
+    UA_Server_updateWriterGroupConfig(server, writerGroupIdent, &writerGroupConfig);
+
+    UA_ByteString buffer = UA_BYTESTRING_ALLOC("");
+    UA_NetworkMessage networkMessage;
+    receiveSingleMessage(buffer, connection, &networkMessage);
+    UA_DataSetMessage *dsm = &networkMessage.payload.dataSetPayload.dataSetMessages[0];
+    ck_assert_uint_eq(dsm->data.keyFrameData.fieldCount, 1);
+    UA_Variant *published = &dsm->data.keyFrameData.dataSetFields[0].value;
+
+    UA_ReadValueId rvid;
+    UA_ReadValueId_init(&rvid);
+    rvid.nodeId = variableId;
+    rvid.attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_DataValue expected = UA_Server_read(server, &rvid, UA_TIMESTAMPSTORETURN_BOTH);
+    ck_assert_ptr_eq(published->type, expected.value.type);
+    if(expected.hasValue)
+        ck_assert_int_eq(*(UA_Int32*)published->data, *(UA_Int32*)expected.value.data);
+    UA_DataValue_clear(&expected);
+    UA_NetworkMessage_clear(&networkMessage);
+    UA_ByteString_clear(&buffer);
+} END_TEST
+
 int main(void) {
     TCase *tc_add_pubsub_DSMandNMcalculation = tcase_create("PubSub NM and DSM");
     tcase_add_checked_fixture(tc_add_pubsub_DSMandNMcalculation, setup, teardown);
     tcase_add_test(tc_add_pubsub_DSMandNMcalculation, CheckNMandDSMcalculation);
     tcase_add_test(tc_add_pubsub_DSMandNMcalculation, CheckNMandDSMBufferCalculation);
+    tcase_add_test(tc_add_pubsub_DSMandNMcalculation, PublishNotReadableVariable);
 
     Suite *s = suite_create("PubSub NM and DSM calculation");
     suite_add_tcase(s, tc_add_pubsub_DSMandNMcalculation);
@@ -1310,6 +1310,163 @@ START_TEST(SinglePublishSubscribewithValidIdentifiers) {
         UA_Variant_delete(publishedNodeData);
     } END_TEST
 
+/* Add a DataSetReader with a single Int32 target variable */
+static void
+addInt32Reader(UA_UInt16 dataSetWriterId, UA_NodeId *readerIdentifier) {
+    UA_DataSetReaderConfig readerConfig;
+    memset(&readerConfig, 0, sizeof(UA_DataSetReaderConfig));
+    readerConfig.name = UA_STRING("DataSetReader Test");
+    UA_UInt16 publisherIdentifier = PUBLISHER_ID;
+    readerConfig.publisherId.type = &UA_TYPES[UA_TYPES_UINT16];
+    readerConfig.publisherId.data = &publisherIdentifier;
+    readerConfig.writerGroupId = WRITER_GROUP_ID;
+    readerConfig.dataSetWriterId = dataSetWriterId;
+    UA_FieldMetaData field;
+    UA_FieldMetaData_init(&field);
+    field.dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+    field.builtInType = UA_NS0ID_INT32;
+    field.valueRank = -1; /* scalar */
+    readerConfig.dataSetMetaData.fieldsSize = 1;
+    readerConfig.dataSetMetaData.fields = &field;
+    UA_StatusCode retVal =
+        UA_Server_addDataSetReader(server, readerGroupTest, &readerConfig, readerIdentifier);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    UA_VariableAttributes vAttr = UA_VariableAttributes_default;
+    vAttr.displayName = UA_LOCALIZEDTEXT("en-US", "Subscribed Int32");
+    vAttr.dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+    UA_Int32 initial = 0;
+    UA_Variant_setScalar(&vAttr.value, &initial, &UA_TYPES[UA_TYPES_INT32]);
+    retVal = UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, SUBSCRIBEVARIABLE_NODEID + dataSetWriterId),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                       UA_QUALIFIEDNAME(1, "Subscribed Int32"),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                       vAttr, NULL, NULL);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    UA_FieldTargetDataType target;
+    UA_FieldTargetDataType_init(&target);
+    target.attributeId = UA_ATTRIBUTEID_VALUE;
+    target.targetNodeId = UA_NODEID_NUMERIC(1, SUBSCRIBEVARIABLE_NODEID + dataSetWriterId);
+    UA_TargetVariablesDataType targetVars = {1, &target};
+    retVal = UA_Server_DataSetReader_createTargetVariables(server, *readerIdentifier, &targetVars);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+}
+
+static UA_Int32
+readInt32Target(UA_UInt16 dataSetWriterId) {
+    UA_Variant value;
+    UA_StatusCode retVal =
+        UA_Server_readValue(server, UA_NODEID_NUMERIC(1, SUBSCRIBEVARIABLE_NODEID + dataSetWriterId), &value);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    ck_assert(UA_Variant_hasScalarType(&value, &UA_TYPES[UA_TYPES_INT32]));
+    UA_Int32 result = *(UA_Int32*)value.data;
+    UA_Variant_clear(&value);
+    return result;
+}
+
+/* Process a NetworkMessage with one DataSetMessage per given DataSetWriterId.
+ * The DataSetMessage for a DataSetWriterId carries the id as the value. The
+ * WriterGroupId is only marked as present with writerGroupIdEnabled. */
+static UA_StatusCode
+processInt32NetworkMessageEx(UA_UInt16 *dataSetWriterIds, UA_Byte count,
+                             UA_Boolean writerGroupIdEnabled) {
+    UA_DataValue values[8];
+    UA_Int32 data[8];
+    UA_DataSetMessage dsms[8];
+    ck_assert_uint_le(count, 8);
+    memset(dsms, 0, sizeof(dsms));
+    for(UA_Byte i = 0; i < count; i++) {
+        data[i] = dataSetWriterIds[i];
+        UA_DataValue_init(&values[i]);
+        UA_Variant_setScalar(&values[i].value, &data[i], &UA_TYPES[UA_TYPES_INT32]);
+        values[i].hasValue = true;
+        dsms[i].header.dataSetMessageValid = true;
+        dsms[i].header.dataSetMessageType = UA_DATASETMESSAGE_DATAKEYFRAME;
+        dsms[i].header.fieldEncoding = UA_FIELDENCODING_VARIANT;
+        dsms[i].data.keyFrameData.fieldCount = 1;
+        dsms[i].data.keyFrameData.dataSetFields = &values[i];
+    }
+
+    UA_NetworkMessage nm;
+    memset(&nm, 0, sizeof(UA_NetworkMessage));
+    nm.publisherIdEnabled = true;
+    nm.publisherIdType = UA_PUBLISHERDATATYPE_UINT16;
+    nm.publisherId.publisherIdUInt16 = PUBLISHER_ID;
+    nm.groupHeaderEnabled = true;
+    nm.groupHeader.writerGroupIdEnabled = writerGroupIdEnabled;
+    /* A stale value must be ignored if it is not marked as present */
+    nm.groupHeader.writerGroupId = writerGroupIdEnabled ? WRITER_GROUP_ID : 0xFFFF;
+    nm.payloadHeaderEnabled = true;
+    nm.payloadHeader.dataSetPayloadHeader.count = count;
+    nm.payloadHeader.dataSetPayloadHeader.dataSetWriterIds = dataSetWriterIds;
+    nm.payload.dataSetPayload.dataSetMessages = dsms;
+
+    UA_PubSubConnection *connection =
+        UA_PubSubConnection_findConnectionbyId(server, connection_test);
+    ck_assert(connection != NULL);
+    return UA_Server_processNetworkMessage(server, &nm, connection);
+}
+
+static UA_StatusCode
+processInt32NetworkMessage(UA_UInt16 *dataSetWriterIds, UA_Byte count) {
+    return processInt32NetworkMessageEx(dataSetWriterIds, count, true);
+}
+
+START_TEST(DispatchMultipleDataSetMessages) {
+    UA_ReaderGroupConfig readerGroupConfig;
+    memset(&readerGroupConfig, 0, sizeof(UA_ReaderGroupConfig));
+    readerGroupConfig.name = UA_STRING("ReaderGroup Test");
+    UA_StatusCode retVal =
+        UA_Server_addReaderGroup(server, connection_test, &readerGroupConfig, &readerGroupTest);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    UA_NodeId readers[3];
+    for(UA_UInt16 i = 0; i < 3; i++)
+        addInt32Reader((UA_UInt16)(i + 1), &readers[i]);
+
+    /* Every DataSetMessage goes to the reader of its DataSetWriter */
+    UA_UInt16 ids[2] = {3, 1};
+    ck_assert_int_eq(processInt32NetworkMessage(ids, 2), UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(readInt32Target(1), 1);
+    ck_assert_int_eq(readInt32Target(2), 0);
+    ck_assert_int_eq(readInt32Target(3), 3);
+
+    /* Unknown DataSetWriters are skipped */
+    UA_UInt16 unknownIds[2] = {7, 2};
+    ck_assert_int_eq(processInt32NetworkMessage(unknownIds, 2), UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(readInt32Target(2), 2);
+    ck_assert_int_eq(processInt32NetworkMessage(unknownIds, 1), UA_STATUSCODE_BADNOTFOUND);
+
+    /* Without a WriterGroupId, the readers are matched by the PublisherId and
+     * the DataSetWriterId */
+    UA_UInt16 noGroupIds[2] = {2, 3};
+    UA_Variant zero;
+    UA_Int32 zeroValue = 0;
+    UA_Variant_setScalar(&zero, &zeroValue, &UA_TYPES[UA_TYPES_INT32]);
+    for(UA_UInt16 i = 2; i <= 3; i++) {
+        retVal = UA_Server_writeValue(server, UA_NODEID_NUMERIC(1, SUBSCRIBEVARIABLE_NODEID + i), zero);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    }
+    ck_assert_int_eq(processInt32NetworkMessageEx(noGroupIds, 2, false), UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(readInt32Target(2), 2);
+    ck_assert_int_eq(readInt32Target(3), 3);
+    ck_assert_int_eq(processInt32NetworkMessageEx(unknownIds, 1, false),
+                     UA_STATUSCODE_BADNOTFOUND);
+
+    /* Removed readers are no longer found */
+    retVal = UA_Server_removeDataSetReader(server, readers[0]);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    UA_UInt16 firstId = 1;
+    ck_assert_int_eq(processInt32NetworkMessage(&firstId, 1), UA_STATUSCODE_BADNOTFOUND);
+
+    /* Readers of a removed ReaderGroup are no longer found */
+    retVal = UA_Server_removeReaderGroup(server, readerGroupTest);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(processInt32NetworkMessage(ids, 2), UA_STATUSCODE_BADNOTFOUND);
+} END_TEST
+
 int main(void) {
     TCase *tc_add_pubsub_readergroup = tcase_create("PubSub readerGroup items handling");
     tcase_add_checked_fixture(tc_add_pubsub_readergroup, setup, teardown);
@@ -1339,6 +1496,11 @@ int main(void) {
     tcase_add_test(tc_add_pubsub_readergroup, AddTargetVariableWithInvalidConfiguration);
     tcase_add_test(tc_add_pubsub_readergroup, AddTargetVariableWithValidConfiguration);
 
+    /* Test case for the dispatch of received messages to the readers */
+    TCase *tc_pubsub_dispatch = tcase_create("Dispatch NetworkMessages to DataSetReaders");
+    tcase_add_checked_fixture(tc_pubsub_dispatch, setup, teardown);
+    tcase_add_test(tc_pubsub_dispatch, DispatchMultipleDataSetMessages);
+
     /*Test case to run both publisher and subscriber */
     TCase *tc_pubsub_publish_subscribe = tcase_create("Publisher publishing and Subscriber subscribing");
     tcase_add_checked_fixture(tc_pubsub_publish_subscribe, setup, teardown);
@@ -1350,6 +1512,7 @@ int main(void) {
 
     Suite *suite = suite_create("PubSub readerGroups/reader/Fields handling and publishing");
     suite_add_tcase(suite, tc_add_pubsub_readergroup);
+    suite_add_tcase(suite, tc_pubsub_dispatch);
     suite_add_tcase(suite, tc_pubsub_publish_subscribe);
 
     SRunner *suiteRunner = srunner_create(suite);
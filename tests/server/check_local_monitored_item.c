@@ -117,12 +117,105 @@ START_TEST(Server_LocalMonitoredItem) {
 }
 END_TEST
 
+static size_t changeCount = 0;
+
+static void
+countChangesCallback(UA_Server *thisServer, UA_UInt32 monitoredItemId,
+                     void *monitoredItemContext, const UA_NodeId *nodeId,
+                     void *nodeContext, UA_UInt32 attributeId,
+                     const UA_DataValue *value) {
+    changeCount++;
+}
+
+static UA_NodeId anyNodeId;
+
+static void
+writeAndSample(const UA_Variant *val) {
+    ASSERT_STATUSCODE(UA_Server_writeValue(server, anyNodeId, *val),
+                      UA_STATUSCODE_GOOD);
+    UA_fakeSleep(100);
+    UA_Server_run_iterate(server, 1);
+}
+
+/* Only changed values are reported. Scalars and arrays of numerical types are
+ * compared in place, other types with their binary encoding. */
+START_TEST(Server_LocalMonitoredItemChangeDetection) {
+    /* Variable that accepts values of any type */
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_UInt32 myUint32 = 40;
+    UA_Variant_setScalar(&attr.value, &myUint32, &UA_TYPES[UA_TYPES_UINT32]);
+    attr.displayName = UA_LOCALIZEDTEXT("en-US","any");
+    attr.valueRank = UA_VALUERANK_ANY;
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    anyNodeId = UA_NODEID_STRING(1, "any");
+    ASSERT_STATUSCODE(UA_Server_addVariableNode(server, anyNodeId, parentNodeId,
+                                                parentReferenceNodeId,
+                                                UA_QUALIFIEDNAME(1, "any"),
+                                                UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                                attr, NULL, NULL), UA_STATUSCODE_GOOD);
+
+    changeCount = 0;
+    UA_MonitoredItemCreateRequest monitorRequest =
+            UA_MonitoredItemCreateRequest_default(anyNodeId);
+    monitorRequest.requestedParameters.samplingInterval = (double)100;
+    monitorRequest.monitoringMode = UA_MONITORINGMODE_REPORTING;
+    UA_MonitoredItemCreateResult result =
+            UA_Server_createDataChangeMonitoredItem(server, UA_TIMESTAMPSTORETURN_BOTH,
+                                                    monitorRequest, NULL,
+                                                    &countChangesCallback);
+    ASSERT_STATUSCODE(result.statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(changeCount, 1);
+
+    /* Unchanged scalar */
+    UA_UInt32 count = 40;
+    UA_Variant val;
+    UA_Variant_setScalar(&val, &count, &UA_TYPES[UA_TYPES_UINT32]);
+    writeAndSample(&val);
+    ck_assert_uint_eq(changeCount, 1);
+
+    /* Array (stored on the heap) */
+    UA_UInt32 arr[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    UA_Variant_setArray(&val, arr, 10, &UA_TYPES[UA_TYPES_UINT32]);
+    writeAndSample(&val);
+    ck_assert_uint_eq(changeCount, 2);
+    writeAndSample(&val);
+    ck_assert_uint_eq(changeCount, 2);
+    arr[9] = 10;
+    writeAndSample(&val);
+    ck_assert_uint_eq(changeCount, 3);
+
+    /* Shorter array */
+    UA_Variant_setArray(&val, arr, 9, &UA_TYPES[UA_TYPES_UINT32]);
+    writeAndSample(&val);
+    ck_assert_uint_eq(changeCount, 4);
+
+    /* Strings are compared in the binary encoding */
+    UA_String str = UA_STRING("open62541");
+    UA_Variant_setScalar(&val, &str, &UA_TYPES[UA_TYPES_STRING]);
+    writeAndSample(&val);
+    ck_assert_uint_eq(changeCount, 5);
+    writeAndSample(&val);
+    ck_assert_uint_eq(changeCount, 5);
+    str = UA_STRING("open62542");
+    writeAndSample(&val);
+    ck_assert_uint_eq(changeCount, 6);
+
+    /* Back to the scalar */
+    UA_Variant_setScalar(&val, &count, &UA_TYPES[UA_TYPES_UINT32]);
+    writeAndSample(&val);
+    ck_assert_uint_eq(changeCount, 7);
+    writeAndSample(&val);
+    ck_assert_uint_eq(changeCount, 7);
+}
+END_TEST
+
 static Suite* testSuite_Client(void)
 {
     Suite *s = suite_create("Local Monitored Item");
     TCase *tc_server = tcase_create("Local Monitored Item Basic");
     tcase_add_checked_fixture(tc_server, setup, teardown);
     tcase_add_test(tc_server, Server_LocalMonitoredItem);
+    tcase_add_test(tc_server, Server_LocalMonitoredItemChangeDetection);
     suite_add_tcase(s, tc_server);
 
     return s;
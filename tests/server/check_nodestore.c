@@ -25,6 +25,12 @@ static void setupHashMap(void) {
     UA_Nodestore_HashMap(&ns);
 }
 
+#if UA_MULTITHREADING >= 200
+static void setupHashMapConcurrent(void) {
+    UA_Nodestore_HashMapConcurrent(&ns);
+}
+#endif
+
 static void teardown(void) {
     ns.clear(ns.context);
 }
@@ -248,6 +254,149 @@ START_TEST(profileGetDelete) {
 }
 END_TEST
 
+#if UA_MULTITHREADING >= 200
+#define CONCURRENT_NODES 1000
+#define CONCURRENT_READERS 4
+
+static volatile UA_Boolean writerDone;
+
+static void *concurrentReadThread(void *arg) {
+    size_t *reads = (size_t*)arg;
+    UA_NodeId id = UA_NODEID_NUMERIC(0, 0);
+    while(!writerDone) {
+        for(UA_UInt32 i = 0; i < CONCURRENT_NODES; i++) {
+            id.identifier.numeric = i + 1;
+            const UA_Node *n = ns.getNode(ns.context, &id);
+            /* The node is always found. Either before or after an update. */
+            ck_assert_ptr_ne(n, NULL);
+            ck_assert_uint_eq(n->nodeId.identifier.numeric, i + 1);
+            ns.releaseNode(ns.context, n);
+            (*reads)++;
+        }
+    }
+    return NULL;
+}
+
+/* Readers run in parallel to replacing nodes and to inserting/removing nodes
+ * (which resizes the hash-map). Run with ASAN/valgrind to detect accesses to
+ * freed nodes. */
+START_TEST(concurrentReadWrite) {
+    for(UA_UInt32 i = 0; i < CONCURRENT_NODES; i++) {
+        UA_Node *n = createNode(0, i + 1);
+        ck_assert_uint_eq(ns.insertNode(ns.context, n, NULL), UA_STATUSCODE_GOOD);
+    }
+
+    writerDone = false;
+    pthread_t t[CONCURRENT_READERS];
+    size_t reads[CONCURRENT_READERS];
+    for(size_t i = 0; i < CONCURRENT_READERS; i++) {
+        reads[i] = 0;
+        pthread_create(&t[i], NULL, concurrentReadThread, &reads[i]);
+    }
+
+    for(size_t round = 0; round < 5; round++) {
+        /* Replace all nodes */
+        UA_NodeId id = UA_NODEID_NUMERIC(0, 0);
+        for(UA_UInt32 i = 0; i < CONCURRENT_NODES; i++) {
+            id.identifier.numeric = i + 1;
+            UA_Node *copy = NULL;
+            ck_assert_uint_eq(ns.getNodeCopy(ns.context, &id, &copy), UA_STATUSCODE_GOOD);
+            copy->writeMask = (UA_UInt32)round;
+            ck_assert_uint_eq(ns.replaceNode(ns.context, copy), UA_STATUSCODE_GOOD);
+        }
+
+        /* Grow and shrink the hash-map */
+        for(UA_UInt32 i = 0; i < 4 * CONCURRENT_NODES; i++) {
+            UA_Node *n = createNode(1, i + 1);
+            ck_assert_uint_eq(ns.insertNode(ns.context, n, NULL), UA_STATUSCODE_GOOD);
+        }
+        for(UA_UInt32 i = 0; i < 4 * CONCURRENT_NODES; i++) {
+            UA_NodeId rid = UA_NODEID_NUMERIC(1, i + 1);
+            ck_assert_uint_eq(ns.removeNode(ns.context, &rid), UA_STATUSCODE_GOOD);
+        }
+    }
+
+    writerDone = true;
+    size_t total = 0;
+    for(size_t i = 0; i < CONCURRENT_READERS; i++) {
+        pthread_join(t[i], NULL);
+        total += reads[i];
+    }
+    printf("%lu concurrent reads on %d threads\n", (unsigned long)total,
+           CONCURRENT_READERS);
+
+    /* All nodes have the last version */
+    UA_NodeId id = UA_NODEID_NUMERIC(0, 1);
+    const UA_Node *n = ns.getNode(ns.context, &id);
+    ck_assert_uint_eq(n->writeMask, 4);
+    ns.releaseNode(ns.context, n);
+}
+END_TEST
+
+/* The node was removed and a node with the same NodeId inserted while the copy
+ * was held. The new entry can reuse the memory of the removed one. */
+START_TEST(replaceReinsertedNode) {
+    UA_Node* n1 = createNode(0,2253);
+    ns.insertNode(ns.context, n1, NULL);
+    UA_NodeId in1 = UA_NODEID_NUMERIC(0,2253);
+    UA_Node* copy;
+    ck_assert_uint_eq(ns.getNodeCopy(ns.context, &in1, &copy), UA_STATUSCODE_GOOD);
+
+    ck_assert_uint_eq(ns.removeNode(ns.context, &in1), UA_STATUSCODE_GOOD);
+    UA_Node* n2 = createNode(0,2253);
+    ck_assert_uint_eq(ns.insertNode(ns.context, n2, NULL), UA_STATUSCODE_GOOD);
+
+    /* shall fail */
+    ck_assert_int_ne(ns.replaceNode(ns.context, copy), UA_STATUSCODE_GOOD);
+}
+END_TEST
+
+#define SCALING_NODES 10000
+#define SCALING_ROUNDS 20
+
+static void *scalingReadThread(void *arg) {
+    (void)arg;
+    UA_NodeId id = UA_NODEID_NUMERIC(0, 0);
+    for(size_t round = 0; round < SCALING_ROUNDS; round++) {
+        for(UA_UInt32 i = 0; i < SCALING_NODES; i++) {
+            id.identifier.numeric = i + 1;
+            const UA_Node *n = ns.getNode(ns.context, &id);
+            ck_assert_ptr_ne(n, NULL);
+            ns.releaseNode(ns.context, n);
+        }
+    }
+    return NULL;
+}
+
+/* Read throughput of the Nodestore with an increasing number of threads. Every
+ * thread reads all nodes. Only the Nodestore is measured. The services of the
+ * server are still serialized by the server lock. */
+START_TEST(readScaling) {
+    for(UA_UInt32 i = 0; i < SCALING_NODES; i++) {
+        UA_Node *n = createNode(0, i + 1);
+        ck_assert_uint_eq(ns.insertNode(ns.context, n, NULL), UA_STATUSCODE_GOOD);
+    }
+
+    pthread_t t[CONCURRENT_READERS];
+    for(size_t threads = 1; threads <= CONCURRENT_READERS; threads *= 2) {
+        /* The unit tests replace the monotonic clock of the library. Use the
+         * wall time of the system. */
+        struct timespec begin, end;
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        for(size_t i = 0; i < threads; i++)
+            pthread_create(&t[i], NULL, scalingReadThread, NULL);
+        for(size_t i = 0; i < threads; i++)
+            pthread_join(t[i], NULL);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double seconds = (double)(end.tv_sec - begin.tv_sec) +
+            (double)(end.tv_nsec - begin.tv_nsec) / 1e9;
+        double reads = (double)(threads * SCALING_ROUNDS * SCALING_NODES);
+        printf("%lu threads: %.0f reads/s\n", (unsigned long)threads, reads / seconds);
+    }
+}
+END_TEST
+#endif
+
 static Suite * namespace_suite (void) {
     Suite *s = suite_create ("UA_NodeStore");
 
@@ -303,6 +452,37 @@ static Suite * namespace_suite (void) {
     tcase_add_test (tc_profile_hm, profileGetDelete);
     suite_add_tcase (s, tc_profile_hm);
 
+#if UA_MULTITHREADING >= 200
+    TCase* tc_find_chm = tcase_create ("Find-HashMapConcurrent");
+    tcase_add_checked_fixture(tc_find_chm, setupHashMapConcurrent, teardown);
+    tcase_add_test (tc_find_chm, findNodeInUA_NodeStoreWithSingleEntry);
+    tcase_add_test (tc_find_chm, findNodeInUA_NodeStoreWithSeveralEntries);
+    tcase_add_test (tc_find_chm, findNodeInExpandedNamespace);
+    tcase_add_test (tc_find_chm, failToFindNonExistentNodeInUA_NodeStoreWithSeveralEntries);
+    tcase_add_test (tc_find_chm, failToFindNodeInOtherUA_NodeStore);
+    suite_add_tcase (s, tc_find_chm);
+
+    TCase *tc_replace_chm = tcase_create("Replace-HashMapConcurrent");
+    tcase_add_checked_fixture(tc_replace_chm, setupHashMapConcurrent, teardown);
+    tcase_add_test (tc_replace_chm, replaceExistingNode);
+    tcase_add_test (tc_replace_chm, replaceOldNode);
+    tcase_add_test (tc_replace_chm, replaceReinsertedNode);
+    suite_add_tcase (s, tc_replace_chm);
+
+    TCase* tc_iterate_chm = tcase_create ("Iterate-HashMapConcurrent");
+    tcase_add_checked_fixture(tc_iterate_chm, setupHashMapConcurrent, teardown);
+    tcase_add_test (tc_iterate_chm, iterateOverUA_NodeStoreShallNotVisitEmptyNodes);
+    tcase_add_test (tc_iterate_chm, iterateOverExpandedNamespaceShallNotVisitEmptyNodes);
+    suite_add_tcase (s, tc_iterate_chm);
+
+    TCase* tc_profile_chm = tcase_create ("Profile-HashMapConcurrent");
+    tcase_add_checked_fixture(tc_profile_chm, setupHashMapConcurrent, teardown);
+    tcase_add_test (tc_profile_chm, profileGetDelete);
+    tcase_add_test (tc_profile_chm, concurrentReadWrite);
+    tcase_add_test (tc_profile_chm, readScaling);
+    suite_add_tcase (s, tc_profile_chm);
+#endif
+
     return s;
 }
 
@@ -8,6 +8,7 @@
 #include <open62541/server.h>
 #include <open62541/client.h>
 #include <open62541/client_config_default.h>
+#include <open62541/client_highlevel.h>
 #include <open62541/client_highlevel_async.h>
 #include <open62541/plugin/log_stdout.h>
 #include "testing_clock.h"
@@ -20,6 +21,8 @@ THREAD_HANDLE server_thread;
 static UA_Server *server;
 static size_t clientCounter;
 
+static volatile size_t methodCounter;
+
 static UA_StatusCode
 methodCallback(UA_Server *serverArg,
          const UA_NodeId *sessionId, void *sessionHandle,
@@ -27,6 +30,7 @@ methodCallback(UA_Server *serverArg,
          const UA_NodeId *objectId, void *objectContext,
          size_t inputSize, const UA_Variant *input,
          size_t outputSize, UA_Variant *output) {
+    methodCounter++;
     return UA_STATUSCODE_GOOD;
 }
 
@@ -45,6 +49,7 @@ THREAD_CALLBACK(serverloop) {
 
 static void setup(void) {
     clientCounter = 0;
+    methodCounter = 0;
     running = true;
     server = UA_Server_new();
     UA_ServerConfig *config = UA_Server_getConfig(server);
@@ -76,6 +81,23 @@ static void setup(void) {
     res = UA_Server_setMethodNodeAsync(server, UA_NODEID_STRING(1, "asyncMethod"), true);
     ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
 
+    /* Asynchronous Method with a higher priority */
+    res = UA_Server_addMethodNode(server, UA_NODEID_STRING(1, "asyncMethodHigh"),
+                            UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                            UA_NODEID_NUMERIC(0, UA_NS0ID_HASORDEREDCOMPONENT),
+                            UA_QUALIFIEDNAME(1, "asyncMethodHigh"),
+                            methodAttr, &methodCallback,
+                            0, NULL, 0, NULL, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_Server_setMethodNodeAsync(server, UA_NODEID_STRING(1, "asyncMethodHigh"), true);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_Server_setMethodNodeAsyncPriority(server, UA_NODEID_STRING(1, "asyncMethodHigh"),
+                                               UA_ASYNCOPERATION_PRIORITIES);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADINVALIDARGUMENT);
+    res = UA_Server_setMethodNodeAsyncPriority(server, UA_NODEID_STRING(1, "asyncMethodHigh"),
+                                               UA_ASYNCOPERATION_PRIORITIES - 1);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
     UA_Server_run_startup(server);
     THREAD_CREATE(server_thread, serverloop);
 }
@@ -131,6 +153,9 @@ START_TEST(Async_call) {
     UA_CallMethodResult_init(&response.callMethodResult);
     UA_Server_setAsyncOperationResult(server, &response, context);
 
+    /* A second result for the pending operation is rejected */
+    UA_Server_setAsyncOperationResult(server, &response, context);
+
     /* Iterate and pick up the async response to be sent out */
     UA_fakeSleep(1000);
     UA_Server_run_iterate(server, true);
@@ -232,7 +257,8 @@ START_TEST(Async_timeout_worker) {
     UA_Client_run_iterate(client, 0);
     ck_assert_uint_eq(clientCounter, 1);
 
-    /* Return the late response */
+    /* Return the late response. A second result is rejected. */
+    UA_Server_setAsyncOperationResult(server, &response, context);
     UA_Server_setAsyncOperationResult(server, &response, context);
 
     running = true;
@@ -242,6 +268,87 @@ START_TEST(Async_timeout_worker) {
     UA_Client_delete(client);
 } END_TEST
 
+/* Operations of a higher priority are taken out first */
+START_TEST(Async_priority) {
+    UA_Client *client = UA_Client_new();
+    UA_ClientConfig *clientConfig = UA_Client_getConfig(client);
+    UA_ClientConfig_setDefault(clientConfig);
+
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Stop the server thread. Iterate manually from now on */
+    running = false;
+    THREAD_JOIN(server_thread);
+
+    /* Call the low-priority method first */
+    retval = UA_Client_call_async(client,
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_STRING(1, "asyncMethod"),
+                                  0, NULL, clientReceiveCallback, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Client_call_async(client,
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_STRING(1, "asyncMethodHigh"),
+                                  0, NULL, clientReceiveCallback, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Server_run_iterate(server, true);
+    UA_Server_run_iterate(server, true);
+
+    /* Take out both operations at once */
+    UA_AsyncOperationEntry ops[4];
+    size_t opsCount = UA_Server_getAsyncOperations(server, ops, 4);
+    ck_assert_uint_eq(opsCount, 2);
+    ck_assert_uint_eq(ops[0].type, UA_ASYNCOPERATIONTYPE_CALL);
+    UA_NodeId high = UA_NODEID_STRING(1, "asyncMethodHigh");
+    UA_NodeId low = UA_NODEID_STRING(1, "asyncMethod");
+    ck_assert(UA_NodeId_equal(&ops[0].request->callMethodRequest.methodId, &high));
+    ck_assert(UA_NodeId_equal(&ops[1].request->callMethodRequest.methodId, &low));
+    ck_assert_uint_eq(UA_Server_getAsyncOperations(server, ops + 2, 2), 0);
+
+    /* Return the results in reverse order */
+    UA_AsyncOperationResponse response;
+    UA_CallMethodResult_init(&response.callMethodResult);
+    UA_Server_setAsyncOperationResult(server, &response, ops[1].context);
+    UA_Server_setAsyncOperationResult(server, &response, ops[0].context);
+
+    UA_Server_run_iterate(server, true);
+    UA_Client_run_iterate(client, 0);
+    UA_Client_run_iterate(client, 0);
+    ck_assert_uint_eq(clientCounter, 2);
+
+    running = true;
+    THREAD_CREATE(server_thread, serverloop);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+} END_TEST
+
+#if UA_MULTITHREADING >= 200
+/* The server executes the async methods on its worker threads */
+START_TEST(Async_executor) {
+    UA_Server_getConfig(server)->asyncOperationExecutor = true;
+
+    UA_Client *client = UA_Client_new();
+    UA_ClientConfig *clientConfig = UA_Client_getConfig(client);
+    UA_ClientConfig_setDefault(clientConfig);
+
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    for(size_t i = 0; i < 10; i++) {
+        retval = UA_Client_call(client, UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                UA_NODEID_STRING(1, i % 2 ? "asyncMethod" : "asyncMethodHigh"),
+                                0, NULL, NULL, NULL);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    ck_assert_uint_eq(methodCounter, 10);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+} END_TEST
+#endif
+
 static Suite* method_async_suite(void) {
     /* set up unit test for internal data structures */
     Suite *s = suite_create("Async Method");
@@ -251,6 +358,10 @@ static Suite* method_async_suite(void) {
     tcase_add_test(tc_manager, Async_call);
     tcase_add_test(tc_manager, Async_timeout);
     tcase_add_test(tc_manager, Async_timeout_worker);
+    tcase_add_test(tc_manager, Async_priority);
+#if UA_MULTITHREADING >= 200
+    tcase_add_test(tc_manager, Async_executor);
+#endif
     suite_add_tcase(s, tc_manager);
     
     return s;
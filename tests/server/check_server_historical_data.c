@@ -10,6 +10,7 @@
 #include <open62541/client_highlevel.h>
 #include <open62541/plugin/historydata/history_data_backend.h>
 #include <open62541/plugin/historydata/history_data_backend_memory.h>
+#include <open62541/plugin/historydata/history_data_backend_memory_compressed.h>
 #include <open62541/plugin/historydata/history_data_gathering_default.h>
 #include <open62541/plugin/historydata/history_database_default.h>
 #include <open62541/plugin/historydatabase.h>
@@ -21,6 +22,15 @@
 
 #include <check.h>
 
+#ifdef UA_ENABLE_HISTORIZING_FILE
+#include <open62541/plugin/historydata/history_data_backend_file.h>
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "testing_clock.h"
 #include "testing_networklayers.h"
 #include "thread_wrapper.h"
@@ -240,10 +250,10 @@ resultIsEqual(const UA_DataValue * result, const testTuple * tuple, size_t index
 }
 
 static UA_Boolean
-fillHistoricalDataBackend(UA_HistoryDataBackend backend)
+fillHistoricalDataBackend(UA_HistoryDataBackend backend, const UA_DateTime *data)
 {
     int i = 0;
-    UA_DateTime currentDateTime = testData[i];
+    UA_DateTime currentDateTime = data[i];
     fprintf(stderr, "Adding to historical data backend: ");
     while (currentDateTime) {
         fprintf(stderr, "%lld, ", currentDateTime / UA_DATETIME_SEC);
@@ -263,7 +273,7 @@ fillHistoricalDataBackend(UA_HistoryDataBackend backend)
             return false;
         }
         UA_DataValue_deleteMembers(&value);
-        currentDateTime = testData[++i];
+        currentDateTime = data[++i];
     }
     fprintf(stderr, "\n");
     return true;
@@ -621,7 +631,7 @@ START_TEST(Server_HistorizingUpdateDelete)
     ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
 
     // fill backend
-    ck_assert_uint_eq(fillHistoricalDataBackend(backend), true);
+    ck_assert_uint_eq(fillHistoricalDataBackend(backend, testData), true);
 
     // delete some values
     ck_assert_str_eq(UA_StatusCode_name(deleteHistory(DELETE_START_TIME, DELETE_STOP_TIME)),
@@ -701,9 +711,30 @@ START_TEST(Server_HistorizingUpdateReplace)
 }
 END_TEST
 
+/* The backends that support HistoryUpdate */
+static UA_HistoryDataBackend
+updateBackendMemory(void) {
+    return UA_HistoryDataBackend_Memory(1, 1);
+}
+
+static UA_HistoryDataBackend
+updateBackendMemoryCompressed(void) {
+    return UA_HistoryDataBackend_MemoryCompressed(4, 0, 0);
+}
+
+static const struct {
+    UA_HistoryDataBackend (*create)(void);
+    void (*deleteMembers)(UA_HistoryDataBackend *backend);
+} updateBackends[] = {
+    {updateBackendMemory, UA_HistoryDataBackend_Memory_deleteMembers},
+    {updateBackendMemoryCompressed, UA_HistoryDataBackend_MemoryCompressed_deleteMembers}
+};
+
+#define UPDATE_BACKENDS (sizeof(updateBackends) / sizeof(updateBackends[0]))
+
 START_TEST(Server_HistorizingUpdateUpdate)
 {
-    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Memory(1, 1);
+    UA_HistoryDataBackend backend = updateBackends[_i].create();
     UA_HistorizingNodeIdSettings setting;
     setting.historizingBackend = backend;
     setting.maxHistoryDataResponseSize = 1000;
@@ -748,7 +779,7 @@ START_TEST(Server_HistorizingUpdateUpdate)
     }
 
     UA_HistoryData_deleteMembers(&data);
-    UA_HistoryDataBackend_Memory_deleteMembers(&setting.historizingBackend);
+    updateBackends[_i].deleteMembers(&setting.historizingBackend);
 }
 END_TEST
 
@@ -963,7 +994,7 @@ START_TEST(Server_HistorizingBackendMemory)
     fprintf(stderr, "%d tests expected failed.\n", retval);
 
     // fill backend
-    ck_assert_uint_eq(fillHistoricalDataBackend(backend), true);
+    ck_assert_uint_eq(fillHistoricalDataBackend(backend, testData), true);
 
     // read all in one
     retval = testHistoricalDataBackend(100);
@@ -1013,6 +1044,719 @@ START_TEST(Server_HistorizingRandomIndexBackend)
 }
 END_TEST
 
+static const UA_DataValue*
+getDataValue_failing(UA_Server *srv, void *hdbContext, const UA_NodeId *sessionId,
+                     void *sessionContext, const UA_NodeId *nodeId, size_t index) {
+    return NULL;
+}
+
+START_TEST(Server_HistorizingBackendGetDataValueFails)
+{
+    /* A backend that cannot provide the value for a bound */
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Memory(1, 1);
+    backend.getDataValue = getDataValue_failing;
+    UA_HistorizingNodeIdSettings setting;
+    setting.historizingBackend = backend;
+    setting.maxHistoryDataResponseSize = 1000;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_USER;
+    serverMutexLock();
+    UA_StatusCode ret = gathering->registerNodeId(server, gathering->context, &outNodeId, setting);
+    serverMutexUnlock();
+    ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+    ck_assert_uint_eq(fillHistoricalDataBackend(backend, testData), true);
+
+    UA_HistoryReadResponse response;
+    UA_HistoryReadResponse_init(&response);
+    requestHistory(TIMESTAMP_UNSPECIFIED, TIMESTAMP_5_00, &response, 0, true, NULL);
+    ck_assert_uint_eq(response.resultsSize, 1);
+    ck_assert_str_eq(UA_StatusCode_name(response.results[0].statusCode),
+                     UA_StatusCode_name(UA_STATUSCODE_BADINTERNALERROR));
+    UA_HistoryReadResponse_deleteMembers(&response);
+    UA_HistoryDataBackend_Memory_deleteMembers(&setting.historizingBackend);
+}
+END_TEST
+
+START_TEST(Server_HistorizingBackendMemoryCompressed)
+{
+    /* Small chunks to cover reads across chunk boundaries */
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_MemoryCompressed(4, 0, 0);
+    UA_HistorizingNodeIdSettings setting;
+    setting.historizingBackend = backend;
+    setting.maxHistoryDataResponseSize = 1000;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_USER;
+    serverMutexLock();
+    UA_StatusCode ret = gathering->registerNodeId(server, gathering->context, &outNodeId, setting);
+    serverMutexUnlock();
+    ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    // empty backend should not crash
+    UA_UInt32 retval = testHistoricalDataBackend(100);
+    fprintf(stderr, "%d tests expected failed.\n", retval);
+
+    // fill backend (out of order)
+    ck_assert_uint_eq(fillHistoricalDataBackend(backend, testData), true);
+
+    // read all in one
+    retval = testHistoricalDataBackend(100);
+    fprintf(stderr, "%d tests failed.\n", retval);
+    ck_assert_uint_eq(retval, 0);
+
+    // read continuous one at one request
+    retval = testHistoricalDataBackend(1);
+    fprintf(stderr, "%d tests failed.\n", retval);
+    ck_assert_uint_eq(retval, 0);
+
+    // read continuous two at one request
+    retval = testHistoricalDataBackend(2);
+    fprintf(stderr, "%d tests failed.\n", retval);
+    ck_assert_uint_eq(retval, 0);
+    UA_HistoryDataBackend_MemoryCompressed_deleteMembers(&setting.historizingBackend);
+}
+END_TEST
+
+#define COMPRESSED_VALUES 1000
+
+/* Every sample has a different shape. So all column encodings are used. */
+static void
+compressedTestValue(size_t i, UA_DataValue *value) {
+    UA_DataValue_init(value);
+    UA_DateTime time = (UA_DateTime)(1000 + i) * UA_DATETIME_SEC;
+    if(i % 7 == 0)
+        time += (UA_DateTime)(i * 13); /* Irregular timestamps */
+    value->hasSourceTimestamp = true;
+    value->sourceTimestamp = time;
+    if(i % 5 != 0) {
+        value->hasServerTimestamp = true;
+        value->serverTimestamp = time + (UA_DateTime)(i % 3) * UA_DATETIME_MSEC;
+    }
+    if(i % 11 == 0) {
+        value->hasStatus = true;
+        value->status = UA_STATUSCODE_UNCERTAININITIALVALUE;
+    }
+    if(i % 13 == 0) {
+        value->hasSourcePicoseconds = true;
+        value->sourcePicoseconds = (UA_UInt16)i;
+    }
+    if(i % 17 == 0)
+        return; /* No value */
+    value->hasValue = true;
+    UA_Double d = 20.0 + (UA_Double)(i % 10) * 0.25;
+    UA_Int32 n = -(UA_Int32)i;
+    UA_Float f = (UA_Float)i / 3.0f;
+    UA_Boolean b = (i % 2 == 0);
+    UA_String str = UA_STRING("overflow");
+    UA_UInt64 u = 0xFFFFFFFFFFFFFFFFULL - i;
+    switch(i % 6) {
+    case 0: UA_Variant_setScalarCopy(&value->value, &n, &UA_TYPES[UA_TYPES_INT32]); break;
+    case 1: UA_Variant_setScalarCopy(&value->value, &f, &UA_TYPES[UA_TYPES_FLOAT]); break;
+    case 2: UA_Variant_setScalarCopy(&value->value, &b, &UA_TYPES[UA_TYPES_BOOLEAN]); break;
+    case 3: UA_Variant_setScalarCopy(&value->value, &str, &UA_TYPES[UA_TYPES_STRING]); break;
+    case 4: UA_Variant_setScalarCopy(&value->value, &u, &UA_TYPES[UA_TYPES_UINT64]); break;
+    default: UA_Variant_setScalarCopy(&value->value, &d, &UA_TYPES[UA_TYPES_DOUBLE]); break;
+    }
+}
+
+static UA_Boolean
+dataValueEqual(const UA_DataValue *a, const UA_DataValue *b) {
+    if(!a || !b)
+        return false;
+    if(a->hasValue != b->hasValue || a->hasStatus != b->hasStatus ||
+       a->hasSourceTimestamp != b->hasSourceTimestamp ||
+       a->hasServerTimestamp != b->hasServerTimestamp ||
+       a->hasSourcePicoseconds != b->hasSourcePicoseconds ||
+       a->hasServerPicoseconds != b->hasServerPicoseconds)
+        return false;
+    if((a->hasStatus && a->status != b->status) ||
+       (a->hasSourceTimestamp && a->sourceTimestamp != b->sourceTimestamp) ||
+       (a->hasServerTimestamp && a->serverTimestamp != b->serverTimestamp) ||
+       (a->hasSourcePicoseconds && a->sourcePicoseconds != b->sourcePicoseconds) ||
+       (a->hasServerPicoseconds && a->serverPicoseconds != b->serverPicoseconds))
+        return false;
+    if(!a->hasValue)
+        return true;
+    if(a->value.type != b->value.type)
+        return false;
+    if(a->value.type == &UA_TYPES[UA_TYPES_STRING])
+        return UA_String_equal((UA_String*)a->value.data, (UA_String*)b->value.data);
+    return memcmp(a->value.data, b->value.data, a->value.type->memSize) == 0;
+}
+
+START_TEST(Server_HistorizingBackendMemoryCompressedRoundtrip)
+{
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_MemoryCompressed(64, 0, 0);
+    UA_NodeId nodeId = UA_NODEID_STRING(1, "compressed");
+
+    /* Every third value arrives late */
+    for(size_t i = 0; i < COMPRESSED_VALUES; i++) {
+        size_t j = (i % 3 == 2 && i + 1 < COMPRESSED_VALUES) ? i + 1 :
+            (i % 3 == 0 && i > 0) ? i - 1 : i;
+        UA_DataValue value;
+        compressedTestValue(j, &value);
+        UA_StatusCode ret = backend.serverSetHistoryData(server, backend.context, NULL, NULL,
+                                                         &nodeId, true, &value);
+        ck_assert_uint_eq(ret, UA_STATUSCODE_GOOD);
+        UA_DataValue_clear(&value);
+    }
+    ck_assert_uint_eq(backend.getEnd(server, backend.context, NULL, NULL, &nodeId),
+                      COMPRESSED_VALUES);
+
+    for(size_t i = 0; i < COMPRESSED_VALUES; i++) {
+        UA_DataValue expected;
+        compressedTestValue(i, &expected);
+        size_t index = backend.getDateTimeMatch(server, backend.context, NULL, NULL, &nodeId,
+                                                expected.sourceTimestamp, MATCH_EQUAL);
+        ck_assert_uint_eq(index, i);
+        const UA_DataValue *value =
+            backend.getDataValue(server, backend.context, NULL, NULL, &nodeId, index);
+        ck_assert_ptr_ne(value, NULL);
+        ck_assert(dataValueEqual(value, &expected));
+        UA_DataValue_clear(&expected);
+    }
+
+    /* Remove a range across chunks (the end is not included) and insert a
+     * value into the gap */
+    UA_DataValue first, last;
+    compressedTestValue(100, &first);
+    compressedTestValue(299, &last);
+    ck_assert_uint_eq(backend.removeDataValue(server, backend.context, NULL, NULL, &nodeId,
+                                              first.sourceTimestamp, last.sourceTimestamp),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(backend.getEnd(server, backend.context, NULL, NULL, &nodeId),
+                      COMPRESSED_VALUES - 199);
+    ck_assert_uint_eq(backend.insertDataValue(server, backend.context, NULL, NULL, &nodeId,
+                                              &first), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(backend.insertDataValue(server, backend.context, NULL, NULL, &nodeId,
+                                              &first), UA_STATUSCODE_BADENTRYEXISTS);
+    size_t index = backend.getDateTimeMatch(server, backend.context, NULL, NULL, &nodeId,
+                                            first.sourceTimestamp, MATCH_EQUAL);
+    ck_assert_uint_eq(index, 100);
+    ck_assert(dataValueEqual(backend.getDataValue(server, backend.context, NULL, NULL, &nodeId, index),
+                       &first));
+    index = backend.getDateTimeMatch(server, backend.context, NULL, NULL, &nodeId,
+                                     last.sourceTimestamp, MATCH_EQUAL);
+    ck_assert_uint_eq(index, 101);
+    UA_DataValue_clear(&first);
+    UA_DataValue_clear(&last);
+
+    /* Remove the newest values including the last chunk and append again */
+    UA_DataValue newest;
+    compressedTestValue(900, &first);
+    compressedTestValue(COMPRESSED_VALUES, &last);
+    compressedTestValue(COMPRESSED_VALUES + 1, &newest);
+    ck_assert_uint_eq(backend.removeDataValue(server, backend.context, NULL, NULL, &nodeId,
+                                              first.sourceTimestamp, last.sourceTimestamp),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(backend.serverSetHistoryData(server, backend.context, NULL, NULL,
+                                                   &nodeId, true, &newest),
+                      UA_STATUSCODE_GOOD);
+    index = backend.lastIndex(server, backend.context, NULL, NULL, &nodeId);
+    ck_assert(dataValueEqual(backend.getDataValue(server, backend.context, NULL, NULL, &nodeId, index),
+                       &newest));
+    UA_DataValue_clear(&first);
+    UA_DataValue_clear(&last);
+    UA_DataValue_clear(&newest);
+
+    UA_HistoryDataBackend_MemoryCompressed_deleteMembers(&backend);
+}
+END_TEST
+
+START_TEST(Server_HistorizingBackendMemoryCompressedRetention)
+{
+    /* Keep at least 100 values and at most one chunk more */
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_MemoryCompressed(16, 100, 0);
+    UA_NodeId nodeId = UA_NODEID_NUMERIC(1, 4711);
+    for(size_t i = 0; i < COMPRESSED_VALUES; i++) {
+        UA_DataValue value;
+        compressedTestValue(i, &value);
+        ck_assert_uint_eq(backend.serverSetHistoryData(server, backend.context, NULL, NULL,
+                                                       &nodeId, true, &value),
+                          UA_STATUSCODE_GOOD);
+        UA_DataValue_clear(&value);
+        size_t end = backend.getEnd(server, backend.context, NULL, NULL, &nodeId);
+        ck_assert_uint_le(end, 100 + 16);
+        if(i >= 100)
+            ck_assert_uint_ge(end, 100);
+    }
+
+    /* The newest values are kept */
+    size_t end = backend.getEnd(server, backend.context, NULL, NULL, &nodeId);
+    for(size_t i = 0; i < end; i++) {
+        UA_DataValue expected;
+        compressedTestValue(COMPRESSED_VALUES - end + i, &expected);
+        ck_assert(dataValueEqual(backend.getDataValue(server, backend.context, NULL, NULL, &nodeId, i),
+                           &expected));
+        UA_DataValue_clear(&expected);
+    }
+    UA_HistoryDataBackend_MemoryCompressed_deleteMembers(&backend);
+
+    /* Bound by age: values older than 100 seconds before the newest */
+    backend = UA_HistoryDataBackend_MemoryCompressed(16, 0, 100 * UA_DATETIME_SEC);
+    for(size_t i = 0; i < COMPRESSED_VALUES; i++) {
+        UA_DataValue value;
+        compressedTestValue(i, &value);
+        ck_assert_uint_eq(backend.serverSetHistoryData(server, backend.context, NULL, NULL,
+                                                       &nodeId, true, &value),
+                          UA_STATUSCODE_GOOD);
+        UA_DataValue_clear(&value);
+    }
+    end = backend.getEnd(server, backend.context, NULL, NULL, &nodeId);
+    ck_assert_uint_ge(end, 100);
+    ck_assert_uint_le(end, 100 + 16 + 1);
+    UA_HistoryDataBackend_MemoryCompressed_deleteMembers(&backend);
+}
+END_TEST
+
+START_TEST(Server_HistorizingBackendMemoryCompressedReplace)
+{
+    /* Non-numeric values are kept in the overflow array of the chunk */
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_MemoryCompressed(4, 0, 0);
+    UA_NodeId nodeId = UA_NODEID_STRING(1, "replace");
+    UA_String strings[3] = {UA_STRING_STATIC("first"), UA_STRING_STATIC("second"),
+                            UA_STRING_STATIC("third")};
+    UA_DataValue values[3];
+    for(size_t i = 0; i < 3; i++) {
+        UA_DataValue_init(&values[i]);
+        values[i].hasSourceTimestamp = true;
+        values[i].sourceTimestamp = (UA_DateTime)(1000 + i) * UA_DATETIME_SEC;
+        values[i].hasValue = true;
+        UA_Variant_setScalar(&values[i].value, &strings[i], &UA_TYPES[UA_TYPES_STRING]);
+        ck_assert_uint_eq(backend.serverSetHistoryData(server, backend.context, NULL, NULL,
+                                                       &nodeId, true, &values[i]),
+                          UA_STATUSCODE_GOOD);
+    }
+
+    /* Replace the overflow value in the middle by a compressed value */
+    UA_Int32 n = 42;
+    UA_Variant_setScalar(&values[1].value, &n, &UA_TYPES[UA_TYPES_INT32]);
+    ck_assert_uint_eq(backend.updateDataValue(server, backend.context, NULL, NULL,
+                                              &nodeId, &values[1]),
+                      UA_STATUSCODE_GOODENTRYREPLACED);
+    ck_assert_uint_eq(backend.getEnd(server, backend.context, NULL, NULL, &nodeId), 3);
+    for(size_t i = 0; i < 3; i++)
+        ck_assert(dataValueEqual(backend.getDataValue(server, backend.context, NULL, NULL,
+                                                      &nodeId, i), &values[i]));
+
+    /* And back to an overflow value */
+    UA_Variant_setScalar(&values[1].value, &strings[1], &UA_TYPES[UA_TYPES_STRING]);
+    ck_assert_uint_eq(backend.replaceDataValue(server, backend.context, NULL, NULL,
+                                               &nodeId, &values[1]),
+                      UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < 3; i++)
+        ck_assert(dataValueEqual(backend.getDataValue(server, backend.context, NULL, NULL,
+                                                      &nodeId, i), &values[i]));
+
+    UA_HistoryDataBackend_MemoryCompressed_deleteMembers(&backend);
+}
+END_TEST
+
+#ifdef UA_ENABLE_HISTORIZING_FILE
+
+static void
+makeTestDirectory(char *dir, size_t size) {
+    snprintf(dir, size, "/tmp/ua_history_XXXXXX");
+    ck_assert_ptr_ne(mkdtemp(dir), NULL);
+}
+
+static void
+removeTestDirectory(const char *dir) {
+    DIR *d = opendir(dir);
+    ck_assert_ptr_ne(d, NULL);
+    struct dirent *entry;
+    char path[512];
+    while((entry = readdir(d))) {
+        if(entry->d_name[0] == '.')
+            continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        unlink(path);
+    }
+    closedir(d);
+    rmdir(dir);
+}
+
+/* Number of segment files of a node and the path of the newest one */
+static size_t
+nodeSegmentFiles(const char *dir, const UA_NodeId *nodeId, char *tail, size_t tailSize) {
+    char prefix[16];
+    snprintf(prefix, sizeof(prefix), "%08x-0000-", (unsigned)UA_NodeId_hash(nodeId));
+    DIR *d = opendir(dir);
+    ck_assert_ptr_ne(d, NULL);
+    struct dirent *entry;
+    size_t count = 0;
+    char newest[256] = "";
+    while((entry = readdir(d))) {
+        if(strncmp(entry->d_name, prefix, strlen(prefix)) != 0)
+            continue;
+        count++;
+        if(strcmp(entry->d_name, newest) > 0)
+            snprintf(newest, sizeof(newest), "%s", entry->d_name);
+    }
+    closedir(d);
+    if(tail)
+        snprintf(tail, tailSize, "%s/%s", dir, newest);
+    return count;
+}
+
+static void
+fileTestValue(size_t i, UA_Boolean string, UA_DataValue *value) {
+    UA_DataValue_init(value);
+    value->hasValue = true;
+    if(string) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "value %u", (unsigned)i);
+        UA_String str = UA_STRING(buf);
+        UA_Variant_setScalarCopy(&value->value, &str, &UA_TYPES[UA_TYPES_STRING]);
+    } else {
+        UA_Int64 v = (UA_Int64)i;
+        UA_Variant_setScalarCopy(&value->value, &v, &UA_TYPES[UA_TYPES_INT64]);
+    }
+    value->hasSourceTimestamp = true;
+    value->sourceTimestamp = (UA_DateTime)(i + 1) * UA_DATETIME_SEC;
+    value->hasServerTimestamp = true;
+    value->serverTimestamp = value->sourceTimestamp + UA_DATETIME_MSEC;
+}
+
+static void
+checkFileTestValue(UA_HistoryDataBackend *backend, const UA_NodeId *nodeId,
+                   size_t index, size_t i, UA_Boolean string) {
+    UA_DataValue expected;
+    fileTestValue(i, string, &expected);
+    const UA_DataValue *value =
+        backend->getDataValue(server, backend->context, NULL, NULL, nodeId, index);
+    ck_assert_ptr_ne(value, NULL);
+    ck_assert(dataValueEqual(value, &expected));
+    UA_DataValue_clear(&expected);
+}
+
+START_TEST(Server_HistorizingBackendFile)
+{
+    char dir[64];
+    makeTestDirectory(dir, sizeof(dir));
+
+    /* Small segments so that the values are spread over several files */
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_File(dir, 256, 0);
+    ck_assert_ptr_ne(backend.context, NULL);
+    UA_HistorizingNodeIdSettings setting;
+    setting.historizingBackend = backend;
+    setting.maxHistoryDataResponseSize = 1000;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_USER;
+    serverMutexLock();
+    UA_StatusCode ret = gathering->registerNodeId(server, gathering->context, &outNodeId, setting);
+    serverMutexUnlock();
+    ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    // empty backend should not crash
+    UA_UInt32 retval = testHistoricalDataBackend(100);
+    fprintf(stderr, "%d tests expected failed.\n", retval);
+
+    // fill backend (values are appended in order)
+    ck_assert_uint_eq(fillHistoricalDataBackend(backend, testDataSorted), true);
+    ck_assert_uint_gt(nodeSegmentFiles(dir, &outNodeId, NULL, 0), 1);
+
+    // read all in one
+    retval = testHistoricalDataBackend(100);
+    fprintf(stderr, "%d tests failed.\n", retval);
+    ck_assert_uint_eq(retval, 0);
+
+    // read continuous one at one request
+    retval = testHistoricalDataBackend(1);
+    fprintf(stderr, "%d tests failed.\n", retval);
+    ck_assert_uint_eq(retval, 0);
+
+    // older values are rejected
+    UA_DataValue value;
+    UA_DataValue_init(&value);
+    value.hasSourceTimestamp = true;
+    value.sourceTimestamp = testDataSorted[0];
+    ck_assert_uint_eq(backend.serverSetHistoryData(server, backend.context, NULL, NULL,
+                                                   &outNodeId, true, &value),
+                      UA_STATUSCODE_BADINVALIDTIMESTAMP);
+    UA_HistoryDataBackend_File_deleteMembers(&backend);
+
+    // reopen and read again
+    setting.historizingBackend = UA_HistoryDataBackend_File(dir, 256, 0);
+    ck_assert_ptr_ne(setting.historizingBackend.context, NULL);
+    gathering->updateNodeIdSetting(server, gathering->context, &outNodeId, setting);
+
+    retval = testHistoricalDataBackend(100);
+    fprintf(stderr, "%d tests failed.\n", retval);
+    ck_assert_uint_eq(retval, 0);
+
+    // read continuous two at one request
+    retval = testHistoricalDataBackend(2);
+    fprintf(stderr, "%d tests failed.\n", retval);
+    ck_assert_uint_eq(retval, 0);
+
+    UA_HistoryDataBackend_File_deleteMembers(&setting.historizingBackend);
+    removeTestDirectory(dir);
+}
+END_TEST
+
+#define FILE_VALUES 100
+
+START_TEST(Server_HistorizingBackendFileRecovery)
+{
+    char dir[64];
+    makeTestDirectory(dir, sizeof(dir));
+    UA_NodeId nodeA = UA_NODEID_NUMERIC(1, 1234);
+    UA_NodeId nodeB = UA_NODEID_STRING(1, "history");
+
+    /* More than one index entry per segment */
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_File(dir, 2048, 0);
+    ck_assert_ptr_ne(backend.context, NULL);
+    for(size_t i = 0; i < FILE_VALUES; i++) {
+        UA_DataValue value;
+        fileTestValue(i, false, &value);
+        ck_assert_uint_eq(backend.serverSetHistoryData(server, backend.context, NULL, NULL,
+                                                       &nodeA, true, &value),
+                          UA_STATUSCODE_GOOD);
+        UA_DataValue_clear(&value);
+        fileTestValue(i, true, &value);
+        ck_assert_uint_eq(backend.serverSetHistoryData(server, backend.context, NULL, NULL,
+                                                       &nodeB, true, &value),
+                          UA_STATUSCODE_GOOD);
+        UA_DataValue_clear(&value);
+    }
+    ck_assert_uint_eq(backend.getEnd(server, backend.context, NULL, NULL, &nodeA), FILE_VALUES);
+    ck_assert_uint_eq(backend.getEnd(server, backend.context, NULL, NULL, &nodeB), FILE_VALUES);
+    for(size_t i = 0; i < FILE_VALUES; i++) {
+        checkFileTestValue(&backend, &nodeA, i, i, false);
+        checkFileTestValue(&backend, &nodeB, i, i, true);
+    }
+
+    UA_DateTime t = 51 * UA_DATETIME_SEC; /* Value 50 */
+    ck_assert_uint_eq(backend.getDateTimeMatch(server, backend.context, NULL, NULL, &nodeA,
+                                               t, MATCH_EQUAL), 50);
+    ck_assert_uint_eq(backend.getDateTimeMatch(server, backend.context, NULL, NULL, &nodeA,
+                                               t, MATCH_AFTER), 51);
+    ck_assert_uint_eq(backend.getDateTimeMatch(server, backend.context, NULL, NULL, &nodeA,
+                                               t, MATCH_BEFORE), 49);
+    ck_assert_uint_eq(backend.getDateTimeMatch(server, backend.context, NULL, NULL, &nodeA,
+                                               t + 1, MATCH_EQUAL_OR_AFTER), 51);
+    ck_assert_uint_eq(backend.getDateTimeMatch(server, backend.context, NULL, NULL, &nodeA,
+                                               t + 1, MATCH_EQUAL_OR_BEFORE), 50);
+    ck_assert_uint_eq(backend.getDateTimeMatch(server, backend.context, NULL, NULL, &nodeA,
+                                               t + 1, MATCH_EQUAL), FILE_VALUES);
+    ck_assert_uint_eq(backend.getDateTimeMatch(server, backend.context, NULL, NULL, &nodeA,
+                                               0, MATCH_BEFORE), FILE_VALUES);
+    UA_HistoryDataBackend_File_deleteMembers(&backend);
+
+    /* Simulate a crash. The last record of node A fails the checksum and it is
+     * followed by a partially written record. */
+    char path[512];
+    nodeSegmentFiles(dir, &nodeA, path, sizeof(path));
+    FILE *f = fopen(path, "r+b");
+    ck_assert_ptr_ne(f, NULL);
+    UA_Byte buf[2048];
+    size_t len = fread(buf, 1, sizeof(buf), f);
+    UA_UInt32 pos;
+    memcpy(&pos, &buf[8], sizeof(UA_UInt32));
+    UA_UInt32 last = 0;
+    while(pos + 16 <= len) {
+        UA_UInt32 size;
+        memcpy(&size, &buf[pos], sizeof(UA_UInt32));
+        if(size == 0)
+            break;
+        last = pos;
+        pos += 16 + ((size + 7) & ~7u);
+    }
+    ck_assert_uint_gt(last, 0);
+    ck_assert_uint_le(pos + 16, len);
+    buf[last + 20] ^= 0xff;
+    UA_UInt32 torn = 24;
+    memcpy(&buf[pos], &torn, sizeof(UA_UInt32));
+    memset(&buf[pos + 4], 0xaa, 12);
+    fseek(f, 0, SEEK_SET);
+    ck_assert_uint_eq(fwrite(buf, 1, len, f), len);
+    fclose(f);
+
+    /* A segment file that was created but never written */
+    snprintf(path, sizeof(path), "%s/ffffffff-0000-00000000.seg", dir);
+    f = fopen(path, "wb");
+    ck_assert_ptr_ne(f, NULL);
+    fputs("garbage", f);
+    fclose(f);
+
+    backend = UA_HistoryDataBackend_File(dir, 2048, 0);
+    ck_assert_ptr_ne(backend.context, NULL);
+    ck_assert_int_ne(access(path, F_OK), 0);
+    ck_assert_uint_eq(backend.getEnd(server, backend.context, NULL, NULL, &nodeA), FILE_VALUES - 1);
+    ck_assert_uint_eq(backend.getEnd(server, backend.context, NULL, NULL, &nodeB), FILE_VALUES);
+    checkFileTestValue(&backend, &nodeA, FILE_VALUES - 2, FILE_VALUES - 2, false);
+    checkFileTestValue(&backend, &nodeB, FILE_VALUES - 1, FILE_VALUES - 1, true);
+
+    /* Append after the recovered records */
+    UA_DataValue value;
+    fileTestValue(2 * FILE_VALUES, false, &value);
+    ck_assert_uint_eq(backend.serverSetHistoryData(server, backend.context, NULL, NULL,
+                                                   &nodeA, true, &value),
+                      UA_STATUSCODE_GOOD);
+    UA_DataValue_clear(&value);
+    UA_HistoryDataBackend_File_deleteMembers(&backend);
+
+    backend = UA_HistoryDataBackend_File(dir, 2048, 0);
+    ck_assert_ptr_ne(backend.context, NULL);
+    ck_assert_uint_eq(backend.getEnd(server, backend.context, NULL, NULL, &nodeA), FILE_VALUES);
+    checkFileTestValue(&backend, &nodeA, FILE_VALUES - 2, FILE_VALUES - 2, false);
+    checkFileTestValue(&backend, &nodeA, FILE_VALUES - 1, 2 * FILE_VALUES, false);
+    UA_HistoryDataBackend_File_deleteMembers(&backend);
+    removeTestDirectory(dir);
+}
+END_TEST
+
+START_TEST(Server_HistorizingBackendFileRetention)
+{
+    char dir[64];
+    makeTestDirectory(dir, sizeof(dir));
+    UA_NodeId nodeId = UA_NODEID_NUMERIC(1, 4711);
+
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_File(dir, 512, 2);
+    ck_assert_ptr_ne(backend.context, NULL);
+    for(size_t i = 0; i < FILE_VALUES; i++) {
+        UA_DataValue value;
+        fileTestValue(i, false, &value);
+        ck_assert_uint_eq(backend.serverSetHistoryData(server, backend.context, NULL, NULL,
+                                                       &nodeId, true, &value),
+                          UA_STATUSCODE_GOOD);
+        UA_DataValue_clear(&value);
+        ck_assert_uint_le(nodeSegmentFiles(dir, &nodeId, NULL, 0), 2);
+    }
+
+    /* The newest values are kept */
+    size_t end = backend.getEnd(server, backend.context, NULL, NULL, &nodeId);
+    ck_assert_uint_gt(end, 0);
+    ck_assert_uint_lt(end, FILE_VALUES);
+    for(size_t i = 0; i < end; i++)
+        checkFileTestValue(&backend, &nodeId, i, FILE_VALUES - end + i, false);
+    UA_HistoryDataBackend_File_deleteMembers(&backend);
+
+    backend = UA_HistoryDataBackend_File(dir, 512, 2);
+    ck_assert_uint_eq(backend.getEnd(server, backend.context, NULL, NULL, &nodeId), end);
+    UA_HistoryDataBackend_File_deleteMembers(&backend);
+    removeTestDirectory(dir);
+}
+END_TEST
+
+/* More segment files than can be mapped at the same time */
+#define FILE_MANY_VALUES 1000
+
+START_TEST(Server_HistorizingBackendFileManySegments)
+{
+    char dir[64];
+    makeTestDirectory(dir, sizeof(dir));
+    UA_NodeId nodeId = UA_NODEID_NUMERIC(1, 4712);
+
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_File(dir, 256, 0);
+    ck_assert_ptr_ne(backend.context, NULL);
+    for(size_t i = 0; i < FILE_MANY_VALUES; i++) {
+        UA_DataValue value;
+        fileTestValue(i, false, &value);
+        ck_assert_uint_eq(backend.serverSetHistoryData(server, backend.context, NULL, NULL,
+                                                       &nodeId, true, &value),
+                          UA_STATUSCODE_GOOD);
+        UA_DataValue_clear(&value);
+    }
+    ck_assert_uint_gt(nodeSegmentFiles(dir, &nodeId, NULL, 0), 128);
+    for(size_t i = 0; i < FILE_MANY_VALUES; i++)
+        checkFileTestValue(&backend, &nodeId, i, i, false);
+    UA_HistoryDataBackend_File_deleteMembers(&backend);
+
+    /* Reopen and read all values in one pass */
+    backend = UA_HistoryDataBackend_File(dir, 256, 0);
+    ck_assert_ptr_ne(backend.context, NULL);
+    ck_assert_uint_eq(backend.getEnd(server, backend.context, NULL, NULL, &nodeId),
+                      FILE_MANY_VALUES);
+    UA_DataValue *values = (UA_DataValue*)
+        UA_Array_new(FILE_MANY_VALUES, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    UA_ByteString cp = UA_BYTESTRING_NULL;
+    UA_ByteString outCp = UA_BYTESTRING_NULL;
+    size_t provided = 0;
+    UA_NumericRange range = {0, NULL};
+    ck_assert_uint_eq(backend.copyDataValues(server, backend.context, NULL, NULL, &nodeId,
+                                             0, FILE_MANY_VALUES - 1, false,
+                                             FILE_MANY_VALUES, range, false, &cp,
+                                             &outCp, &provided, values),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(provided, FILE_MANY_VALUES);
+    ck_assert_uint_eq(outCp.length, 0);
+    for(size_t i = 0; i < FILE_MANY_VALUES; i++) {
+        UA_DataValue expected;
+        fileTestValue(i, false, &expected);
+        ck_assert(dataValueEqual(&values[i], &expected));
+        UA_DataValue_clear(&expected);
+    }
+    UA_Array_delete(values, FILE_MANY_VALUES, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    UA_HistoryDataBackend_File_deleteMembers(&backend);
+    removeTestDirectory(dir);
+}
+END_TEST
+
+/* More nodes than sealed segments can be mapped. Every node appends to a small
+ * tail segment that grows. */
+#define FILE_NODES 200
+#define FILE_NODE_VALUES 200
+
+START_TEST(Server_HistorizingBackendFileManyNodes)
+{
+    char dir[64];
+    makeTestDirectory(dir, sizeof(dir));
+
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_File(dir, 0, 0);
+    ck_assert_ptr_ne(backend.context, NULL);
+    for(size_t i = 0; i < FILE_NODE_VALUES; i++) {
+        for(UA_UInt32 n = 0; n < FILE_NODES; n++) {
+            UA_NodeId nodeId = UA_NODEID_NUMERIC(1, 5000 + n);
+            UA_DataValue value;
+            fileTestValue(i, true, &value);
+            ck_assert_uint_eq(backend.serverSetHistoryData(server, backend.context, NULL,
+                                                           NULL, &nodeId, true, &value),
+                              UA_STATUSCODE_GOOD);
+            UA_DataValue_clear(&value);
+        }
+    }
+
+    /* One segment file per node that has grown beyond the initial size but
+     * not to the full segment size */
+    for(UA_UInt32 n = 0; n < FILE_NODES; n++) {
+        UA_NodeId nodeId = UA_NODEID_NUMERIC(1, 5000 + n);
+        char path[256];
+        ck_assert_uint_eq(nodeSegmentFiles(dir, &nodeId, path, sizeof(path)), 1);
+        struct stat st;
+        ck_assert_int_eq(stat(path, &st), 0);
+        ck_assert_uint_gt((size_t)st.st_size, 4096);
+        ck_assert_uint_lt((size_t)st.st_size, UA_HISTORY_FILE_SEGMENTSIZE / 64);
+    }
+    for(UA_UInt32 n = 0; n < FILE_NODES; n++) {
+        UA_NodeId nodeId = UA_NODEID_NUMERIC(1, 5000 + n);
+        ck_assert_uint_eq(backend.getEnd(server, backend.context, NULL, NULL, &nodeId),
+                          FILE_NODE_VALUES);
+        checkFileTestValue(&backend, &nodeId, 0, 0, true);
+        checkFileTestValue(&backend, &nodeId, FILE_NODE_VALUES - 1,
+                           FILE_NODE_VALUES - 1, true);
+    }
+    UA_HistoryDataBackend_File_deleteMembers(&backend);
+
+    /* Reopen and continue appending to the grown segments */
+    backend = UA_HistoryDataBackend_File(dir, 0, 0);
+    ck_assert_ptr_ne(backend.context, NULL);
+    for(UA_UInt32 n = 0; n < FILE_NODES; n++) {
+        UA_NodeId nodeId = UA_NODEID_NUMERIC(1, 5000 + n);
+        UA_DataValue value;
+        fileTestValue(FILE_NODE_VALUES, true, &value);
+        ck_assert_uint_eq(backend.serverSetHistoryData(server, backend.context, NULL,
+                                                       NULL, &nodeId, true, &value),
+                          UA_STATUSCODE_GOOD);
+        UA_DataValue_clear(&value);
+        ck_assert_uint_eq(nodeSegmentFiles(dir, &nodeId, NULL, 0), 1);
+        for(size_t i = 0; i <= FILE_NODE_VALUES; i++)
+            checkFileTestValue(&backend, &nodeId, i, i, true);
+    }
+    UA_HistoryDataBackend_File_deleteMembers(&backend);
+    removeTestDirectory(dir);
+}
+END_TEST
+
+#endif /* UA_ENABLE_HISTORIZING_FILE */
+
 #endif /*UA_ENABLE_HISTORIZING*/
 
 static Suite* testSuite_Client(void)
@@ -1026,10 +1770,22 @@ static Suite* testSuite_Client(void)
     tcase_add_test(tc_server, Server_HistorizingStrategyValueSet);
     tcase_add_test(tc_server, Server_HistorizingBackendMemory);
     tcase_add_test(tc_server, Server_HistorizingRandomIndexBackend);
+    tcase_add_test(tc_server, Server_HistorizingBackendGetDataValueFails);
     tcase_add_test(tc_server, Server_HistorizingUpdateDelete);
     tcase_add_test(tc_server, Server_HistorizingUpdateInsert);
     tcase_add_test(tc_server, Server_HistorizingUpdateReplace);
-    tcase_add_test(tc_server, Server_HistorizingUpdateUpdate);
+    tcase_add_loop_test(tc_server, Server_HistorizingUpdateUpdate, 0, UPDATE_BACKENDS);
+    tcase_add_test(tc_server, Server_HistorizingBackendMemoryCompressed);
+    tcase_add_test(tc_server, Server_HistorizingBackendMemoryCompressedRoundtrip);
+    tcase_add_test(tc_server, Server_HistorizingBackendMemoryCompressedRetention);
+    tcase_add_test(tc_server, Server_HistorizingBackendMemoryCompressedReplace);
+#ifdef UA_ENABLE_HISTORIZING_FILE
+    tcase_add_test(tc_server, Server_HistorizingBackendFile);
+    tcase_add_test(tc_server, Server_HistorizingBackendFileRecovery);
+    tcase_add_test(tc_server, Server_HistorizingBackendFileRetention);
+    tcase_add_test(tc_server, Server_HistorizingBackendFileManySegments);
+    tcase_add_test(tc_server, Server_HistorizingBackendFileManyNodes);
+#endif
 #endif /* UA_ENABLE_HISTORIZING */
     suite_add_tcase(s, tc_server);
 
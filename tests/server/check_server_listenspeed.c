@@ -0,0 +1,173 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* Measure the cost of one listen iteration of the TCP server network layer
+ * with many idle connections and a few active ones. The clients are plain
+ * sockets in the same process. */
+
+#include <open62541/network_tcp.h>
+#include <open62541/server_config_default.h>
+
+#include <check.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#define ACTIVECONNECTIONS 100
+#ifdef UA_ENABLE_EPOLL
+#define IDLECONNECTIONS 10000
+#else
+/* select cannot handle file descriptors beyond FD_SETSIZE. The client and the
+ * server side of a connection both use a file descriptor. */
+#define IDLECONNECTIONS ((FD_SETSIZE - 64) / 2 - ACTIVECONNECTIONS)
+#endif
+#define LISTENS 1000 /* Number of listen iterations to measure */
+
+static UA_Server *server;
+static UA_ServerNetworkLayer nl;
+static UA_NetworkStatistics statistics;
+static UA_SOCKET clients[IDLECONNECTIONS + ACTIVECONNECTIONS];
+static size_t clientsSize;
+static size_t idleConnections;
+
+static void
+listenUntilConnections(size_t connections) {
+    for(size_t i = 0; i < 100000; i++) {
+        if(statistics.currentConnectionCount == connections)
+            return;
+        nl.listen(&nl, server, 0);
+    }
+}
+
+static void setup(void) {
+    /* Every connection uses two file descriptors (client and server side) */
+    idleConnections = IDLECONNECTIONS;
+    struct rlimit limit;
+    if(getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+        size_t maxConnections = ((size_t)limit.rlim_cur - 64) / 2;
+        if(maxConnections < ACTIVECONNECTIONS + 1)
+            idleConnections = 1;
+        else if(maxConnections < idleConnections + ACTIVECONNECTIONS)
+            idleConnections = maxConnections - ACTIVECONNECTIONS;
+    }
+
+    server = UA_Server_new();
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_ServerConfig_setDefault(config);
+    config->maxSecureChannels = ACTIVECONNECTIONS; /* Don't purge the active */
+
+    memset(&statistics, 0, sizeof(UA_NetworkStatistics));
+    nl = UA_ServerNetworkLayerTCP(UA_ConnectionConfig_default, 0, 0,
+                                  &config->logger);
+    nl.statistics = &statistics;
+    UA_StatusCode retval = nl.start(&nl, &UA_STRING_NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Get the automatically selected port from the discovery url */
+    char url[256];
+    ck_assert_uint_lt(nl.discoveryUrl.length, sizeof(url));
+    memcpy(url, nl.discoveryUrl.data, nl.discoveryUrl.length);
+    url[nl.discoveryUrl.length] = 0;
+    char *port = strrchr(url, ':');
+    ck_assert_ptr_ne(port, NULL);
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((UA_UInt16)atoi(port + 1));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    /* Connect the clients. Accept in between to keep the backlog short. */
+    clientsSize = 0;
+    for(size_t i = 0; i < idleConnections + ACTIVECONNECTIONS; i++) {
+        UA_SOCKET s = UA_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        ck_assert(s != UA_INVALID_SOCKET);
+        int res = UA_connect(s, (struct sockaddr*)&addr, sizeof(addr));
+        ck_assert_int_eq(res, 0);
+        clients[clientsSize++] = s;
+        listenUntilConnections(clientsSize);
+    }
+    ck_assert_uint_eq(statistics.currentConnectionCount, clientsSize);
+}
+
+static void teardown(void) {
+    /* Close the clients and let the server pick up the remaining data */
+    for(size_t i = 0; i < clientsSize; i++)
+        UA_close(clients[i]);
+    listenUntilConnections(0);
+    ck_assert_uint_eq(statistics.currentConnectionCount, 0);
+    nl.stop(&nl, server);
+    nl.clear(&nl);
+    UA_Server_delete(server);
+}
+
+static double
+measureListens(UA_Boolean active) {
+    /* The active clients send the header of a large Hello message up front and
+     * then a few bytes in every iteration. The server keeps the incomplete
+     * chunk until it is complete. */
+    UA_Byte header[8] = {'H', 'E', 'L', 'F', 0xe8, 0xfd, 0x00, 0x00}; /* 65000 */
+    UA_Byte payload[8] = {0};
+    if(active) {
+        for(size_t i = idleConnections; i < clientsSize; i++)
+            ck_assert_int_eq(UA_send(clients[i], (const char*)header, 8, 0), 8);
+    }
+
+    /* Only the listen is measured */
+    clock_t duration = 0;
+    for(size_t i = 0; i < LISTENS; i++) {
+        if(active) {
+            for(size_t j = idleConnections; j < clientsSize; j++)
+                UA_send(clients[j], (const char*)payload, sizeof(payload), 0);
+        }
+        clock_t begin = clock();
+        nl.listen(&nl, server, 0);
+        duration += clock() - begin;
+    }
+    return (double)duration / CLOCKS_PER_SEC;
+}
+
+START_TEST(listenSpeedIdle) {
+    double time_spent = measureListens(false);
+    printf("%u listens with %u idle connections: %f s (%f us per listen)\n",
+           (unsigned)LISTENS, (unsigned)clientsSize, time_spent,
+           time_spent * 1000000.0 / LISTENS);
+    ck_assert_uint_eq(statistics.currentConnectionCount, clientsSize);
+} END_TEST
+
+START_TEST(listenSpeedActive) {
+    double time_spent = measureListens(true);
+    printf("%u listens with %u idle and %u active connections: %f s "
+           "(%f us per listen)\n", (unsigned)LISTENS, (unsigned)idleConnections,
+           (unsigned)ACTIVECONNECTIONS, time_spent,
+           time_spent * 1000000.0 / LISTENS);
+    ck_assert_uint_eq(statistics.currentConnectionCount, clientsSize);
+} END_TEST
+
+static Suite * testSuite_listenSpeed(void) {
+    Suite *s = suite_create("Listen Speed");
+    TCase *tc_listenspeed = tcase_create("Listen Speed");
+    tcase_add_checked_fixture(tc_listenspeed, setup, teardown);
+    tcase_set_timeout(tc_listenspeed, 120);
+    tcase_add_test(tc_listenspeed, listenSpeedIdle);
+    tcase_add_test(tc_listenspeed, listenSpeedActive);
+    suite_add_tcase(s,tc_listenspeed);
+    return s;
+}
+
+int main(void) {
+    int number_failed = 0;
+    Suite *s;
+    SRunner *sr;
+
+    s = testSuite_listenSpeed();
+    sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed += srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -19,6 +19,7 @@
 #endif
 
 static UA_Server *server = NULL;
+static size_t temperatureReads = 0;
 
 static UA_StatusCode
 readCPUTemperature(UA_Server *server_,
@@ -26,12 +27,30 @@ readCPUTemperature(UA_Server *server_,
                    const UA_NodeId *nodeId, void *nodeContext,
                    UA_Boolean sourceTimeStamp, const UA_NumericRange *range,
                    UA_DataValue *dataValue) {
+    temperatureReads++;
     UA_Float temp = 20.5f;
     UA_Variant_setScalarCopy(&dataValue->value, &temp, &UA_TYPES[UA_TYPES_FLOAT]);
     dataValue->hasValue = true;
     return UA_STATUSCODE_GOOD;
 }
 
+/* Replaces itself while the server lock is released for the read. This
+ * invalidates the cache entry of the variable. */
+static UA_StatusCode
+readCPUTemperatureReplace(UA_Server *server_,
+                          const UA_NodeId *sessionId, void *sessionContext,
+                          const UA_NodeId *nodeId, void *nodeContext,
+                          UA_Boolean sourceTimeStamp, const UA_NumericRange *range,
+                          UA_DataValue *dataValue) {
+    UA_DataSource ds;
+    ds.read = readCPUTemperature;
+    ds.write = NULL;
+    UA_StatusCode retval = UA_Server_setVariableNode_dataSource(server_, *nodeId, ds);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    return readCPUTemperature(server_, sessionId, sessionContext, nodeId, nodeContext,
+                              sourceTimeStamp, range, dataValue);
+}
+
 static void teardown(void) {
     UA_Server_delete(server);
 }
@@ -568,6 +587,90 @@ START_TEST(ReadSingleDataSourceAttributeValueWithoutTimestamp) {
     UA_DataValue_deleteMembers(&resp);
 } END_TEST
 
+static void
+readTemperatureWithMaxAge(UA_Double maxAge) {
+    UA_ReadValueId rvi;
+    UA_ReadValueId_init(&rvi);
+    rvi.nodeId = UA_NODEID_STRING(1, "cpu.temperature");
+    rvi.attributeId = UA_ATTRIBUTEID_VALUE;
+
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.maxAge = maxAge;
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_SERVER;
+    request.nodesToReadSize = 1;
+    request.nodesToRead = &rvi;
+
+    UA_ReadResponse response;
+    UA_ReadResponse_init(&response);
+    UA_LOCK(server->serviceMutex);
+    Service_Read(server, &server->adminSession, &request, &response);
+    UA_UNLOCK(server->serviceMutex);
+
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response.resultsSize, 1);
+    ck_assert(response.results[0].hasValue);
+    ck_assert(response.results[0].hasServerTimestamp);
+    ck_assert(response.results[0].value.type == &UA_TYPES[UA_TYPES_FLOAT]);
+    ck_assert(*(UA_Float*)response.results[0].value.data == 20.5f);
+    UA_ReadResponse_clear(&response);
+}
+
+START_TEST(ReadDataSourceValueCache) {
+    UA_NodeId id = UA_NODEID_STRING(1, "cpu.temperature");
+    UA_StatusCode retval = UA_Server_setVariableNode_dataSourceCache(server, id, -1.0);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_BADINVALIDARGUMENT);
+    retval = UA_Server_setVariableNode_dataSourceCache(server, UA_NODEID_NUMERIC(1, 50),
+                                                       10000.0);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_BADNODECLASSINVALID);
+    retval = UA_Server_setVariableNode_dataSourceCache(server, id, 10000.0);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* The first read fills the cache, the second is answered from it */
+    temperatureReads = 0;
+    readTemperatureWithMaxAge(10000.0);
+    readTemperatureWithMaxAge(10000.0);
+    ck_assert_uint_eq(temperatureReads, 1);
+    UA_ServerStatistics stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.dss.cacheMissCount, 1);
+    ck_assert_uint_eq(stats.dss.cacheHitCount, 1);
+
+    /* maxAge zero always reads from the DataSource */
+    readTemperatureWithMaxAge(0.0);
+    ck_assert_uint_eq(temperatureReads, 2);
+
+    /* Replacing the DataSource drops the cached value */
+    UA_DataSource ds;
+    ds.read = readCPUTemperature;
+    ds.write = NULL;
+    retval = UA_Server_setVariableNode_dataSource(server, id, ds);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    readTemperatureWithMaxAge(10000.0);
+    ck_assert_uint_eq(temperatureReads, 3);
+    readTemperatureWithMaxAge(10000.0);
+    ck_assert_uint_eq(temperatureReads, 3);
+
+    /* A value read before an invalidation is not cached */
+    ds.read = readCPUTemperatureReplace;
+    retval = UA_Server_setVariableNode_dataSource(server, id, ds);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    readTemperatureWithMaxAge(10000.0);
+    ck_assert_uint_eq(temperatureReads, 4);
+    readTemperatureWithMaxAge(10000.0);
+    ck_assert_uint_eq(temperatureReads, 5);
+    readTemperatureWithMaxAge(10000.0);
+    ck_assert_uint_eq(temperatureReads, 5);
+
+    /* Disable the cache */
+    retval = UA_Server_setVariableNode_dataSourceCache(server, id, 0.0);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    readTemperatureWithMaxAge(10000.0);
+    ck_assert_uint_eq(temperatureReads, 6);
+    stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.dss.cacheMissCount, 5);
+    ck_assert_uint_eq(stats.dss.cacheHitCount, 3);
+} END_TEST
+
 START_TEST(ReadSingleDataSourceAttributeDataTypeWithoutTimestamp) {
     UA_ReadValueId rvi;
     UA_ReadValueId_init(&rvi);
@@ -954,6 +1057,7 @@ static Suite * testSuite_services_attributes(void) {
     tcase_add_test(tc_readSingleAttributes, ReadSingleDataSourceAttributeValueWithoutTimestamp);
     tcase_add_test(tc_readSingleAttributes, ReadSingleDataSourceAttributeValueEmptyWithoutTimestamp);
     tcase_add_test(tc_readSingleAttributes, ReadSingleDataSourceAttributeDataTypeWithoutTimestamp);
+    tcase_add_test(tc_readSingleAttributes, ReadDataSourceValueCache);
     tcase_add_test(tc_readSingleAttributes, ReadSingleDataSourceAttributeArrayDimensionsWithoutTimestamp);
     tcase_add_test(tc_readSingleAttributes, ReadSingleAttributeDataTypeDefinitionWithoutTimestamp);
 
@@ -625,6 +625,69 @@ START_TEST(AddDoubleReference) {
 
 } END_TEST
 
+static UA_NodeId
+addObjType(UA_UInt32 id, UA_NodeId parentId, const char *name) {
+    UA_ObjectTypeAttributes attr = UA_ObjectTypeAttributes_default;
+    attr.displayName = UA_LOCALIZEDTEXT("", (char*)(uintptr_t)name);
+    UA_NodeId typeId = UA_NODEID_NUMERIC(1, id);
+    UA_StatusCode retval =
+        UA_Server_addObjectTypeNode(server, typeId, parentId,
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE),
+                                    UA_QUALIFIEDNAME(1, (char*)(uintptr_t)name),
+                                    attr, NULL, NULL);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    return typeId;
+}
+
+START_TEST(ChangeSubtypeReferences) {
+    UA_NodeId baseId = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE);
+    UA_NodeId typeA = addObjType(7000, baseId, "TypeA");
+    UA_NodeId typeB = addObjType(7001, typeA, "TypeB");
+    UA_NodeId typeC = addObjType(7002, baseId, "TypeC");
+
+    ck_assert(isNodeInTree(server, &typeB, &typeA, &subtypeId, 1));
+    ck_assert(isNodeInTree(server, &typeB, &baseId, &subtypeId, 1));
+    ck_assert(!isNodeInTree(server, &typeB, &typeC, &subtypeId, 1));
+    ck_assert(!isNodeInTree(server, &typeA, &typeB, &subtypeId, 1));
+
+    /* Add a second supertype */
+    UA_ExpandedNodeId targetB = UA_EXPANDEDNODEID_NUMERIC(1, 7001);
+    UA_StatusCode retval = UA_Server_addReference(server, typeC, subtypeId, targetB, true);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(isNodeInTree(server, &typeB, &typeC, &subtypeId, 1));
+
+    /* Remove the first supertype */
+    retval = UA_Server_deleteReference(server, typeA, subtypeId, true, targetB, true);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(!isNodeInTree(server, &typeB, &typeA, &subtypeId, 1));
+    ck_assert(isNodeInTree(server, &typeB, &typeC, &subtypeId, 1));
+
+    /* Deleting the type drops the cached supertypes */
+    retval = UA_Server_deleteNode(server, typeB, true);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(!isNodeInTree(server, &typeB, &typeC, &subtypeId, 1));
+    typeB = addObjType(7001, typeA, "TypeB");
+    ck_assert(isNodeInTree(server, &typeB, &typeA, &subtypeId, 1));
+    ck_assert(!isNodeInTree(server, &typeB, &typeC, &subtypeId, 1));
+} END_TEST
+
+START_TEST(DeleteTypeKeepReferences) {
+    UA_NodeId baseId = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE);
+    UA_NodeId typeA = addObjType(7000, baseId, "TypeA");
+    UA_NodeId typeB = addObjType(7001, typeA, "TypeB");
+    UA_NodeId typeC = addObjType(7002, baseId, "TypeC");
+    ck_assert(isNodeInTree(server, &typeB, &typeA, &subtypeId, 1));
+
+    /* The references to the deleted type remain. The cached supertypes are
+     * dropped anyway. */
+    UA_StatusCode retval = UA_Server_deleteNode(server, typeB, false);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(!isNodeInTree(server, &typeB, &typeA, &subtypeId, 1));
+    typeB = addObjType(7001, typeC, "TypeB");
+    ck_assert(!isNodeInTree(server, &typeB, &typeA, &subtypeId, 1));
+    ck_assert(isNodeInTree(server, &typeB, &typeC, &subtypeId, 1));
+} END_TEST
+
 int main(void) {
     Suite *s = suite_create("services_nodemanagement");
 
@@ -651,6 +714,8 @@ int main(void) {
     TCase *tc_addreferences = tcase_create("addreferences");
     tcase_add_checked_fixture(tc_addreferences, setup, teardown);
     tcase_add_test(tc_addreferences, AddDoubleReference);
+    tcase_add_test(tc_addreferences, ChangeSubtypeReferences);
+    tcase_add_test(tc_addreferences, DeleteTypeKeepReferences);
     suite_add_tcase(s, tc_addreferences);
 
     SRunner *sr = srunner_create(s);
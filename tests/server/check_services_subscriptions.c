@@ -422,21 +422,21 @@ START_TEST(Server_overflow) {
     notification = TAILQ_LAST(&mon->queue, NotificationQueue);
     ck_assert_uint_eq(notification->data.value.hasStatus, false);
 
-    UA_ByteString_deleteMembers(&mon->lastSampledValue);
+    UA_LastSample_clear(&mon->lastSample);
     UA_MonitoredItem_sampleCallback(server, mon);
     ck_assert_uint_eq(mon->queueSize, 2); 
     ck_assert_uint_eq(mon->maxQueueSize, 3); 
     notification = TAILQ_LAST(&mon->queue, NotificationQueue);
     ck_assert_uint_eq(notification->data.value.hasStatus, false);
 
-    UA_ByteString_deleteMembers(&mon->lastSampledValue);
+    UA_LastSample_clear(&mon->lastSample);
     UA_MonitoredItem_sampleCallback(server, mon);
     ck_assert_uint_eq(mon->queueSize, 3); 
     ck_assert_uint_eq(mon->maxQueueSize, 3); 
     notification = TAILQ_LAST(&mon->queue, NotificationQueue);
     ck_assert_uint_eq(notification->data.value.hasStatus, false);
 
-    UA_ByteString_deleteMembers(&mon->lastSampledValue);
+    UA_LastSample_clear(&mon->lastSample);
     UA_MonitoredItem_sampleCallback(server, mon);
     ck_assert_uint_eq(mon->queueSize, 3); 
     ck_assert_uint_eq(mon->maxQueueSize, 3); 
@@ -619,6 +619,107 @@ START_TEST(Server_deleteMonitoredItems) {
 }
 END_TEST
 
+static void
+deleteMonitoredItem(UA_UInt32 id) {
+    UA_DeleteMonitoredItemsRequest request;
+    UA_DeleteMonitoredItemsRequest_init(&request);
+    request.subscriptionId = subscriptionId;
+    request.monitoredItemIdsSize = 1;
+    request.monitoredItemIds = &id;
+
+    UA_DeleteMonitoredItemsResponse response;
+    UA_DeleteMonitoredItemsResponse_init(&response);
+
+    UA_LOCK(server->serviceMutex);
+    Service_DeleteMonitoredItems(server, session, &request, &response);
+    UA_UNLOCK(server->serviceMutex);
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response.resultsSize, 1);
+    ck_assert_uint_eq(response.results[0], UA_STATUSCODE_GOOD);
+
+    UA_DeleteMonitoredItemsResponse_deleteMembers(&response);
+}
+
+/* MonitoredItems with the same sampling interval share one sampling group */
+START_TEST(Server_samplingGroups) {
+    createSubscription();
+    UA_UInt32 ids[3];
+    for(size_t i = 0; i < 3; i++) {
+        createMonitoredItem();
+        ids[i] = monitoredItemId;
+    }
+
+    UA_SamplingGroup *sg = LIST_FIRST(&server->samplingGroups);
+    ck_assert_ptr_ne(sg, NULL);
+    ck_assert_ptr_eq(LIST_NEXT(sg, listEntry), NULL);
+    ck_assert_uint_eq(sg->itemsSize, 3);
+    for(size_t i = 0; i < sg->itemsSize; i++) {
+        ck_assert_ptr_eq(sg->items[i]->samplingGroup, sg);
+        ck_assert_uint_eq(sg->items[i]->samplingGroupIndex, i);
+    }
+
+    /* Sample all items from the shared callback */
+    UA_fakeSleep((UA_UInt32)sg->samplingInterval + 1);
+    UA_Server_run_iterate(server, false);
+
+    /* Removing an item moves the last item into its place */
+    deleteMonitoredItem(ids[0]);
+    ck_assert_uint_eq(sg->itemsSize, 2);
+    for(size_t i = 0; i < sg->itemsSize; i++)
+        ck_assert_uint_eq(sg->items[i]->samplingGroupIndex, i);
+
+    /* The group is removed with the last item */
+    deleteMonitoredItem(ids[1]);
+    deleteMonitoredItem(ids[2]);
+    ck_assert_ptr_eq(LIST_FIRST(&server->samplingGroups), NULL);
+}
+END_TEST
+
+#define INDEXITEMS 200
+
+/* MonitoredItems are found by their identifier after many insertions and
+ * removals */
+START_TEST(Server_monitoredItemsIndex) {
+    createSubscription();
+    UA_Subscription *sub = UA_Session_getSubscriptionById(session, subscriptionId);
+    ck_assert_ptr_ne(sub, NULL);
+
+    UA_UInt32 ids[INDEXITEMS];
+    for(size_t i = 0; i < INDEXITEMS; i++) {
+        createMonitoredItem();
+        ids[i] = monitoredItemId;
+    }
+    ck_assert_uint_eq(sub->monitoredItemsSize, INDEXITEMS);
+    ck_assert_uint_ge(sub->monitoredItemsIndex.slotsSize, 2 * INDEXITEMS);
+
+    /* Remove every other MonitoredItem */
+    for(size_t i = 0; i < INDEXITEMS; i += 2)
+        deleteMonitoredItem(ids[i]);
+    for(size_t i = 0; i < INDEXITEMS; i++) {
+        UA_MonitoredItem *mon = UA_Subscription_getMonitoredItem(sub, ids[i]);
+        if(i % 2 == 0) {
+            ck_assert_ptr_eq(mon, NULL);
+        } else {
+            ck_assert_ptr_ne(mon, NULL);
+            ck_assert_uint_eq(mon->monitoredItemId, ids[i]);
+        }
+    }
+
+    /* Unknown identifiers are not found */
+    ck_assert_ptr_eq(UA_Subscription_getMonitoredItem(sub, ids[INDEXITEMS-1] + 1), NULL);
+    UA_LOCK(server->serviceMutex);
+    ck_assert_uint_eq(UA_Subscription_deleteMonitoredItem(server, sub, ids[0]),
+                      UA_STATUSCODE_BADMONITOREDITEMIDINVALID);
+    UA_UNLOCK(server->serviceMutex);
+
+    /* The index shrinks when the MonitoredItems are removed */
+    for(size_t i = 1; i < INDEXITEMS; i += 2)
+        deleteMonitoredItem(ids[i]);
+    ck_assert_uint_eq(sub->monitoredItemsSize, 0);
+    ck_assert_uint_lt(sub->monitoredItemsIndex.slotsSize, 2 * INDEXITEMS);
+}
+END_TEST
+
 START_TEST(Server_lifeTimeCount) {
     /* Create a subscription */
     UA_CreateSubscriptionRequest request;
@@ -859,6 +960,8 @@ static Suite* testSuite_Client(void) {
     tcase_add_test(tc_server, Server_overflow);
     tcase_add_test(tc_server, Server_setMonitoringMode);
     tcase_add_test(tc_server, Server_deleteMonitoredItems);
+    tcase_add_test(tc_server, Server_samplingGroups);
+    tcase_add_test(tc_server, Server_monitoredItemsIndex);
     tcase_add_test(tc_server, Server_republish);
     tcase_add_test(tc_server, Server_republish_invalid);
     tcase_add_test(tc_server, Server_deleteSubscription);
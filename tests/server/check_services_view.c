@@ -161,6 +161,60 @@ START_TEST(Service_Browse_Recursive) {
 }
 END_TEST
 
+START_TEST(Service_Browse_NewReferenceTypeSubtype) {
+    UA_Server *server = UA_Server_new();
+    UA_ServerConfig_setDefault(UA_Server_getConfig(server));
+
+    /* Browse once to build the index of the ReferenceType hierarchy */
+    UA_BrowseDescription bd;
+    UA_BrowseDescription_init(&bd);
+    bd.resultMask = UA_BROWSERESULTMASK_ALL;
+    bd.nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+    bd.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HIERARCHICALREFERENCES);
+    bd.includeSubtypes = true;
+    bd.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+    UA_BrowseResult br = UA_Server_browse(server, 0, &bd);
+    ck_assert_int_eq(br.statusCode, UA_STATUSCODE_GOOD);
+    size_t before = br.referencesSize;
+    UA_BrowseResult_deleteMembers(&br);
+
+    /* Add a new subtype of HierarchicalReferences and use it */
+    UA_ReferenceTypeAttributes rattr = UA_ReferenceTypeAttributes_default;
+    rattr.displayName = UA_LOCALIZEDTEXT("", "MyReference");
+    UA_NodeId refTypeId = UA_NODEID_NUMERIC(1, 5000);
+    UA_StatusCode retval =
+        UA_Server_addReferenceTypeNode(server, refTypeId,
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_HIERARCHICALREFERENCES),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE),
+                                       UA_QUALIFIEDNAME(1, "MyReference"),
+                                       rattr, NULL, NULL);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_ObjectAttributes oattr = UA_ObjectAttributes_default;
+    oattr.displayName = UA_LOCALIZEDTEXT("", "MyObject");
+    retval = UA_Server_addObjectNode(server, UA_NODEID_NUMERIC(1, 5001),
+                                     UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                     refTypeId, UA_QUALIFIEDNAME(1, "MyObject"),
+                                     UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                                     oattr, NULL, NULL);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    br = UA_Server_browse(server, 0, &bd);
+    ck_assert_int_eq(br.statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(br.referencesSize, before + 1);
+    UA_BrowseResult_deleteMembers(&br);
+
+    /* Without subtypes, the new reference is not returned */
+    bd.includeSubtypes = false;
+    br = UA_Server_browse(server, 0, &bd);
+    ck_assert_int_eq(br.statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(br.referencesSize, 0);
+    UA_BrowseResult_deleteMembers(&br);
+
+    UA_Server_delete(server);
+}
+END_TEST
+
 START_TEST(Service_TranslateBrowsePathsToNodeIds) {
     UA_Client *client = UA_Client_new();
     UA_ClientConfig_setDefault(UA_Client_getConfig(client));
@@ -229,6 +283,7 @@ static Suite *testSuite_Service_TranslateBrowsePathsToNodeIds(void) {
     tcase_add_test(tc_browse, Service_Browse_WithBrowseName);
     tcase_add_test(tc_browse, Service_Browse_WithMaxResults);
     tcase_add_test(tc_browse, Service_Browse_Recursive);
+    tcase_add_test(tc_browse, Service_Browse_NewReferenceTypeSubtype);
     suite_add_tcase(s, tc_browse);
 
     TCase *tc_translate = tcase_create("TranslateBrowsePathsToNodeIds");
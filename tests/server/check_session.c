@@ -8,11 +8,13 @@
 #include <open62541/server_config_default.h>
 #include <open62541/types.h>
 
+#include "server/ua_server_internal.h"
 #include "server/ua_services.h"
 #include "client/ua_client_internal.h"
 
 #include <check.h>
 
+#include "testing_clock.h"
 #include "thread_wrapper.h"
 
 UA_Server *server;
@@ -113,6 +115,67 @@ START_TEST(Session_updateLifetime_ShallWork) {
 }
 END_TEST
 
+#define INDEXSESSIONS 100
+
+/* Sessions are found by their authentication token and SessionId. The cleanup
+ * removes exactly the sessions that have timed out. */
+START_TEST(Session_index) {
+    UA_Server *s = UA_Server_new();
+    UA_ServerConfig_setDefault(UA_Server_getConfig(s));
+
+    UA_Session *sessions[INDEXSESSIONS];
+    UA_NodeId tokens[INDEXSESSIONS];
+    UA_NodeId ids[INDEXSESSIONS];
+    UA_CreateSessionRequest request;
+    UA_CreateSessionRequest_init(&request);
+    UA_LOCK(s->serviceMutex);
+    for(size_t i = 0; i < INDEXSESSIONS; i++) {
+        request.requestedSessionTimeout = 1000.0 + (UA_Double)(i * 10);
+        UA_StatusCode retval = UA_Server_createSession(s, NULL, &request, &sessions[i]);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        tokens[i] = sessions[i]->header.authenticationToken;
+        ids[i] = sessions[i]->sessionId;
+    }
+    ck_assert_uint_eq(s->sessionCount, INDEXSESSIONS);
+
+    for(size_t i = 0; i < INDEXSESSIONS; i++) {
+        ck_assert_ptr_eq(getSessionByToken(s, &tokens[i]), sessions[i]);
+        ck_assert_ptr_eq(UA_Server_getSessionById(s, &ids[i]), sessions[i]);
+    }
+    ck_assert_ptr_eq(getSessionByToken(s, &ids[0]), NULL);
+
+    /* Extend the lifetime of the first session */
+    UA_fakeSleep(500);
+    UA_Session_updateLifetime(sessions[0]);
+
+    /* Sessions 1-49 have timed out */
+    UA_fakeSleep(995);
+    UA_Server_cleanupSessions(s, UA_DateTime_nowMonotonic());
+    ck_assert_uint_eq(s->sessionCount, INDEXSESSIONS - 49);
+    ck_assert_ptr_eq(getSessionByToken(s, &tokens[0]), sessions[0]);
+    for(size_t i = 1; i < INDEXSESSIONS; i++) {
+        UA_Session *expected = (i < 50) ? NULL : sessions[i];
+        ck_assert_ptr_eq(getSessionByToken(s, &tokens[i]), expected);
+        ck_assert_ptr_eq(UA_Server_getSessionById(s, &ids[i]), expected);
+    }
+
+    /* Remove by token */
+    ck_assert_uint_eq(UA_Server_removeSessionByToken(s, &tokens[0], UA_DIAGNOSTICEVENT_CLOSE),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(UA_Server_removeSessionByToken(s, &tokens[0], UA_DIAGNOSTICEVENT_CLOSE),
+                      UA_STATUSCODE_BADSESSIONIDINVALID);
+    ck_assert_uint_eq(s->sessionCount, INDEXSESSIONS - 50);
+
+    /* All remaining sessions time out */
+    UA_fakeSleep(1000 + (INDEXSESSIONS * 10));
+    UA_Server_cleanupSessions(s, UA_DateTime_nowMonotonic());
+    ck_assert_uint_eq(s->sessionCount, 0);
+    UA_UNLOCK(s->serviceMutex);
+
+    UA_Server_delete(s);
+}
+END_TEST
+
 static Suite* testSuite_Session(void) {
     Suite *s = suite_create("Session");
     TCase *tc_session = tcase_create("Core");
@@ -121,6 +184,9 @@ static Suite* testSuite_Session(void) {
     tcase_add_test(tc_session, Session_init_ShallWork);
     tcase_add_test(tc_session, Session_updateLifetime_ShallWork);
     suite_add_tcase(s,tc_session);
+    TCase *tc_index = tcase_create("Index");
+    tcase_add_test(tc_index, Session_index);
+    suite_add_tcase(s,tc_index);
     return s;
 }
 
@@ -699,6 +699,116 @@ START_TEST(eventStressing) {
     UA_DeleteMonitoredItemsResponse_deleteMembers(&deleteResponse);
 } END_TEST
 
+static UA_StatusCode
+emitEventLocked(const UA_NodeId origin) {
+    /* The fields reside on the stack. No node is created for the event. */
+    UA_QualifiedName severityName = UA_QUALIFIEDNAME(0, "Severity");
+    UA_QualifiedName messageName = UA_QUALIFIEDNAME(0, "Message");
+    UA_UInt16 eventSeverity = 1000;
+    UA_LocalizedText message = UA_LOCALIZEDTEXT("en-US", "Generated Event");
+    UA_EventField fields[2];
+    fields[0].browsePathSize = 1;
+    fields[0].browsePath = &severityName;
+    UA_Variant_setScalar(&fields[0].value, &eventSeverity, &UA_TYPES[UA_TYPES_UINT16]);
+    fields[1].browsePathSize = 1;
+    fields[1].browsePath = &messageName;
+    UA_Variant_setScalar(&fields[1].value, &message, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+
+    serverMutexLock();
+    UA_StatusCode retval = UA_Server_emitEvent(server, eventType, origin, 2, fields, NULL);
+    serverMutexUnlock();
+    return retval;
+}
+
+static void
+deleteMonitoredItem(void) {
+    UA_DeleteMonitoredItemsRequest deleteRequest;
+    UA_DeleteMonitoredItemsRequest_init(&deleteRequest);
+    deleteRequest.subscriptionId = subscriptionId;
+    deleteRequest.monitoredItemIds = &monitoredItemId;
+    deleteRequest.monitoredItemIdsSize = 1;
+
+    UA_DeleteMonitoredItemsResponse deleteResponse =
+        UA_Client_MonitoredItems_delete(client, deleteRequest);
+
+    ck_assert_uint_eq(deleteResponse.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(deleteResponse.resultsSize, 1);
+    ck_assert_uint_eq(*(deleteResponse.results), UA_STATUSCODE_GOOD);
+
+    UA_DeleteMonitoredItemsResponse_deleteMembers(&deleteResponse);
+}
+
+/* Events emitted without a node representation are received with the same
+ * values as triggered event nodes */
+START_TEST(emitEvents) {
+    UA_MonitoredItemCreateResult createResult = addMonitoredItem(handler_events_simple, true, true);
+    ck_assert_uint_eq(createResult.statusCode, UA_STATUSCODE_GOOD);
+    monitoredItemId = createResult.monitoredItemId;
+
+    UA_StatusCode retval = emitEventLocked(UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER));
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    notificationReceived = false;
+    sleepUntilAnswer(publishingInterval + 100);
+    retval = UA_Client_run_iterate(client, 0);
+    sleepUntilAnswer(publishingInterval + 100);
+    retval = UA_Client_run_iterate(client, 0);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(notificationReceived, true);
+
+    deleteMonitoredItem();
+} END_TEST
+
+START_TEST(emitEventsUppropagation) {
+    UA_MonitoredItemCreateResult createResult = addMonitoredItem(handler_events_propagate, true, true);
+    ck_assert_uint_eq(createResult.statusCode, UA_STATUSCODE_GOOD);
+    monitoredItemId = createResult.monitoredItemId;
+
+    /* The notifiers of the origin are cached after the first event */
+    UA_NodeId origin = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_VENDORSERVERINFO);
+    for(size_t i = 0; i < 2; i++) {
+        UA_StatusCode retval = emitEventLocked(origin);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+        notificationReceived = false;
+        sleepUntilAnswer(publishingInterval + 100);
+        retval = UA_Client_run_iterate(client, 0);
+        sleepUntilAnswer(publishingInterval + 100);
+        retval = UA_Client_run_iterate(client, 0);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(notificationReceived, true);
+    }
+
+    serverMutexLock();
+    UA_EventNotifierCacheEntry *entry = &server->eventNotifierCache
+        [UA_NodeId_hash(&origin) % UA_EVENTNOTIFIERCACHE_SIZE];
+    ck_assert(UA_NodeId_equal(&entry->origin, &origin));
+    ck_assert_uint_eq(entry->referenceVersion, server->referenceVersion);
+    ck_assert(entry->inObjectsFolder);
+    ck_assert_uint_ge(entry->emitNodesSize, 2);
+    serverMutexUnlock();
+
+    deleteMonitoredItem();
+} END_TEST
+
+START_TEST(emitEventsInvalid) {
+    /* Not an event type */
+    serverMutexLock();
+    UA_StatusCode retval =
+        UA_Server_emitEvent(server, UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                            UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER), 0, NULL, NULL);
+    serverMutexUnlock();
+    ck_assert_uint_eq(retval, UA_STATUSCODE_BADINVALIDARGUMENT);
+
+    /* Unknown origin */
+    retval = emitEventLocked(UA_NODEID_NUMERIC(1, 424242));
+    ck_assert_uint_eq(retval, UA_STATUSCODE_BADNOTFOUND);
+
+    /* Origin outside of the ObjectsFolder */
+    retval = emitEventLocked(UA_NODEID_NUMERIC(0, UA_NS0ID_TYPESFOLDER));
+    ck_assert_uint_eq(retval, UA_STATUSCODE_BADINVALIDARGUMENT);
+} END_TEST
+
 START_TEST(evaluateWhereClause) {
     /* Everything is on the stack, so no memory cleaning required.*/
     UA_NodeId eventNodeId;
@@ -772,6 +882,9 @@ static Suite *testSuite_Client(void) {
     tcase_add_test(tc_server, discardNewestOverflow);
     tcase_add_test(tc_server, eventStressing);
     tcase_add_test(tc_server, evaluateWhereClause);
+    tcase_add_test(tc_server, emitEvents);
+    tcase_add_test(tc_server, emitEventsUppropagation);
+    tcase_add_test(tc_server, emitEventsInvalid);
 #endif /* UA_ENABLE_SUBSCRIPTIONS_EVENTS */
     suite_add_tcase(s, tc_server);
 
@@ -192,6 +192,7 @@ function(ua_generate_datatypes)
         ${UA_GEN_DT_INTERNAL_ARG}
         ${UA_GEN_DT_OUTPUT_DIR}/${UA_GEN_DT_NAME}
         DEPENDS ${open62541_TOOLS_DIR}/generate_datatypes.py
+        ${open62541_TOOLS_DIR}/nodeset_compiler/backend_open62541_typedefinitions.py
         ${UA_GEN_DT_FILES_BSD}
         ${UA_GEN_DT_FILE_CSV}
         ${UA_GEN_DT_FILES_SELECTED})
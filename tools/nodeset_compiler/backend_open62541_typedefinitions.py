@@ -379,6 +379,14 @@ _UA_BEGIN_DECLS
             self.printh(
                 "extern UA_EXPORT const UA_DataType UA_" + self.parser.outname.upper() + "[UA_" + self.parser.outname.upper() + "_COUNT];")
 
+            if self.parser.outname == "types":
+                self.printh('''
+/* Hash tables to look up the index of a type from the numeric identifier of
+ * its typeId or binary encoding. Used internally by UA_findDataType. */
+#define UA_TYPES_HASHBITS %s
+extern const UA_UInt16 UA_TYPES_TYPEIDHASH[1 << UA_TYPES_HASHBITS];
+extern const UA_UInt16 UA_TYPES_BINARYENCODINGIDHASH[1 << UA_TYPES_HASHBITS];''' % self.get_hashbits())
+
             for i, t in enumerate(self.filtered_types):
                 self.printh("\n/**\n * " + t.name)
                 self.printh(" * " + "^" * len(t.name))
@@ -450,6 +458,56 @@ _UA_END_DECLS
                 self.printc(self.print_datatype(t) + ",")
             self.printc("};\n")
 
+            if self.parser.outname == "types":
+                self.print_hashtables()
+
+    def get_hashbits(self):
+        # At most half of the slots are used
+        bits = 1
+        while (1 << bits) < 2 * len(self.filtered_types):
+            bits += 1
+        return bits
+
+    def print_hashtables(self):
+        # Open addressing with linear probing. The slots contain the index + 1.
+        # Zero marks an empty slot. The hash function and the probing are
+        # mirrored by findDataTypeByNumericId in ua_types.c.
+        bits = self.get_hashbits()
+        size = 1 << bits
+        typeIds = []
+        binaryIds = []
+        for t in self.filtered_types:
+            if t.name not in self.parser.typedescriptions:
+                typeIds.append(None)
+                binaryIds.append(None)
+                continue
+            description = self.parser.typedescriptions[t.name]
+            nodeid = str(description.nodeid)
+            if nodeid.startswith("i="):
+                nodeid = nodeid[2:]
+            ns = int(description.namespaceid)
+            typeIds.append((ns, int(nodeid)) if nodeid.isdigit() else None)
+            binaryIds.append((ns, int(description.binaryEncodingId)))
+
+        def hashtable(ids):
+            table = [0] * size
+            seen = set()
+            for i, identifier in enumerate(ids):
+                # The first type with the identifier takes precedence
+                if not identifier or identifier[1] == 0 or identifier in seen:
+                    continue
+                seen.add(identifier)
+                slot = ((identifier[1] * 2654435761) & 0xffffffff) >> (32 - bits)
+                while table[slot] != 0:
+                    slot = (slot + 1) & (size - 1)
+                table[slot] = i + 1
+            return ", ".join(map(str, table))
+
+        self.printc("const UA_UInt16 UA_TYPES_TYPEIDHASH[1 << UA_TYPES_HASHBITS] = {" +
+                    hashtable(typeIds) + "};\n")
+        self.printc("const UA_UInt16 UA_TYPES_BINARYENCODINGIDHASH[1 << UA_TYPES_HASHBITS] = {" +
+                    hashtable(binaryIds) + "};\n")
+
     def print_encoding(self):
         self.printe('''/* Generated from ''' + self.inname + ''' with script ''' + sys.argv[0] + '''
  * on host ''' + platform.uname()[1] + ''' by user ''' + getpass.getuser() + ''' at ''' + time.strftime(
@@ -431,6 +431,9 @@ cmake \
     -DUA_ENABLE_DISCOVERY=ON \
     -DUA_ENABLE_DISCOVERY_MULTICAST=ON \
     -DUA_ENABLE_ENCRYPTION=ON \
+    -DUA_ENABLE_HISTORIZING=ON \
+    -DUA_ENABLE_HISTORIZING_FILE=ON \
+    -DUA_ENABLE_IMMUTABLE_NODES=ON \
     -DUA_ENABLE_JSON_ENCODING=ON \
     -DUA_ENABLE_PUBSUB=ON \
     -DUA_ENABLE_PUBSUB_DELTAFRAMES=ON \